@@ -29,7 +29,7 @@ setup(
         'tif': ['Pillow'],
         'test': ['requests', 'Pillow', 'mock', 'diskcache']
     },
-    install_requires=['bottle==0.13-dev'],
+    install_requires=['bottle==0.13-dev', 'numpy'],
     dependency_links=[
         dm3_url,
         bottle_url
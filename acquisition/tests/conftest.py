@@ -16,7 +16,9 @@ class Server(Thread):
         self.base_url = 'http://%s:%d' % (self.host, self.port)
         self.url = '%s/acquisition' % self.base_url
         self.dev = dev
-        self._server = WSGIRefServer(host=self.host, port=self.port)
+        self._server = WSGIRefServer(
+            host=self.host, port=self.port,
+            server_class=server.ThreadingWSGIServer)
 
     def run(self):
         self.setup()
@@ -4,6 +4,7 @@ import hashlib
 import sys
 import os
 import re
+import numpy as np
 from PIL import Image
 import dm3_lib as dm3
 
@@ -175,6 +176,43 @@ def test_tiff_stem_acquire(passive_acquisition_server, tmpdir,
             assert md5.hexdigest() == expected_md5.hexdigest()
 
 
+def test_tiff_next_frame(passive_acquisition_server, tmpdir,
+                         mock_tiff_tiltseries_writer):
+    id = 1234
+    request = jsonrpc_message({
+        'id': id,
+        'method': 'connect',
+        'params': {
+            'path': tmpdir.strpath,
+            'fileNameRegex': '.*\.tif'
+        }
+    })
+    response = requests.post(passive_acquisition_server.url, json=request)
+    assert response.status_code == 200, response.content
+
+    url = '%s/frames/next' % passive_acquisition_server.base_url
+    tilt_series = []
+    while len(tilt_series) < mock_tiff_tiltseries_writer.series_size:
+        response = requests.get(url, params={'timeout': 10})
+        assert response.status_code == 200, response.content
+
+        dtype = np.dtype(response.headers['X-Tomviz-Dtype'])
+        shape = [int(d) for d in response.headers['X-Tomviz-Shape'].split(',')]
+        frame = np.frombuffer(response.content,
+                              dtype=dtype.newbyteorder('<')).reshape(shape)
+        tilt_series.append(frame)
+
+    # Now check we got the right pixels
+    with Image.open(test_image()) as image_stack:
+        for i in range(0, image_stack.n_frames):
+            image_stack.seek(i)
+            assert np.array_equal(tilt_series[i], np.asarray(image_stack))
+
+    # No images left to fetch
+    response = requests.get(url, params={'timeout': 0.1})
+    assert response.status_code == 204
+
+
 def test_dm3_stem_acquire(passive_acquisition_server, tmpdir,
                           mock_dm3_tiltseries_writer):
     id = 1234
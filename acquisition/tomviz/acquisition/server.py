@@ -1,17 +1,22 @@
 import os
 import sys
+import json
+import time
 import tempfile
+import threading
 import importlib
 import inspect
 import logging
 import logging.handlers
 import bottle
 from bottle import run, route, request, HTTPResponse, Bottle
+from wsgiref.simple_server import WSGIServer
 
 import tomviz
 from tomviz import jsonrpc
 from tomviz.utility import inject
 from tomviz.acquisition import AbstractSource
+from tomviz.acquisition.utility import toarray
 import shutil
 
 # For python 3
@@ -20,16 +25,34 @@ try:
 except ImportError:
     pass
 
+try:
+    from SocketServer import ThreadingMixIn
+except ImportError:
+    # py3
+    from socketserver import ThreadingMixIn
+
 
 ADAPTER = 'tests.mock.source.ApiAdapter'
 HOST = 'localhost'
 PORT = 8080
 LOG_BUF_SIZE = 65536
+# Seconds a request for the next frame waits for one to be acquired.
+FRAME_TIMEOUT = 30
+# Seconds between asking the source for a frame while a request waits.
+FRAME_POLL_INTERVAL = 0.05
 
 logger = logging.getLogger('tomviz')
 app = Bottle()
 
 
+class ThreadingWSGIServer(ThreadingMixIn, WSGIServer):
+    """
+    Serves each request in its own thread, so requests waiting for frames
+    don't hold up the JSON-RPC calls.
+    """
+    daemon_threads = True
+
+
 def _load_source_adapter(source_adapter):
     logger.info('Loading source_adapter: %s', source_adapter)
     # First load the chosen source_adapter
@@ -67,6 +90,8 @@ def _setup_adapter(source_adapter): # noqa
 
     source_adapter = cls()
     slices = {}
+    # Requests are served concurrently, only one of them acquires at a time.
+    acquire_lock = threading.Lock()
 
     @jsonrpc.endpoint(path='/acquisition')
     @inject(source_adapter)
@@ -124,7 +149,8 @@ def _setup_adapter(source_adapter): # noqa
     @inject(source_adapter)
     def stem_acquire(source_adapter):
         id = 'stem_acquire_slice'
-        data = source_adapter.stem_acquire()
+        with acquire_lock:
+            data = source_adapter.stem_acquire()
 
         if data is None:
             return None
@@ -145,6 +171,38 @@ def _setup_adapter(source_adapter): # noqa
         else:
             return image_data_url
 
+    @route('/frames/next')
+    @inject(source_adapter)
+    def next_frame(source_adapter):
+        """
+        Waits for the source to acquire a frame and returns its pixels, raw
+        and C ordered, with the dtype, shape and metadata of the frame in the
+        headers. Returns 204 if no frame is acquired within the timeout.
+        """
+        timeout = float(request.query.timeout or FRAME_TIMEOUT)
+        deadline = time.time() + timeout
+        while True:
+            with acquire_lock:
+                data = source_adapter.stem_acquire()
+            if data is not None:
+                break
+            if time.time() >= deadline:
+                return HTTPResponse(status=204)
+            time.sleep(FRAME_POLL_INTERVAL)
+
+        metadata = {}
+        if isinstance(data, tuple):
+            (metadata, data) = data
+        frame = toarray(data)
+
+        headers = {
+            'Content-Type': 'application/octet-stream',
+            'X-Tomviz-Dtype': frame.dtype.name,
+            'X-Tomviz-Shape': ','.join(str(d) for d in frame.shape),
+            'X-Tomviz-Meta': json.dumps(metadata or {})
+        }
+        return HTTPResponse(body=frame.tobytes(), status=200, headers=headers)
+
     @route('/data/<id>')
     @inject(source_adapter)
     def data(source_adapter, id):
@@ -247,4 +305,5 @@ def start(host=HOST, port=PORT, debug=True, dev=False, adapter=ADAPTER):
     with app:
         setup(adapter, dev)
         logger.info('Starting HTTP server')
-        run(host=host, port=port, debug=debug)
+        run(host=host, port=port, debug=debug,
+            server_class=ThreadingWSGIServer)
@@ -1,4 +1,5 @@
 from io import BytesIO
+import numpy as np
 
 
 def tobytes(img, format='TIFF'):
@@ -6,3 +7,15 @@ def tobytes(img, format='TIFF'):
     img.save(buf, format)
 
     return buf.getvalue()
+
+
+def toarray(data):
+    """
+    Decode image data, as returned by a source, into a C ordered little endian
+    numpy array. Sources may also return the array directly.
+    """
+    if not isinstance(data, np.ndarray):
+        from PIL import Image
+        data = np.asarray(Image.open(BytesIO(data)))
+
+    return np.ascontiguousarray(data, dtype=data.dtype.newbyteorder('<'))
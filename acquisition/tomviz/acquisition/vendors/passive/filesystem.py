@@ -1,11 +1,16 @@
 import os
 import re
+import time
 try:
     import Queue as queue
 except ImportError:
     # py3
     import queue
 
+# Seconds within which files added to a directory may not change its
+# modification time.
+MTIME_RESOLUTION = 2
+
 
 class Monitor(object):
     def __init__(self, path, filename_regex=None,
@@ -16,32 +21,45 @@ class Monitor(object):
         self._filename_regex \
             = re.compile(filename_regex) if filename_regex else None
         self._listing = set()
+        self._mtime = None
+        self._incomplete = False
         self._valid_file_check = valid_file_check
 
     def _check(self):
+        # Only list the directory again if it has changed since the last
+        # check, or files may have been added within the resolution of its
+        # modification time, or some files were still being written.
+        mtime = os.stat(self._path).st_mtime
+        if mtime == self._mtime and not self._incomplete and \
+                time.time() - mtime > MTIME_RESOLUTION:
+            return
+        self._mtime = mtime
 
-        new_listing = os.listdir(self._path)
+        listing = os.listdir(self._path)
         # If we have a regex filter use it
         if self._filename_regex:
-            new_listing = filter(lambda f: self._filename_regex.match(f),
-                                 new_listing)
+            listing = [f for f in listing if self._filename_regex.match(f)]
 
-        # if we have a valid_file_check use it
+        # if we have a valid_file_check use it, only on the new files as it may
+        # have to open them.
+        new_files = [f for f in listing if f not in self._listing]
+        self._incomplete = False
         if self._valid_file_check:
-            new_listing = filter(lambda f: self._valid_file_check(
-                os.path.join(self._path, f)), new_listing)
+            valid_files = [f for f in new_files if self._valid_file_check(
+                os.path.join(self._path, f))]
+            self._incomplete = len(valid_files) < len(new_files)
+            new_files = valid_files
 
         # sort by m_time
-        new_listing = sorted(new_listing,
-                             key=lambda f: os.path.getmtime(
-                                 os.path.join(self._path, f)))
+        new_files = sorted(new_files,
+                           key=lambda f: os.path.getmtime(
+                               os.path.join(self._path, f)))
 
         # enqueue an new files
-        for f in new_listing:
-            if f not in self._listing:
-                absolute_path = os.path.join(self._path, f)
-                self._files.put(absolute_path)
-        self._listing = set(new_listing)
+        for f in new_files:
+            absolute_path = os.path.join(self._path, f)
+            self._files.put(absolute_path)
+        self._listing = self._listing.intersection(listing).union(new_files)
 
     def get(self):
         """
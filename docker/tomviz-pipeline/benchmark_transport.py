@@ -0,0 +1,134 @@
+"""Time pipeline runs in the tomviz-pipeline container with the data passed as
+EMD files and as raw files in shared memory, the two transports of the Docker
+executor.
+
+Each run writes the input on the host, runs a pass through operator in the
+container and reads the output back on the host, so the times include the
+start of the container. The host side writes and reads the files with h5py and
+numpy in the layout of the application's EmdFormat and raw files, so the times
+are an estimate of what the application sees.
+
+Needs docker, numpy, h5py and the tomviz Python package on the host:
+
+    python docker/tomviz-pipeline/benchmark_transport.py \\
+        --image tomviz/pipeline --size 512
+"""
+import argparse
+import json
+import os
+import shutil
+import subprocess
+import tempfile
+import time
+
+import h5py
+import numpy
+
+from tomviz import executor
+
+PASS_THROUGH = '''
+def transform_scalars(dataset):
+    from tomviz import utils
+    utils.set_scalars(dataset, utils.get_scalars(dataset))
+'''
+
+
+def _write_state(directory):
+    state = {
+        'dataSources': [{
+            'operators': [{
+                'label': 'Pass Through',
+                'script': PASS_THROUGH
+            }]
+        }]
+    }
+    with open(os.path.join(directory, 'state.tvsm'), 'w') as f:
+        json.dump(state, f)
+
+
+def _write_emd(path, data):
+    # As EmdFormat writes it, the names and units are arrays of one string.
+    strings = h5py.special_dtype(vlen=str)
+    with h5py.File(path, 'w') as f:
+        tomography = f.create_group('data/tomography')
+        tomography.attrs.create('emd_group_type', 1, dtype='uint32')
+        tomography.create_dataset('data', data=data)
+        for (dataset_name, name) in zip(executor.DIMS, ['x', 'y', 'z']):
+            dim = tomography.create_dataset(dataset_name, data=[0.0, 1.0])
+            dim.attrs.create('name', [name], dtype=strings)
+            dim.attrs.create('units', ['[n_m]'], dtype=strings)
+
+
+def _write_input(path, data):
+    if executor._is_raw(path):
+        executor._write_raw(path, data, [1.0, 1.0, 1.0])
+    else:
+        _write_emd(path, data)
+
+
+def _read_output(path):
+    if executor._is_raw(path):
+        data, _ = executor._read_raw(path)
+        # The output is mapped, copy it as the application does.
+        return numpy.array(data)
+    with h5py.File(path, 'r') as f:
+        return f['data/tomography/data'][:]
+
+
+def _run(image, directory, data, input_file, output_file):
+    start = time.time()
+    _write_input(os.path.join(directory, input_file), data)
+    subprocess.check_call([
+        'docker', 'run', '--rm',
+        '-u', '%d:%d' % (os.getuid(), os.getgid()),
+        '-v', '%s:/tomviz' % directory, image,
+        '-s', '/tomviz/state.tvsm',
+        '-d', '/tomviz/%s' % input_file,
+        '-o', '/tomviz/%s' % output_file
+    ])
+    output = _read_output(os.path.join(directory, output_file))
+    elapsed = time.time() - start
+
+    if not numpy.array_equal(output, data):
+        raise Exception('The output differs from the input.')
+
+    return elapsed
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n\n')[0])
+    parser.add_argument('--image', default='tomviz/pipeline',
+                        help='The tomviz-pipeline image to run.')
+    parser.add_argument('--size', type=int, default=512,
+                        help='The side of the float32 test volume.')
+    parser.add_argument('--repeat', type=int, default=3,
+                        help='The number of runs of each transport.')
+    args = parser.parse_args()
+
+    shape = (args.size,) * 3
+    data = numpy.random.random_sample(shape).astype(numpy.float32)
+    print('Volume of %s float32, %.1f MiB' % (shape, data.nbytes / 2**20))
+
+    transports = [
+        ('EMD', None, 'original.emd', 'transformed.emd'),
+        ('Shared memory', '/dev/shm', 'original.json', 'transformed.json')
+    ]
+    for (name, parent, input_file, output_file) in transports:
+        if parent is not None and not os.path.isdir(parent):
+            print('%s: %s is not available' % (name, parent))
+            continue
+        times = []
+        for _ in range(args.repeat):
+            directory = tempfile.mkdtemp(dir=parent)
+            try:
+                _write_state(directory)
+                times.append(_run(args.image, directory, data, input_file,
+                                  output_file))
+            finally:
+                shutil.rmtree(directory)
+        print('%s: best %.3f s, mean %.3f s over %d runs' %
+              (name, min(times), sum(times) / len(times), len(times)))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,123 @@
+/******************************************************************************
+
+  This source file is part of the tomviz project.
+
+  Copyright Kitware, Inc.
+
+  This source code is released under the New BSD License, (the "License").
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+******************************************************************************/
+#include <gtest/gtest.h>
+
+#include <vtkDataArray.h>
+#include <vtkImageData.h>
+#include <vtkNew.h>
+#include <vtkPointData.h>
+#include <vtkSmartPointer.h>
+
+#include "Utilities.h"
+
+using namespace tomviz;
+
+class AppendSliceTest : public ::testing::Test
+{
+protected:
+  vtkSmartPointer<vtkImageData> makeSlice(int type, double value)
+  {
+    auto slice = vtkSmartPointer<vtkImageData>::New();
+    slice->SetDimensions(8, 6, 1);
+    slice->AllocateScalars(type, 1);
+    slice->GetPointData()->GetScalars()->FillComponent(0, value);
+    return slice;
+  }
+
+  double valueAt(vtkImageData* image, int x, int y, int z)
+  {
+    return image->GetScalarComponentAsDouble(x, y, z, 0);
+  }
+};
+
+TEST_F(AppendSliceTest, append)
+{
+  auto image = makeSlice(VTK_UNSIGNED_SHORT, 0);
+  for (int i = 1; i < 5; ++i) {
+    ASSERT_TRUE(appendSlice(image, makeSlice(VTK_UNSIGNED_SHORT, i)));
+  }
+
+  int dims[3];
+  image->GetDimensions(dims);
+  ASSERT_EQ(dims[2], 5);
+  ASSERT_EQ(image->GetPointData()->GetScalars()->GetNumberOfTuples(),
+            8 * 6 * 5);
+  for (int z = 0; z < 5; ++z) {
+    ASSERT_EQ(valueAt(image, 0, 0, z), z);
+    ASSERT_EQ(valueAt(image, 7, 5, z), z);
+  }
+}
+
+TEST_F(AppendSliceTest, convertsType)
+{
+  auto image = makeSlice(VTK_FLOAT, 0.5);
+  ASSERT_TRUE(appendSlice(image, makeSlice(VTK_UNSIGNED_CHAR, 200)));
+  ASSERT_EQ(image->GetScalarType(), VTK_FLOAT);
+  ASSERT_EQ(valueAt(image, 3, 3, 0), 0.5);
+  ASSERT_EQ(valueAt(image, 3, 3, 1), 200.0);
+}
+
+TEST_F(AppendSliceTest, mismatch)
+{
+  auto image = makeSlice(VTK_FLOAT, 0);
+  vtkNew<vtkImageData> slice;
+  slice->SetDimensions(8, 7, 1);
+  slice->AllocateScalars(VTK_FLOAT, 1);
+  ASSERT_FALSE(appendSlice(image, slice.Get()));
+
+  vtkNew<vtkImageData> rgb;
+  rgb->SetDimensions(8, 6, 1);
+  rgb->AllocateScalars(VTK_FLOAT, 3);
+  ASSERT_FALSE(appendSlice(image, rgb.Get()));
+
+  int dims[3];
+  image->GetDimensions(dims);
+  ASSERT_EQ(dims[2], 1);
+}
+
+TEST_F(AppendSliceTest, sharedScalars)
+{
+  auto image = makeSlice(VTK_FLOAT, 1);
+  vtkNew<vtkImageData> copy;
+  copy->ShallowCopy(image);
+
+  // The data sharing the scalars doesn't see the new slice
+  ASSERT_TRUE(appendSlice(image, makeSlice(VTK_FLOAT, 2)));
+  ASSERT_NE(image->GetPointData()->GetScalars(),
+            copy->GetPointData()->GetScalars());
+  ASSERT_EQ(copy->GetPointData()->GetScalars()->GetNumberOfTuples(), 8 * 6);
+  ASSERT_EQ(valueAt(image, 0, 0, 0), 1.0);
+  ASSERT_EQ(valueAt(image, 0, 0, 1), 2.0);
+}
+
+TEST_F(AppendSliceTest, amortised)
+{
+  // The scalars are reallocated a logarithmic number of times.
+  auto image = makeSlice(VTK_FLOAT, 0);
+  auto slice = makeSlice(VTK_FLOAT, 1);
+  int reallocations = 0;
+  vtkIdType capacity = image->GetPointData()->GetScalars()->GetSize();
+  for (int i = 0; i < 256; ++i) {
+    ASSERT_TRUE(appendSlice(image, slice));
+    auto size = image->GetPointData()->GetScalars()->GetSize();
+    if (size != capacity) {
+      ++reallocations;
+      capacity = size;
+    }
+  }
+  ASSERT_LE(reallocations, 9);
+  ASSERT_EQ(valueAt(image, 4, 4, 256), 1.0);
+}
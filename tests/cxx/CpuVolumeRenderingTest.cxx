@@ -0,0 +1,234 @@
+/******************************************************************************
+
+  This source file is part of the tomviz project.
+
+  Copyright Kitware, Inc.
+
+  This source code is released under the New BSD License, (the "License").
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+******************************************************************************/
+#include <gtest/gtest.h>
+
+#include <vtkAutoInit.h>
+#include <vtkCamera.h>
+#include <vtkColorTransferFunction.h>
+#include <vtkDataArray.h>
+#include <vtkFixedPointVolumeRayCastMapper.h>
+#include <vtkGPUVolumeRayCastMapper.h>
+#include <vtkImageData.h>
+#include <vtkNew.h>
+#include <vtkPiecewiseFunction.h>
+#include <vtkPointData.h>
+#include <vtkRenderWindow.h>
+#include <vtkRenderer.h>
+#include <vtkTimerLog.h>
+#include <vtkVolume.h>
+#include <vtkVolumeProperty.h>
+#include <vtkWindowToImageFilter.h>
+
+#include <iostream>
+#include <random>
+#include <string>
+
+#include "CpuVolumeRendering.h"
+
+VTK_MODULE_INIT(vtkRenderingOpenGL2)
+VTK_MODULE_INIT(vtkRenderingVolumeOpenGL2)
+
+using namespace tomviz;
+
+class CpuVolumeRenderingTest : public ::testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    // A box of the 2D transfer function editor, its opacity ramps up along
+    // the scalar and is constant along the gradient magnitude.
+    transfer2D->SetDimensions(8, 8, 1);
+    transfer2D->AllocateScalars(VTK_FLOAT, 4);
+    transfer2D->GetPointData()->GetScalars()->FillComponent(0, 0);
+    transfer2D->GetPointData()->GetScalars()->FillComponent(1, 0);
+    transfer2D->GetPointData()->GetScalars()->FillComponent(2, 0);
+    transfer2D->GetPointData()->GetScalars()->FillComponent(3, 0);
+    for (int j = 3; j < 7; ++j) {
+      for (int i = 2; i < 6; ++i) {
+        transfer2D->SetScalarComponentFromDouble(i, j, 0, 0, i / 8.0);
+        transfer2D->SetScalarComponentFromDouble(i, j, 0, 1, 0.5);
+        transfer2D->SetScalarComponentFromDouble(i, j, 0, 2, 1);
+        transfer2D->SetScalarComponentFromDouble(i, j, 0, 3, alpha(i));
+      }
+    }
+  }
+
+  double alpha(int i) { return (i - 1) * 0.2; }
+
+  vtkNew<vtkImageData> transfer2D;
+  vtkNew<vtkColorTransferFunction> color;
+  vtkNew<vtkPiecewiseFunction> opacity;
+  vtkNew<vtkPiecewiseFunction> gradientOpacity;
+};
+
+TEST_F(CpuVolumeRenderingTest, softwareOpenGL)
+{
+  ASSERT_TRUE(isSoftwareOpenGL(
+    "OpenGL vendor string:  VMware, Inc.\n"
+    "OpenGL renderer string:  llvmpipe (LLVM 6.0, 256 bits)\n"
+    "OpenGL version string:  3.3 (Core Profile) Mesa 18.0.5\n"));
+  ASSERT_FALSE(isSoftwareOpenGL(
+    "OpenGL vendor string:  NVIDIA Corporation\n"
+    "OpenGL renderer string:  GeForce GTX 1080/PCIe/SSE2\n"
+    "OpenGL version string:  4.5.0 NVIDIA 390.48\n"));
+
+  // Assume a GPU when there's nothing to tell.
+  ASSERT_FALSE(isSoftwareOpenGL(nullptr));
+  ASSERT_FALSE(isSoftwareOpenGL(""));
+  ASSERT_TRUE(hasHardwareGpu(nullptr));
+}
+
+TEST_F(CpuVolumeRenderingTest, separateBox)
+{
+  const double range[2] = { 0, 80 };
+  separateTransferFunction2D(transfer2D.Get(), range, 20, color.Get(),
+                             opacity.Get(), gradientOpacity.Get());
+
+  // The product of the scalar and gradient opacities at the center of the
+  // bins is the 2D transfer function.
+  for (int j = 0; j < 8; ++j) {
+    for (int i = 0; i < 8; ++i) {
+      const bool inside = i >= 2 && i < 6 && j >= 3 && j < 7;
+      const double expected = inside ? alpha(i) : 0;
+      const double value = opacity->GetValue((i + 0.5) * 10) *
+                           gradientOpacity->GetValue((j + 0.5) * 2.5);
+      ASSERT_NEAR(value, expected, 1e-6);
+    }
+  }
+
+  double rgb[3];
+  color->GetColor(35, rgb);
+  ASSERT_NEAR(rgb[0], 3 / 8.0, 1e-6);
+  ASSERT_NEAR(rgb[1], 0.5, 1e-6);
+  ASSERT_NEAR(rgb[2], 1, 1e-6);
+}
+
+TEST_F(CpuVolumeRenderingTest, separateEmpty)
+{
+  const double range[2] = { 0, 80 };
+  separateTransferFunction2D(nullptr, range, 20, color.Get(), opacity.Get(),
+                             gradientOpacity.Get());
+  ASSERT_EQ(opacity->GetValue(40), 0);
+  ASSERT_EQ(gradientOpacity->GetValue(10), 0);
+}
+
+// Renders sparse particles offscreen along fixed camera paths, with the CPU
+// and the GPU mappers, and reports the time per frame. Disabled by default,
+// run it with:
+//   tomvizTests --gtest_filter=CpuVolumeRenderingTest.DISABLED_benchmark
+//     --gtest_also_run_disabled_tests
+TEST_F(CpuVolumeRenderingTest, DISABLED_benchmark)
+{
+  // Most of the voxels are background, which the transfer function hides.
+  const int size = 192;
+  vtkNew<vtkImageData> image;
+  image->SetDimensions(size, size, size);
+  image->AllocateScalars(VTK_UNSIGNED_CHAR, 1);
+  auto scalars = static_cast<unsigned char*>(image->GetScalarPointer());
+  std::mt19937 generator(0);
+  std::uniform_int_distribution<int> noise(0, 20);
+  for (vtkIdType i = 0; i < image->GetNumberOfPoints(); ++i) {
+    scalars[i] = static_cast<unsigned char>(noise(generator));
+  }
+  std::uniform_real_distribution<double> position(16, size - 16);
+  std::uniform_real_distribution<double> radius(4, 12);
+  for (int particle = 0; particle < 150; ++particle) {
+    const double c[3] = { position(generator), position(generator),
+                          position(generator) };
+    const double r = radius(generator);
+    for (int k = int(c[2] - r); k <= int(c[2] + r); ++k) {
+      for (int j = int(c[1] - r); j <= int(c[1] + r); ++j) {
+        for (int i = int(c[0] - r); i <= int(c[0] + r); ++i) {
+          const double d2 = (i - c[0]) * (i - c[0]) + (j - c[1]) * (j - c[1]) +
+                            (k - c[2]) * (k - c[2]);
+          if (d2 <= r * r) {
+            scalars[i + size * (j + size * k)] = 200;
+          }
+        }
+      }
+    }
+  }
+
+  vtkNew<vtkPiecewiseFunction> scalarOpacity;
+  scalarOpacity->AddPoint(0, 0);
+  scalarOpacity->AddPoint(50, 0);
+  scalarOpacity->AddPoint(200, 0.8);
+  scalarOpacity->AddPoint(255, 0.8);
+  vtkNew<vtkColorTransferFunction> colors;
+  colors->AddRGBPoint(0, 0, 0, 0);
+  colors->AddRGBPoint(255, 1, 0.9, 0.6);
+  vtkNew<vtkVolumeProperty> property;
+  property->SetScalarOpacity(scalarOpacity.Get());
+  property->SetColor(colors.Get());
+  property->SetInterpolationTypeToLinear();
+  property->ShadeOn();
+
+  vtkNew<vtkFixedPointVolumeRayCastMapper> cpuMapper;
+  setupCpuVolumeMapper(cpuMapper.Get());
+  vtkNew<vtkGPUVolumeRayCastMapper> gpuMapper;
+  vtkVolumeMapper* mappers[] = { cpuMapper.Get(), gpuMapper.Get() };
+  const char* names[] = { "cpu", "gpu" };
+
+  for (int m = 0; m < 2; ++m) {
+    vtkNew<vtkRenderWindow> window;
+    window->SetOffScreenRendering(1);
+    window->SetSize(512, 512);
+    vtkNew<vtkRenderer> renderer;
+    window->AddRenderer(renderer.Get());
+    mappers[m]->SetInputData(image.Get());
+    vtkNew<vtkVolume> volume;
+    volume->SetMapper(mappers[m]);
+    volume->SetProperty(property.Get());
+    renderer->AddVolume(volume.Get());
+    renderer->ResetCamera();
+    window->Render();
+
+    // Orbit around, look from above and below, then zoom in.
+    auto camera = renderer->GetActiveCamera();
+    vtkNew<vtkTimerLog> timer;
+    for (const std::string path : { "azimuth", "elevation", "zoom" }) {
+      const int frames = 24;
+      renderer->ResetCamera();
+      timer->StartTimer();
+      for (int frame = 0; frame < frames; ++frame) {
+        if (path == "azimuth") {
+          camera->Azimuth(15);
+        } else if (path == "elevation") {
+          camera->Elevation(15);
+          camera->OrthogonalizeViewUp();
+        } else {
+          camera->Dolly(1.05);
+          renderer->ResetCameraClippingRange();
+        }
+        window->Render();
+      }
+      timer->StopTimer();
+      const double msPerFrame = 1000 * timer->GetElapsedTime() / frames;
+      std::cout << names[m] << " " << path << ": " << msPerFrame
+                << " ms per frame" << std::endl;
+      RecordProperty(std::string(names[m]) + "_" + path,
+                     std::to_string(msPerFrame));
+    }
+
+    // The particles are in the image.
+    vtkNew<vtkWindowToImageFilter> capture;
+    capture->SetInput(window.Get());
+    capture->Update();
+    double pixelRange[2];
+    capture->GetOutput()->GetPointData()->GetScalars()->GetRange(pixelRange);
+    ASSERT_GT(pixelRange[1], 0);
+  }
+}
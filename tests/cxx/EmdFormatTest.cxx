@@ -0,0 +1,134 @@
+/******************************************************************************
+
+  This source file is part of the tomviz project.
+
+  Copyright Kitware, Inc.
+
+  This source code is released under the New BSD License, (the "License").
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+******************************************************************************/
+#include <QTemporaryDir>
+#include <QTest>
+
+#include <vtkImageData.h>
+#include <vtkNew.h>
+
+#include "EmdFormat.h"
+
+using namespace tomviz;
+
+class EmdFormatTest : public QObject
+{
+  Q_OBJECT
+
+private:
+  static float value(int x, int y, int z)
+  {
+    return x * 0.5f + y * 100.0f + z * 10000.0f;
+  }
+
+  // Returns true if the image holds the samples of the test volume within
+  // extent, taken every stride voxels.
+  bool isSubsample(vtkImageData* image, const int extent[6],
+                   const int stride[3])
+  {
+    int dims[3];
+    image->GetDimensions(dims);
+    for (int i = 0; i < 3; ++i) {
+      if (dims[i] != (extent[2 * i + 1] - extent[2 * i]) / stride[i] + 1) {
+        return false;
+      }
+    }
+    auto values = static_cast<float*>(image->GetScalarPointer());
+    for (int z = 0; z < dims[2]; ++z) {
+      for (int y = 0; y < dims[1]; ++y) {
+        for (int x = 0; x < dims[0]; ++x) {
+          if (*values++ != value(extent[0] + x * stride[0],
+                                 extent[2] + y * stride[1],
+                                 extent[4] + z * stride[2])) {
+            return false;
+          }
+        }
+      }
+    }
+    return true;
+  }
+
+  const int dims[3] = { 100, 70, 50 };
+  QTemporaryDir dir;
+  vtkNew<vtkImageData> volume;
+
+private slots:
+  void initTestCase()
+  {
+    volume->SetDimensions(dims[0], dims[1], dims[2]);
+    volume->AllocateScalars(VTK_FLOAT, 1);
+    auto values = static_cast<float*>(volume->GetScalarPointer());
+    for (int z = 0; z < dims[2]; ++z) {
+      for (int y = 0; y < dims[1]; ++y) {
+        for (int x = 0; x < dims[0]; ++x) {
+          *values++ = value(x, y, z);
+        }
+      }
+    }
+    QVERIFY(dir.isValid());
+  }
+
+  void read_data()
+  {
+    QTest::addColumn<int>("chunkSize");
+    QTest::addColumn<int>("compressionLevel");
+
+    QTest::newRow("contiguous") << 0 << 0;
+    QTest::newRow("chunked") << 16 << 0;
+    QTest::newRow("compressed") << 16 << 1;
+    QTest::newRow("large chunks") << 128 << 6;
+  }
+
+  void read()
+  {
+    QFETCH(int, chunkSize);
+    QFETCH(int, compressionLevel);
+
+    auto fileName = dir.filePath("volume.emd").toStdString();
+    EmdFormat writer;
+    writer.setChunkSize(chunkSize);
+    writer.setCompressionLevel(compressionLevel);
+    QVERIFY(writer.write(fileName, volume.Get()));
+
+    int whole[6] = { 0, dims[0] - 1, 0, dims[1] - 1, 0, dims[2] - 1 };
+    int unit[3] = { 1, 1, 1 };
+    vtkNew<vtkImageData> image;
+    QVERIFY(EmdFormat().read(fileName, image.Get()));
+    QVERIFY(isSubsample(image.Get(), whole, unit));
+
+    int extent[6] = { 5, 60, 3, 69, 10, 40 };
+    vtkNew<vtkImageData> subVolume;
+    QVERIFY(EmdFormat().read(fileName, subVolume.Get(), extent));
+    QVERIFY(isSubsample(subVolume.Get(), extent, unit));
+
+    int stride[3] = { 3, 2, 5 };
+    vtkNew<vtkImageData> subsample;
+    QVERIFY(EmdFormat().read(fileName, subsample.Get(), extent, stride));
+    QVERIFY(isSubsample(subsample.Get(), extent, stride));
+    double spacing[3];
+    subsample->GetSpacing(spacing);
+    QCOMPARE(spacing[0], 3.0);
+    QCOMPARE(spacing[2], 5.0);
+
+    // Strides larger than the chunks skip some of them entirely
+    int sparse[3] = { 33, 17, 20 };
+    vtkNew<vtkImageData> preview;
+    QVERIFY(EmdFormat().read(fileName, preview.Get(), whole, sparse));
+    QVERIFY(isSubsample(preview.Get(), whole, sparse));
+  }
+};
+
+QTEST_GUILESS_MAIN(EmdFormatTest)
+#include "EmdFormatTest.moc"
@@ -0,0 +1,139 @@
+/******************************************************************************
+
+  This source file is part of the tomviz project.
+
+  Copyright Kitware, Inc.
+
+  This source code is released under the New BSD License, (the "License").
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+******************************************************************************/
+#include <gtest/gtest.h>
+
+#include <vtkDataArray.h>
+#include <vtkImageData.h>
+#include <vtkMarchingCubes.h>
+#include <vtkMassProperties.h>
+#include <vtkMath.h>
+#include <vtkNew.h>
+#include <vtkPointData.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+#include <vtkSmartPointer.h>
+
+#include <cmath>
+
+#include "pvextensions/vtkImageBrickContour.h"
+
+class ImageBrickContourTest : public ::testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    // The distance to a sphere, positive inside.
+    image->SetDimensions(40, 35, 30);
+    image->AllocateScalars(VTK_FLOAT, 1);
+    auto array = image->GetPointData()->GetScalars();
+    array->SetName("scalars");
+    auto scalars = static_cast<float*>(array->GetVoidPointer(0));
+    for (int k = 0; k < 30; ++k) {
+      for (int j = 0; j < 35; ++j) {
+        for (int i = 0; i < 40; ++i) {
+          const double x[3] = { i - 19.3, j - 17.1, k - 14.6 };
+          *scalars++ = static_cast<float>(radius - vtkMath::Norm(x));
+        }
+      }
+    }
+    contour->SetInputData(image.Get());
+    contour->SetBrickSize(7);
+  }
+
+  vtkPolyData* extract(double value)
+  {
+    contour->SetValue(0, value);
+    contour->Update();
+    return contour->GetOutput();
+  }
+
+  double volume(vtkPolyData* surface)
+  {
+    vtkNew<vtkMassProperties> mass;
+    mass->SetInputData(surface);
+    mass->Update();
+    return mass->GetVolume();
+  }
+
+  const double radius = 11.3;
+  vtkNew<vtkImageData> image;
+  vtkNew<vtkImageBrickContour> contour;
+};
+
+TEST_F(ImageBrickContourTest, marchingCubes)
+{
+  auto surface = extract(0);
+
+  // The same triangles as a single pass over the image, only the points on
+  // the faces of the bricks are duplicated.
+  vtkNew<vtkMarchingCubes> marchingCubes;
+  marchingCubes->SetInputData(image.Get());
+  marchingCubes->SetValue(0, 0);
+  marchingCubes->Update();
+  ASSERT_EQ(surface->GetNumberOfPolys(),
+            marchingCubes->GetOutput()->GetNumberOfPolys());
+
+  const double expected = 4.0 / 3.0 * vtkMath::Pi() * std::pow(radius, 3);
+  ASSERT_NEAR(std::fabs(volume(surface)), expected, 0.02 * expected);
+
+  // The normals point out of the sphere.
+  auto normals = surface->GetPointData()->GetNormals();
+  ASSERT_NE(normals, nullptr);
+  for (vtkIdType i = 0; i < surface->GetNumberOfPoints(); ++i) {
+    double x[3], n[3];
+    surface->GetPoint(i, x);
+    normals->GetTuple(i, n);
+    x[0] -= 19.3;
+    x[1] -= 17.1;
+    x[2] -= 14.6;
+    vtkMath::Normalize(x);
+    ASSERT_GT(vtkMath::Dot(x, n), 0.9);
+  }
+}
+
+TEST_F(ImageBrickContourTest, cache)
+{
+  vtkSmartPointer<vtkPoints> points = extract(0)->GetPoints();
+  ASSERT_NE(extract(2.5)->GetPoints(), points.Get());
+  ASSERT_EQ(extract(0)->GetPoints(), points.Get());
+
+  // The cached surfaces are dropped when the image changes.
+  image->Modified();
+  ASSERT_NE(extract(0)->GetPoints(), points.Get());
+}
+
+TEST_F(ImageBrickContourTest, multipleValues)
+{
+  const vtkIdType inner = extract(5)->GetNumberOfPolys();
+  const vtkIdType outer = extract(-2)->GetNumberOfPolys();
+  ASSERT_GT(outer, inner);
+
+  contour->SetNumberOfContours(2);
+  contour->SetValue(0, 5);
+  contour->SetValue(1, -2);
+  contour->ComputeScalarsOn();
+  contour->Update();
+  auto surface = contour->GetOutput();
+  ASSERT_EQ(surface->GetNumberOfPolys(), inner + outer);
+
+  auto scalars = surface->GetPointData()->GetScalars();
+  ASSERT_NE(scalars, nullptr);
+  ASSERT_STREQ(scalars->GetName(), "scalars");
+  double range[2];
+  scalars->GetRange(range);
+  ASSERT_EQ(range[0], -2);
+  ASSERT_EQ(range[1], 5);
+}
@@ -0,0 +1,129 @@
+/******************************************************************************
+
+  This source file is part of the tomviz project.
+
+  Copyright Kitware, Inc.
+
+  This source code is released under the New BSD License, (the "License").
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+******************************************************************************/
+#include <gtest/gtest.h>
+
+#include <vtkDataArray.h>
+#include <vtkFloatArray.h>
+#include <vtkImageData.h>
+#include <vtkNew.h>
+#include <vtkPointData.h>
+#include <vtkSmartPointer.h>
+
+#include "ImagePyramid.h"
+
+using namespace tomviz;
+
+class ImagePyramidTest : public ::testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    // A linear ramp, so the averages are the values at the coarse voxels.
+    image->SetDimensions(6, 5, 3);
+    image->SetSpacing(1, 2, 3);
+    image->SetOrigin(10, 20, 30);
+    image->AllocateScalars(VTK_FLOAT, 1);
+    image->GetPointData()->GetScalars()->SetName("ramp");
+    for (int k = 0; k < 3; ++k) {
+      for (int j = 0; j < 5; ++j) {
+        for (int i = 0; i < 6; ++i) {
+          image->SetScalarComponentFromDouble(i, j, k, 0, i + 10 * j + 100 * k);
+        }
+      }
+    }
+  }
+
+  vtkNew<vtkImageData> image;
+};
+
+TEST_F(ImagePyramidTest, geometry)
+{
+  auto coarse = ImagePyramid::downsample(image.Get());
+  int dims[3];
+  coarse->GetDimensions(dims);
+  ASSERT_EQ(dims[0], 3);
+  ASSERT_EQ(dims[1], 3);
+  ASSERT_EQ(dims[2], 2);
+
+  // The coarse voxels are at the center of the voxels they average.
+  double spacing[3], origin[3];
+  coarse->GetSpacing(spacing);
+  coarse->GetOrigin(origin);
+  ASSERT_DOUBLE_EQ(spacing[0], 2);
+  ASSERT_DOUBLE_EQ(spacing[1], 4);
+  ASSERT_DOUBLE_EQ(spacing[2], 6);
+  ASSERT_DOUBLE_EQ(origin[0], 10.5);
+  ASSERT_DOUBLE_EQ(origin[1], 21);
+  ASSERT_DOUBLE_EQ(origin[2], 31.5);
+}
+
+TEST_F(ImagePyramidTest, average)
+{
+  auto coarse = ImagePyramid::downsample(image.Get());
+  auto scalars = coarse->GetPointData()->GetScalars();
+  ASSERT_NE(scalars, nullptr);
+  ASSERT_STREQ(scalars->GetName(), "ramp");
+  ASSERT_EQ(scalars->GetDataType(), VTK_FLOAT);
+
+  ASSERT_DOUBLE_EQ(coarse->GetScalarComponentAsDouble(0, 0, 0, 0), 55.5);
+  ASSERT_DOUBLE_EQ(coarse->GetScalarComponentAsDouble(2, 1, 0, 0), 79.5);
+
+  // The odd voxels at the end of y and z are averaged on their own.
+  ASSERT_DOUBLE_EQ(coarse->GetScalarComponentAsDouble(1, 2, 1, 0), 242.5);
+}
+
+TEST_F(ImagePyramidTest, integers)
+{
+  vtkNew<vtkImageData> bytes;
+  bytes->SetDimensions(2, 2, 1);
+  bytes->AllocateScalars(VTK_UNSIGNED_CHAR, 1);
+  bytes->SetScalarComponentFromDouble(0, 0, 0, 0, 0);
+  bytes->SetScalarComponentFromDouble(1, 0, 0, 0, 1);
+  bytes->SetScalarComponentFromDouble(0, 1, 0, 0, 1);
+  bytes->SetScalarComponentFromDouble(1, 1, 0, 0, 255);
+
+  // Rounded to the nearest, and the single voxel along z is left alone.
+  auto coarse = ImagePyramid::downsample(bytes.Get());
+  ASSERT_EQ(coarse->GetNumberOfPoints(), 1);
+  ASSERT_EQ(coarse->GetScalarComponentAsDouble(0, 0, 0, 0), 64);
+  ASSERT_EQ(coarse->GetSpacing()[2], 1);
+}
+
+TEST_F(ImagePyramidTest, arrays)
+{
+  vtkNew<vtkFloatArray> vectors;
+  vectors->SetName("vectors");
+  vectors->SetNumberOfComponents(3);
+  vectors->SetNumberOfTuples(image->GetNumberOfPoints());
+  vectors->FillComponent(0, 1);
+  vectors->FillComponent(1, 2);
+  vectors->FillComponent(2, 3);
+  image->GetPointData()->AddArray(vectors.Get());
+
+  auto coarse = ImagePyramid::downsample(image.Get());
+  auto array = coarse->GetPointData()->GetArray("vectors");
+  ASSERT_NE(array, nullptr);
+  ASSERT_EQ(array->GetNumberOfComponents(), 3);
+  ASSERT_EQ(array->GetNumberOfTuples(), coarse->GetNumberOfPoints());
+  double tuple[3];
+  array->GetTuple(coarse->GetNumberOfPoints() - 1, tuple);
+  ASSERT_FLOAT_EQ(tuple[0], 1);
+  ASSERT_FLOAT_EQ(tuple[1], 2);
+  ASSERT_FLOAT_EQ(tuple[2], 3);
+
+  // The active scalars are still the active scalars.
+  ASSERT_STREQ(coarse->GetPointData()->GetScalars()->GetName(), "ramp");
+}
@@ -0,0 +1,100 @@
+/******************************************************************************
+
+  This source file is part of the tomviz project.
+
+  Copyright Kitware, Inc.
+
+  This source code is released under the New BSD License, (the "License").
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+******************************************************************************/
+#include <gtest/gtest.h>
+
+#include <vtkCellArray.h>
+#include <vtkDataArray.h>
+#include <vtkImageData.h>
+#include <vtkMassProperties.h>
+#include <vtkNew.h>
+#include <vtkPointData.h>
+#include <vtkPolyData.h>
+#include <vtkSmartPointer.h>
+#include <vtkTriangleFilter.h>
+
+#include "pvextensions/vtkImageThresholdSurface.h"
+
+class ImageThresholdSurfaceTest : public ::testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    image->SetDimensions(6, 5, 4);
+    image->SetSpacing(1, 2, 3);
+    image->AllocateScalars(VTK_FLOAT, 1);
+    image->GetPointData()->GetScalars()->FillComponent(0, 0);
+  }
+
+  void setValue(int x, int y, int z, double value)
+  {
+    image->SetScalarComponentFromDouble(x, y, z, 0, value);
+  }
+
+  vtkPolyData* threshold(double lower, double upper)
+  {
+    filter->SetInputData(image.Get());
+    filter->ThresholdBetween(lower, upper);
+    filter->Update();
+    return filter->GetOutput();
+  }
+
+  double volume(vtkPolyData* surface)
+  {
+    vtkNew<vtkTriangleFilter> triangles;
+    triangles->SetInputData(surface);
+    vtkNew<vtkMassProperties> mass;
+    mass->SetInputConnection(triangles->GetOutputPort());
+    mass->Update();
+    return mass->GetVolume();
+  }
+
+  vtkNew<vtkImageData> image;
+  vtkNew<vtkImageThresholdSurface> filter;
+};
+
+TEST_F(ImageThresholdSurfaceTest, singleCell)
+{
+  for (int i = 0; i < 8; ++i) {
+    setValue(2 + (i & 1), 1 + ((i >> 1) & 1), 1 + (i >> 2), 1);
+  }
+
+  auto surface = threshold(0.5, 1.5);
+  ASSERT_EQ(surface->GetNumberOfPoints(), 8);
+  ASSERT_EQ(surface->GetNumberOfPolys(), 6);
+  ASSERT_NEAR(volume(surface), 1 * 2 * 3, 1e-6);
+
+  auto scalars = surface->GetPointData()->GetScalars();
+  ASSERT_NE(scalars, nullptr);
+  for (vtkIdType i = 0; i < scalars->GetNumberOfTuples(); ++i) {
+    ASSERT_EQ(scalars->GetComponent(i, 0), 1);
+  }
+}
+
+TEST_F(ImageThresholdSurfaceTest, wholeImage)
+{
+  // Only the boundary of the image is generated, none of the inner faces.
+  auto surface = threshold(-1, 1);
+  ASSERT_EQ(surface->GetNumberOfPolys(), 2 * (5 * 4 + 4 * 3 + 5 * 3));
+  ASSERT_EQ(surface->GetNumberOfPoints(), 6 * 5 * 4 - 4 * 3 * 2);
+  ASSERT_NEAR(volume(surface), 5 * 8 * 9, 1e-6);
+}
+
+TEST_F(ImageThresholdSurfaceTest, outOfRange)
+{
+  auto surface = threshold(0.5, 1.5);
+  ASSERT_EQ(surface->GetNumberOfPoints(), 0);
+  ASSERT_EQ(surface->GetNumberOfPolys(), 0);
+}
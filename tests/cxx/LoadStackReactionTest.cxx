@@ -0,0 +1,170 @@
+/******************************************************************************
+
+  This source file is part of the tomviz project.
+
+  Copyright Kitware, Inc.
+
+  This source code is released under the New BSD License, (the "License").
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+******************************************************************************/
+#include <gtest/gtest.h>
+
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QStringList>
+#include <QTemporaryDir>
+
+#include <vtkImageData.h>
+#include <vtkNew.h>
+#include <vtkTIFFWriter.h>
+
+#include "ImageStackModel.h"
+#include "LoadStackReaction.h"
+
+using namespace tomviz;
+
+class LoadStackReactionTest : public ::testing::Test
+{
+protected:
+  // Save the reader properties of a data source in a state and load them
+  // back, returning the file names and the reader options passed to
+  // LoadDataReaction::loadData().
+  QJsonObject saveAndReload(const QJsonObject& reader, QStringList& fileNames)
+  {
+    QJsonObject dataSource;
+    dataSource["reader"] = reader;
+    QJsonObject state;
+    state["dataSources"] = QJsonArray({ dataSource });
+    auto saved = QJsonDocument(state).toJson();
+
+    auto loaded = QJsonDocument::fromJson(saved).object();
+    auto options = loaded["dataSources"].toArray()[0].toObject()["reader"];
+    fileNames.clear();
+    for (auto value : options.toObject()["fileNames"].toArray()) {
+      fileNames << value.toString();
+    }
+    return options.toObject();
+  }
+
+  // Write a slice whose values are 100 times its index plus x, which doesn't
+  // depend on the orientation of the rows in the file.
+  QString writeSlice(int index, int type = VTK_UNSIGNED_SHORT, int width = 4,
+                     int height = 3)
+  {
+    vtkNew<vtkImageData> slice;
+    slice->SetDimensions(width, height, 1);
+    slice->AllocateScalars(type, 1);
+    for (int y = 0; y < height; ++y) {
+      for (int x = 0; x < width; ++x) {
+        slice->SetScalarComponentFromDouble(x, y, 0, 0, 100 * index + x);
+      }
+    }
+
+    auto fileName = dir.filePath(QString("slice_%1.tif").arg(index));
+    vtkNew<vtkTIFFWriter> writer;
+    writer->SetFileName(fileName.toLatin1().data());
+    writer->SetInputData(slice.Get());
+    writer->Write();
+    return fileName;
+  }
+
+  QStringList files = { "/data/tilt_000.tif", "/data/tilt_001.tif",
+                        "/data/tilt_002.tif" };
+  QTemporaryDir dir;
+};
+
+TEST_F(LoadStackReactionTest, fromDialog)
+{
+  // Without any reader options.
+  ASSERT_TRUE(LoadStackReaction::isTiffStack(files, QJsonObject()));
+  ASSERT_FALSE(LoadStackReaction::isTiffStack(files.mid(0, 1), QJsonObject()));
+  ASSERT_FALSE(LoadStackReaction::isTiffStack(
+    { "/data/tilt_000.png", "/data/tilt_001.png" }, QJsonObject()));
+}
+
+TEST_F(LoadStackReactionTest, saveAndReload)
+{
+  // As recorded by LoadDataReaction::loadData() and DataSource::setFileNames()
+  QJsonObject reader;
+  reader["name"] = LoadStackReaction::TIFF_STACK_READER;
+  reader["fileNames"] = QJsonArray::fromStringList(files);
+
+  QStringList fileNames;
+  auto options = saveAndReload(reader, fileNames);
+  ASSERT_EQ(fileNames, files);
+  ASSERT_TRUE(LoadStackReaction::isTiffStack(fileNames, options));
+
+  // Saved without a reader name.
+  reader.remove("name");
+  options = saveAndReload(reader, fileNames);
+  ASSERT_TRUE(LoadStackReaction::isTiffStack(fileNames, options));
+
+  // Saved when the stack was read by ParaView, it still is.
+  reader["name"] = "TIFFSeriesReader";
+  options = saveAndReload(reader, fileNames);
+  ASSERT_FALSE(LoadStackReaction::isTiffStack(fileNames, options));
+}
+
+TEST_F(LoadStackReactionTest, readTiffStack)
+{
+  ASSERT_TRUE(dir.isValid());
+  // Not in the order of the file names, the stack follows the list.
+  QStringList fileNames = { writeSlice(2), writeSlice(0), writeSlice(1) };
+
+  auto image = LoadStackReaction::readTiffStack(fileNames);
+  ASSERT_TRUE(image != nullptr);
+  int dims[3];
+  image->GetDimensions(dims);
+  ASSERT_EQ(dims[0], 4);
+  ASSERT_EQ(dims[1], 3);
+  ASSERT_EQ(dims[2], 3);
+  ASSERT_EQ(image->GetScalarType(), VTK_UNSIGNED_SHORT);
+  int extent[6];
+  image->GetExtent(extent);
+  int order[3] = { 2, 0, 1 };
+  for (int z = 0; z < 3; ++z) {
+    for (int y = 0; y < 3; ++y) {
+      for (int x = 0; x < 4; ++x) {
+        ASSERT_EQ(image->GetScalarComponentAsDouble(
+                    extent[0] + x, extent[2] + y, extent[4] + z, 0),
+                  100 * order[z] + x);
+      }
+    }
+  }
+
+  // The images must all have the same size and type.
+  ASSERT_TRUE(LoadStackReaction::readTiffStack(
+                { fileNames[0], writeSlice(3, VTK_UNSIGNED_CHAR) }) == nullptr);
+  ASSERT_TRUE(LoadStackReaction::readTiffStack(
+                { fileNames[0], writeSlice(4, VTK_UNSIGNED_SHORT, 5) }) ==
+              nullptr);
+}
+
+TEST_F(LoadStackReactionTest, loadTiffStack)
+{
+  ASSERT_TRUE(dir.isValid());
+  QStringList fileNames = { writeSlice(0), writeSlice(1),
+                            writeSlice(2, VTK_UNSIGNED_SHORT, 5, 6) };
+
+  auto summary = LoadStackReaction::loadTiffStack(fileNames);
+  ASSERT_EQ(summary.size(), 3);
+  for (int i = 0; i < 2; ++i) {
+    ASSERT_EQ(summary[i].fileInfo.absoluteFilePath(),
+              QFileInfo(fileNames[i]).absoluteFilePath());
+    ASSERT_EQ(summary[i].m, 4);
+    ASSERT_EQ(summary[i].n, 3);
+    ASSERT_TRUE(summary[i].consistent);
+  }
+  // An image of another size is reported, as inconsistent with the first.
+  ASSERT_EQ(summary[2].m, 5);
+  ASSERT_EQ(summary[2].n, 6);
+  ASSERT_FALSE(summary[2].consistent);
+}
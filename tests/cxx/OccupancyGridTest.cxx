@@ -0,0 +1,127 @@
+/******************************************************************************
+
+  This source file is part of the tomviz project.
+
+  Copyright Kitware, Inc.
+
+  This source code is released under the New BSD License, (the "License").
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+******************************************************************************/
+#include <gtest/gtest.h>
+
+#include <vtkDataArray.h>
+#include <vtkDoubleArray.h>
+#include <vtkImageData.h>
+#include <vtkMath.h>
+#include <vtkNew.h>
+#include <vtkPiecewiseFunction.h>
+#include <vtkPointData.h>
+#include <vtkSmartPointer.h>
+
+#include "OccupancyGrid.h"
+
+using namespace tomviz;
+
+class OccupancyGridTest : public ::testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    // A ramp along x, in three bricks of 32 cells along x covering the points
+    // [0, 32], [32, 64] and [64, 65], the last one having only NaNs.
+    image->SetDimensions(66, 2, 2);
+    image->AllocateScalars(VTK_FLOAT, 1);
+    for (int k = 0; k < 2; ++k) {
+      for (int j = 0; j < 2; ++j) {
+        for (int i = 0; i < 66; ++i) {
+          image->SetScalarComponentFromDouble(i, j, k, 0,
+                                              i < 64 ? i : vtkMath::Nan());
+        }
+      }
+    }
+    ranges = OccupancyGrid::computeRanges(image.Get(), 32);
+  }
+
+  vtkNew<vtkImageData> image;
+  vtkSmartPointer<vtkDoubleArray> ranges;
+};
+
+TEST_F(OccupancyGridTest, ranges)
+{
+  int counts[3];
+  OccupancyGrid::brickCounts(image->GetDimensions(), 32, counts);
+  ASSERT_EQ(counts[0], 3);
+  ASSERT_EQ(counts[1], 1);
+  ASSERT_EQ(counts[2], 1);
+
+  ASSERT_EQ(ranges->GetNumberOfComponents(), 2);
+  ASSERT_EQ(ranges->GetNumberOfTuples(), 3);
+  ASSERT_EQ(ranges->GetComponent(0, 0), 0);
+  ASSERT_EQ(ranges->GetComponent(0, 1), 32);
+  ASSERT_EQ(ranges->GetComponent(1, 0), 32);
+  ASSERT_EQ(ranges->GetComponent(1, 1), 63);
+
+  // Only NaNs, the range is inverted.
+  ASSERT_GT(ranges->GetComponent(2, 0), ranges->GetComponent(2, 1));
+}
+
+TEST_F(OccupancyGridTest, opacity)
+{
+  vtkNew<vtkPiecewiseFunction> opacity;
+  opacity->AddPoint(0, 0);
+  opacity->AddPoint(40, 0);
+  opacity->AddPoint(50, 1);
+  opacity->AddPoint(60, 0);
+  opacity->AddPoint(100, 0);
+  auto occupancy = OccupancyGrid::occupancy(ranges, opacity.Get());
+  ASSERT_EQ(occupancy.size(), 3u);
+  ASSERT_FALSE(occupancy[0]);
+  ASSERT_TRUE(occupancy[1]);
+  ASSERT_FALSE(occupancy[2]);
+
+  // The opacity of the last point extends beyond it when clamping.
+  opacity->RemoveAllPoints();
+  opacity->AddPoint(-10, 0);
+  opacity->AddPoint(-5, 0.5);
+  occupancy = OccupancyGrid::occupancy(ranges, opacity.Get());
+  ASSERT_TRUE(occupancy[0]);
+  ASSERT_TRUE(occupancy[1]);
+  ASSERT_FALSE(occupancy[2]);
+
+  opacity->ClampingOff();
+  occupancy = OccupancyGrid::occupancy(ranges, opacity.Get());
+  ASSERT_FALSE(occupancy[0]);
+  ASSERT_FALSE(occupancy[1]);
+}
+
+TEST_F(OccupancyGridTest, transfer2D)
+{
+  // Columns of 10 over [0, 100], the opacity of the 7th one, centered on 65,
+  // is interpolated down to the centers of its neighbors, 55 and 75.
+  vtkNew<vtkImageData> transfer2D;
+  transfer2D->SetDimensions(10, 4, 1);
+  transfer2D->AllocateScalars(VTK_FLOAT, 4);
+  vtkDataArray* rgba = transfer2D->GetPointData()->GetScalars();
+  rgba->FillComponent(3, 0);
+  transfer2D->SetScalarComponentFromDouble(6, 2, 0, 3, 0.5);
+  const double range[2] = { 0, 100 };
+  auto occupancy = OccupancyGrid::occupancy(ranges, transfer2D.Get(), range);
+  ASSERT_EQ(occupancy.size(), 3u);
+  ASSERT_FALSE(occupancy[0]);
+  ASSERT_TRUE(occupancy[1]);
+  ASSERT_FALSE(occupancy[2]);
+
+  // Down to 5 and 25.
+  rgba->FillComponent(3, 0);
+  transfer2D->SetScalarComponentFromDouble(1, 0, 0, 3, 1);
+  occupancy = OccupancyGrid::occupancy(ranges, transfer2D.Get(), range);
+  ASSERT_TRUE(occupancy[0]);
+  ASSERT_FALSE(occupancy[1]);
+  ASSERT_FALSE(occupancy[2]);
+}
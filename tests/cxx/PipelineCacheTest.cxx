@@ -0,0 +1,147 @@
+/******************************************************************************
+
+  This source file is part of the tomviz project.
+
+  Copyright Kitware, Inc.
+
+  This source code is released under the New BSD License, (the "License").
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+******************************************************************************/
+#include <gtest/gtest.h>
+
+#include <vtkImageData.h>
+#include <vtkNew.h>
+#include <vtkPointData.h>
+
+#include "PipelineCache.h"
+#include "operators/CropOperator.h"
+
+using namespace tomviz;
+
+class PipelineCacheTest : public ::testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    image->SetDimensions(32, 32, 32);
+    image->AllocateScalars(VTK_FLOAT, 1);
+    for (int i = 0; i < 3; ++i) {
+      outputs[i]->DeepCopy(image.Get());
+      int bounds[6] = { 0, 31 - i, 0, 31, 0, 31 };
+      crops[i].setCropBounds(bounds);
+      operators << &crops[i];
+    }
+  }
+
+  // Size of the image in the cache
+  qint64 imageSize() { return image->GetActualMemorySize() * 1024; }
+
+  vtkNew<vtkImageData> image;
+  // Outputs of the stages that don't share their arrays
+  vtkNew<vtkImageData> outputs[3];
+  CropOperator crops[3];
+  QList<Operator*> operators;
+};
+
+TEST_F(PipelineCacheTest, keys)
+{
+  auto keys = PipelineCache::stageKeys(image.Get(), operators);
+  ASSERT_EQ(keys.size(), 3);
+  ASSERT_EQ(keys, PipelineCache::stageKeys(image.Get(), operators));
+
+  // Changing the parameters of an operator changes its key and the keys of
+  // the operators after it.
+  int bounds[6] = { 1, 30, 0, 31, 0, 31 };
+  crops[1].setCropBounds(bounds);
+  auto modified = PipelineCache::stageKeys(image.Get(), operators);
+  ASSERT_EQ(modified[0], keys[0]);
+  ASSERT_NE(modified[1], keys[1]);
+  ASSERT_NE(modified[2], keys[2]);
+
+  // So does modifying the input.
+  image->Modified();
+  modified = PipelineCache::stageKeys(image.Get(), operators);
+  ASSERT_NE(modified[0], keys[0]);
+}
+
+TEST_F(PipelineCacheTest, findDeepest)
+{
+  PipelineCache cache(4 * imageSize());
+  auto keys = PipelineCache::stageKeys(image.Get(), operators);
+  int index;
+  ASSERT_TRUE(cache.findDeepest(keys, index) == nullptr);
+  ASSERT_EQ(index, -1);
+  ASSERT_EQ(cache.misses(), 3);
+
+  cache.insert(keys[0], image.Get());
+  cache.insert(keys[1], image.Get());
+  auto data = cache.findDeepest(keys, index);
+  ASSERT_EQ(index, 1);
+  ASSERT_EQ(cache.hits(), 2);
+  ASSERT_EQ(cache.misses(), 4);
+
+  // A shallow copy is handed out
+  auto cached = vtkImageData::SafeDownCast(data);
+  ASSERT_NE(cached, image.Get());
+  ASSERT_EQ(cached->GetPointData()->GetScalars(),
+            image->GetPointData()->GetScalars());
+}
+
+TEST_F(PipelineCacheTest, leastRecentlyUsed)
+{
+  PipelineCache cache(2 * imageSize());
+  auto keys = PipelineCache::stageKeys(image.Get(), operators);
+  cache.insert(keys[0], outputs[0].Get());
+  cache.insert(keys[1], outputs[1].Get());
+  ASSERT_EQ(cache.size(), 2 * imageSize());
+
+  // Using the first output makes the second the one to evict.
+  ASSERT_TRUE(cache.find(keys[0]) != nullptr);
+  cache.insert(keys[2], outputs[2].Get());
+  ASSERT_TRUE(cache.contains(keys[0]));
+  ASSERT_FALSE(cache.contains(keys[1]));
+  ASSERT_TRUE(cache.contains(keys[2]));
+  ASSERT_EQ(cache.size(), 2 * imageSize());
+
+  cache.setBudget(imageSize());
+  ASSERT_FALSE(cache.contains(keys[0]));
+  ASSERT_TRUE(cache.contains(keys[2]));
+
+  // Outputs larger than the budget aren't cached.
+  cache.setBudget(imageSize() - 1);
+  cache.clear();
+  cache.insert(keys[0], outputs[0].Get());
+  ASSERT_FALSE(cache.contains(keys[0]));
+  ASSERT_EQ(cache.size(), 0);
+}
+
+TEST_F(PipelineCacheTest, sharedArrays)
+{
+  // Stages that pass their input through share its arrays, which only take
+  // memory once.
+  PipelineCache cache(2 * imageSize());
+  auto keys = PipelineCache::stageKeys(image.Get(), operators);
+  for (int i = 0; i < 3; ++i) {
+    cache.insert(keys[i], image.Get());
+  }
+  ASSERT_EQ(cache.size(), imageSize());
+  for (int i = 0; i < 3; ++i) {
+    ASSERT_TRUE(cache.contains(keys[i]));
+  }
+
+  // The shared array is released with the last output holding it.
+  auto key = PipelineCache::stageKey(keys[2], &crops[0]);
+  cache.insert(key, outputs[0].Get());
+  ASSERT_EQ(cache.size(), 2 * imageSize());
+  cache.setBudget(imageSize());
+  ASSERT_FALSE(cache.contains(keys[0]));
+  ASSERT_FALSE(cache.contains(keys[2]));
+  ASSERT_TRUE(cache.contains(key));
+  ASSERT_EQ(cache.size(), imageSize());
+}
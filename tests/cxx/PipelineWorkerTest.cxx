@@ -0,0 +1,362 @@
+/******************************************************************************
+
+  This source file is part of the tomviz project.
+
+  Copyright Kitware, Inc.
+
+  This source code is released under the New BSD License, (the "License").
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+******************************************************************************/
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QIcon>
+#include <QSignalSpy>
+#include <QTest>
+
+#include <algorithm>
+
+#include <vtkDataArray.h>
+#include <vtkDoubleArray.h>
+#include <vtkFieldData.h>
+#include <vtkImageData.h>
+#include <vtkNew.h>
+#include <vtkPointData.h>
+#include <vtkSmartPointer.h>
+#include <vtkVector.h>
+
+#include "PipelineWorker.h"
+#include "PythonUtilities.h"
+#include "TomvizTest.h"
+#include "Utilities.h"
+#include "operators/CropOperator.h"
+#include "operators/Operator.h"
+#include "operators/OperatorPython.h"
+#include "operators/SetTiltAnglesOperator.h"
+#include "operators/TranslateAlignOperator.h"
+
+using namespace tomviz;
+
+// Adds one to every value, in place.
+class IncrementOperator : public Operator
+{
+public:
+  QString label() const override { return "Increment"; }
+  QIcon icon() const override { return QIcon(); }
+  Operator* clone() const override { return new IncrementOperator; }
+
+protected:
+  bool applyTransform(vtkDataObject* data) override
+  {
+    auto image = vtkImageData::SafeDownCast(data);
+    auto values = static_cast<unsigned short*>(image->GetScalarPointer());
+    vtkIdType count = image->GetNumberOfPoints();
+    for (vtkIdType i = 0; i < count; ++i) {
+      ++values[i];
+    }
+    return true;
+  }
+};
+
+class PipelineWorkerTest : public QObject
+{
+  Q_OBJECT
+
+private:
+  vtkSmartPointer<vtkImageData> makeImage(int dim)
+  {
+    auto image = vtkSmartPointer<vtkImageData>::New();
+    image->SetDimensions(dim, dim, dim);
+    image->AllocateScalars(VTK_UNSIGNED_SHORT, 1);
+    auto values = static_cast<unsigned short*>(image->GetScalarPointer());
+    for (vtkIdType i = 0; i < image->GetNumberOfPoints(); ++i) {
+      values[i] = static_cast<unsigned short>(i % 1000);
+    }
+    vtkNew<vtkDoubleArray> angles;
+    angles->SetName("tilt_angles");
+    angles->SetNumberOfTuples(dim);
+    angles->FillComponent(0, 0.0);
+    image->GetFieldData()->AddArray(angles.Get());
+    return image;
+  }
+
+  bool run(vtkDataObject* data, QList<Operator*> operators)
+  {
+    PipelineWorker worker;
+    auto future = worker.run(data, operators);
+    QSignalSpy finished(future, &PipelineWorker::Future::finished);
+    bool result = finished.wait(60000) && finished.at(0).at(0).toBool();
+    future->deleteLater();
+    return result;
+  }
+
+  // Reads the script of an ITK median filter operator, returns false if ITK's
+  // Python wrapping isn't available.
+  bool loadMedianScript(QString& script)
+  {
+    Python::initialize();
+    {
+      Python python;
+      if (!python.import("itk").isValid()) {
+        return false;
+      }
+    }
+    QFile file(QString("%1/fixtures/itk_median.py").arg(SOURCE_DIR));
+    if (!file.open(QIODevice::ReadOnly)) {
+      return false;
+    }
+    script = file.readAll();
+    return true;
+  }
+
+  // Runs the median filter script on two images of the given size, in two
+  // pipelines at the same time or one after the other.
+  bool runMedian(const QString& script, int dim, bool concurrent,
+                 vtkSmartPointer<vtkImageData> images[2])
+  {
+    OperatorPython operators[2];
+    for (int i = 0; i < 2; ++i) {
+      operators[i].setLabel("Median");
+      operators[i].setScript(script);
+      images[i] = makeImage(dim);
+    }
+
+    if (!concurrent) {
+      return run(images[0], { &operators[0] }) &&
+             run(images[1], { &operators[1] });
+    }
+
+    // Neither pipeline starts before the event loop runs.
+    PipelineWorker worker;
+    auto first = worker.run(images[0], &operators[0]);
+    auto second = worker.run(images[1], &operators[1]);
+    QSignalSpy firstFinished(first, &PipelineWorker::Future::finished);
+    QSignalSpy secondFinished(second, &PipelineWorker::Future::finished);
+    bool result = firstFinished.wait(120000) &&
+                  (secondFinished.count() > 0 || secondFinished.wait(120000));
+    result = result && firstFinished.at(0).at(0).toBool() &&
+             secondFinished.at(0).at(0).toBool();
+    first->deleteLater();
+    second->deleteLater();
+    return result;
+  }
+
+  bool isUnchanged(vtkImageData* image)
+  {
+    auto values = static_cast<unsigned short*>(image->GetScalarPointer());
+    for (vtkIdType i = 0; i < image->GetNumberOfPoints(); ++i) {
+      if (values[i] != i % 1000) {
+        return false;
+      }
+    }
+    auto angles = image->GetFieldData()->GetArray("tilt_angles");
+    for (vtkIdType i = 0; i < angles->GetNumberOfTuples(); ++i) {
+      if (angles->GetTuple1(i) != 0.0) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // Peak resident memory in kB since the last reset, or -1 if it can't be
+  // measured on this platform.
+  long long peakMemory()
+  {
+    QFile status("/proc/self/status");
+    if (!status.open(QIODevice::ReadOnly)) {
+      return -1;
+    }
+    for (auto line : status.readAll().split('\n')) {
+      if (line.startsWith("VmHWM:")) {
+        return line.mid(6).trimmed().split(' ').first().toLongLong();
+      }
+    }
+    return -1;
+  }
+
+  bool resetPeakMemory()
+  {
+    QFile clearRefs("/proc/self/clear_refs");
+    return clearRefs.open(QIODevice::WriteOnly) && clearRefs.write("5") == 1;
+  }
+
+  // Five operators, a mix of ones producing new arrays and ones modifying
+  // the data in place.
+  QList<Operator*> makePipeline(int dim)
+  {
+    auto translate = new TranslateAlignOperator(nullptr);
+    QVector<vtkVector2i> offsets(dim, vtkVector2i(1, -1));
+    translate->setAlignOffsets(offsets);
+
+    auto tiltAngles = new SetTiltAnglesOperator;
+    QMap<size_t, double> angles;
+    angles[0] = -60.0;
+    tiltAngles->setTiltAngles(angles);
+
+    auto crop = new CropOperator;
+    int bounds[6] = { 0, dim - 1, 0, dim - 1, 0, dim / 4 };
+    crop->setCropBounds(bounds);
+
+    QList<Operator*> operators;
+    operators << translate << tiltAngles << new IncrementOperator << crop
+              << new IncrementOperator;
+    return operators;
+  }
+
+private slots:
+  void copyOnWrite()
+  {
+    auto source = makeImage(16);
+    vtkNew<vtkImageData> data;
+    data->ShallowCopy(source);
+
+    auto tiltAngles = new SetTiltAnglesOperator;
+    QMap<size_t, double> angles;
+    angles[3] = 45.0;
+    tiltAngles->setTiltAngles(angles);
+    auto increment = new IncrementOperator;
+    QVERIFY(run(data.Get(), { tiltAngles, increment }));
+
+    // The shared arrays were copied before being modified
+    QVERIFY(isUnchanged(source));
+    auto values = static_cast<unsigned short*>(data->GetScalarPointer());
+    QCOMPARE(values[1234], static_cast<unsigned short>(1234 % 1000 + 1));
+    auto dataAngles = data->GetFieldData()->GetArray("tilt_angles");
+    QCOMPARE(dataAngles->GetTuple1(3), 45.0);
+
+    // Only arrays that are still shared get copied
+    QCOMPARE(detachSharedArrays(data.Get()), vtkIdType(0));
+
+    tiltAngles->deleteLater();
+    increment->deleteLater();
+  }
+
+  // A slice run on its own through an operator applying per slice comes out
+  // the same as when the whole volume is run.
+  void perSlice()
+  {
+    const int dim = 16;
+    auto volume = makeImage(dim);
+    auto translate = new TranslateAlignOperator(nullptr);
+    QVector<vtkVector2i> offsets;
+    for (int i = 0; i < dim; ++i) {
+      offsets.append(vtkVector2i(i % 3, -(i % 2)));
+    }
+    translate->setAlignOffsets(offsets);
+    QVERIFY(translate->appliesPerSlice());
+
+    const int index = 5;
+    vtkNew<vtkImageData> slice;
+    slice->SetExtent(0, dim - 1, 0, dim - 1, index, index);
+    slice->AllocateScalars(VTK_UNSIGNED_SHORT, 1);
+    std::copy_n(static_cast<unsigned short*>(volume->GetScalarPointer(
+                  0, 0, index)),
+                dim * dim,
+                static_cast<unsigned short*>(slice->GetScalarPointer()));
+
+    QVERIFY(run(volume, { translate }));
+    QVERIFY(run(slice.Get(), { translate }));
+    auto expected =
+      static_cast<unsigned short*>(volume->GetScalarPointer(0, 0, index));
+    auto values = static_cast<unsigned short*>(slice->GetScalarPointer());
+    QVERIFY(std::equal(values, values + dim * dim, expected));
+
+    translate->deleteLater();
+  }
+
+  // Peak memory of the pipeline when it is given a deep copy of the input, as
+  // it used to be, and when the copies are only made on write, which needs
+  // less.
+  void memoryPeak()
+  {
+    const int dim = 128;
+    auto source = makeImage(dim);
+    if (!resetPeakMemory() || peakMemory() < 0) {
+      QSKIP("Peak memory can't be measured on this platform");
+    }
+
+    long long peaks[2];
+    for (int deep = 0; deep < 2; ++deep) {
+      auto operators = makePipeline(dim);
+      resetPeakMemory();
+      long long start = peakMemory();
+      {
+        vtkNew<vtkImageData> data;
+        if (deep) {
+          data->DeepCopy(source);
+        } else {
+          data->ShallowCopy(source);
+        }
+        QVERIFY(run(data.Get(), operators));
+      }
+      peaks[deep] = peakMemory() - start;
+      QVERIFY(isUnchanged(source));
+      qDeleteAll(operators);
+    }
+
+    QVERIFY(peaks[0] < peaks[1]);
+  }
+
+  // Two pipelines running an ITK filter from Python share the one interpreter,
+  // the GIL is released while ITK updates so they overlap. They give the same
+  // results at the same time as one after the other.
+  void concurrentPython()
+  {
+    QString script;
+    if (!loadMedianScript(script)) {
+      QSKIP("ITK's Python wrapping isn't available");
+    }
+
+    const int dim = 64;
+    vtkSmartPointer<vtkImageData> results[2][2];
+    for (int concurrent = 0; concurrent < 2; ++concurrent) {
+      QVERIFY(runMedian(script, dim, concurrent, results[concurrent]));
+    }
+
+    auto first = results[0][0];
+    QCOMPARE(first->GetScalarType(), VTK_UNSIGNED_SHORT);
+    QVERIFY(!isUnchanged(first));
+    auto expected = static_cast<unsigned short*>(first->GetScalarPointer());
+    const vtkIdType count = first->GetNumberOfPoints();
+    for (auto& image : { results[0][1], results[1][0], results[1][1] }) {
+      QCOMPARE(image->GetScalarType(), VTK_UNSIGNED_SHORT);
+      QCOMPARE(image->GetNumberOfPoints(), count);
+      auto values = static_cast<unsigned short*>(image->GetScalarPointer());
+      QVERIFY(std::equal(values, values + count, expected));
+    }
+  }
+
+  // Times the two ITK pipelines one after the other and at the same time.
+  // QTest has no disabled tests, set TOMVIZ_RUN_BENCHMARKS to run it.
+  void DISABLED_concurrentPythonBenchmark()
+  {
+    if (qgetenv("TOMVIZ_RUN_BENCHMARKS").isEmpty()) {
+      QSKIP("Set TOMVIZ_RUN_BENCHMARKS to run benchmarks");
+    }
+    QString script;
+    if (!loadMedianScript(script)) {
+      QSKIP("ITK's Python wrapping isn't available");
+    }
+
+    const int dim = 128;
+    qint64 elapsed[2];
+    for (int concurrent = 0; concurrent < 2; ++concurrent) {
+      vtkSmartPointer<vtkImageData> images[2];
+      QElapsedTimer timer;
+      timer.start();
+      QVERIFY(runMedian(script, dim, concurrent, images));
+      elapsed[concurrent] = timer.elapsed();
+    }
+    qDebug() << "Two ITK pipelines, in ms: one after the other" << elapsed[0]
+             << "at the same time" << elapsed[1];
+  }
+};
+
+QTEST_GUILESS_MAIN(PipelineWorkerTest)
+#include "PipelineWorkerTest.moc"
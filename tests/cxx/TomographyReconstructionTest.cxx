@@ -0,0 +1,430 @@
+/******************************************************************************
+
+  This source file is part of the tomviz project.
+
+  Copyright Kitware, Inc.
+
+  This source code is released under the New BSD License, (the "License").
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+******************************************************************************/
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cmath>
+#include <vector>
+
+#include <vtkImageData.h>
+#include <vtkNew.h>
+
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include "TomographyReconstruction.h"
+#include "TomvizTest.h"
+
+using namespace tomviz;
+using namespace tomviz::TomographyReconstruction;
+
+class TomographyReconstructionTest : public ::testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    for (int t = 0; t < tilts; ++t) {
+      angles.push_back(-90 + 180.0 * t / tilts);
+    }
+
+    // A disk with an off center block in each slice, stored as the
+    // reconstructions are.
+    phantom.resize(static_cast<size_t>(slices) * rays * rays);
+    for (int s = 0; s < slices; ++s) {
+      for (int iy = 0; iy < rays; ++iy) {
+        for (int iz = 0; iz < rays; ++iz) {
+          double y = iy - rays / 2.0 + 0.5;
+          double z = iz - rays / 2.0 + 0.5;
+          float value = y * y + z * z < (8 + s) * (8 + s) ? 1.0f : 0.0f;
+          if (std::fabs(y - 3) < 3 && std::fabs(z + 2) < 4) {
+            value += 1;
+          }
+          phantom[voxel(s, iy, iz)] = value;
+        }
+      }
+    }
+
+    // Its projections through the system matrix.
+    auto matrix = parallelRay(rays, angles.data(), tilts);
+    tiltSeries->SetExtent(0, slices - 1, 0, rays - 1, 0, tilts - 1);
+    tiltSeries->AllocateScalars(VTK_FLOAT, 1);
+    auto data = static_cast<float*>(tiltSeries->GetScalarPointer());
+    for (int s = 0; s < slices; ++s) {
+      for (int row = 0; row < matrix.numOfRows; ++row) {
+        double sum = 0;
+        for (size_t i = matrix.rowOffsets[row]; i < matrix.rowOffsets[row + 1];
+             ++i) {
+          int column = matrix.columns[i];
+          sum += matrix.values[i] * phantom[voxel(s, column / rays,
+                                                  column % rays)];
+        }
+        int t = row / rays, r = row % rays;
+        data[(static_cast<size_t>(t) * rays + r) * slices + s] =
+          static_cast<float>(sum);
+      }
+    }
+  }
+
+  size_t voxel(int s, int iy, int iz) const
+  {
+    return (static_cast<size_t>(iz) * rays + iy) * slices + s;
+  }
+
+  // Relative root mean square error of a reconstruction.
+  double error(const std::vector<float>& recon) const
+  {
+    double difference = 0, norm = 0;
+    for (size_t i = 0; i < phantom.size(); ++i) {
+      difference += (recon[i] - phantom[i]) * (recon[i] - phantom[i]);
+      norm += phantom[i] * phantom[i];
+    }
+    return std::sqrt(difference / norm);
+  }
+
+  const int slices = 3, rays = 24, tilts = 45;
+  std::vector<double> angles;
+  std::vector<float> phantom;
+  vtkNew<vtkImageData> tiltSeries;
+};
+
+// At 0 and 90 degrees the rays run along the rows or the columns of the
+// pixels, crossing each one over its whole width.
+TEST_F(TomographyReconstructionTest, parallelRay)
+{
+  const int n = 5;
+  const double axisAligned[2] = { 0, 90 };
+  auto matrix = parallelRay(n, axisAligned, 2);
+  ASSERT_EQ(matrix.numOfRows, 2 * n);
+  ASSERT_EQ(matrix.numOfColumns, n * n);
+  ASSERT_EQ(matrix.rowOffsets.size(), static_cast<size_t>(2 * n + 1));
+  for (int row = 0; row < matrix.numOfRows; ++row) {
+    ASSERT_EQ(matrix.rowOffsets[row + 1] - matrix.rowOffsets[row],
+              static_cast<size_t>(n));
+    std::vector<bool> crossed(n * n, false);
+    for (size_t i = matrix.rowOffsets[row]; i < matrix.rowOffsets[row + 1];
+         ++i) {
+      ASSERT_NEAR(matrix.values[i], 1.0f, 1e-5);
+      ASSERT_FALSE(crossed[matrix.columns[i]]);
+      crossed[matrix.columns[i]] = true;
+    }
+  }
+
+  // At 45 degrees the central ray runs along the diagonal.
+  const double diagonal = 45;
+  matrix = parallelRay(n, &diagonal, 1);
+  double length = 0;
+  for (size_t i = matrix.rowOffsets[n / 2]; i < matrix.rowOffsets[n / 2 + 1];
+       ++i) {
+    length += matrix.values[i];
+  }
+  ASSERT_NEAR(length, n * std::sqrt(2.0), 1e-4);
+}
+
+// backward() is the adjoint of forward(): <A x, y> = <x, A^T y>.
+TEST_F(TomographyReconstructionTest, josephAdjoint)
+{
+  JosephProjector projector(rays, angles.data(), tilts, 0.5);
+  std::vector<float> image(projector.numberOfColumns());
+  std::vector<float> projections(projector.numberOfRows());
+  for (size_t i = 0; i < image.size(); ++i) {
+    image[i] = static_cast<float>((i * 7919) % 101) / 101;
+  }
+  for (size_t i = 0; i < projections.size(); ++i) {
+    projections[i] = static_cast<float>((i * 104729) % 97) / 97;
+  }
+
+  std::vector<float> work(projector.workSize());
+  std::vector<float> forward(projector.numberOfRows());
+  std::vector<float> backward(projector.numberOfColumns(), 0.0f);
+  projector.forward(image.data(), forward.data(), work.data());
+  projector.backward(projections.data(), backward.data(), work.data());
+  double left = 0, right = 0;
+  for (size_t i = 0; i < projections.size(); ++i) {
+    left += forward[i] * projections[i];
+  }
+  for (size_t i = 0; i < image.size(); ++i) {
+    right += image[i] * backward[i];
+  }
+  ASSERT_NEAR(left, right, 1e-4 * std::fabs(left));
+
+  // forEachInRow() walks the same weights.
+  for (int row = 0; row < projector.numberOfRows(); ++row) {
+    double sum = 0;
+    projector.forEachInRow(
+      row, [&](int column, float value) { sum += value * image[column]; });
+    ASSERT_NEAR(sum, forward[row], 1e-4);
+  }
+}
+
+// Both projectors see the same geometry, so they project the phantom alike.
+TEST_F(TomographyReconstructionTest, josephProjections)
+{
+  JosephProjector projector(rays, angles.data(), tilts);
+  std::vector<float> image(projector.numberOfColumns());
+  for (int iy = 0; iy < rays; ++iy) {
+    for (int iz = 0; iz < rays; ++iz) {
+      image[iy * rays + iz] = phantom[voxel(0, iy, iz)];
+    }
+  }
+  std::vector<float> work(projector.workSize());
+  std::vector<float> projections(projector.numberOfRows());
+  projector.forward(image.data(), projections.data(), work.data());
+
+  auto data = static_cast<float*>(tiltSeries->GetScalarPointer());
+  double difference = 0, norm = 0;
+  for (int row = 0; row < projector.numberOfRows(); ++row) {
+    float expected = data[static_cast<size_t>(row) * slices];
+    difference += (projections[row] - expected) * (projections[row] - expected);
+    norm += expected * expected;
+  }
+  ASSERT_LT(std::sqrt(difference / norm), 0.05);
+}
+
+TEST_F(TomographyReconstructionTest, art)
+{
+  std::vector<float> recon(phantom.size());
+  std::atomic<int> calls(0);
+  auto callback = [&calls]() {
+    ++calls;
+    return true;
+  };
+
+  ASSERT_TRUE(
+    art3(tiltSeries.Get(), angles.data(), recon.data(), 1, callback));
+  double first = error(recon);
+  ASSERT_TRUE(
+    art3(tiltSeries.Get(), angles.data(), recon.data(), 10, callback));
+  ASSERT_EQ(calls, slices * 11);
+  ASSERT_LT(error(recon), first);
+  ASSERT_LT(error(recon), 0.1);
+}
+
+TEST_F(TomographyReconstructionTest, sirt)
+{
+  std::vector<float> recon(phantom.size());
+  const SirtMethod methods[3] = { SirtMethod::Landweber, SirtMethod::Cimmino,
+                                  SirtMethod::ComponentAveraging };
+  const double stepSizes[3] = { 0.0005, 40, 1 };
+  for (int i = 0; i < 3; ++i) {
+    ASSERT_TRUE(sirt3(tiltSeries.Get(), angles.data(), recon.data(), 5,
+                      stepSizes[i], methods[i]));
+    double first = error(recon);
+    ASSERT_TRUE(sirt3(tiltSeries.Get(), angles.data(), recon.data(), 50,
+                      stepSizes[i], methods[i]));
+    ASSERT_LT(error(recon), first);
+    ASSERT_LT(error(recon), 0.2);
+  }
+}
+
+TEST_F(TomographyReconstructionTest, tvMinimization)
+{
+  std::vector<float> recon(phantom.size());
+  ASSERT_TRUE(
+    tvMinimization3(tiltSeries.Get(), angles.data(), recon.data(), 1));
+  double first = error(recon);
+  ASSERT_TRUE(
+    tvMinimization3(tiltSeries.Get(), angles.data(), recon.data(), 10));
+  ASSERT_LT(error(recon), first);
+  for (float value : recon) {
+    ASSERT_FALSE(std::isnan(value));
+  }
+}
+
+TEST_F(TomographyReconstructionTest, cancel)
+{
+  std::vector<float> recon(phantom.size());
+  std::atomic<int> calls(0);
+  auto callback = [&calls]() { return ++calls < 2; };
+  ASSERT_FALSE(
+    art3(tiltSeries.Get(), angles.data(), recon.data(), 100, callback));
+  // Each thread stops after the iteration it is running.
+  ASSERT_LT(calls, slices * 100);
+}
+
+// The reconstructions match those of the numpy implementations Recon_ART.py
+// and Recon_SIRT.py used, generated by fixtures/recon_reference.py.
+TEST_F(TomographyReconstructionTest, pythonReference)
+{
+  QFile file(QString("%1/fixtures/recon_reference.json").arg(SOURCE_DIR));
+  ASSERT_TRUE(file.open(QIODevice::ReadOnly));
+  auto reference = QJsonDocument::fromJson(file.readAll()).object();
+  const int n = reference["rays"].toInt();
+  const int numOfSlices = reference["slices"].toInt();
+  std::vector<double> referenceAngles;
+  for (auto angle : reference["angles"].toArray()) {
+    referenceAngles.push_back(angle.toDouble());
+  }
+  const int numOfTilts = static_cast<int>(referenceAngles.size());
+
+  vtkNew<vtkImageData> input;
+  input->SetExtent(0, numOfSlices - 1, 0, n - 1, 0, numOfTilts - 1);
+  input->AllocateScalars(VTK_FLOAT, 1);
+  auto data = static_cast<float*>(input->GetScalarPointer());
+  auto values = reference["tiltSeries"].toArray();
+  ASSERT_EQ(values.size(), numOfSlices * n * numOfTilts);
+  for (int i = 0; i < values.size(); ++i) {
+    data[i] = static_cast<float>(values[i].toDouble());
+  }
+
+  // Relative root mean square difference with the reference.
+  auto difference = [](const std::vector<float>& recon,
+                       const QJsonArray& expected) {
+    double difference = 0, norm = 0;
+    for (int i = 0; i < expected.size(); ++i) {
+      double value = expected[i].toDouble();
+      difference += (recon[i] - value) * (recon[i] - value);
+      norm += value * value;
+    }
+    return std::sqrt(difference / norm);
+  };
+
+  // The matrix-free projector interpolates between neighbouring pixels where
+  // the reference weights them by the length of the rays through them. Their
+  // projections of the phantom differ by about 2.5%, which the iterations
+  // take to a relative difference of about 0.11 for ART and 0.07 for SIRT.
+  struct
+  {
+    Projection projection;
+    double artTolerance;
+    double sirtTolerance;
+  } projections[] = { { Projection::SystemMatrix, 1e-4, 1e-4 },
+                      { Projection::MatrixFree, 0.15, 0.1 } };
+
+  std::vector<float> recon(static_cast<size_t>(numOfSlices) * n * n);
+  for (auto& p : projections) {
+    auto art = reference["art"].toObject();
+    ASSERT_TRUE(art3(input.Get(), referenceAngles.data(), recon.data(),
+                     art["iterations"].toInt(), IterationCallback(),
+                     p.projection));
+    ASSERT_LT(difference(recon, art["recon"].toArray()), p.artTolerance);
+
+    for (auto value : reference["sirt"].toArray()) {
+      auto sirt = value.toObject();
+      auto name = sirt["method"].toString();
+      auto method = name == "landweber"
+                      ? SirtMethod::Landweber
+                      : name == "cimmino" ? SirtMethod::Cimmino
+                                          : SirtMethod::ComponentAveraging;
+      ASSERT_TRUE(sirt3(input.Get(), referenceAngles.data(), recon.data(),
+                        sirt["iterations"].toInt(),
+                        sirt["stepSize"].toDouble(), method,
+                        IterationCallback(), p.projection));
+      ASSERT_LT(difference(recon, sirt["recon"].toArray()), p.sirtTolerance)
+        << name.toStdString();
+    }
+  }
+}
+
+// The projections were computed with the system matrix, so the matrix-free
+// reconstructions don't get as close to the phantom.
+TEST_F(TomographyReconstructionTest, matrixFree)
+{
+  std::vector<float> recon(phantom.size());
+  ASSERT_TRUE(art3(tiltSeries.Get(), angles.data(), recon.data(), 10,
+                   IterationCallback(), Projection::MatrixFree));
+  ASSERT_LT(error(recon), 0.2);
+
+  std::fill(recon.begin(), recon.end(), 0.0f);
+  ASSERT_TRUE(sirt3(tiltSeries.Get(), angles.data(), recon.data(), 50, 1,
+                    SirtMethod::ComponentAveraging, IterationCallback(),
+                    Projection::MatrixFree));
+  ASSERT_LT(error(recon), 0.2);
+}
+
+// The back projections and the direct Fourier method follow Recon_WBP.py and
+// Recon_DFT.py: at 0 degrees ray r runs along the row iy = r, where for the
+// system matrix it runs along the column iz = r. Their reconstructions are
+// the phantom rotated by 90 degrees.
+TEST_F(TomographyReconstructionTest, directFourier)
+{
+  auto rotatedError = [this](const std::vector<float>& recon) {
+    double difference = 0, norm = 0;
+    for (int s = 0; s < slices; ++s) {
+      for (int iy = 0; iy < rays; ++iy) {
+        for (int iz = 0; iz < rays; ++iz) {
+          double expected = phantom[voxel(s, rays - 1 - iz, iy)];
+          double value = recon[voxel(s, iy, iz)];
+          difference += (value - expected) * (value - expected);
+          norm += expected * expected;
+        }
+      }
+    }
+    return std::sqrt(difference / norm);
+  };
+
+  std::vector<float> recon(phantom.size());
+  ASSERT_TRUE(backProjection3(tiltSeries.Get(), angles.data(), recon.data(),
+                              Filter::Ramp));
+  double backProjectionError = rotatedError(recon);
+
+  // The phantom is sharp and small, and the projections come from a ray
+  // tracer centered half a pixel away, so neither method gets very close.
+  std::atomic<int> calls(0);
+  auto callback = [&calls](int, const float*) {
+    ++calls;
+    return true;
+  };
+  ASSERT_TRUE(directFourier3(tiltSeries.Get(), angles.data(), recon.data(),
+                             Interpolation::Bilinear, callback));
+  ASSERT_EQ(calls, slices);
+  double bilinearError = rotatedError(recon);
+  ASSERT_LT(bilinearError, backProjectionError);
+  ASSERT_LT(bilinearError, 0.3);
+
+  ASSERT_TRUE(directFourier3(tiltSeries.Get(), angles.data(), recon.data(),
+                             Interpolation::KaiserBessel));
+  ASSERT_LT(rotatedError(recon), bilinearError);
+}
+
+// The direct Fourier method reconstructs two slices at once, in the real and
+// imaginary parts of the transforms. Each comes out as when reconstructed
+// alone, next to a zero slice.
+TEST_F(TomographyReconstructionTest, directFourierPairs)
+{
+  std::vector<float> recon(phantom.size());
+  vtkNew<vtkImageData> single;
+  single->SetExtent(0, 0, 0, rays - 1, 0, tilts - 1);
+  single->AllocateScalars(VTK_FLOAT, 1);
+  auto data = static_cast<float*>(tiltSeries->GetScalarPointer());
+  auto singleData = static_cast<float*>(single->GetScalarPointer());
+  std::vector<float> alone(static_cast<size_t>(rays) * rays);
+
+  for (auto interpolation :
+       { Interpolation::Bilinear, Interpolation::KaiserBessel }) {
+    ASSERT_TRUE(directFourier3(tiltSeries.Get(), angles.data(), recon.data(),
+                               interpolation));
+    // Slices 0 and 1 are reconstructed together.
+    for (int s = 0; s < 2; ++s) {
+      for (int i = 0; i < rays * tilts; ++i) {
+        singleData[i] = data[static_cast<size_t>(i) * slices + s];
+      }
+      ASSERT_TRUE(directFourier3(single.Get(), angles.data(), alone.data(),
+                                 interpolation));
+      double difference = 0, norm = 0;
+      for (int iy = 0; iy < rays; ++iy) {
+        for (int iz = 0; iz < rays; ++iz) {
+          double expected = alone[static_cast<size_t>(iz) * rays + iy];
+          double value = recon[voxel(s, iy, iz)];
+          difference += (value - expected) * (value - expected);
+          norm += expected * expected;
+        }
+      }
+      ASSERT_LT(std::sqrt(difference / norm), 1e-5);
+    }
+  }
+}
@@ -0,0 +1,124 @@
+/******************************************************************************
+
+  This source file is part of the tomviz project.
+
+  Copyright Kitware, Inc.
+
+  This source code is released under the New BSD License, (the "License").
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+******************************************************************************/
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+#include <vtkImageData.h>
+#include <vtkNew.h>
+#include <vtkPointData.h>
+
+#include "TomographyTiltSeries.h"
+
+using namespace tomviz;
+
+class TomographyTiltSeriesTest : public ::testing::Test
+{
+protected:
+  // Fill a [slices, rays, tilts] unsigned short tilt series with a value that
+  // encodes the position of each sample.
+  void makeTiltSeries(vtkImageData* image, int slices, int rays, int tilts)
+  {
+    image->SetExtent(0, slices - 1, 0, rays - 1, 0, tilts - 1);
+    image->AllocateScalars(VTK_UNSIGNED_SHORT, 1);
+    auto data = static_cast<unsigned short*>(image->GetScalarPointer());
+    for (int t = 0; t < tilts; ++t) {
+      for (int r = 0; r < rays; ++r) {
+        for (int s = 0; s < slices; ++s) {
+          *data++ = static_cast<unsigned short>(value(s, r, t));
+        }
+      }
+    }
+  }
+
+  static int value(int slice, int ray, int tilt)
+  {
+    return (slice * 7 + ray * 3 + tilt * 11) % 1000;
+  }
+
+  // Average time in seconds to extract one sinogram.
+  double timeSinograms(vtkImageData* image, int slices, int rays, int tilts)
+  {
+    std::vector<float> sinogram(rays * tilts);
+    const int count = 16;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < count; ++i) {
+      TomographyTiltSeries::getSinogram(image, (i * 37) % slices,
+                                        sinogram.data());
+    }
+    std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+    return elapsed.count() / count;
+  }
+};
+
+TEST_F(TomographyTiltSeriesTest, sinogram)
+{
+  const int slices = 5, rays = 6, tilts = 7;
+  vtkNew<vtkImageData> image;
+  makeTiltSeries(image.Get(), slices, rays, tilts);
+
+  std::vector<float> sinogram(rays * tilts);
+  for (int s = 0; s < slices; ++s) {
+    TomographyTiltSeries::getSinogram(image.Get(), s, sinogram.data());
+    for (int t = 0; t < tilts; ++t) {
+      for (int r = 0; r < rays; ++r) {
+        ASSERT_EQ(sinogram[t * rays + r], value(s, r, t));
+      }
+    }
+  }
+}
+
+TEST_F(TomographyTiltSeriesTest, average)
+{
+  const int slices = 4, rays = 3, tilts = 5;
+  vtkNew<vtkImageData> image;
+  makeTiltSeries(image.Get(), slices, rays, tilts);
+
+  std::vector<float> average(slices * rays);
+  TomographyTiltSeries::averageTiltSeries(image.Get(), average.data());
+  for (int r = 0; r < rays; ++r) {
+    for (int s = 0; s < slices; ++s) {
+      double expected = 0;
+      for (int t = 0; t < tilts; ++t) {
+        expected += value(s, r, t);
+      }
+      ASSERT_FLOAT_EQ(average[r * slices + s], expected / tilts);
+    }
+  }
+}
+
+// Extracting a sinogram only reads the y-z slice, so the amount of data read
+// depends on the number of rays and tilts but not on the number of slices. The
+// larger volume is only slower because the strided reads miss the cache.
+// Disabled by default, run it with:
+//   tomvizTests --gtest_filter=TomographyTiltSeriesTest.DISABLED_*
+//     --gtest_also_run_disabled_tests
+TEST_F(TomographyTiltSeriesTest, DISABLED_sinogramBenchmark)
+{
+  const int rays = 256, tilts = 64;
+  vtkNew<vtkImageData> small;
+  makeTiltSeries(small.Get(), 16, rays, tilts);
+  vtkNew<vtkImageData> large;
+  makeTiltSeries(large.Get(), 1024, rays, tilts);
+
+  double smallTime = timeSinograms(small.Get(), 16, rays, tilts);
+  double largeTime = timeSinograms(large.Get(), 1024, rays, tilts);
+  std::cout << "Sinogram extraction, 16 slices: " << smallTime * 1e3
+            << " ms, 1024 slices: " << largeTime * 1e3 << " ms" << std::endl;
+}
@@ -0,0 +1,15 @@
+import tomviz.operators
+
+
+class MedianFilter(tomviz.operators.CancelableOperator):
+
+    def transform_scalars(self, dataset):
+        import itk
+        from tomviz import itkutils
+
+        itk_image = itkutils.convert_vtk_to_itk_image(dataset)
+        median_filter = itk.MedianImageFilter.New(Input=itk_image)
+        median_filter.SetRadius(2)
+        itkutils.observe_filter_progress(self, median_filter, 0, 100)
+        itkutils.update_filter(median_filter)
+        itkutils.set_array_from_itk_image(dataset, median_filter.GetOutput())
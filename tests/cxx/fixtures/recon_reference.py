@@ -0,0 +1,199 @@
+# Generates recon_reference.json, the reconstructions of a small phantom by
+# the numpy implementations of ART and SIRT that Recon_ART.py and
+# Recon_SIRT.py used before they called the native ones. The system matrix
+# and the updates are theirs, the matrix is dense rather than a scipy sparse
+# one.
+#
+#   cd tests/cxx
+#   python - < fixtures/recon_reference.py > fixtures/recon_reference.json
+#
+# It is read from stdin so that operator.py, next to it, doesn't hide the
+# operator module of the standard library.
+import json
+
+import numpy as np
+
+Nslice, Nray = 2, 16
+angles = np.arange(-75.0, 76.0, 10.0) # No 0, which Recon_SIRT.py shifted
+
+
+def parallelRay(Nside, pixelWidth, angles, Nray, rayWidth):
+    # Suppress warning messages that pops up when dividing zeros
+    np.seterr(all='ignore')
+    Nproj = angles.size # Number of projections
+
+    # Ray coordinates at 0 degrees.
+    offsets = np.linspace(-(Nray * 1.0 - 1) / 2,
+                          (Nray * 1.0 - 1) / 2, Nray) * rayWidth
+    # Intersection lines/grid Coordinates
+    xgrid = np.linspace(-Nside * 0.5, Nside * 0.5, Nside + 1) * pixelWidth
+    ygrid = np.linspace(-Nside * 0.5, Nside * 0.5, Nside + 1) * pixelWidth
+    A = np.zeros((Nray * Nproj, Nside**2))
+
+    for i in range(0, Nproj): # Loop over projection angles
+        ang = angles[i] * np.pi / 180.
+        # Points passed by rays at current angles
+        xrayRotated = np.cos(ang) * offsets
+        yrayRotated = np.sin(ang) * offsets
+        xrayRotated[np.abs(xrayRotated) < 1e-8] = 0
+        yrayRotated[np.abs(yrayRotated) < 1e-8] = 0
+
+        a = rmepsilon(-np.sin(ang))
+        b = rmepsilon(np.cos(ang))
+
+        for j in range(0, Nray): # Loop rays in current projection
+            #Ray: y = tx * x + intercept
+            t_xgrid = (xgrid - xrayRotated[j]) / a
+            y_xgrid = b * t_xgrid + yrayRotated[j]
+
+            t_ygrid = (ygrid - yrayRotated[j]) / b
+            x_ygrid = a * t_ygrid + xrayRotated[j]
+            # Collect all points
+            t_grid = np.append(t_xgrid, t_ygrid)
+            xx = np.append(xgrid, x_ygrid)
+            yy = np.append(y_xgrid, ygrid)
+            # Sort the coordinates according to intersection time
+            I = np.argsort(t_grid)
+            xx = xx[I]
+            yy = yy[I]
+
+            # Get rid of points that are outside the image grid
+            Ix = np.logical_and(xx >= -Nside / 2.0 * pixelWidth,
+                                xx <= Nside / 2.0 * pixelWidth)
+            Iy = np.logical_and(yy >= -Nside / 2.0 * pixelWidth,
+                                yy <= Nside / 2.0 * pixelWidth)
+            I = np.logical_and(Ix, Iy)
+            xx = xx[I]
+            yy = yy[I]
+
+            # If the ray pass through the image grid
+            if (xx.size != 0 and yy.size != 0):
+                # Get rid of double counted points
+                I = np.logical_and(np.abs(np.diff(xx)) <=
+                                   1e-8, np.abs(np.diff(yy)) <= 1e-8)
+                I2 = np.zeros(I.size + 1)
+                I2[0:-1] = I
+                xx = xx[np.logical_not(I2)]
+                yy = yy[np.logical_not(I2)]
+
+                # Calculate the length within the cell
+                length = np.sqrt(np.diff(xx)**2 + np.diff(yy)**2)
+                #Count number of cells the ray passes through
+                numvals = length.size
+
+                # Remove the rays that are on the boundary of the box in the
+                # top or to the right of the image grid
+                check1 = np.logical_and(b == 0, np.absolute(
+                    yrayRotated[j] - Nside / 2 * pixelWidth) < 1e-15)
+                check2 = np.logical_and(a == 0, np.absolute(
+                    xrayRotated[j] - Nside / 2 * pixelWidth) < 1e-15)
+                check = np.logical_not(np.logical_or(check1, check2))
+
+                if np.logical_and(numvals > 0, check):
+                    midpoints_x = rmepsilon(0.5 * (xx[0:-1] + xx[1:]))
+                    midpoints_y = rmepsilon(0.5 * (yy[0:-1] + yy[1:]))
+                    #Calculate the pixel index for mid points
+                    pixelIndicex = \
+                        (np.floor(Nside / 2.0 - midpoints_y / pixelWidth)) * \
+                        Nside + (np.floor(midpoints_x /
+                                          pixelWidth + Nside / 2.0))
+                    # Summed like the duplicates of a scipy coo_matrix
+                    np.add.at(A[i * Nray + j], pixelIndicex.astype(int),
+                              length)
+    return A
+
+
+def rmepsilon(input):
+    if (input.size > 1):
+        input[np.abs(input) < 1e-10] = 0
+    else:
+        if np.abs(input) < 1e-10:
+            input = 0
+    return input
+
+
+def art(A, b, Niter):
+    (Nrow, Ncol) = A.shape
+    rowInnerProduct = np.einsum('ij,ij->i', A, A)
+    f = np.zeros(Ncol)
+    beta = 1.0
+    for i in range(Niter):
+        for j in range(Nrow):
+            row = A[j]
+            a = (b[j] - np.dot(row, f)) / rowInnerProduct[j]
+            f = f + row * a * beta
+    return f
+
+
+def sirt(A, b, Niter, stepSize, method):
+    (Nrow, Ncol) = A.shape
+    f = np.zeros(Ncol)
+    if method == 'cimmino':
+        weights = 1 / np.einsum('ij,ij->i', A, A)
+    elif method == 'component averaging':
+        s = np.count_nonzero(A, axis=0)
+        weights = 1 / np.einsum('ij,ij,j->i', A, A, s)
+    for i in range(Niter):
+        if method == 'landweber':
+            f = f + A.T.dot(b - A.dot(f)) * stepSize
+        elif method == 'cimmino':
+            f = f + A.T.dot((b - A.dot(f)) * weights) * stepSize / Nrow
+        elif method == 'component averaging':
+            f = f + A.T.dot((b - A.dot(f)) * weights) * stepSize
+    return f
+
+
+# A disk with an off center block in each slice, recon[s, y, z].
+phantom = np.zeros((Nslice, Nray, Nray))
+for s in range(Nslice):
+    for iy in range(Nray):
+        for iz in range(Nray):
+            y = iy - Nray / 2.0 + 0.5
+            z = iz - Nray / 2.0 + 0.5
+            value = 1.0 if y * y + z * z < (5 + s)**2 else 0.0
+            if abs(y - 2) < 2 and abs(z + 1) < 3:
+                value += 1
+            phantom[s, iy, iz] = value
+
+A = parallelRay(Nray, 1.0, angles, Nray, 1.0)
+# The sinograms, b[t * Nray + r] as in Recon_ART.py.
+sinograms = [A.dot(phantom[s].flatten()) for s in range(Nslice)]
+
+
+def reconstruct(method):
+    return [method(b).reshape((Nray, Nray)) for b in sinograms]
+
+
+def rounded(values):
+    return [float('%.7g' % v) for v in np.asarray(values).flatten()]
+
+
+# Laid out as the tilt series, tiltSeries[s, r, t], and the reconstructions,
+# recon[s, y, z], are in memory: the first index is the fastest.
+def fortran(volume):
+    return rounded(np.asarray(volume).flatten(order='F'))
+
+
+tiltSeries = np.stack([b.reshape((angles.size, Nray)).T for b in sinograms])
+reference = {
+    'slices': Nslice,
+    'rays': Nray,
+    'angles': angles.tolist(),
+    'tiltSeries': fortran(tiltSeries),
+    'phantom': fortran(phantom),
+    'art': {
+        'iterations': 3,
+        'recon': fortran(reconstruct(lambda b: art(A, b, 3))),
+    },
+    'sirt': [],
+}
+for method, stepSize in (('landweber', 0.004), ('cimmino', 15.0),
+                         ('component averaging', 1.0)):
+    reference['sirt'].append({
+        'method': method,
+        'iterations': 20,
+        'stepSize': stepSize,
+        'recon': fortran(reconstruct(
+            lambda b: sirt(A, b, 20, stepSize, method))),
+    })
+print(json.dumps(reference))
@@ -0,0 +1,85 @@
+import json
+import os
+import subprocess
+import sys
+
+import numpy
+
+from tomviz import executor
+
+INCREMENT = '''
+def transform_scalars(dataset):
+    from tomviz import utils
+
+    array = utils.get_array(dataset)
+    utils.set_array(dataset, array + 1)
+'''
+
+FAIL = '''
+def transform_scalars(dataset):
+    raise Exception('Operator failed')
+'''
+
+
+def _operator(label, script):
+    return {
+        'label': label,
+        'script': script,
+        'arguments': {}
+    }
+
+
+def _start_worker():
+    env = dict(os.environ)
+    env.pop('TOMVIZ_APPLICATION', None)
+    env['PYTHONPATH'] = os.pathsep.join(sys.path)
+
+    return subprocess.Popen([sys.executable, '-u', '-m', 'tomviz.worker'],
+                            stdin=subprocess.PIPE, stdout=subprocess.PIPE,
+                            env=env, universal_newlines=True)
+
+
+def _submit(worker, job):
+    worker.stdin.write('%s\n' % json.dumps(job))
+    worker.stdin.flush()
+
+    return json.loads(worker.stdout.readline())
+
+
+def test_worker(tmpdir):
+    data = numpy.arange(4 * 5 * 6, dtype=numpy.float32).reshape((4, 5, 6))
+    input_path = tmpdir.join('original.json').strpath
+    executor._write_raw(input_path, data, [1.0, 1.0, 2.0])
+    progress_path = tmpdir.mkdir('progress').strpath
+
+    worker = _start_worker()
+    try:
+        # The worker stays up between jobs.
+        for i in range(2):
+            output_path = tmpdir.join('transformed%d.json' % i).strpath
+            job = {
+                'operators': [_operator('Increment', INCREMENT)] * 2,
+                'start': i,
+                'input': input_path,
+                'output': output_path,
+                'progress': 'files',
+                'progressPath': progress_path
+            }
+            assert _submit(worker, job) == {'status': 'ok'}
+
+            (output, spacing) = executor._read_raw(output_path)
+            assert numpy.array_equal(output, data + 2 - i)
+            assert spacing == [1.0, 1.0, 2.0]
+
+        # An operator raising is reported, and the worker carries on.
+        job['operators'] = [_operator('Fail', FAIL)]
+        job['start'] = 0
+        reply = _submit(worker, job)
+        assert reply['status'] == 'error'
+        assert 'Operator failed' in reply['error']
+        assert worker.poll() is None
+    finally:
+        worker.stdin.close()
+        worker.wait()
+
+    assert worker.returncode == 0
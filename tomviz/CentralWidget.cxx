@@ -44,38 +44,125 @@
 #include "DataSource.h"
 #include "Module.h"
 #include "ModuleManager.h"
+#include "OccupancyGrid.h"
 #include "Utilities.h"
 
+#include <atomic>
+#include <vector>
+
 Q_DECLARE_METATYPE(vtkSmartPointer<vtkImageData>)
 Q_DECLARE_METATYPE(vtkSmartPointer<vtkTable>)
 
 namespace tomviz {
 
-// This is just here for now - quick and dirty historgram calculations...
-void PopulateHistogram(vtkImageData* input, vtkTable* output)
+// Make sure the range is never empty so it can be binned.
+void ExpandEmptyRange(double minmax[2])
 {
-  // The output table will have the twice the number of columns, they will be
-  // the x and y for input column. This is the bin centers, and the population.
-  double minmax[2] = { 0.0, 0.0 };
+  if (minmax[0] > minmax[1]) {
+    // No finite values
+    minmax[0] = minmax[1] = 0.0;
+  }
+  if (minmax[0] == minmax[1]) {
+    minmax[1] = minmax[0] + 1.0;
+  }
+}
 
-  // This number of bins in the 2D histogram will also be used as the number of
-  // bins in the 2D transfer function for X (scalar value) and Y (gradient mag.)
-  const int numberOfBins = 256;
+// Range of the finite values (or magnitudes) of the array, computed in one
+// parallel pass. The range is never empty so it can be binned.
+void GetFiniteRange(vtkDataArray* array, double minmax[2])
+{
+  minmax[0] = minmax[1] = 0.0;
+  switch (array->GetDataType()) {
+    vtkTemplateMacro(tomviz::GetFiniteRange(
+      reinterpret_cast<VTK_TT*>(array->GetVoidPointer(0)),
+      array->GetNumberOfTuples(), array->GetNumberOfComponents(), minmax));
+    default:
+      cout << "GetFiniteRange: Unknown data type" << endl;
+  }
+  ExpandEmptyRange(minmax);
+}
 
-  // Keep the array we are working on around even if the user shallow copies
-  // over the input image data by incrementing the reference count here.
-  vtkSmartPointer<vtkDataArray> arrayPtr = input->GetPointData()->GetScalars();
-  if (!arrayPtr) {
+// The range of the finite values of the array, unless it is already known
+// from the ranges of the bricks of the data (knownMin <= knownMax).
+void GetHistogramRange(vtkDataArray* array, double knownMin, double knownMax,
+                       double minmax[2])
+{
+  if (knownMin > knownMax) {
+    GetFiniteRange(array, minmax);
     return;
   }
+  minmax[0] = knownMin;
+  minmax[1] = knownMax;
+  ExpandEmptyRange(minmax);
+}
 
-  // The bin values are the centers, extending +/- half an inc either side
-  arrayPtr->GetFiniteRange(minmax, -1);
-  if (minmax[0] == minmax[1]) {
-    minmax[1] = minmax[0] + 1.0;
+// This number of bins in the 2D histogram will also be used as the number of
+// bins in the 2D transfer function for X (scalar value) and Y (gradient mag.)
+const int HistogramBins = 256;
+
+// Volumes larger than this get a quick sampled preview of their histogram,
+// followed by refinements, before the exact one is delivered.
+const vtkIdType HistogramPreviewTuples = 1 << 22;
+
+// Number of tuples in the sampled histogram preview, small enough to be
+// computed in a few tens of milliseconds.
+const vtkIdType HistogramPreviewSamples = 1 << 20;
+
+// Number of interleaved passes over the slices of large volumes, each pass
+// but the last emits a refined histogram.
+const int HistogramRefinementPasses = 4;
+
+// Computes the range and populations of every stride-th tuple. This is only
+// used on volumes that are much larger than the sample.
+template <typename T>
+void SampledHistogram(const T* values, const vtkIdType numTuples,
+                      const int numComp, const vtkIdType stride,
+                      double minmax[2], int* pops)
+{
+  std::vector<T> samples;
+  samples.reserve((numTuples / stride + 1) * numComp);
+  for (vtkIdType i = 0; i < numTuples; i += stride) {
+    samples.insert(samples.end(), values + i * numComp,
+                   values + (i + 1) * numComp);
   }
+  const vtkIdType numSamples = samples.size() / numComp;
+
+  minmax[0] = minmax[1] = 0.0;
+  GetFiniteRange(samples.data(), numSamples, numComp, minmax);
+  ExpandEmptyRange(minmax);
+
+  const double inc = (minmax[1] - minmax[0]) / (HistogramBins - 1);
+  int invalid = 0;
+  CalculateHistogram(samples.data(), numSamples, numComp, minmax[0], minmax[1],
+                     pops, 1.0 / inc, HistogramBins, invalid);
+}
+
+// Adds the populations of tuples [begin, end) of the array to pops and returns
+// the number of non-finite values.
+int AccumulateHistogram(vtkDataArray* array, vtkIdType begin, vtkIdType end,
+                        const double minmax[2], int* pops)
+{
+  const double inc = (minmax[1] - minmax[0]) / (HistogramBins - 1);
+  const int numComp = array->GetNumberOfComponents();
+  int invalid = 0;
+  switch (array->GetDataType()) {
+    vtkTemplateMacro(tomviz::CalculateHistogram(
+      reinterpret_cast<VTK_TT*>(array->GetVoidPointer(0)) + begin * numComp,
+      end - begin, numComp, minmax[0], minmax[1], pops, 1.0 / inc,
+      HistogramBins, invalid));
+    default:
+      cout << "UpdateFromFile: Unknown data type" << endl;
+  }
+  return invalid;
+}
 
-  double inc = (minmax[1] - minmax[0]) / (numberOfBins - 1);
+// Fill the output table with the bin centers and the populations, scaled by
+// the given factor. The bin values are the centers, extending +/- half an inc
+// either side.
+void SetHistogramColumns(vtkTable* output, const double minmax[2],
+                         const int* pops, double scale = 1.0)
+{
+  double inc = (minmax[1] - minmax[0]) / (HistogramBins - 1);
   double halfInc = inc / 2.0;
   vtkSmartPointer<vtkFloatArray> extents =
     vtkFloatArray::SafeDownCast(output->GetColumnByName("image_extents"));
@@ -83,9 +170,9 @@ void PopulateHistogram(vtkImageData* input, vtkTable* output)
     extents = vtkSmartPointer<vtkFloatArray>::New();
     extents->SetName("image_extents");
   }
-  extents->SetNumberOfTuples(numberOfBins);
+  extents->SetNumberOfTuples(HistogramBins);
   double min = minmax[0] + halfInc;
-  for (int j = 0; j < numberOfBins; ++j) {
+  for (int j = 0; j < HistogramBins; ++j) {
     extents->SetValue(j, min + j * inc);
   }
   vtkSmartPointer<vtkIntArray> populations =
@@ -94,41 +181,18 @@ void PopulateHistogram(vtkImageData* input, vtkTable* output)
     populations = vtkSmartPointer<vtkIntArray>::New();
     populations->SetName("image_pops");
   }
-  populations->SetNumberOfTuples(numberOfBins);
-  auto pops = static_cast<int*>(populations->GetVoidPointer(0));
-  for (int k = 0; k < numberOfBins; ++k) {
-    pops[k] = 0;
-  }
-  int invalid = 0;
-
-  switch (arrayPtr->GetDataType()) {
-    vtkTemplateMacro(tomviz::CalculateHistogram(
-      reinterpret_cast<VTK_TT*>(arrayPtr->GetVoidPointer(0)),
-      arrayPtr->GetNumberOfTuples(), arrayPtr->GetNumberOfComponents(),
-      minmax[0], minmax[1], pops, 1.0 / inc, invalid));
-    default:
-      cout << "UpdateFromFile: Unknown data type" << endl;
-  }
-
-#ifndef NDEBUG
-  vtkIdType total = invalid;
-  for (int i = 0; i < numberOfBins; ++i)
-    total += pops[i];
-  assert(total == arrayPtr->GetNumberOfTuples());
-#endif
-  if (invalid) {
-    cout << "Warning: NaN or infinite value in dataset" << endl;
+  populations->SetNumberOfTuples(HistogramBins);
+  for (int k = 0; k < HistogramBins; ++k) {
+    populations->SetValue(k, static_cast<int>(pops[k] * scale + 0.5));
   }
 
   output->AddColumn(extents);
   output->AddColumn(populations);
 }
 
-void Populate2DHistogram(vtkImageData* input, vtkImageData* output)
+void Populate2DHistogram(vtkImageData* input, vtkImageData* output,
+                         const double minmax[2], int stride = 1)
 {
-  double minmax[2] = { 0.0, 0.0 };
-  const int numberOfBins = 256;
-
   // Keep the array we are working on around even if the user shallow copies
   // over the input image data by incrementing the reference count here.
   vtkSmartPointer<vtkDataArray> arrayPtr = input->GetPointData()->GetScalars();
@@ -136,14 +200,8 @@ void Populate2DHistogram(vtkImageData* input, vtkImageData* output)
     return;
   }
 
-  // The bin values are the centers, extending +/- half an inc either side
-  arrayPtr->GetFiniteRange(minmax, -1);
-  if (minmax[0] == minmax[1]) {
-    minmax[1] = minmax[0] + 1.0;
-  }
-
   // vtkPlotHistogram2D expects the histogram array to be VTK_DOUBLE
-  output->SetDimensions(numberOfBins, numberOfBins, 1);
+  output->SetDimensions(HistogramBins, HistogramBins, 1);
   output->AllocateScalars(VTK_DOUBLE, 1);
 
   // Get input parameters
@@ -156,12 +214,25 @@ void Populate2DHistogram(vtkImageData* input, vtkImageData* output)
   switch (arrayPtr->GetDataType()) {
     vtkTemplateMacro(tomviz::Calculate2DHistogram(
       reinterpret_cast<VTK_TT*>(arrayPtr->GetVoidPointer(0)), dim, numComp,
-      minmax, output, spacing));
+      minmax, output, spacing, stride));
     default:
       cout << "UpdateFromFile: Unknown data type" << endl;
   }
 }
 
+// Stride giving a 2D histogram preview of about HistogramPreviewSamples
+// interior voxels, or 1 if the volume is small enough to not need one.
+int Histogram2DPreviewStride(vtkImageData* input)
+{
+  const vtkIdType numVoxels = input->GetNumberOfPoints();
+  if (numVoxels <= HistogramPreviewTuples) {
+    return 1;
+  }
+  return static_cast<int>(
+    std::ceil(std::cbrt(static_cast<double>(numVoxels) /
+                        HistogramPreviewSamples)));
+}
+
 // This is a QObject that will be owned by the background thread
 // and use signals/slots to create histograms
 class HistogramMaker : public QObject
@@ -173,39 +244,167 @@ class HistogramMaker : public QObject
 public:
   HistogramMaker(QObject* p = nullptr) : QObject(p) {}
 
+  /// Start a new generation of requests, work still queued or running for an
+  /// earlier generation is abandoned without emitting anything. Can be called
+  /// from any thread, returns the new generation.
+  int newGeneration() { return ++m_generation; }
+  int generation() const { return m_generation; }
+
 public slots:
+  /// The range of the data is computed unless knownMin <= knownMax.
   void makeHistogram(vtkSmartPointer<vtkImageData> input,
-                     vtkSmartPointer<vtkTable> output);
+                     vtkSmartPointer<vtkTable> output, double knownMin,
+                     double knownMax, int generation);
 
   void makeHistogram2D(vtkSmartPointer<vtkImageData> input,
-                       vtkSmartPointer<vtkImageData> output);
+                       vtkSmartPointer<vtkImageData> output, double knownMin,
+                       double knownMax, int generation);
 
 signals:
+  /// Emitted with approximations of the histogram of large volumes, each one
+  /// in a new table, before histogramDone delivers the exact one in output.
+  void histogramRefined(vtkSmartPointer<vtkImageData> image,
+                        vtkSmartPointer<vtkTable> output, int generation);
+
   void histogramDone(vtkSmartPointer<vtkImageData> image,
-                     vtkSmartPointer<vtkTable> output);
+                     vtkSmartPointer<vtkTable> output, int generation);
+
+  /// Emitted with a sampled approximation of the 2D histogram of large
+  /// volumes, before histogram2DDone delivers the exact one.
+  void histogram2DPreviewDone(vtkSmartPointer<vtkImageData> image,
+                              vtkSmartPointer<vtkImageData> output,
+                              int generation);
 
   void histogram2DDone(vtkSmartPointer<vtkImageData> image,
-                       vtkSmartPointer<vtkImageData> output);
+                       vtkSmartPointer<vtkImageData> output, int generation);
+
+private:
+  bool isCanceled(int generation) const { return generation != m_generation; }
+
+  std::atomic<int> m_generation{ 0 };
 };
 
 void HistogramMaker::makeHistogram(vtkSmartPointer<vtkImageData> input,
-                                   vtkSmartPointer<vtkTable> output)
+                                   vtkSmartPointer<vtkTable> output,
+                                   double knownMin, double knownMax,
+                                   int generation)
 {
-  // make the histogram and notify observers (the main thread) that it
-  // is done.
-  if (input && output) {
-    PopulateHistogram(input.Get(), output.Get());
+  if (isCanceled(generation)) {
+    return;
+  }
+
+  // Keep the array we are working on around even if the user shallow copies
+  // over the input image data by incrementing the reference count here.
+  vtkSmartPointer<vtkDataArray> arrayPtr =
+    input ? input->GetPointData()->GetScalars() : nullptr;
+  if (!output || !arrayPtr) {
+    emit histogramDone(input, output, generation);
+    return;
+  }
+
+  const vtkIdType numTuples = arrayPtr->GetNumberOfTuples();
+  const int numComp = arrayPtr->GetNumberOfComponents();
+  std::vector<int> pops(HistogramBins, 0);
+  double minmax[2];
+
+  if (numTuples > HistogramPreviewTuples) {
+    // An odd stride avoids sampling the same columns of power of two rows.
+    const vtkIdType stride = (numTuples / HistogramPreviewSamples) | 1;
+    switch (arrayPtr->GetDataType()) {
+      vtkTemplateMacro(SampledHistogram(
+        reinterpret_cast<VTK_TT*>(arrayPtr->GetVoidPointer(0)), numTuples,
+        numComp, stride, minmax, pops.data()));
+      default:
+        cout << "UpdateFromFile: Unknown data type" << endl;
+    }
+    auto preview = vtkSmartPointer<vtkTable>::New();
+    SetHistogramColumns(preview, minmax, pops.data(), stride);
+    if (isCanceled(generation)) {
+      return;
+    }
+    emit histogramRefined(input, preview, generation);
+    std::fill(pops.begin(), pops.end(), 0);
   }
-  emit histogramDone(input, output);
+
+  GetHistogramRange(arrayPtr, knownMin, knownMax, minmax);
+  int invalid = 0;
+
+  int dim[3];
+  input->GetDimensions(dim);
+  const vtkIdType sliceTuples = static_cast<vtkIdType>(dim[0]) * dim[1];
+  if (numTuples <= HistogramPreviewTuples || dim[2] < 2 ||
+      sliceTuples * dim[2] != numTuples) {
+    invalid += AccumulateHistogram(arrayPtr, 0, numTuples, minmax, pops.data());
+  } else {
+    // Every pass adds an evenly spread subset of the slices, so each refined
+    // histogram covers the whole volume and the last one is exact.
+    const int passes = std::min(HistogramRefinementPasses, dim[2]);
+    int slicesDone = 0;
+    for (int pass = 0; pass < passes; ++pass) {
+      for (int k = pass; k < dim[2]; k += passes) {
+        if (isCanceled(generation)) {
+          return;
+        }
+        invalid += AccumulateHistogram(arrayPtr, k * sliceTuples,
+                                       (k + 1) * sliceTuples, minmax,
+                                       pops.data());
+        ++slicesDone;
+      }
+      if (pass + 1 < passes) {
+        auto refined = vtkSmartPointer<vtkTable>::New();
+        SetHistogramColumns(refined, minmax, pops.data(),
+                            static_cast<double>(dim[2]) / slicesDone);
+        emit histogramRefined(input, refined, generation);
+      }
+    }
+  }
+
+#ifndef NDEBUG
+  vtkIdType total = invalid;
+  for (int i = 0; i < HistogramBins; ++i)
+    total += pops[i];
+  assert(total == numTuples);
+#endif
+  if (invalid) {
+    cout << "Warning: NaN or infinite value in dataset" << endl;
+  }
+
+  SetHistogramColumns(output, minmax, pops.data());
+  emit histogramDone(input, output, generation);
 }
 
 void HistogramMaker::makeHistogram2D(vtkSmartPointer<vtkImageData> input,
-                                     vtkSmartPointer<vtkImageData> output)
+                                     vtkSmartPointer<vtkImageData> output,
+                                     double knownMin, double knownMax,
+                                     int generation)
 {
+  if (isCanceled(generation)) {
+    return;
+  }
   if (input && output) {
-    Populate2DHistogram(input.Get(), output.Get());
+    vtkDataArray* array = input->GetPointData()->GetScalars();
+    if (array) {
+      double minmax[2];
+      GetHistogramRange(array, knownMin, knownMax, minmax);
+
+      // The preview is written to its own image, the main thread may still be
+      // displaying it while the exact pass fills in the output.
+      const int stride = Histogram2DPreviewStride(input.Get());
+      if (stride > 1) {
+        auto preview = vtkSmartPointer<vtkImageData>::New();
+        Populate2DHistogram(input.Get(), preview.Get(), minmax, stride);
+        if (isCanceled(generation)) {
+          return;
+        }
+        emit histogram2DPreviewDone(input, preview, generation);
+      }
+      Populate2DHistogram(input.Get(), output.Get(), minmax);
+    }
+  }
+  if (isCanceled(generation)) {
+    return;
   }
-  emit histogram2DDone(input, output);
+  emit histogram2DDone(input, output, generation);
 }
 
 //////////////////////////////////////////////////////////////////////////////////
@@ -321,16 +520,26 @@ CentralWidget::CentralWidget(QWidget* parentObject, Qt::WindowFlags wflags)
   // histogram has been finished on the background thread.
   m_worker->start();
   m_histogramGen->moveToThread(m_worker);
+  connect(m_histogramGen,
+          SIGNAL(histogramRefined(vtkSmartPointer<vtkImageData>,
+                                  vtkSmartPointer<vtkTable>, int)),
+          SLOT(histogramRefined(vtkSmartPointer<vtkImageData>,
+                                vtkSmartPointer<vtkTable>, int)));
   connect(m_histogramGen,
           SIGNAL(histogramDone(vtkSmartPointer<vtkImageData>,
-                               vtkSmartPointer<vtkTable>)),
+                               vtkSmartPointer<vtkTable>, int)),
           SLOT(histogramReady(vtkSmartPointer<vtkImageData>,
-                              vtkSmartPointer<vtkTable>)));
+                              vtkSmartPointer<vtkTable>, int)));
+  connect(m_histogramGen,
+          SIGNAL(histogram2DPreviewDone(vtkSmartPointer<vtkImageData>,
+                                        vtkSmartPointer<vtkImageData>, int)),
+          SLOT(histogram2DPreviewReady(vtkSmartPointer<vtkImageData>,
+                                       vtkSmartPointer<vtkImageData>, int)));
   connect(m_histogramGen,
           SIGNAL(histogram2DDone(vtkSmartPointer<vtkImageData>,
-                                 vtkSmartPointer<vtkImageData>)),
+                                 vtkSmartPointer<vtkImageData>, int)),
           SLOT(histogram2DReady(vtkSmartPointer<vtkImageData>,
-                                vtkSmartPointer<vtkImageData>)));
+                                vtkSmartPointer<vtkImageData>, int)));
   m_timer->setInterval(200);
   m_timer->setSingleShot(true);
   connect(m_timer.data(), SIGNAL(timeout()), SLOT(refreshHistogram()));
@@ -344,6 +553,8 @@ CentralWidget::~CentralWidget()
   settings->setValue("Tomviz.centralSplitSizes", m_ui->splitter->saveState());
   // disconnect all signals/slots
   disconnect(m_histogramGen, nullptr, nullptr, nullptr);
+  // Abandon any histogram still being computed
+  m_histogramGen->newGeneration();
   // when the HistogramMaker is deleted, kill the background thread
   connect(m_histogramGen, SIGNAL(destroyed()), m_worker, SLOT(quit()));
   // I can't remember if deleteLater must be called on the owning thread
@@ -454,7 +665,14 @@ void CentralWidget::setColorMapDataSource(DataSource* source)
   // Check our cache, and use that if appopriate (or update it).
   if (m_histogramCache.contains(image)) {
     auto cachedTable = m_histogramCache[image];
-    if (cachedTable->GetMTime() > image->GetMTime()) {
+    if (cachedTable == m_pendingHistogram) {
+      if (image->GetMTime() <= m_pendingHistogramTime) {
+        // Still being computed, the refinements and result are on their way.
+        return;
+      }
+      // The data changed since the histogram was queued, it is out of date.
+      m_histogramCache.remove(image);
+    } else if (cachedTable->GetMTime() > image->GetMTime()) {
       setHistogramTable(cachedTable);
       return;
     } else {
@@ -463,23 +681,43 @@ void CentralWidget::setColorMapDataSource(DataSource* source)
     }
   }
 
+  // A histogram still being computed is for data that is no longer shown, or
+  // has changed since. Cancel it rather than queueing behind it.
+  if (m_pendingHistogram) {
+    m_histogramCache.remove(m_histogramCache.key(m_pendingHistogram));
+  }
+  const int generation = m_histogramGen->newGeneration();
+
   // Calculate a histogram.
   auto table = vtkSmartPointer<vtkTable>::New();
   m_histogramCache[image] = table.Get();
+  m_pendingHistogram = table;
+  m_pendingHistogramTime = image->GetMTime();
   vtkSmartPointer<vtkImageData> const imageSP = image;
 
+  // The range of the data is known if the modules computed the ranges of its
+  // bricks, saving the histograms a pass over the data.
+  double range[2] = { 1, 0 };
+  if (image->GetPointData()->GetScalars()->GetNumberOfComponents() == 1) {
+    source->occupancyGrid()->dataRange(range);
+  }
+
   // This fakes a Qt signal to the background thread (without exposing the
   // class internals as a signal).  The background thread will then call
   // makeHistogram on the HistogramMaker object with the parameters we
   // gave here.
   QMetaObject::invokeMethod(m_histogramGen, "makeHistogram",
                             Q_ARG(vtkSmartPointer<vtkImageData>, imageSP),
-                            Q_ARG(vtkSmartPointer<vtkTable>, table));
+                            Q_ARG(vtkSmartPointer<vtkTable>, table),
+                            Q_ARG(double, range[0]), Q_ARG(double, range[1]),
+                            Q_ARG(int, generation));
 
   auto histogram = vtkSmartPointer<vtkImageData>::New();
   QMetaObject::invokeMethod(m_histogramGen, "makeHistogram2D",
                             Q_ARG(vtkSmartPointer<vtkImageData>, imageSP),
-                            Q_ARG(vtkSmartPointer<vtkImageData>, histogram));
+                            Q_ARG(vtkSmartPointer<vtkImageData>, histogram),
+                            Q_ARG(double, range[0]), Q_ARG(double, range[1]),
+                            Q_ARG(int, generation));
 }
 
 void CentralWidget::onColorMapUpdated()
@@ -512,9 +750,30 @@ void CentralWidget::refreshHistogram()
   setColorMapDataSource(m_activeColorMapDataSource);
 }
 
+void CentralWidget::histogramRefined(vtkSmartPointer<vtkImageData> input,
+                                     vtkSmartPointer<vtkTable> output,
+                                     int generation)
+{
+  if (generation != m_histogramGen->generation()) {
+    return;
+  }
+  vtkImageData* inputIm = getInputImage(input);
+  if (!inputIm || !output) {
+    return;
+  }
+
+  setHistogramTable(output.Get());
+}
+
 void CentralWidget::histogramReady(vtkSmartPointer<vtkImageData> input,
-                                   vtkSmartPointer<vtkTable> output)
+                                   vtkSmartPointer<vtkTable> output,
+                                   int generation)
 {
+  if (generation != m_histogramGen->generation()) {
+    return;
+  }
+  m_pendingHistogram = nullptr;
+
   vtkImageData* inputIm = getInputImage(input);
   if (!inputIm || !output) {
     return;
@@ -524,8 +783,12 @@ void CentralWidget::histogramReady(vtkSmartPointer<vtkImageData> input,
 }
 
 void CentralWidget::histogram2DReady(vtkSmartPointer<vtkImageData> input,
-                                     vtkSmartPointer<vtkImageData> output)
+                                     vtkSmartPointer<vtkImageData> output,
+                                     int generation)
 {
+  if (generation != m_histogramGen->generation()) {
+    return;
+  }
   vtkImageData* inputIm = getInputImage(input);
   if (!inputIm || !output) {
     return;
@@ -535,6 +798,22 @@ void CentralWidget::histogram2DReady(vtkSmartPointer<vtkImageData> input,
   m_ui->histogram2DWidget->addFunctionItem(m_transfer2DModel->getDefault());
 }
 
+void CentralWidget::histogram2DPreviewReady(
+  vtkSmartPointer<vtkImageData> input, vtkSmartPointer<vtkImageData> output,
+  int generation)
+{
+  if (generation != m_histogramGen->generation()) {
+    return;
+  }
+  vtkImageData* inputIm = getInputImage(input);
+  if (!inputIm || !output) {
+    return;
+  }
+
+  // The function item is added once the exact histogram is ready.
+  m_ui->histogram2DWidget->setHistogram(output);
+}
+
 vtkImageData* CentralWidget::getInputImage(vtkSmartPointer<vtkImageData> input)
 {
   if (!input) {
@@ -22,6 +22,7 @@
 #include <QWidget>
 
 #include <vtkSmartPointer.h>
+#include <vtkType.h>
 
 class vtkImageData;
 class vtkPVDiscretizableColorTransferFunction;
@@ -65,9 +66,15 @@ public slots:
   void onColorLegendToggled(bool visibility);
 
 private slots:
-  void histogramReady(vtkSmartPointer<vtkImageData>, vtkSmartPointer<vtkTable>);
+  void histogramRefined(vtkSmartPointer<vtkImageData> input,
+                        vtkSmartPointer<vtkTable> output, int generation);
+  void histogramReady(vtkSmartPointer<vtkImageData> input,
+                      vtkSmartPointer<vtkTable> output, int generation);
   void histogram2DReady(vtkSmartPointer<vtkImageData> input,
-                        vtkSmartPointer<vtkImageData> output);
+                        vtkSmartPointer<vtkImageData> output, int generation);
+  void histogram2DPreviewReady(vtkSmartPointer<vtkImageData> input,
+                               vtkSmartPointer<vtkImageData> output,
+                               int generation);
   void onColorMapDataSourceChanged();
   void refreshHistogram();
 
@@ -95,6 +102,10 @@ private:
   HistogramMaker* m_histogramGen;
   QThread* m_worker;
   QMap<vtkImageData*, vtkSmartPointer<vtkTable>> m_histogramCache;
+  /// Table of the histogram being computed in the background, if any.
+  vtkSmartPointer<vtkTable> m_pendingHistogram;
+  /// Modification time of the image when that histogram was queued.
+  vtkMTimeType m_pendingHistogramTime = 0;
   Transfer2DModel* m_transfer2DModel;
 };
 } // namespace tomviz
@@ -4,53 +4,300 @@
 #include <vtkDoubleArray.h>
 #include <vtkImageData.h>
 #include <vtkMath.h>
+#include <vtkSMPThreadLocal.h>
+#include <vtkSMPTools.h>
 
+#include <algorithm>
+#include <array>
 #include <cmath>
+#include <limits>
+#include <type_traits>
+#include <vector>
 
 namespace tomviz {
 
+/**
+ * The histogram kernels accumulate into four interleaved sub-histograms
+ * (laid out one after the other), so that runs of equal values, which are
+ * common in image data, don't serialize on the increment of a single counter.
+ */
+const int HistogramStreams = 4;
+
+/** Bin of a value, clamped to guard against rounding at the range ends. */
+template <typename T>
+inline int histogramBin(T value, const float min, const float inv,
+                        const int maxBin)
+{
+  int bin = static_cast<int>((value - min) * inv);
+  return std::min(std::max(bin, 0), maxBin);
+}
+
 /** Single component integral type specialization. */
 template <typename T,
           typename std::enable_if<std::is_integral<T>::value>::type* = nullptr>
-void calcHistogram(T* values, const vtkIdType numTuples, const float min,
-                   const float inv, int* pops, int&)
+void calcHistogram(const T* values, const vtkIdType numTuples, const float min,
+                   const float inv, const int numBins, vtkIdType* pops,
+                   vtkIdType&)
 {
-  for (vtkIdType j = 0; j < numTuples; ++j) {
-    ++pops[static_cast<int>((*values++ - min) * inv)];
+  vtkIdType j = 0;
+  for (; j + HistogramStreams <= numTuples; j += HistogramStreams) {
+    for (int s = 0; s < HistogramStreams; ++s) {
+      ++pops[s * numBins + histogramBin(values[j + s], min, inv, numBins - 1)];
+    }
+  }
+  for (; j < numTuples; ++j) {
+    ++pops[histogramBin(values[j], min, inv, numBins - 1)];
   }
 }
 
 /** Needs to be present, should never be compiled. */
 template <typename T>
-void calcHistogram(T*, const vtkIdType, int*)
+void calcHistogram(const T*, const vtkIdType, vtkIdType*)
 {
   static_assert(!std::is_same<unsigned char, T>::value, "Invalid type");
 }
 
 /** Single component unsigned char covering 0 -> 255 range. */
-void calcHistogram(unsigned char* values, const vtkIdType numTuples, int* pops)
+inline void calcHistogram(const unsigned char* values,
+                          const vtkIdType numTuples, vtkIdType* pops)
 {
-  for (vtkIdType j = 0; j < numTuples; ++j) {
-    ++pops[*values++];
+  vtkIdType j = 0;
+  for (; j + HistogramStreams <= numTuples; j += HistogramStreams) {
+    for (int s = 0; s < HistogramStreams; ++s) {
+      ++pops[s * 256 + values[j + s]];
+    }
+  }
+  for (; j < numTuples; ++j) {
+    ++pops[values[j]];
   }
 }
 
 /** Single component floating point type specialization. */
 template <typename T,
           typename std::enable_if<!std::is_integral<T>::value>::type* = nullptr>
-void calcHistogram(T* values, const vtkIdType numTuples, const float min,
-                   const float inv, int* pops, int& invalid)
+void calcHistogram(const T* values, const vtkIdType numTuples, const float min,
+                   const float inv, const int numBins, vtkIdType* pops,
+                   vtkIdType& invalid)
 {
   for (vtkIdType j = 0; j < numTuples; ++j) {
-    T value = *(values++);
+    T value = values[j];
     if (std::isfinite(value)) {
-      ++pops[static_cast<int>((value - min) * inv)];
+      ++pops[histogramBin(value, min, inv, numBins - 1)];
     } else {
       ++invalid;
     }
   }
 }
 
+/** Range of a single component integral array, no value can be invalid. */
+template <typename T,
+          typename std::enable_if<std::is_integral<T>::value>::type* = nullptr>
+void calcFiniteRange(const T* values, const vtkIdType numTuples,
+                     double range[2])
+{
+  if (numTuples == 0) {
+    return;
+  }
+  // Plain min/max reductions in the native type vectorize well.
+  T low = values[0];
+  T high = values[0];
+  for (vtkIdType j = 1; j < numTuples; ++j) {
+    low = std::min(low, values[j]);
+    high = std::max(high, values[j]);
+  }
+  range[0] = std::min(range[0], static_cast<double>(low));
+  range[1] = std::max(range[1], static_cast<double>(high));
+}
+
+/** Range of a single component floating point array, skipping NaN/inf. */
+template <typename T,
+          typename std::enable_if<!std::is_integral<T>::value>::type* = nullptr>
+void calcFiniteRange(const T* values, const vtkIdType numTuples,
+                     double range[2])
+{
+  T low = std::numeric_limits<T>::max();
+  T high = std::numeric_limits<T>::lowest();
+  for (vtkIdType j = 0; j < numTuples; ++j) {
+    T value = values[j];
+    if (std::isfinite(value)) {
+      low = std::min(low, value);
+      high = std::max(high, value);
+    }
+  }
+  range[0] = std::min(range[0], static_cast<double>(low));
+  range[1] = std::max(range[1], static_cast<double>(high));
+}
+
+/**
+ * Magnitude of a multicomponent tuple, returns false if any of the components
+ * is not finite.
+ */
+template <typename T>
+bool tupleMagnitude(const T* tuple, const int numComponents, double& magnitude)
+{
+  double squaredSum = 0.0;
+  for (int c = 0; c < numComponents; ++c) {
+    T value = tuple[c];
+    if (!vtkMath::IsFinite(value)) {
+      return false;
+    }
+    squaredSum += (value * value);
+  }
+  magnitude = sqrt(squaredSum);
+  return true;
+}
+
+/** vtkSMPTools functor computing the range of the finite values. */
+template <typename T>
+class FiniteRangeFunctor
+{
+public:
+  FiniteRangeFunctor(const T* values, const int numComponents)
+    : m_values(values), m_numComponents(numComponents)
+  {
+  }
+
+  void Initialize()
+  {
+    auto& range = m_range.Local();
+    range[0] = std::numeric_limits<double>::max();
+    range[1] = std::numeric_limits<double>::lowest();
+  }
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    auto& range = m_range.Local();
+    if (m_numComponents == 1) {
+      calcFiniteRange(m_values + begin, end - begin, range.data());
+      return;
+    }
+    for (vtkIdType j = begin; j < end; ++j) {
+      double magnitude;
+      if (tupleMagnitude(m_values + j * m_numComponents, m_numComponents,
+                         magnitude)) {
+        range[0] = std::min(range[0], magnitude);
+        range[1] = std::max(range[1], magnitude);
+      }
+    }
+  }
+
+  void Reduce()
+  {
+    m_result[0] = std::numeric_limits<double>::max();
+    m_result[1] = std::numeric_limits<double>::lowest();
+    for (auto it = m_range.begin(); it != m_range.end(); ++it) {
+      m_result[0] = std::min(m_result[0], (*it)[0]);
+      m_result[1] = std::max(m_result[1], (*it)[1]);
+    }
+  }
+
+  const double* result() const { return m_result; }
+
+private:
+  const T* m_values;
+  const int m_numComponents;
+  vtkSMPThreadLocal<std::array<double, 2>> m_range;
+  double m_result[2];
+};
+
+/**
+ * Computes the range of the finite values in an array, or of the magnitudes of
+ * the finite tuples for multicomponent arrays, in one parallel pass. If there
+ * are no finite values the range is left inverted (range[0] > range[1]).
+ */
+template <typename T>
+void GetFiniteRange(const T* values, const vtkIdType numTuples,
+                    const int numComponents, double range[2])
+{
+  FiniteRangeFunctor<T> functor(values, numComponents);
+  vtkSMPTools::For(0, numTuples, functor);
+  range[0] = functor.result()[0];
+  range[1] = functor.result()[1];
+}
+
+/**
+ * vtkSMPTools functor computing a histogram, each thread accumulates into its
+ * own bins which are merged at the end.
+ */
+template <typename T>
+class HistogramFunctor
+{
+public:
+  HistogramFunctor(const T* values, const int numComponents, const float min,
+                   const float max, const float inv, const int numBins)
+    : m_values(values), m_numComponents(numComponents), m_min(min),
+      m_inv(inv), m_numBins(numBins),
+      // Very fast path for unsigned char in 0 -> 255 range.
+      m_byteRange(std::is_same<T, unsigned char>::value && min == 0.f &&
+                  max == 255.f && numBins == 256)
+  {
+  }
+
+  void Initialize()
+  {
+    m_pops.Local().assign(HistogramStreams * m_numBins, 0);
+    m_invalid.Local() = 0;
+  }
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    vtkIdType* pops = m_pops.Local().data();
+    vtkIdType& invalid = m_invalid.Local();
+    // Single component is a simpler/faster path, let's dispatch separately.
+    if (m_numComponents == 1) {
+      if (m_byteRange) {
+        calcHistogram(m_values + begin, end - begin, pops);
+      } else {
+        calcHistogram(m_values + begin, end - begin, m_min, m_inv, m_numBins,
+                      pops, invalid);
+      }
+      return;
+    }
+    // Multicomponent magnitude
+    for (vtkIdType j = begin; j < end; ++j) {
+      double magnitude;
+      if (tupleMagnitude(m_values + j * m_numComponents, m_numComponents,
+                         magnitude)) {
+        ++pops[histogramBin(magnitude, m_min, m_inv, m_numBins - 1)];
+      } else {
+        ++invalid;
+      }
+    }
+  }
+
+  void Reduce()
+  {
+    m_result.assign(m_numBins, 0);
+    m_resultInvalid = 0;
+    for (auto it = m_pops.begin(); it != m_pops.end(); ++it) {
+      const std::vector<vtkIdType>& pops = *it;
+      for (int s = 0; s < HistogramStreams; ++s) {
+        for (int i = 0; i < m_numBins; ++i) {
+          m_result[i] += pops[s * m_numBins + i];
+        }
+      }
+    }
+    for (auto it = m_invalid.begin(); it != m_invalid.end(); ++it) {
+      m_resultInvalid += *it;
+    }
+  }
+
+  const std::vector<vtkIdType>& result() const { return m_result; }
+  vtkIdType invalid() const { return m_resultInvalid; }
+
+private:
+  const T* m_values;
+  const int m_numComponents;
+  const float m_min;
+  const float m_inv;
+  const int m_numBins;
+  const bool m_byteRange;
+  vtkSMPThreadLocal<std::vector<vtkIdType>> m_pops;
+  vtkSMPThreadLocal<vtkIdType> m_invalid;
+  std::vector<vtkIdType> m_result;
+  vtkIdType m_resultInvalid = 0;
+};
+
 /**
  * Computes a histogram from an array of values.
  * \param values The array from which to compute the histogram.
@@ -58,53 +305,147 @@ void calcHistogram(T* values, const vtkIdType numTuples, const float min,
  * \param numComponents Number of components in each tuple.
  * \param min Minimum value in range
  * \param max Maximum value in range
+ * \param pops Output populations, an array of numBins values.
  * \param inv Inverse of bin size, numBins is the number of bins
  * in the histogram (or length of the pops array), and invalid is a return
  * parameter indicating how many values in the array had a non-finite value.
+ * The work is split across threads using vtkSMPTools.
  */
 template <typename T>
-void CalculateHistogram(T* values, const vtkIdType numTuples,
+void CalculateHistogram(const T* values, const vtkIdType numTuples,
                         const vtkIdType numComponents, const float min,
                         const float max, int* pops, const float inv,
-                        int& invalid)
+                        const int numBins, int& invalid)
 {
-  // Single component is a simpler/faster path, let's dispatch separately.
-  if (numComponents == 1) {
-    // Very fast path for unsigned char in 0 -> 255 range, or fast path.
-    if (std::is_same<T, unsigned char>::value && min == 0.f && max == 255.f) {
-      calcHistogram(values, numTuples, pops);
-    } else {
-      calcHistogram(values, numTuples, min, inv, pops, invalid);
-    }
-  } else {
-    // Multicomponent magnitude
-    for (vtkIdType j = 0; j < numTuples; ++j) {
-      // Check that all components are valid.
-      bool valid = true;
-      double squaredSum = 0.0;
-      for (vtkIdType c = 0; c < numComponents; ++c) {
-        T value = *(values + c);
-        if (!vtkMath::IsFinite(value)) {
-          valid = false;
-          break;
+  HistogramFunctor<T> functor(values, static_cast<int>(numComponents), min,
+                              max, inv, numBins);
+  vtkSMPTools::For(0, numTuples, functor);
+  for (int i = 0; i < numBins; ++i) {
+    pops[i] += static_cast<int>(functor.result()[i]);
+  }
+  invalid += static_cast<int>(functor.invalid());
+}
+
+/**
+ * vtkSMPTools functor computing a 2D (value x gradient magnitude) histogram.
+ * The range of work items are the sampled z slices, so each thread handles a
+ * contiguous slab of the volume, reading the one slice halo on either side it
+ * needs for the central differences straight from the input, and accumulates
+ * into its own grid. The grids are summed at the end.
+ */
+template <typename T>
+class Histogram2DFunctor
+{
+public:
+  Histogram2DFunctor(const T* values, const int* dim, const int numComp,
+                     const double* range, const int* bins,
+                     const double* delta, const int stride)
+    : m_values(values), m_numComp(numComp), m_range(range), m_bins(bins),
+      m_delta(delta), m_stride(stride)
+  {
+    std::copy(dim, dim + 3, m_dim);
+  }
+
+  void Initialize()
+  {
+    m_grid.Local().assign(static_cast<size_t>(m_bins[0]) * m_bins[1], 0);
+  }
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    vtkIdType* grid = m_grid.Local().data();
+    const vtkIdType strideY = static_cast<vtkIdType>(m_dim[0]) * m_numComp;
+    const vtkIdType strideZ = strideY * m_dim[1];
+
+    // Normalize to RangeMax/4. This is what the gradient computation in the
+    // GPUMapper's fragment shader expects.
+    const double maxGradMag = m_range[1] * 0.25;
+    const double gradScale = maxGradMag > 0.0 ? (m_bins[1] - 1) / maxGradMag
+                                              : 0.0;
+    const double valueScale = (m_bins[0] - 1) / (m_range[1] - m_range[0]);
+
+    for (vtkIdType task = begin; task < end; ++task) {
+      // Only the interior voxels have a full set of neighbors.
+      const int kIndex = 1 + static_cast<int>(task) * m_stride;
+      for (int jIndex = 1; jIndex < m_dim[1] - 1; jIndex += m_stride) {
+        const T* row = m_values + kIndex * strideZ + jIndex * strideY;
+        for (int iIndex = 1; iIndex < m_dim[0] - 1; iIndex += m_stride) {
+          const T* center = row + iIndex * m_numComp;
+          const double value = static_cast<double>(*center);
+          if (!vtkMath::IsFinite(value)) {
+            continue;
+          }
+
+          const double Dx = (static_cast<double>(center[m_numComp]) -
+                             static_cast<double>(center[-m_numComp])) /
+                            m_delta[0];
+          const double Dy = (static_cast<double>(center[strideY]) -
+                             static_cast<double>(center[-strideY])) /
+                            m_delta[1];
+          const double Dz = (static_cast<double>(center[strideZ]) -
+                             static_cast<double>(center[-strideZ])) /
+                            m_delta[2];
+
+          double gradMag = floor(sqrt(Dx * Dx + Dy * Dy + Dz * Dz) + 0.5);
+          if (!(gradMag < maxGradMag)) {
+            // Also catches gradients from non-finite neighbors.
+            gradMag = maxGradMag;
+          }
+          const int gradIndex = static_cast<int>(gradMag * gradScale);
+          const int valueIndex = vtkMath::ClampValue(
+            static_cast<int>((value - m_range[0]) * valueScale), 0,
+            m_bins[0] - 1);
+
+          ++grid[gradIndex * m_bins[0] + valueIndex];
         }
-        squaredSum += (value * value);
       }
-      if (valid) {
-        int index = static_cast<int>((sqrt(squaredSum) - min) * inv);
-        ++pops[index];
-      } else {
-        ++invalid;
+    }
+  }
+
+  void Reduce()
+  {
+    m_result.assign(static_cast<size_t>(m_bins[0]) * m_bins[1], 0);
+    for (auto it = m_grid.begin(); it != m_grid.end(); ++it) {
+      const std::vector<vtkIdType>& grid = *it;
+      for (size_t i = 0; i < m_result.size(); ++i) {
+        m_result[i] += grid[i];
       }
-      values += numComponents;
     }
   }
-}
 
+  const std::vector<vtkIdType>& result() const { return m_result; }
+
+private:
+  const T* m_values;
+  int m_dim[3];
+  const int m_numComp;
+  const double* m_range;
+  const int* m_bins;
+  const double* m_delta;
+  const int m_stride;
+  vtkSMPThreadLocal<std::vector<vtkIdType>> m_grid;
+  std::vector<vtkIdType> m_result;
+};
+
+/**
+ * Computes a 2D histogram of the scalar value (x) against the gradient
+ * magnitude (y) of the interior voxels of a volume. The gradient is computed
+ * from the first component using central differences.
+ * \param values Pointer to the volume, x varying fastest.
+ * \param dim Dimensions of the volume.
+ * \param numComp Number of components in each tuple.
+ * \param range Range of the scalar values.
+ * \param histogram Output 1 component VTK_DOUBLE image, its dimensions
+ * determine the number of bins.
+ * \param spacing Spacing of the volume.
+ * \param stride Only sample every stride-th voxel along each axis, for quick
+ * previews. The populations are scaled by stride^3 so that they approximate
+ * the full histogram.
+ */
 template <typename T>
 void Calculate2DHistogram(T* values, const int* dim, const int numComp,
                           const double* range, vtkImageData* histogram,
-                          double spacing[3])
+                          double spacing[3], int stride = 1)
 {
   // Assumes all inputs are valid
   // Expects histogram image to be 1C double
@@ -122,15 +463,11 @@ void Calculate2DHistogram(T* values, const int* dim, const int numComp,
                            (range[1] * 0.25) / bins[1], 1.0 };
   histogram->SetSpacing(binSpacing);
 
-  memset(histogramArr->GetVoidPointer(0), 0x0, sizeBins * sizeof(double));
-
-  const size_t sizeSlice = static_cast<size_t>(dim[0] * dim[1] * numComp);
-  std::vector<T> sliceLast(sizeSlice, 0);
-  std::vector<T> sliceCurrent(sizeSlice, 0);
-  std::vector<T> sliceNext(sizeSlice, 0);
-
-  double gradMagMax = std::numeric_limits<double>::min();
-  double gradMagMin = std::numeric_limits<double>::max();
+  double* histogramValues = histogramArr->GetPointer(0);
+  std::fill(histogramValues, histogramValues + sizeBins, 0.0);
+  if (dim[0] < 3 || dim[1] < 3 || dim[2] < 3) {
+    return;
+  }
 
   // Central differences delta (2 * h)
   const double avgSpacing = (spacing[0] + spacing[1] + spacing[2]) / 3.0;
@@ -138,62 +475,15 @@ void Calculate2DHistogram(T* values, const int* dim, const int numComp,
                             spacing[1] * 2 / avgSpacing,
                             spacing[2] * 2 / avgSpacing };
 
-  for (int kIndex = 0; kIndex < dim[2]; kIndex++) {
-    // Index assumes alignment order in  x -> y -> z.
-    // ( z0 * Dx * Dy + y0 * Dx + x0 ) * numComp
-    const size_t strideSlice =
-      static_cast<size_t>(dim[0] * dim[1] * kIndex * numComp);
-    memcpy(&(sliceNext[0]), values + strideSlice, sizeSlice * sizeof(T));
-
-    // Fill up temporary slices during the first two iterations
-    if (kIndex >= 2) {
-      for (int jIndex = 1; jIndex < dim[1] - 1; jIndex++) {
-        for (int iIndex = 1; iIndex < dim[0] - 1; iIndex++) {
-          const size_t centerIndex = dim[0] * jIndex + iIndex;
-          const size_t deltaXFront = centerIndex + 1;
-          const size_t deltaXBack = centerIndex - 1;
-
-          const double Dx = static_cast<double>(sliceCurrent[deltaXFront] -
-                                                sliceCurrent[deltaXBack]) /
-                            delta[0];
-
-          const size_t deltaYFront = dim[0] * (jIndex + 1) + iIndex;
-          const size_t deltaYBack = dim[0] * (jIndex - 1) + iIndex;
-          const double Dy = static_cast<double>(sliceCurrent[deltaYFront] -
-                                                sliceCurrent[deltaYBack]) /
-                            delta[1];
-
-          const double Dz = static_cast<double>(sliceNext[centerIndex] -
-                                                sliceLast[centerIndex]) /
-                            delta[2];
-
-          double gradMag = sqrt(Dx * Dx + Dy * Dy + Dz * Dz);
-          gradMagMax = vtkMath::Max(gradMag, gradMagMax);
-          gradMagMin = vtkMath::Min(gradMag, gradMagMin);
-
-          // Normalize to RangeMax/4. This is what the gradient computation in
-          // the
-          // GPUMapper's fragment shader expects.
-          const double maxGradMag = range[1] * 0.25;
-          gradMag = floor(gradMag + 0.5);
-          gradMag = vtkMath::ClampValue(gradMag, 0.0, maxGradMag);
-          const vtkIdType gradIndex =
-            static_cast<vtkIdType>(gradMag * (bins[1] - 1) / maxGradMag);
-
-          const T value = values[strideSlice + centerIndex * numComp];
-          const vtkIdType valueIndex = static_cast<vtkIdType>(
-            (value - range[0]) * (bins[1] - 1) / (range[1] - range[0]));
-
-          // Update histogram array
-          const vtkIdType tupleIndex = gradIndex * bins[0] + valueIndex;
-          double histogramValue = histogramArr->GetValue(tupleIndex);
-          histogramArr->SetValue(tupleIndex, ++histogramValue);
-        }
-      }
-    }
+  stride = std::max(stride, 1);
+  const vtkIdType numSlices = (dim[2] - 2 + stride - 1) / stride;
+  Histogram2DFunctor<T> functor(values, dim, numComp, range, bins, delta,
+                                stride);
+  vtkSMPTools::For(0, numSlices, functor);
 
-    std::swap(sliceLast, sliceCurrent);
-    std::swap(sliceCurrent, sliceNext);
+  const double weight = static_cast<double>(stride) * stride * stride;
+  for (size_t i = 0; i < sizeBins; ++i) {
+    histogramValues[i] = functor.result()[i] * weight;
   }
 }
 
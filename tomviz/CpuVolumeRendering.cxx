@@ -0,0 +1,139 @@
+/******************************************************************************
+
+  This source file is part of the tomviz project.
+
+  Copyright Kitware, Inc.
+
+  This source code is released under the New BSD License, (the "License").
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+******************************************************************************/
+#include "CpuVolumeRendering.h"
+
+#include <vtkColorTransferFunction.h>
+#include <vtkDataArray.h>
+#include <vtkFixedPointVolumeRayCastMapper.h>
+#include <vtkImageData.h>
+#include <vtkMultiThreader.h>
+#include <vtkPiecewiseFunction.h>
+#include <vtkPointData.h>
+#include <vtkRenderWindow.h>
+
+#include <QString>
+#include <QStringList>
+
+#include <algorithm>
+#include <vector>
+
+namespace tomviz {
+
+bool isSoftwareOpenGL(const char* capabilities)
+{
+  if (!capabilities) {
+    return false;
+  }
+
+  QString renderer;
+  foreach (const QString& line, QString(capabilities).split('\n')) {
+    if (line.contains("renderer string", Qt::CaseInsensitive)) {
+      renderer = line.section(':', 1).trimmed().toLower();
+      break;
+    }
+  }
+
+  const QStringList software = { "llvmpipe",       "softpipe",
+                                 "swrast",         "swr",
+                                 "mesa offscreen", "software rasterizer",
+                                 "gdi generic",    "basic render" };
+  foreach (const QString& name, software) {
+    if (renderer.contains(name)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool hasHardwareGpu(vtkRenderWindow* window)
+{
+  return !window || !isSoftwareOpenGL(window->ReportCapabilities());
+}
+
+void setupCpuVolumeMapper(vtkFixedPointVolumeRayCastMapper* mapper)
+{
+  // The space leaping (from the min/max of blocks of the volume against the
+  // opacity) and the early ray termination are always on, the rays are split
+  // between the threads by image rows.
+  mapper->SetNumberOfThreads(
+    vtkMultiThreader::GetGlobalDefaultNumberOfThreads());
+
+  // Cast fewer rays while interacting to keep up with the requested frame
+  // rate, and all of them once still.
+  mapper->AutoAdjustSampleDistancesOn();
+}
+
+void separateTransferFunction2D(vtkImageData* transfer2D,
+                                const double range[2], double gradientMax,
+                                vtkColorTransferFunction* color,
+                                vtkPiecewiseFunction* opacity,
+                                vtkPiecewiseFunction* gradientOpacity)
+{
+  color->RemoveAllPoints();
+  opacity->RemoveAllPoints();
+  gradientOpacity->RemoveAllPoints();
+
+  int dims[3] = { 0, 0, 0 };
+  vtkDataArray* rgba = nullptr;
+  if (transfer2D) {
+    transfer2D->GetDimensions(dims);
+    rgba = transfer2D->GetPointData()->GetScalars();
+  }
+  if (!rgba || rgba->GetNumberOfComponents() != 4 || dims[0] < 1 ||
+      dims[1] < 1) {
+    // Nothing is visible.
+    color->AddRGBPoint(range[0], 0, 0, 0);
+    opacity->AddPoint(range[0], 0);
+    gradientOpacity->AddPoint(0, 0);
+    return;
+  }
+
+  // The scalar opacity is the largest opacity along the gradient, with its
+  // color, the bins being sampled at their center.
+  const double scalarStep = (range[1] - range[0]) / dims[0];
+  std::vector<double> scalarOpacity(dims[0], 0);
+  double tuple[4];
+  for (int i = 0; i < dims[0]; ++i) {
+    int row = 0;
+    for (int j = 0; j < dims[1]; ++j) {
+      const double alpha = rgba->GetComponent(i + j * dims[0], 3);
+      if (alpha > scalarOpacity[i]) {
+        scalarOpacity[i] = alpha;
+        row = j;
+      }
+    }
+    rgba->GetTuple(i + row * dims[0], tuple);
+    const double x = range[0] + (i + 0.5) * scalarStep;
+    color->AddRGBPoint(x, tuple[0], tuple[1], tuple[2]);
+    opacity->AddPoint(x, scalarOpacity[i]);
+  }
+
+  // The gradient opacity is the largest fraction of the scalar opacity the
+  // opacity is at that gradient magnitude.
+  const double gradientStep = gradientMax / dims[1];
+  for (int j = 0; j < dims[1]; ++j) {
+    double fraction = 0;
+    for (int i = 0; i < dims[0]; ++i) {
+      if (scalarOpacity[i] > 0) {
+        const double alpha = rgba->GetComponent(i + j * dims[0], 3);
+        fraction = std::max(fraction, alpha / scalarOpacity[i]);
+      }
+    }
+    gradientOpacity->AddPoint((j + 0.5) * gradientStep,
+                              std::min(fraction, 1.0));
+  }
+}
+} // namespace tomviz
@@ -0,0 +1,53 @@
+/******************************************************************************
+
+  This source file is part of the tomviz project.
+
+  Copyright Kitware, Inc.
+
+  This source code is released under the New BSD License, (the "License").
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+******************************************************************************/
+#ifndef tomvizCpuVolumeRendering_h
+#define tomvizCpuVolumeRendering_h
+
+class vtkColorTransferFunction;
+class vtkFixedPointVolumeRayCastMapper;
+class vtkImageData;
+class vtkPiecewiseFunction;
+class vtkRenderWindow;
+
+namespace tomviz {
+
+/// Whether the OpenGL renderer described by the capabilities (as reported by
+/// vtkRenderWindow::ReportCapabilities()) is a software one, such as Mesa's
+/// llvmpipe, on which ray casting on the GPU is very slow.
+bool isSoftwareOpenGL(const char* capabilities);
+
+/// Whether the render window draws with a hardware GPU. A GPU is assumed when
+/// it can't be told, e.g. before the window has rendered.
+bool hasHardwareGpu(vtkRenderWindow* window);
+
+/// Set up a mapper ray casting volumes on the CPU, with all the cores. It skips
+/// the regions of the volume that are transparent and stops the rays once they
+/// are opaque.
+void setupCpuVolumeMapper(vtkFixedPointVolumeRayCastMapper* mapper);
+
+/// Approximate a 2D transfer function, a VTK_FLOAT RGBA image indexed by the
+/// scalar over range and the gradient magnitude over [0, gradientMax], as the
+/// product of a scalar and a gradient magnitude opacity, for the mappers that
+/// only have 1D transfer functions. This is exact for a box of the 2D transfer
+/// function editor, whose opacity varies along the scalar only.
+void separateTransferFunction2D(vtkImageData* transfer2D,
+                                const double range[2], double gradientMax,
+                                vtkColorTransferFunction* color,
+                                vtkPiecewiseFunction* opacity,
+                                vtkPiecewiseFunction* gradientOpacity);
+} // namespace tomviz
+
+#endif
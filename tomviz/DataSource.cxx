@@ -16,8 +16,10 @@
 #include "DataSource.h"
 
 #include "ActiveObjects.h"
+#include "ImagePyramid.h"
 #include "ModuleFactory.h"
 #include "ModuleManager.h"
+#include "OccupancyGrid.h"
 #include "Operator.h"
 #include "OperatorFactory.h"
 #include "Pipeline.h"
@@ -53,7 +55,6 @@
 #include <QTimer>
 
 #include <cmath>
-#include <cstring>
 #include <sstream>
 
 namespace tomviz {
@@ -69,6 +70,8 @@ public:
   vtkSmartPointer<vtkSMProxy> ColorMap;
   DataSource::DataSourceType Type;
   vtkSmartPointer<vtkStringArray> Units;
+  ImagePyramid* Pyramid = nullptr;
+  OccupancyGrid* Grid = nullptr;
   vtkVector3d DisplayPosition;
   PersistenceState PersistState = PersistenceState::Saved;
   bool UnitsModified = false;
@@ -174,57 +177,30 @@ bool DataSource::appendSlice(vtkImageData* slice)
   if (!slice) {
     return false;
   }
-  if (std::string(slice->GetScalarTypeAsString()) != "unsigned char") {
-    cout << "Only unsigned char is supported at present" << endl;
+
+  auto data = vtkImageData::SafeDownCast(dataObject());
+  if (!data) {
     return false;
   }
 
-  int sliceExtents[6];
-  slice->GetExtent(sliceExtents);
-  auto tp = algorithm();
-  if (tp) {
-    auto data = vtkImageData::SafeDownCast(tp->GetOutputDataObject(0));
-    if (data) {
-      int extents[6];
-      data->GetExtent(extents);
-      cout << "The data is ";
-      for (int i = 0; i < 6; ++i)
-        cout << extents[i] << ", ";
-      cout << endl;
-      for (int i = 0; i < 4; ++i) {
-        if (extents[i] != sliceExtents[i]) {
-          cout << "Mismatch: " << extents[i] << " != " << sliceExtents[i]
-               << endl;
-          return false;
-        }
-      }
+  // The slice is appended in place, a pyramid being built from the data must
+  // be stopped first.
+  pyramid()->reset();
+  if (!tomviz::appendSlice(data, slice)) {
+    qWarning() << "Unable to append a slice that doesn't match the data.";
+    return false;
+  }
 
-      // Now to append the slice onto our image data.
-      auto dataArray = data->GetPointData()->GetScalars();
-
-      int bufferSize = dataArray->GetNumberOfTuples();
-      unsigned char* buffer = new unsigned char[bufferSize];
-      void* ptr = dataArray->GetVoidPointer(0);
-      std::memcpy(buffer, ptr, bufferSize);
-      ++extents[5];
-      data->SetExtent(extents);
-      data->AllocateScalars(data->GetScalarType(),
-                            data->GetNumberOfScalarComponents());
-      ptr = data->GetScalarPointer();
-      std::memcpy(ptr, buffer, bufferSize);
-      delete[] buffer;
-      buffer = 0;
-      void* imagePtr = data->GetScalarPointer(0, 0, extents[5]);
-      auto sliceArray = slice->GetPointData()->GetScalars();
-      void* slicePtr = sliceArray->GetVoidPointer(0);
-      std::memcpy(imagePtr, slicePtr, sliceArray->GetNumberOfTuples());
-
-      // Let everyone know the data has changed, then re-execute the pipeline.
-      data->Modified();
-      emit dataChanged();
-      emit dataPropertiesChanged();
-      pipeline()->execute();
-    }
+  // Let everyone know the data has changed, then run the new slice through
+  // the pipeline.
+  int index = data->GetDimensions()[2] - 1;
+  emit sliceAppended(index);
+  dataModified();
+  emit dataPropertiesChanged();
+  if (pipeline()->dataSource() == this) {
+    pipeline()->executeSlice(index);
+  } else {
+    pipeline()->execute();
   }
   return true;
 }
@@ -767,6 +743,16 @@ vtkDataObject* DataSource::copyData()
   return copy;
 }
 
+vtkDataObject* DataSource::shallowCopyData()
+{
+  this->Internals->ProducerProxy->UpdatePipeline();
+  vtkDataObject* data = dataObject();
+  vtkDataObject* copy = data->NewInstance();
+  copy->ShallowCopy(data);
+
+  return copy;
+}
+
 void DataSource::setData(vtkDataObject* newData)
 {
   auto tp = producer();
@@ -894,6 +880,16 @@ vtkImageData* DataSource::transferFunction2D() const
   return this->Internals->m_transfer2D;
 }
 
+ImagePyramid* DataSource::pyramid() const
+{
+  return this->Internals->Pyramid;
+}
+
+OccupancyGrid* DataSource::occupancyGrid() const
+{
+  return this->Internals->Grid;
+}
+
 bool DataSource::hasLabelMap()
 {
   auto dataSource = proxy();
@@ -983,6 +979,20 @@ void DataSource::init(vtkImageData* data, DataSourceType dataType,
 
   connect(this, &DataSource::dataPropertiesChanged,
           [this]() { this->proxy()->MarkModified(nullptr); });
+
+  // The coarser levels are built again when next needed.
+  this->Internals->Pyramid = new ImagePyramid(this);
+  connect(this, &DataSource::dataChanged, this->Internals->Pyramid,
+          &ImagePyramid::reset);
+  connect(this, &DataSource::activeScalarsChanged, this->Internals->Pyramid,
+          &ImagePyramid::reset);
+
+  // Likewise for the ranges of the bricks, before the modules ask for them.
+  this->Internals->Grid = new OccupancyGrid(this);
+  connect(this, &DataSource::dataChanged, this->Internals->Grid,
+          &OccupancyGrid::reset);
+  connect(this, &DataSource::activeScalarsChanged, this->Internals->Grid,
+          &OccupancyGrid::reset);
 }
 
 vtkAlgorithm* DataSource::algorithm() const
@@ -32,6 +32,8 @@ class vtkAlgorithm;
 class vtkTrivialProducer;
 
 namespace tomviz {
+class ImagePyramid;
+class OccupancyGrid;
 class Operator;
 class Pipeline;
 
@@ -75,7 +77,9 @@ public:
   ~DataSource() override;
 
   /// Append a slice to the data source, this must be of the same x and y
-  /// dimension as the existing slices in order to be appended.
+  /// dimension as the existing slices in order to be appended. Appending is
+  /// amortised constant time, the slice is converted to the scalar type of the
+  /// data source.
   bool appendSlice(vtkImageData* slice);
 
   /// Returns the proxy that can be inserted in ParaView pipelines.
@@ -140,6 +144,12 @@ public:
   vtkPiecewiseFunction* gradientOpacityMap() const;
   vtkImageData* transferFunction2D() const;
 
+  /// Coarser levels of the data, for rendering while interacting.
+  ImagePyramid* pyramid() const;
+
+  /// Ranges of the data in bricks, for skipping the transparent ones.
+  OccupancyGrid* occupancyGrid() const;
+
   /// Indicates whether the DataSource has a label map of the voxels.
   bool hasLabelMap();
 
@@ -202,6 +212,11 @@ public:
   /// Create copy of current data object, caller is responsible for ownership
   vtkDataObject* copyData();
 
+  /// Create a shallow copy of the current data object, sharing its arrays.
+  /// They must be detached before being modified in place, see
+  /// detachSharedArrays(). Caller is responsible for ownership.
+  vtkDataObject* shallowCopyData();
+
   /// Set data output of trivial producer to new data object, the trivial
   /// producer takes over ownership of the data object.
   void setData(vtkDataObject* newData);
@@ -229,6 +244,11 @@ signals:
   /// have changed.
   void dataPropertiesChanged();
 
+  /// This signal is fired after a slice has been appended to the data, with
+  /// the index of the new slice, before dataChanged(). Listeners can update
+  /// just that slice.
+  void sliceAppended(int index);
+
   /// Fired when active scalars change
   void activeScalarsChanged();
 
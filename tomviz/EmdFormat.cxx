@@ -20,12 +20,19 @@
 #include <vtkDataArray.h>
 #include <vtkImageData.h>
 #include <vtkPointData.h>
+#include <vtkSMPThreadLocal.h>
+#include <vtkSMPTools.h>
 #include <vtkTrivialProducer.h>
 
+#include <pqApplicationCore.h>
+#include <pqSettings.h>
 #include <vtkSMSourceProxy.h>
 
 #include "vtk_hdf5.h"
+#include "vtk_zlib.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <string>
 #include <vector>
@@ -34,25 +41,466 @@
 
 namespace tomviz {
 
+#if H5_VERSION_GE(1, 10, 3)
+// Chunks are read and written directly, bypassing the HDF5 filter pipeline, so
+// that they can be compressed and decompressed in parallel.
+#define TOMVIZ_EMD_DIRECT_CHUNK_IO
+#endif
+
+// The side of the cubic chunks used when compressing without an explicit chunk
+// size.
+const int DefaultChunkSize = 64;
+
+// The uncompressed size of the chunks processed in parallel at once.
+const size_t ChunkBatchBytes = size_t(64) << 20;
+
+/**
+ * The chunks of a 3D dataset, and the filters they are stored with if they are
+ * ones we can apply ourselves. Sizes are slowest varying first, as stored in
+ * the file.
+ */
+struct ChunkGrid
+{
+  hsize_t dims[3];
+  hsize_t chunk[3];
+  size_t elementSize;
+  // Index of the filters in the pipeline, or -1 if they aren't used.
+  int shuffle = -1;
+  int deflate = -1;
+
+  hsize_t count(int axis) const
+  {
+    return (dims[axis] + chunk[axis] - 1) / chunk[axis];
+  }
+
+  vtkIdType numberOfChunks() const { return count(0) * count(1) * count(2); }
+
+  size_t chunkElements() const { return chunk[0] * chunk[1] * chunk[2]; }
+
+  // Offset, in elements, of the n-th chunk.
+  void offset(vtkIdType n, hsize_t offset[3]) const
+  {
+    offset[2] = (n % count(2)) * chunk[2];
+    n /= count(2);
+    offset[1] = (n % count(1)) * chunk[1];
+    n /= count(1);
+    offset[0] = n * chunk[0];
+  }
+
+  // Returns false if the dataset isn't a chunked volume, or if it uses
+  // filters other than shuffle followed by deflate.
+  bool fromDataset(hid_t datasetId, size_t size)
+  {
+    hid_t spaceId = H5Dget_space(datasetId);
+    bool volume = H5Sget_simple_extent_ndims(spaceId) == 3 &&
+                  H5Sget_simple_extent_dims(spaceId, dims, nullptr) == 3;
+    H5Sclose(spaceId);
+
+    hid_t propertiesId = H5Dget_create_plist(datasetId);
+    bool supported = volume && H5Pget_layout(propertiesId) == H5D_CHUNKED &&
+                     H5Pget_chunk(propertiesId, 3, chunk) == 3;
+    int filters = supported ? H5Pget_nfilters(propertiesId) : 0;
+    for (int i = 0; i < filters && supported; ++i) {
+      unsigned int flags, config;
+      size_t valueCount = 0;
+      auto filter = H5Pget_filter2(propertiesId, i, &flags, &valueCount,
+                                   nullptr, 0, nullptr, &config);
+      if (filter == H5Z_FILTER_SHUFFLE && i == 0) {
+        shuffle = i;
+      } else if (filter == H5Z_FILTER_DEFLATE && deflate < 0) {
+        deflate = i;
+      } else {
+        supported = false;
+      }
+    }
+    H5Pclose(propertiesId);
+    elementSize = size;
+
+    return supported;
+  }
+};
+
+void shuffleBytes(const char* in, char* out, size_t count, size_t size)
+{
+  for (size_t i = 0; i < count; ++i) {
+    for (size_t j = 0; j < size; ++j) {
+      out[j * count + i] = in[i * size + j];
+    }
+  }
+}
+
+void unshuffleBytes(const char* in, char* out, size_t count, size_t size)
+{
+  for (size_t i = 0; i < count; ++i) {
+    for (size_t j = 0; j < size; ++j) {
+      out[i * size + j] = in[j * count + i];
+    }
+  }
+}
+
+/**
+ * Copies chunks out of a volume, padding the ones on the edges, and shuffles
+ * and compresses them as the HDF5 filters would.
+ */
+class ChunkEncoder
+{
+public:
+  ChunkEncoder(const char* volume, const ChunkGrid& grid, int level,
+               vtkIdType first, std::vector<std::vector<char>>& chunks)
+    : m_volume(volume), m_grid(grid), m_level(level), m_first(first),
+      m_chunks(chunks), m_failed(false)
+  {
+  }
+
+  void Initialize()
+  {
+    m_raw.Local().resize(m_grid.chunkElements() * m_grid.elementSize);
+    m_shuffled.Local().resize(m_raw.Local().size());
+  }
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    auto& raw = m_raw.Local();
+    auto& shuffled = m_shuffled.Local();
+    for (vtkIdType n = begin; n < end; ++n) {
+      hsize_t offset[3];
+      m_grid.offset(m_first + n, offset);
+      gather(offset, raw.data());
+
+      const char* source = raw.data();
+      if (m_grid.shuffle >= 0) {
+        shuffleBytes(raw.data(), shuffled.data(), m_grid.chunkElements(),
+                     m_grid.elementSize);
+        source = shuffled.data();
+      }
+      auto& chunk = m_chunks[n];
+      if (m_grid.deflate < 0) {
+        chunk.assign(source, source + raw.size());
+        continue;
+      }
+      uLongf size = compressBound(static_cast<uLong>(raw.size()));
+      chunk.resize(size);
+      if (compress2(reinterpret_cast<Bytef*>(chunk.data()), &size,
+                    reinterpret_cast<const Bytef*>(source),
+                    static_cast<uLong>(raw.size()), m_level) != Z_OK) {
+        m_failed = true;
+      }
+      chunk.resize(size);
+    }
+  }
+
+  void Reduce() {}
+
+  bool failed() const { return m_failed; }
+
+private:
+  void gather(const hsize_t offset[3], char* chunk)
+  {
+    const auto& dims = m_grid.dims;
+    const auto& size = m_grid.chunk;
+    size_t elementSize = m_grid.elementSize;
+    size_t rowBytes = size[2] * elementSize;
+    hsize_t columns = std::min(size[2], dims[2] - offset[2]);
+    for (hsize_t z = 0; z < size[0]; ++z) {
+      for (hsize_t y = 0; y < size[1]; ++y) {
+        char* row = chunk + (z * size[1] + y) * rowBytes;
+        hsize_t vz = offset[0] + z, vy = offset[1] + y;
+        if (vz >= dims[0] || vy >= dims[1]) {
+          std::fill(row, row + rowBytes, 0);
+          continue;
+        }
+        const char* source =
+          m_volume + ((vz * dims[1] + vy) * dims[2] + offset[2]) * elementSize;
+        std::copy(source, source + columns * elementSize, row);
+        std::fill(row + columns * elementSize, row + rowBytes, 0);
+      }
+    }
+  }
+
+  const char* m_volume;
+  const ChunkGrid& m_grid;
+  int m_level;
+  vtkIdType m_first;
+  std::vector<std::vector<char>>& m_chunks;
+  vtkSMPThreadLocal<std::vector<char>> m_raw;
+  vtkSMPThreadLocal<std::vector<char>> m_shuffled;
+  std::atomic<bool> m_failed;
+};
+
+/**
+ * The samples of a strided selection within a volume, along one axis.
+ */
+struct Selection
+{
+  hsize_t start[3];
+  hsize_t stride[3];
+  hsize_t count[3];
+
+  // The range of selected samples within [offset, offset + size).
+  void samples(int axis, hsize_t offset, hsize_t size, hsize_t& first,
+               hsize_t& last) const
+  {
+    first = offset > start[axis]
+              ? (offset - start[axis] + stride[axis] - 1) / stride[axis]
+              : 0;
+    last = offset + size > start[axis]
+             ? (offset + size - start[axis] + stride[axis] - 1) / stride[axis]
+             : 0;
+    last = std::min(last, count[axis]);
+  }
+};
+
+/**
+ * Decompresses and unshuffles chunks, then copies their selected samples into
+ * the output volume.
+ */
+class ChunkDecoder
+{
+public:
+  ChunkDecoder(const ChunkGrid& grid, const Selection& selection,
+               const std::vector<vtkIdType>& indices,
+               const std::vector<std::vector<char>>& chunks,
+               const std::vector<uint32_t>& masks, char* output)
+    : m_grid(grid), m_selection(selection), m_indices(indices),
+      m_chunks(chunks), m_masks(masks), m_output(output), m_failed(false)
+  {
+  }
+
+  void Initialize()
+  {
+    m_inflated.Local().resize(m_grid.chunkElements() * m_grid.elementSize);
+    m_unshuffled.Local().resize(m_inflated.Local().size());
+  }
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    size_t bytes = m_grid.chunkElements() * m_grid.elementSize;
+    for (vtkIdType n = begin; n < end; ++n) {
+      const auto& chunk = m_chunks[n];
+      const char* data = chunk.data();
+      uint32_t mask = m_masks[n];
+      // A chunk that was never written holds the fill value.
+      if (chunk.empty()) {
+        auto& inflated = m_inflated.Local();
+        std::fill(inflated.begin(), inflated.end(), 0);
+        data = inflated.data();
+      } else {
+        if (m_grid.deflate >= 0 && !(mask & (1u << m_grid.deflate))) {
+          auto& inflated = m_inflated.Local();
+          uLongf size = static_cast<uLongf>(bytes);
+          if (uncompress(reinterpret_cast<Bytef*>(inflated.data()), &size,
+                         reinterpret_cast<const Bytef*>(data),
+                         static_cast<uLong>(chunk.size())) != Z_OK ||
+              size != bytes) {
+            m_failed = true;
+            continue;
+          }
+          data = inflated.data();
+        } else if (chunk.size() != bytes) {
+          m_failed = true;
+          continue;
+        }
+        if (m_grid.shuffle >= 0 && !(mask & (1u << m_grid.shuffle))) {
+          auto& unshuffled = m_unshuffled.Local();
+          unshuffleBytes(data, unshuffled.data(), m_grid.chunkElements(),
+                         m_grid.elementSize);
+          data = unshuffled.data();
+        }
+      }
+      hsize_t offset[3];
+      m_grid.offset(m_indices[n], offset);
+      scatter(offset, data);
+    }
+  }
+
+  void Reduce() {}
+
+  bool failed() const { return m_failed; }
+
+private:
+  void scatter(const hsize_t offset[3], const char* chunk)
+  {
+    const auto& size = m_grid.chunk;
+    const auto& s = m_selection;
+    size_t elementSize = m_grid.elementSize;
+    hsize_t first[3], last[3];
+    for (int i = 0; i < 3; ++i) {
+      s.samples(i, offset[i], size[i], first[i], last[i]);
+    }
+    for (hsize_t k = first[0]; k < last[0]; ++k) {
+      hsize_t z = s.start[0] + k * s.stride[0] - offset[0];
+      for (hsize_t j = first[1]; j < last[1]; ++j) {
+        hsize_t y = s.start[1] + j * s.stride[1] - offset[1];
+        hsize_t x = s.start[2] + first[2] * s.stride[2] - offset[2];
+        const char* source =
+          chunk + ((z * size[1] + y) * size[2] + x) * elementSize;
+        char* target =
+          m_output +
+          ((k * s.count[1] + j) * s.count[2] + first[2]) * elementSize;
+        if (s.stride[2] == 1) {
+          std::copy(source, source + (last[2] - first[2]) * elementSize,
+                    target);
+          continue;
+        }
+        for (hsize_t i = first[2]; i < last[2]; ++i) {
+          std::copy(source, source + elementSize, target);
+          source += s.stride[2] * elementSize;
+          target += elementSize;
+        }
+      }
+    }
+  }
+
+  const ChunkGrid& m_grid;
+  const Selection& m_selection;
+  const std::vector<vtkIdType>& m_indices;
+  const std::vector<std::vector<char>>& m_chunks;
+  const std::vector<uint32_t>& m_masks;
+  char* m_output;
+  vtkSMPThreadLocal<std::vector<char>> m_inflated;
+  vtkSMPThreadLocal<std::vector<char>> m_unshuffled;
+  std::atomic<bool> m_failed;
+};
+
+// Number of chunks processed in parallel at once.
+vtkIdType chunkBatchSize(const ChunkGrid& grid)
+{
+  size_t bytes = grid.chunkElements() * grid.elementSize;
+  return std::max<vtkIdType>(1, ChunkBatchBytes / bytes);
+}
+
+#ifdef TOMVIZ_EMD_DIRECT_CHUNK_IO
+/**
+ * Write a volume to a chunked dataset, encoding the chunks in parallel.
+ */
+bool writeChunks(hid_t datasetId, const char* volume, const ChunkGrid& grid,
+                 int level)
+{
+  vtkIdType total = grid.numberOfChunks();
+  vtkIdType batch = chunkBatchSize(grid);
+  std::vector<std::vector<char>> chunks;
+  for (vtkIdType first = 0; first < total; first += batch) {
+    vtkIdType count = std::min(batch, total - first);
+    chunks.resize(count);
+    ChunkEncoder encoder(volume, grid, level, first, chunks);
+    vtkSMPTools::For(0, count, encoder);
+    if (encoder.failed()) {
+      return false;
+    }
+
+    for (vtkIdType n = 0; n < count; ++n) {
+      hsize_t offset[3];
+      grid.offset(first + n, offset);
+      if (H5Dwrite_chunk(datasetId, H5P_DEFAULT, 0, offset, chunks[n].size(),
+                         chunks[n].data()) < 0) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+/**
+ * Read the selected samples of a chunked dataset, reading only the chunks
+ * holding some of them and decoding the chunks in parallel.
+ */
+bool readChunks(hid_t datasetId, const ChunkGrid& grid,
+                const Selection& selection, char* output)
+{
+  // The chunks holding selected samples
+  std::vector<hsize_t> axes[3];
+  for (int i = 0; i < 3; ++i) {
+    for (hsize_t c = 0; c < grid.count(i); ++c) {
+      hsize_t first, last;
+      selection.samples(i, c * grid.chunk[i], grid.chunk[i], first, last);
+      if (first < last) {
+        axes[i].push_back(c);
+      }
+    }
+  }
+  std::vector<vtkIdType> selected;
+  for (auto z : axes[0]) {
+    for (auto y : axes[1]) {
+      for (auto x : axes[2]) {
+        selected.push_back((z * grid.count(1) + y) * grid.count(2) + x);
+      }
+    }
+  }
+
+  vtkIdType total = static_cast<vtkIdType>(selected.size());
+  vtkIdType batch = chunkBatchSize(grid);
+  std::vector<std::vector<char>> chunks;
+  std::vector<uint32_t> masks;
+  for (vtkIdType first = 0; first < total; first += batch) {
+    vtkIdType count = std::min(batch, total - first);
+    std::vector<vtkIdType> indices(selected.begin() + first,
+                                   selected.begin() + first + count);
+    chunks.resize(count);
+    masks.assign(count, 0);
+    for (vtkIdType n = 0; n < count; ++n) {
+      hsize_t offset[3];
+      grid.offset(indices[n], offset);
+      hsize_t size = 0;
+      if (H5Dget_chunk_storage_size(datasetId, offset, &size) < 0 ||
+          size == 0) {
+        chunks[n].clear();
+        continue;
+      }
+      chunks[n].resize(size);
+      if (H5Dread_chunk(datasetId, H5P_DEFAULT, offset, &masks[n],
+                        chunks[n].data()) < 0) {
+        return false;
+      }
+    }
+
+    ChunkDecoder decoder(grid, selection, indices, chunks, masks, output);
+    vtkSMPTools::For(0, count, decoder);
+    if (decoder.failed()) {
+      return false;
+    }
+  }
+  return true;
+}
+#endif
+
+// Chunks written directly are stored with the byte order of the memory.
+bool sameByteOrder(hid_t dataTypeId, hid_t memTypeId)
+{
+  return H5Tget_order(dataTypeId) == H5Tget_order(memTypeId);
+}
+
 /**
  * Write the data into the supplied group. This is really just mapping the C++
  * vtkImageData types to the HDF5 API/types.
  *
  * dataTypeId refers to the type that will be stored in the HDF5 file
  * memTypeId refers to the memory type that will be copied from vtkImageData
+ * propertiesId sets the layout and filters of the dataset
  */
 template <typename T>
 bool writeVolume(T* buffer, hid_t groupId, const char* name, hid_t dataspaceId,
-                 hid_t dataTypeId, hid_t memTypeId)
+                 hid_t dataTypeId, hid_t memTypeId, hid_t propertiesId,
+                 int compressionLevel)
 {
   bool success = true;
   hid_t dataId = H5Dcreate(groupId, name, dataTypeId, dataspaceId, H5P_DEFAULT,
-                           H5P_DEFAULT, H5P_DEFAULT);
+                           propertiesId, H5P_DEFAULT);
   if (dataId < 0) { // Failed to create object.
     return false;
   }
-  hid_t status =
-    H5Dwrite(dataId, memTypeId, H5S_ALL, H5S_ALL, H5P_DEFAULT, buffer);
+  hid_t status = 0;
+#ifdef TOMVIZ_EMD_DIRECT_CHUNK_IO
+  ChunkGrid grid;
+  if (grid.fromDataset(dataId, sizeof(T)) &&
+      sameByteOrder(dataTypeId, memTypeId)) {
+    success = writeChunks(dataId, reinterpret_cast<const char*>(buffer), grid,
+                          compressionLevel);
+  } else
+#endif
+  {
+    status =
+      H5Dwrite(dataId, memTypeId, H5S_ALL, H5S_ALL, H5P_DEFAULT, buffer);
+  }
   if (status < 0) {
     success = false;
   }
@@ -68,6 +516,8 @@ class EmdFormat::Private
 public:
   Private() : fileId(H5I_INVALID_HID) {}
   hid_t fileId;
+  int chunkSize = 0;
+  int compressionLevel = 0;
 
   hid_t createGroup(const std::string& group)
   {
@@ -272,14 +722,38 @@ public:
     hid_t groupId = H5Gopen(fileId, group.c_str(), H5P_DEFAULT);
     hid_t dataspaceId = H5Screate_simple(3, &h5dim[0], NULL);
 
+    // Compressing requires the volume to be chunked.
+    hid_t propertiesId = H5P_DEFAULT;
+    int level =
+      H5Zfilter_avail(H5Z_FILTER_DEFLATE) > 0 ? compressionLevel : 0;
+    int size = chunkSize > 0 ? chunkSize : (level > 0 ? DefaultChunkSize : 0);
+    if (size > 0) {
+      hsize_t chunk[3];
+      for (int i = 0; i < 3; ++i) {
+        chunk[i] = std::max<hsize_t>(std::min<hsize_t>(size, h5dim[i]), 1);
+      }
+      propertiesId = H5Pcreate(H5P_DATASET_CREATE);
+      H5Pset_chunk(propertiesId, 3, chunk);
+      if (level > 0) {
+        if (arrayPtr->GetDataTypeSize() > 1) {
+          H5Pset_shuffle(propertiesId);
+        }
+        H5Pset_deflate(propertiesId, level);
+      }
+    }
+
     switch (data->GetScalarType()) {
-      vtkTemplateMacro(success =
-                         writeVolume((VTK_TT*)(dataPtr), groupId, name.c_str(),
-                                     dataspaceId, dataTypeId, memTypeId));
+      vtkTemplateMacro(success = writeVolume(
+                         (VTK_TT*)(dataPtr), groupId, name.c_str(),
+                         dataspaceId, dataTypeId, memTypeId, propertiesId,
+                         level));
       default:
         success = false;
     }
 
+    if (propertiesId != H5P_DEFAULT) {
+      H5Pclose(propertiesId);
+    }
     hid_t status = H5Sclose(dataspaceId);
     if (status < 0) {
       success = false;
@@ -371,36 +845,56 @@ public:
     return result;
   }
 
-  bool readData(const std::string& path, vtkImageData* data)
+  // Read the dataset into data, or only the samples within the extent, in
+  // voxels, taken every stride voxels along each axis if they are given.
+  bool readData(const std::string& path, vtkImageData* data,
+                const int* extent = nullptr, const int* stride = nullptr)
   {
-    std::vector<int> dims;
     hid_t datasetId = H5Dopen(fileId, path.c_str(), H5P_DEFAULT);
     if (datasetId < 0) {
       return false;
     }
     hid_t dataspaceId = H5Dget_space(datasetId);
     if (dataspaceId < 0) {
-      H5Dclose(dataspaceId);
+      H5Dclose(datasetId);
       return false;
     }
     int dimCount = H5Sget_simple_extent_ndims(dataspaceId);
-    if (dimCount < 1) {
+    if (dimCount < 1 || dimCount > 3) {
       H5Sclose(dataspaceId);
       H5Dclose(datasetId);
       return false;
     }
 
-    hsize_t* h5dims = new hsize_t[dimCount];
-    int dimCount2 = H5Sget_simple_extent_dims(dataspaceId, h5dims, nullptr);
-    if (dimCount == dimCount2) {
-      dims.resize(dimCount);
-      std::copy(h5dims, h5dims + dimCount, dims.begin());
-    }
-    if (dimCount == 3) {
-      dims[0] = h5dims[2];
-      dims[2] = h5dims[0];
+    // The dimensions are in C order, slowest varying first, so reversed
+    // compared to VTK. Lower dimensional datasets are read as a volume one
+    // voxel deep.
+    hsize_t h5dims[3] = { 1, 1, 1 };
+    H5Sget_simple_extent_dims(dataspaceId, h5dims + 3 - dimCount, nullptr);
+
+    Selection selection;
+    for (int i = 0; i < 3; ++i) {
+      int axis = 2 - i;
+      hsize_t first = 0;
+      hsize_t last = h5dims[i] - 1;
+      if (extent != nullptr) {
+        if (extent[2 * axis + 1] < std::max(extent[2 * axis], 0) ||
+            static_cast<hsize_t>(std::max(extent[2 * axis], 0)) >= h5dims[i]) {
+          std::cout << "The extent to read is outside of the data."
+                    << std::endl;
+          H5Sclose(dataspaceId);
+          H5Dclose(datasetId);
+          return false;
+        }
+        first = static_cast<hsize_t>(std::max(extent[2 * axis], 0));
+        last = std::min(static_cast<hsize_t>(extent[2 * axis + 1]), last);
+      }
+      selection.start[i] = first;
+      selection.stride[i] =
+        stride != nullptr ? static_cast<hsize_t>(std::max(stride[axis], 1))
+                          : 1;
+      selection.count[i] = (last - first) / selection.stride[i] + 1;
     }
-    delete[] h5dims;
 
     // Map the HDF5 types to the VTK types for storage and memory. We should
     // probably add more, but I got the important ones for testing in first.
@@ -440,19 +934,40 @@ public:
       H5Dclose(datasetId);
       return false;
     }
-    H5Tclose(dataTypeId);
 
-    data->SetDimensions(&dims[0]);
+    int dims[3] = { static_cast<int>(selection.count[2]),
+                    static_cast<int>(selection.count[1]),
+                    static_cast<int>(selection.count[0]) };
+    data->SetDimensions(dims);
     data->AllocateScalars(vtkDataType, 1);
-
-    H5Dread(datasetId, memTypeId, H5S_ALL, dataspaceId, H5P_DEFAULT,
-            data->GetScalarPointer());
+    auto buffer = static_cast<char*>(data->GetScalarPointer());
+
+    bool success = false;
+#ifdef TOMVIZ_EMD_DIRECT_CHUNK_IO
+    ChunkGrid grid;
+    if (dimCount == 3 && grid.fromDataset(datasetId, H5Tget_size(memTypeId)) &&
+        sameByteOrder(dataTypeId, memTypeId)) {
+      success = readChunks(datasetId, grid, selection, buffer);
+    } else
+#endif
+    {
+      int offset = 3 - dimCount;
+      hid_t memspaceId =
+        H5Screate_simple(dimCount, selection.count + offset, nullptr);
+      H5Sselect_hyperslab(dataspaceId, H5S_SELECT_SET,
+                          selection.start + offset, selection.stride + offset,
+                          selection.count + offset, nullptr);
+      success = H5Dread(datasetId, memTypeId, memspaceId, dataspaceId,
+                        H5P_DEFAULT, buffer) >= 0;
+      H5Sclose(memspaceId);
+    }
     data->Modified();
 
+    H5Tclose(dataTypeId);
     H5Sclose(dataspaceId);
     H5Dclose(datasetId);
 
-    return true;
+    return success;
   }
 
   std::vector<std::string> children(const std::string path)
@@ -501,6 +1016,12 @@ public:
 EmdFormat::EmdFormat() : d(new Private) {}
 
 bool EmdFormat::read(const std::string& fileName, vtkImageData* image)
+{
+  return read(fileName, image, nullptr, nullptr);
+}
+
+bool EmdFormat::read(const std::string& fileName, vtkImageData* image,
+                     const int extent[6], const int stride[3])
 {
   d->fileId = H5Fopen(fileName.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT);
 
@@ -515,42 +1036,47 @@ bool EmdFormat::read(const std::string& fileName, vtkImageData* image)
   std::string emdNode = d->firstEmdNode();
   std::string emdDataNode = emdNode + "/data";
 
-  if (emdNode.length() == 0) {
-    // We couldn't find a valid EMD node, exit early.
-    return false;
-  }
-
   // Verify that the path exists in the HDF5 file.
   bool dataLinkExists = false;
-  if (H5Oexists_by_name(d->fileId, emdNode.c_str(), H5P_DEFAULT) == 1) {
-    dataLinkExists = true;
-  }
-
   H5O_info_t info;
-  if (H5Oget_info_by_name(d->fileId, emdDataNode.c_str(), &info,
-                          H5P_DEFAULT < 0)) {
+  if (emdNode.length() == 0) {
+    // We couldn't find a valid EMD node.
+    dataLinkExists = false;
+  } else if (H5Oget_info_by_name(d->fileId, emdDataNode.c_str(), &info,
+                                 H5P_DEFAULT) < 0) {
     dataLinkExists = false;
   } else {
     dataLinkExists = true;
   }
 
-  if (dataLinkExists && info.type == H5O_TYPE_DATASET) {
-    d->readData(emdDataNode, image);
-  } else {
-    return false;
-  }
+  bool success = dataLinkExists && info.type == H5O_TYPE_DATASET &&
+                 d->readData(emdDataNode, image, extent, stride);
 
   // Now to read back in the units, note the reordering for C vs Fortran...
   auto dim1 = d->readData("/data/tomography/dim1");
   auto dim2 = d->readData("/data/tomography/dim2");
   auto dim3 = d->readData("/data/tomography/dim3");
 
-  if (dim1.size() > 1 && dim2.size() > 1 && dim3.size() > 1) {
+  if (success && dim1.size() > 1 && dim2.size() > 1 && dim3.size() > 1) {
     double spacing[3];
     spacing[2] = static_cast<double>(dim1[1] - dim1[0]);
     spacing[1] = static_cast<double>(dim2[1] - dim2[0]);
     spacing[0] = static_cast<double>(dim3[1] - dim3[0]);
+
+    // A subsample spans the same space as the volume it was taken from.
+    double origin[3] = { 0.0, 0.0, 0.0 };
+    for (int i = 0; i < 3; ++i) {
+      if (extent != nullptr) {
+        origin[i] = std::max(extent[2 * i], 0) * spacing[i];
+      }
+      if (stride != nullptr) {
+        spacing[i] *= std::max(stride[i], 1);
+      }
+    }
     image->SetSpacing(spacing);
+    if (extent != nullptr) {
+      image->SetOrigin(origin);
+    }
   }
 
   // Close up the file now we are done.
@@ -559,7 +1085,7 @@ bool EmdFormat::read(const std::string& fileName, vtkImageData* image)
     d->fileId = H5I_INVALID_HID;
   }
 
-  return true;
+  return success;
 }
 
 bool EmdFormat::write(const std::string& fileName, DataSource* source)
@@ -634,6 +1160,23 @@ bool EmdFormat::write(const std::string& fileName, vtkImageData* image)
   return status >= 0;
 }
 
+void EmdFormat::setChunkSize(int size)
+{
+  d->chunkSize = size;
+}
+
+void EmdFormat::setCompressionLevel(int level)
+{
+  d->compressionLevel = level;
+}
+
+void EmdFormat::readSettings()
+{
+  auto settings = pqApplicationCore::instance()->settings();
+  setChunkSize(settings->value("emd/chunkSize", 0).toInt());
+  setCompressionLevel(settings->value("emd/compressionLevel", 0).toInt());
+}
+
 EmdFormat::~EmdFormat()
 {
   delete d;
@@ -31,9 +31,29 @@ public:
   ~EmdFormat();
 
   bool read(const std::string& fileName, vtkImageData* data);
+  /// Read the sub-volume within the voxel extent (x min, x max, y min, ...),
+  /// sampled every stride voxels along each axis. Only the chunks holding the
+  /// samples are read from chunked files.
+  bool read(const std::string& fileName, vtkImageData* data,
+            const int extent[6], const int stride[3] = nullptr);
   bool write(const std::string& fileName, DataSource* source);
   bool write(const std::string& fileName, vtkImageData* image);
 
+  /// Write the volume in cubic chunks with sides of the given length, or
+  /// contiguously if it is 0 (the default). Chunks are read and written in
+  /// parallel.
+  void setChunkSize(int size);
+
+  /// Compress the chunks with gzip at the given level (1-9), shuffling the
+  /// bytes of the values first, or don't compress if it is 0 (the default).
+  /// Volumes are chunked when they are compressed.
+  void setCompressionLevel(int level);
+
+  /// Set the chunk size and compression level of the files the user saves
+  /// from the "emd/chunkSize" and "emd/compressionLevel" application settings,
+  /// both 0 unless they are set.
+  void readSettings();
+
 private:
   class Private;
   Private* d;
@@ -160,6 +160,7 @@ bool ExportDataReaction::exportData(const QString& filename)
   QFileInfo info(filename);
   if (info.suffix() == "emd") {
     EmdFormat writer;
+    writer.readSettings();
     auto image = vtkImageData::SafeDownCast(data);
     if (!image || !writer.write(filename.toLatin1().data(), image)) {
       qCritical() << "Failed to write out data.";
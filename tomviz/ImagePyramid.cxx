@@ -0,0 +1,267 @@
+/******************************************************************************
+
+  This source file is part of the tomviz project.
+
+  Copyright Kitware, Inc.
+
+  This source code is released under the New BSD License, (the "License").
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+******************************************************************************/
+#include "ImagePyramid.h"
+
+#include "DataSource.h"
+
+#include <vtkDataArray.h>
+#include <vtkImageData.h>
+#include <vtkNew.h>
+#include <vtkPointData.h>
+#include <vtkSMPTools.h>
+#include <vtkSMParaViewPipelineController.h>
+#include <vtkSMSessionProxyManager.h>
+#include <vtkSMSourceProxy.h>
+#include <vtkTrivialProducer.h>
+
+#include <QtConcurrent>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace tomviz {
+
+namespace {
+
+// Average the voxels of rows of the output, row j + k * dims[1] being the
+// voxels (*, j, k).
+template <typename T>
+class Downsample
+{
+public:
+  Downsample(const T* input, T* output, int numberOfComponents,
+             const int inDims[3], const int outDims[3],
+             const std::atomic<bool>* cancel)
+    : Input(input), Output(output), NumberOfComponents(numberOfComponents),
+      Cancel(cancel)
+  {
+    std::copy(inDims, inDims + 3, this->InDims);
+    std::copy(outDims, outDims + 3, this->OutDims);
+  }
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    const int n = this->NumberOfComponents;
+    const vtkIdType inRow = static_cast<vtkIdType>(this->InDims[0]) * n;
+    const vtkIdType inSlice = inRow * this->InDims[1];
+    for (vtkIdType row = begin; row < end; ++row) {
+      if (this->Cancel && *this->Cancel) {
+        return;
+      }
+      const int j = static_cast<int>(row % this->OutDims[1]);
+      const int k = static_cast<int>(row / this->OutDims[1]);
+      const int y[2] = { 2 * j, std::min(2 * j + 2, this->InDims[1]) };
+      const int z[2] = { 2 * k, std::min(2 * k + 2, this->InDims[2]) };
+      T* out = this->Output + row * this->OutDims[0] * n;
+      for (int i = 0; i < this->OutDims[0]; ++i) {
+        const int x[2] = { 2 * i, std::min(2 * i + 2, this->InDims[0]) };
+        const int count = (x[1] - x[0]) * (y[1] - y[0]) * (z[1] - z[0]);
+        for (int c = 0; c < n; ++c) {
+          double sum = 0;
+          for (int zz = z[0]; zz < z[1]; ++zz) {
+            for (int yy = y[0]; yy < y[1]; ++yy) {
+              const T* in = this->Input + zz * inSlice + yy * inRow + c;
+              for (int xx = x[0]; xx < x[1]; ++xx) {
+                sum += static_cast<double>(in[xx * n]);
+              }
+            }
+          }
+          const double average = sum / count;
+          *out++ = std::numeric_limits<T>::is_integer
+                     ? static_cast<T>(std::floor(average + 0.5))
+                     : static_cast<T>(average);
+        }
+      }
+    }
+  }
+
+private:
+  const T* Input;
+  T* Output;
+  int NumberOfComponents;
+  int InDims[3];
+  int OutDims[3];
+  const std::atomic<bool>* Cancel;
+};
+} // namespace
+
+ImagePyramid::ImagePyramid(DataSource* source)
+  : QObject(source), m_source(source)
+{
+  connect(&m_watcher,
+          &QFutureWatcher<QVector<vtkSmartPointer<vtkImageData>>>::finished,
+          this, &ImagePyramid::onBuilt);
+}
+
+ImagePyramid::~ImagePyramid()
+{
+  if (m_cancel) {
+    *m_cancel = true;
+  }
+  m_watcher.waitForFinished();
+}
+
+void ImagePyramid::build()
+{
+  if (m_ready || m_watcher.isRunning()) {
+    return;
+  }
+  auto data = vtkImageData::SafeDownCast(m_source->dataObject());
+  if (!data) {
+    return;
+  }
+
+  // The build works on a shallow copy, the data object of the source can be
+  // replaced while it runs.
+  auto image = vtkSmartPointer<vtkImageData>::New();
+  image->ShallowCopy(data);
+  auto cancel = std::make_shared<std::atomic<bool>>(false);
+  m_cancel = cancel;
+  m_watcher.setFuture(QtConcurrent::run([image, cancel]() {
+    QVector<vtkSmartPointer<vtkImageData>> levels;
+    vtkImageData* previous = image;
+    while (!*cancel && previous->GetNumberOfPoints() > INTERACTIVE_VOXELS) {
+      auto next = downsample(previous, cancel.get());
+      if (next->GetNumberOfPoints() == previous->GetNumberOfPoints()) {
+        break;
+      }
+      levels.append(next);
+      previous = next;
+    }
+    return levels;
+  }));
+}
+
+vtkImageData* ImagePyramid::level(int i) const
+{
+  return i > 0 && i <= m_levels.size() ? m_levels[i - 1].Get() : nullptr;
+}
+
+vtkSMSourceProxy* ImagePyramid::interactiveProxy()
+{
+  build();
+  return m_ready && !m_levels.isEmpty() ? m_interactiveProxy.Get() : nullptr;
+}
+
+void ImagePyramid::reset()
+{
+  if (m_cancel) {
+    *m_cancel = true;
+    m_cancel.reset();
+  }
+  m_watcher.waitForFinished();
+
+  const bool wasReady = m_ready;
+  m_ready = false;
+  m_levels.clear();
+  if (m_interactiveProxy) {
+    auto tp = vtkTrivialProducer::SafeDownCast(
+      m_interactiveProxy->GetClientSideObject());
+    tp->SetOutput(vtkNew<vtkImageData>().Get());
+  }
+  if (wasReady) {
+    emit dropped();
+  }
+}
+
+void ImagePyramid::onBuilt()
+{
+  // Reset since it started.
+  if (!m_cancel || *m_cancel) {
+    return;
+  }
+
+  m_levels = m_watcher.result();
+  m_ready = true;
+  if (!m_levels.isEmpty()) {
+    if (!m_interactiveProxy) {
+      auto pxm = m_source->proxy()->GetSessionProxyManager();
+      vtkSmartPointer<vtkSMProxy> proxy;
+      proxy.TakeReference(pxm->NewProxy("sources", "TrivialProducer"));
+      m_interactiveProxy = vtkSMSourceProxy::SafeDownCast(proxy);
+      vtkNew<vtkSMParaViewPipelineController> controller;
+      controller->InitializeProxy(m_interactiveProxy);
+    }
+    auto tp = vtkTrivialProducer::SafeDownCast(
+      m_interactiveProxy->GetClientSideObject());
+    tp->SetOutput(m_levels.last());
+    m_interactiveProxy->MarkModified(nullptr);
+    m_interactiveProxy->UpdatePipeline();
+  }
+  emit ready();
+}
+
+vtkSmartPointer<vtkImageData> ImagePyramid::downsample(
+  vtkImageData* image, const std::atomic<bool>* cancel)
+{
+  int inDims[3], outDims[3], extent[6];
+  double origin[3], spacing[3];
+  image->GetDimensions(inDims);
+  image->GetExtent(extent);
+  image->GetOrigin(origin);
+  image->GetSpacing(spacing);
+
+  // The coarse voxels are at the center of the voxels they average.
+  for (int a = 0; a < 3; ++a) {
+    outDims[a] = (inDims[a] + 1) / 2;
+    origin[a] += extent[2 * a] * spacing[a];
+    if (inDims[a] > 1) {
+      origin[a] += 0.5 * spacing[a];
+      spacing[a] *= 2;
+    }
+  }
+
+  auto output = vtkSmartPointer<vtkImageData>::New();
+  output->SetOrigin(origin);
+  output->SetSpacing(spacing);
+  output->SetDimensions(outDims);
+
+  const vtkIdType rows = static_cast<vtkIdType>(outDims[1]) * outDims[2];
+  vtkPointData* inPD = image->GetPointData();
+  vtkPointData* outPD = output->GetPointData();
+  for (int i = 0; i < inPD->GetNumberOfArrays(); ++i) {
+    vtkDataArray* array = inPD->GetArray(i);
+    if (!array) {
+      continue;
+    }
+    vtkSmartPointer<vtkDataArray> coarse;
+    coarse.TakeReference(array->NewInstance());
+    coarse->SetName(array->GetName());
+    coarse->SetNumberOfComponents(array->GetNumberOfComponents());
+    coarse->SetNumberOfTuples(output->GetNumberOfPoints());
+    switch (array->GetDataType()) {
+      vtkTemplateMacro({
+        Downsample<VTK_TT> average(
+          static_cast<const VTK_TT*>(array->GetVoidPointer(0)),
+          static_cast<VTK_TT*>(coarse->GetVoidPointer(0)),
+          array->GetNumberOfComponents(), inDims, outDims, cancel);
+        vtkSMPTools::For(0, rows, average);
+      });
+      default:
+        continue;
+    }
+    if (array == inPD->GetScalars()) {
+      outPD->SetScalars(coarse);
+    } else {
+      outPD->AddArray(coarse);
+    }
+  }
+
+  return output;
+}
+
+} // namespace tomviz
@@ -0,0 +1,103 @@
+/******************************************************************************
+
+  This source file is part of the tomviz project.
+
+  Copyright Kitware, Inc.
+
+  This source code is released under the New BSD License, (the "License").
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+******************************************************************************/
+#ifndef tomvizImagePyramid_h
+#define tomvizImagePyramid_h
+
+#include <QFutureWatcher>
+#include <QObject>
+#include <QVector>
+
+#include <vtkSmartPointer.h>
+
+#include <atomic>
+#include <memory>
+
+class vtkImageData;
+class vtkSMSourceProxy;
+
+namespace tomviz {
+
+class DataSource;
+
+/// Coarser levels of the data of a DataSource, for the modules to render
+/// while the view is interacted with. Each level has half the resolution of
+/// the previous one, its voxels are the average of 2x2x2 voxels. The levels
+/// are built in the background when they are first requested, down to one
+/// small enough to render interactively, and dropped when the data changes.
+class ImagePyramid : public QObject
+{
+  Q_OBJECT
+
+public:
+  /// Levels are built until one has at most this many voxels.
+  static const long long INTERACTIVE_VOXELS = 256 * 256 * 256;
+
+  ImagePyramid(DataSource* source);
+  ~ImagePyramid() override;
+
+  /// Start building the levels, unless they are built or being built.
+  void build();
+
+  /// Whether the levels are built.
+  bool isReady() const { return m_ready; }
+
+  /// The number of levels, the data itself being level 0. Only the data until
+  /// the levels are built.
+  int numberOfLevels() const { return m_levels.size() + 1; }
+
+  /// A coarse level, from 1 to numberOfLevels() - 1.
+  vtkImageData* level(int i) const;
+
+  /// The proxy producing the coarsest level, nullptr until the levels are
+  /// built or if the data is small enough to render interactively. Starts
+  /// building the levels.
+  vtkSMSourceProxy* interactiveProxy();
+
+  /// Drop the levels, waiting for a build in progress to stop. This must be
+  /// called before the data is modified in place.
+  void reset();
+
+  /// An image with half the resolution of the given one, its point data
+  /// arrays averaged over 2x2x2 voxels in parallel. An odd voxel at the end of
+  /// an axis is averaged on its own, an axis of a single voxel is left alone.
+  /// Stops early, leaving the arrays partly computed, once cancel is set.
+  static vtkSmartPointer<vtkImageData> downsample(
+    vtkImageData* image, const std::atomic<bool>* cancel = nullptr);
+
+signals:
+  /// The levels were built.
+  void ready();
+
+  /// The levels were dropped, whatever uses them should go back to the data.
+  void dropped();
+
+private slots:
+  void onBuilt();
+
+private:
+  Q_DISABLE_COPY(ImagePyramid)
+
+  DataSource* m_source;
+  bool m_ready = false;
+  QVector<vtkSmartPointer<vtkImageData>> m_levels;
+  vtkSmartPointer<vtkSMSourceProxy> m_interactiveProxy;
+  QFutureWatcher<QVector<vtkSmartPointer<vtkImageData>>> m_watcher;
+  // Set to stop the build running, a new flag is made for each build.
+  std::shared_ptr<std::atomic<bool>> m_cancel;
+};
+} // namespace tomviz
+
+#endif
@@ -59,6 +59,7 @@
 #include <QFileInfo>
 #include <QJsonArray>
 
+#include <algorithm>
 #include <sstream>
 
 namespace {
@@ -192,12 +193,38 @@ DataSource* LoadDataReaction::loadData(const QStringList& fileNames,
   }
   QFileInfo info(fileName);
   if (info.suffix().toLower() == "emd") {
-    // Load the file using our simple EMD class.
+    // Load the file using our simple EMD class, only the voxels within the
+    // extent taken every stride voxels if the reader options give them.
     loadWithParaview = false;
     EmdFormat emdFile;
     vtkNew<vtkImageData> imageData;
-    if (emdFile.read(fileName.toLatin1().data(), imageData)) {
+    auto reader = options["reader"].toObject();
+    QJsonObject readerProperties;
+    bool read;
+    if (reader["extent"].toArray().size() == 6) {
+      int extent[6];
+      int stride[3] = { 1, 1, 1 };
+      for (int i = 0; i < 6; ++i) {
+        extent[i] = reader["extent"].toArray()[i].toInt();
+      }
+      auto strides = reader["stride"].toArray();
+      for (int i = 0; i < std::min(strides.size(), 3); ++i) {
+        stride[i] = strides[i].toInt(1);
+      }
+      read = emdFile.read(fileName.toLatin1().data(), imageData, extent,
+                          stride);
+      // Saved with the state, so that it is read the same way again.
+      readerProperties["extent"] = reader["extent"];
+      readerProperties["stride"] = QJsonArray({ stride[0], stride[1],
+                                                stride[2] });
+    } else {
+      read = emdFile.read(fileName.toLatin1().data(), imageData);
+    }
+    if (read) {
       dataSource = new DataSource(imageData);
+      if (!readerProperties.isEmpty()) {
+        dataSource->setReaderProperties(readerProperties.toVariantMap());
+      }
       LoadDataReaction::dataSourceAdded(dataSource, defaultModules, child);
     }
   } else if (info.completeSuffix().endsWith("ome.tif")) {
@@ -216,6 +243,21 @@ DataSource* LoadDataReaction::loadData(const QStringList& fileNames,
     QJsonObject readerProperties;
     readerProperties["name"] = name;
     dataSource->setReaderProperties(readerProperties.toVariantMap());
+  } else if (LoadStackReaction::isTiffStack(fileNames,
+                                            options["reader"].toObject())) {
+    // Read the stack of images ourselves, decoding them concurrently.
+    loadWithParaview = false;
+    auto imageData = LoadStackReaction::readTiffStack(fileNames);
+    if (imageData == nullptr) {
+      return nullptr;
+    }
+    dataSource = new DataSource(imageData);
+    LoadDataReaction::dataSourceAdded(dataSource, defaultModules, child);
+    // Record how the stack was read, so that it is read the same way when a
+    // state is loaded.
+    QJsonObject readerProperties;
+    readerProperties["name"] = LoadStackReaction::TIFF_STACK_READER;
+    dataSource->setReaderProperties(readerProperties.toVariantMap());
   } else if (options.contains("reader")) {
     loadWithParaview = false;
     // Create the ParaView reader and set its properties using the JSON
@@ -226,6 +268,10 @@ DataSource* LoadDataReaction::loadData(const QStringList& fileNames,
     auto pxm = ActiveObjects::instance().proxyManager();
     vtkSmartPointer<vtkSMProxy> reader;
     reader.TakeReference(pxm->NewProxy("sources", name.toLatin1().data()));
+    if (!reader) {
+      qCritical() << "Unable to create the reader:" << name;
+      return nullptr;
+    }
 
     setProperties(props, reader);
     setFileNameProperties(props, reader);
@@ -21,10 +21,28 @@
 #include "SetTiltAnglesOperator.h"
 #include "Utilities.h"
 
+#include <vtkDataArray.h>
 #include <vtkImageData.h>
+#include <vtkInformation.h>
 #include <vtkNew.h>
+#include <vtkPointData.h>
+#include <vtkStreamingDemandDrivenPipeline.h>
 #include <vtkTIFFReader.h>
 
+#include <QApplication>
+#include <QDebug>
+#include <QEventLoop>
+#include <QFileInfo>
+#include <QFutureWatcher>
+#include <QJsonObject>
+#include <QProgressDialog>
+#include <QtConcurrent>
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <numeric>
+
 namespace tomviz {
 
 LoadStackReaction::LoadStackReaction(QAction* parentObject)
@@ -34,6 +52,24 @@ LoadStackReaction::LoadStackReaction(QAction* parentObject)
 
 LoadStackReaction::~LoadStackReaction() = default;
 
+const char* LoadStackReaction::TIFF_STACK_READER = "TomvizTIFFStack";
+
+bool LoadStackReaction::isTiffStack(const QStringList& fileNames,
+                                    const QJsonObject& reader)
+{
+  if (fileNames.size() < 2) {
+    return false;
+  }
+  auto suffix = QFileInfo(fileNames[0]).suffix().toLower();
+  if (suffix != "tif" && suffix != "tiff") {
+    return false;
+  }
+  // States saved before the reader was recorded have no name, older ones name
+  // the ParaView reader that was used then.
+  auto name = reader["name"].toString();
+  return name.isEmpty() || name == TIFF_STACK_READER;
+}
+
 void LoadStackReaction::onTriggered()
 {
   loadData();
@@ -97,18 +133,22 @@ QStringList LoadStackReaction::summaryToFileNames(
 QList<ImageInfo> LoadStackReaction::loadTiffStack(const QStringList& fileNames)
 {
   QList<ImageInfo> summary;
-  vtkNew<vtkTIFFReader> reader;
   int n = -1;
   int m = -1;
   int dims[3];
-  int i = -1;
   bool consistent;
   foreach (QString file, fileNames) {
-    i++;
     consistent = true;
+    // Only the header is read to get the dimensions, the image isn't decoded.
+    vtkNew<vtkTIFFReader> reader;
     reader->SetFileName(file.toLatin1().data());
-    reader->Update();
-    reader->GetOutput()->GetDimensions(dims);
+    reader->UpdateInformation();
+    int extent[6];
+    reader->GetOutputInformation(0)->Get(
+      vtkStreamingDemandDrivenPipeline::WHOLE_EXTENT(), extent);
+    for (int i = 0; i < 3; ++i) {
+      dims[i] = extent[2 * i + 1] - extent[2 * i] + 1;
+    }
     if (n == -1 && m == -1) {
       n = dims[0];
       m = dims[1];
@@ -121,4 +161,94 @@ QList<ImageInfo> LoadStackReaction::loadTiffStack(const QStringList& fileNames)
   }
   return summary;
 }
+
+vtkSmartPointer<vtkImageData> LoadStackReaction::readTiffStack(
+  const QStringList& fileNames)
+{
+  if (fileNames.isEmpty()) {
+    return nullptr;
+  }
+
+  // The header of the first image describes the volume.
+  vtkNew<vtkTIFFReader> first;
+  first->SetFileName(fileNames[0].toLatin1().data());
+  first->UpdateInformation();
+  auto info = first->GetOutputInformation(0);
+  int extent[6];
+  info->Get(vtkStreamingDemandDrivenPipeline::WHOLE_EXTENT(), extent);
+  int dims[3];
+  for (int i = 0; i < 3; ++i) {
+    dims[i] = extent[2 * i + 1] - extent[2 * i] + 1;
+  }
+  if (dims[0] < 1 || dims[1] < 1 || dims[2] < 1) {
+    qCritical() << "Unable to read" << fileNames[0];
+    return nullptr;
+  }
+  int type = first->GetDataScalarType();
+  int components = first->GetNumberOfScalarComponents();
+
+  auto image = vtkSmartPointer<vtkImageData>::New();
+  image->SetExtent(extent[0], extent[1], extent[2], extent[3], 0,
+                   dims[2] * fileNames.size() - 1);
+  image->SetSpacing(info->Get(vtkDataObject::SPACING()));
+  image->SetOrigin(info->Get(vtkDataObject::ORIGIN()));
+  image->AllocateScalars(type, components);
+  auto scalars = static_cast<char*>(image->GetScalarPointer());
+  size_t imageSize = static_cast<size_t>(dims[0]) * dims[1] * dims[2] *
+                     components * image->GetScalarSize();
+
+  // Each image is decoded on its own and copied to its place in the volume.
+  std::atomic<bool> consistent(true);
+  auto read = [&](int& index) {
+    vtkNew<vtkTIFFReader> reader;
+    reader->SetFileName(fileNames[index].toLatin1().data());
+    reader->Update();
+    auto slice = reader->GetOutput();
+    auto sliceScalars = slice->GetPointData()->GetScalars();
+    int sliceDims[3];
+    slice->GetDimensions(sliceDims);
+    if (sliceScalars == nullptr || sliceScalars->GetDataType() != type ||
+        sliceScalars->GetNumberOfComponents() != components ||
+        !std::equal(dims, dims + 3, sliceDims)) {
+      consistent = false;
+      return;
+    }
+    std::memcpy(scalars + index * imageSize, sliceScalars->GetVoidPointer(0),
+                imageSize);
+  };
+  QVector<int> indices(fileNames.size());
+  std::iota(indices.begin(), indices.end(), 0);
+
+  auto future = QtConcurrent::map(indices, read);
+  // Show the progress when there is a GUI to show it in.
+  if (qobject_cast<QApplication*>(QCoreApplication::instance())) {
+    QProgressDialog progress("Reading TIFF stack...", "Cancel", 0,
+                             fileNames.size(), mainWidget());
+    progress.setWindowModality(Qt::WindowModal);
+    progress.setMinimumDuration(500);
+    QFutureWatcher<void> watcher;
+    QEventLoop loop;
+    QObject::connect(&watcher, &QFutureWatcher<void>::progressValueChanged,
+                     &progress, &QProgressDialog::setValue);
+    QObject::connect(&progress, &QProgressDialog::canceled, &watcher,
+                     &QFutureWatcher<void>::cancel);
+    QObject::connect(&watcher, &QFutureWatcher<void>::finished, &loop,
+                     &QEventLoop::quit);
+    watcher.setFuture(future);
+    if (!future.isFinished()) {
+      loop.exec();
+    }
+  }
+  future.waitForFinished();
+
+  if (future.isCanceled()) {
+    return nullptr;
+  }
+  if (!consistent) {
+    qCritical() << "The images of the stack don't have the same dimensions "
+                   "and type.";
+    return nullptr;
+  }
+  return image;
+}
 }
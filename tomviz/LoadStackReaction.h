@@ -20,6 +20,11 @@
 
 #include "ImageStackModel.h"
 
+#include <vtkSmartPointer.h>
+
+class QJsonObject;
+class vtkImageData;
+
 namespace tomviz {
 class DataSource;
 class ImageStackDialog;
@@ -41,7 +46,19 @@ public:
 
   static DataSource* loadData();
   static DataSource* loadData(QStringList fileNames);
+  /// Summary of the dimensions of each image, only their headers are read.
   static QList<ImageInfo> loadTiffStack(const QStringList& fileNames);
+  /// Read a stack of TIFF images of the same size and type into one volume,
+  /// the images are decoded concurrently. Shows the progress in a GUI, returns
+  /// null if the images don't match or reading is canceled.
+  static vtkSmartPointer<vtkImageData> readTiffStack(
+    const QStringList& fileNames);
+  /// The reader name saved with the data sources read by readTiffStack().
+  static const char* TIFF_STACK_READER;
+  /// Whether the files are read by readTiffStack(), rather than by the
+  /// ParaView reader named in the reader properties saved with a state.
+  static bool isTiffStack(const QStringList& fileNames,
+                          const QJsonObject& reader);
 
 protected:
   /// Called when the action is triggered.
@@ -282,9 +282,13 @@ MainWindow::MainWindow(QWidget* parent, Qt::WindowFlags flags)
   reconLabel->setEnabled(false);
   QAction* reconDFMAction =
     m_ui->menuTomography->addAction("Direct Fourier Method");
+  QAction* reconDFM_CAction =
+    m_ui->menuTomography->addAction("Direct Fourier Method (C++)");
   QAction* reconWBPAction =
     m_ui->menuTomography->addAction("Weighted Back Projection");
   QAction* reconWBP_CAction =
+    m_ui->menuTomography->addAction("Weighted Back Projection (C++)");
+  QAction* reconBP_CAction =
     m_ui->menuTomography->addAction("Simple Back Projection (C++)");
   QAction* reconARTAction =
     m_ui->menuTomography->addAction("Algebraic Reconstruction Technique (ART)");
@@ -379,7 +383,12 @@ MainWindow::MainWindow(QWidget* parent, Qt::WindowFlags flags)
     readInPythonScript("Recon_TV_minimization"), true, false,
     readInJSONDescription("Recon_TV_minimization"));
 
-  new ReconstructionReaction(reconWBP_CAction);
+  new ReconstructionReaction(reconWBP_CAction,
+                             TomographyReconstruction::Filter::Ramp);
+  new ReconstructionReaction(reconBP_CAction);
+  new ReconstructionReaction(
+    reconDFM_CAction, TomographyReconstruction::Filter::None,
+    ReconstructionOperator::Algorithm::DirectFourier);
 
   new AddPythonTransformReaction(
     randomShiftsAction, "Shift Tilt Series Randomly",
@@ -0,0 +1,389 @@
+/******************************************************************************
+
+  This source file is part of the tomviz project.
+
+  Copyright Kitware, Inc.
+
+  This source code is released under the New BSD License, (the "License").
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+******************************************************************************/
+#include "OccupancyGrid.h"
+
+#include "DataSource.h"
+
+#include <vtkDataArray.h>
+#include <vtkDoubleArray.h>
+#include <vtkImageData.h>
+#include <vtkMath.h>
+#include <vtkPiecewiseFunction.h>
+#include <vtkPointData.h>
+#include <vtkSMPTools.h>
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+namespace tomviz {
+
+namespace {
+
+typedef std::vector<std::pair<double, double>> Intervals;
+
+// The extent of the points of brick index along an axis of dim points.
+void brickExtent(int index, int brickSize, int dim, int extent[2])
+{
+  extent[0] = index * brickSize;
+  extent[1] = extent[0] + std::min(brickSize, dim - 1 - extent[0]);
+}
+
+// Compute the ranges of bricks, brick b being at (b % counts[0],
+// b / counts[0] % counts[1], b / (counts[0] * counts[1])).
+template <typename T>
+class ComputeBrickRanges
+{
+public:
+  ComputeBrickRanges(const T* scalars, int numberOfComponents,
+                     const int dims[3], const int counts[3], int brickSize,
+                     double* ranges)
+    : Scalars(scalars), BrickSize(brickSize), Ranges(ranges)
+  {
+    std::copy(dims, dims + 3, this->Dims);
+    std::copy(counts, counts + 3, this->Counts);
+    this->Strides[0] = numberOfComponents;
+    this->Strides[1] = this->Strides[0] * dims[0];
+    this->Strides[2] = this->Strides[1] * dims[1];
+  }
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    for (vtkIdType b = begin; b < end; ++b) {
+      const int index[3] = {
+        static_cast<int>(b % this->Counts[0]),
+        static_cast<int>(b / this->Counts[0] % this->Counts[1]),
+        static_cast<int>(b / (this->Counts[0] * this->Counts[1]))
+      };
+      int e[6];
+      for (int a = 0; a < 3; ++a) {
+        brickExtent(index[a], this->BrickSize, this->Dims[a], e + 2 * a);
+      }
+      double min = std::numeric_limits<double>::infinity();
+      double max = -std::numeric_limits<double>::infinity();
+      for (int k = e[4]; k <= e[5]; ++k) {
+        for (int j = e[2]; j <= e[3]; ++j) {
+          const T* row =
+            this->Scalars + k * this->Strides[2] + j * this->Strides[1];
+          for (int i = e[0]; i <= e[1]; ++i) {
+            const double value = static_cast<double>(row[i * this->Strides[0]]);
+            // Comparisons with NaN are false, they are skipped.
+            if (value < min) {
+              min = value;
+            }
+            if (value > max) {
+              max = value;
+            }
+          }
+        }
+      }
+      this->Ranges[2 * b] = min;
+      this->Ranges[2 * b + 1] = max;
+    }
+  }
+
+private:
+  const T* Scalars;
+  int BrickSize;
+  double* Ranges;
+  int Dims[3];
+  int Counts[3];
+  vtkIdType Strides[3];
+};
+
+// Sort and merge overlapping intervals, their ends are then sorted too.
+void mergeIntervals(Intervals& intervals)
+{
+  std::sort(intervals.begin(), intervals.end());
+  Intervals merged;
+  for (auto& interval : intervals) {
+    if (!merged.empty() && interval.first <= merged.back().second) {
+      merged.back().second = std::max(merged.back().second, interval.second);
+    } else {
+      merged.push_back(interval);
+    }
+  }
+  intervals.swap(merged);
+}
+
+// Whether each brick's range meets one of the merged intervals.
+std::vector<bool> meetIntervals(vtkDataArray* ranges, const Intervals& visible)
+{
+  const vtkIdType count = ranges ? ranges->GetNumberOfTuples() : 0;
+  std::vector<bool> occupied(count, false);
+  for (vtkIdType b = 0; b < count; ++b) {
+    const double min = ranges->GetComponent(b, 0);
+    const double max = ranges->GetComponent(b, 1);
+    auto interval = std::lower_bound(
+      visible.begin(), visible.end(), min,
+      [](const Intervals::value_type& i, double v) { return i.second < v; });
+    occupied[b] = min <= max && interval != visible.end() &&
+                  interval->first <= max;
+  }
+  return occupied;
+}
+} // namespace
+
+OccupancyGrid::OccupancyGrid(DataSource* source)
+  : QObject(source), m_source(source)
+{
+}
+
+OccupancyGrid::~OccupancyGrid() = default;
+
+vtkDataArray* OccupancyGrid::ranges()
+{
+  if (isReady()) {
+    return m_ranges;
+  }
+
+  reset();
+  auto image = vtkImageData::SafeDownCast(m_source->dataObject());
+  vtkDataArray* scalars = image ? image->GetPointData()->GetScalars() : nullptr;
+  if (!scalars) {
+    return nullptr;
+  }
+
+  m_ranges = computeRanges(image, BRICK_SIZE);
+  m_scalars = scalars;
+  m_scalarsTime = scalars->GetMTime();
+  int extent[6];
+  image->GetDimensions(m_dimensions);
+  image->GetExtent(extent);
+  image->GetOrigin(m_origin);
+  image->GetSpacing(m_spacing);
+  for (int a = 0; a < 3; ++a) {
+    m_origin[a] += extent[2 * a] * m_spacing[a];
+  }
+  return m_ranges;
+}
+
+bool OccupancyGrid::isReady() const
+{
+  auto image = vtkImageData::SafeDownCast(m_source->dataObject());
+  vtkDataArray* scalars = image ? image->GetPointData()->GetScalars() : nullptr;
+  if (!m_ranges || !scalars || scalars != m_scalars ||
+      scalars->GetMTime() != m_scalarsTime) {
+    return false;
+  }
+  const int* dims = image->GetDimensions();
+  return std::equal(dims, dims + 3, m_dimensions);
+}
+
+bool OccupancyGrid::dataRange(double range[2]) const
+{
+  if (!isReady()) {
+    return false;
+  }
+  double min = std::numeric_limits<double>::infinity();
+  double max = -std::numeric_limits<double>::infinity();
+  for (vtkIdType b = 0; b < m_ranges->GetNumberOfTuples(); ++b) {
+    min = std::min(min, m_ranges->GetValue(2 * b));
+    max = std::max(max, m_ranges->GetValue(2 * b + 1));
+  }
+  if (!vtkMath::IsFinite(min) || !vtkMath::IsFinite(max)) {
+    return false;
+  }
+  range[0] = min;
+  range[1] = max;
+  return true;
+}
+
+std::vector<bool> OccupancyGrid::occupancy(vtkPiecewiseFunction* opacity)
+{
+  return occupancy(ranges(), opacity);
+}
+
+std::vector<bool> OccupancyGrid::occupancy(vtkImageData* transfer2D)
+{
+  auto brickRanges = ranges();
+  double range[2];
+  if (!dataRange(range)) {
+    // Can't tell where the transfer function is, every brick may be visible.
+    const vtkIdType count = brickRanges ? brickRanges->GetNumberOfTuples() : 0;
+    return std::vector<bool>(count, true);
+  }
+  return occupancy(brickRanges, transfer2D, range);
+}
+
+bool OccupancyGrid::occupiedBounds(const std::vector<bool>& occupancy,
+                                   double bounds[6]) const
+{
+  int counts[3];
+  brickCounts(m_dimensions, BRICK_SIZE, counts);
+  const size_t count = static_cast<size_t>(counts[0]) * counts[1] * counts[2];
+  if (!m_ranges || occupancy.size() != count) {
+    return false;
+  }
+
+  int first[3] = { VTK_INT_MAX, VTK_INT_MAX, VTK_INT_MAX };
+  int last[3] = { -1, -1, -1 };
+  for (size_t b = 0; b < count; ++b) {
+    if (!occupancy[b]) {
+      continue;
+    }
+    const int index[3] = { static_cast<int>(b % counts[0]),
+                           static_cast<int>(b / counts[0] % counts[1]),
+                           static_cast<int>(b / (counts[0] * counts[1])) };
+    for (int a = 0; a < 3; ++a) {
+      first[a] = std::min(first[a], index[a]);
+      last[a] = std::max(last[a], index[a]);
+    }
+  }
+  if (last[0] < 0) {
+    return false;
+  }
+
+  for (int a = 0; a < 3; ++a) {
+    int firstExtent[2], lastExtent[2];
+    brickExtent(first[a], BRICK_SIZE, m_dimensions[a], firstExtent);
+    brickExtent(last[a], BRICK_SIZE, m_dimensions[a], lastExtent);
+    bounds[2 * a] = m_origin[a] + firstExtent[0] * m_spacing[a];
+    bounds[2 * a + 1] = m_origin[a] + lastExtent[1] * m_spacing[a];
+  }
+  return true;
+}
+
+void OccupancyGrid::reset()
+{
+  m_ranges = nullptr;
+  m_scalars = nullptr;
+  m_scalarsTime = 0;
+}
+
+void OccupancyGrid::brickCounts(const int dims[3], int brickSize,
+                                int counts[3])
+{
+  for (int a = 0; a < 3; ++a) {
+    counts[a] = dims[a] > 0 ? std::max(dims[a] - 2, 0) / brickSize + 1 : 0;
+  }
+}
+
+vtkSmartPointer<vtkDoubleArray> OccupancyGrid::computeRanges(
+  vtkImageData* image, int brickSize)
+{
+  int dims[3], counts[3];
+  image->GetDimensions(dims);
+  brickCounts(dims, brickSize, counts);
+
+  vtkDataArray* scalars = image->GetPointData()->GetScalars();
+  auto ranges = vtkSmartPointer<vtkDoubleArray>::New();
+  ranges->SetName(scalars ? scalars->GetName() : nullptr);
+  ranges->SetNumberOfComponents(2);
+  ranges->SetNumberOfTuples(static_cast<vtkIdType>(counts[0]) * counts[1] *
+                            counts[2]);
+  if (!scalars || ranges->GetNumberOfTuples() == 0) {
+    return ranges;
+  }
+
+  switch (scalars->GetDataType()) {
+    vtkTemplateMacro({
+      ComputeBrickRanges<VTK_TT> functor(
+        static_cast<const VTK_TT*>(scalars->GetVoidPointer(0)),
+        scalars->GetNumberOfComponents(), dims, counts, brickSize,
+        ranges->GetPointer(0));
+      vtkSMPTools::For(0, ranges->GetNumberOfTuples(), functor);
+    });
+    default:
+      // Unknown types are taken as visible everywhere.
+      ranges->FillComponent(0, -std::numeric_limits<double>::infinity());
+      ranges->FillComponent(1, std::numeric_limits<double>::infinity());
+  }
+  return ranges;
+}
+
+std::vector<bool> OccupancyGrid::occupancy(vtkDataArray* ranges,
+                                           vtkPiecewiseFunction* opacity)
+{
+  const double inf = std::numeric_limits<double>::infinity();
+  Intervals visible;
+  if (!opacity) {
+    visible.push_back(std::make_pair(-inf, inf));
+    return meetIntervals(ranges, visible);
+  }
+
+  // The opacity is linear between its nodes (or a curve between them with
+  // their sharpness), it is zero between two nodes only if both are.
+  const int size = opacity->GetSize();
+  double node[4], next[4];
+  for (int i = 0; i < size; ++i) {
+    opacity->GetNodeValue(i, node);
+    if (node[1] > 0) {
+      visible.push_back(std::make_pair(node[0], node[0]));
+    }
+    if (i + 1 < size) {
+      opacity->GetNodeValue(i + 1, next);
+      if (node[1] > 0 || next[1] > 0) {
+        visible.push_back(std::make_pair(node[0], next[0]));
+      }
+    }
+  }
+
+  // The ends extend to the values beyond the nodes when clamping.
+  if (size > 0 && opacity->GetClamping()) {
+    opacity->GetNodeValue(0, node);
+    if (node[1] > 0) {
+      visible.push_back(std::make_pair(-inf, node[0]));
+    }
+    opacity->GetNodeValue(size - 1, node);
+    if (node[1] > 0) {
+      visible.push_back(std::make_pair(node[0], inf));
+    }
+  }
+
+  mergeIntervals(visible);
+  return meetIntervals(ranges, visible);
+}
+
+std::vector<bool> OccupancyGrid::occupancy(vtkDataArray* ranges,
+                                           vtkImageData* transfer2D,
+                                           const double range[2])
+{
+  const double inf = std::numeric_limits<double>::infinity();
+  Intervals visible;
+  int dims[3] = { 0, 0, 0 };
+  vtkDataArray* rgba = nullptr;
+  if (transfer2D) {
+    transfer2D->GetDimensions(dims);
+    rgba = transfer2D->GetPointData()->GetScalars();
+  }
+  if (!rgba || rgba->GetNumberOfComponents() != 4 || dims[0] < 1 ||
+      dims[1] < 1) {
+    visible.push_back(std::make_pair(-inf, inf));
+    return meetIntervals(ranges, visible);
+  }
+
+  // A column of the transfer function with some opacity is visible up to the
+  // centers of its neighbors, between which the opacity is interpolated. The
+  // first and last columns extend beyond the range.
+  const double step = (range[1] - range[0]) / dims[0];
+  for (int i = 0; i < dims[0]; ++i) {
+    bool opaque = false;
+    for (int j = 0; j < dims[1] && !opaque; ++j) {
+      opaque = rgba->GetComponent(i + j * dims[0], 3) > 0;
+    }
+    if (opaque) {
+      const double min = i > 0 ? range[0] + (i - 0.5) * step : -inf;
+      const double max = i + 1 < dims[0] ? range[0] + (i + 1.5) * step : inf;
+      visible.push_back(std::make_pair(min, max));
+    }
+  }
+
+  mergeIntervals(visible);
+  return meetIntervals(ranges, visible);
+}
+
+} // namespace tomviz
@@ -0,0 +1,117 @@
+/******************************************************************************
+
+  This source file is part of the tomviz project.
+
+  Copyright Kitware, Inc.
+
+  This source code is released under the New BSD License, (the "License").
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+******************************************************************************/
+#ifndef tomvizOccupancyGrid_h
+#define tomvizOccupancyGrid_h
+
+#include <QObject>
+
+#include <vtkSmartPointer.h>
+#include <vtkType.h>
+#include <vtkWeakPointer.h>
+
+#include <vector>
+
+class vtkDataArray;
+class vtkDoubleArray;
+class vtkImageData;
+class vtkPiecewiseFunction;
+
+namespace tomviz {
+
+class DataSource;
+
+/// The range of the active scalars of the data of a DataSource in bricks of
+/// voxels, computed in parallel when first requested after the data changed.
+/// Which bricks are visible through a transfer function is then a cheap test
+/// of their ranges, so that the modules can skip the empty ones.
+///
+/// The bricks are laid out as in vtkImageBrickContour, each covers
+/// BRICK_SIZE cells along the axes and includes the points it shares with
+/// its neighbors. The values interpolated in its cells are within its range.
+class OccupancyGrid : public QObject
+{
+  Q_OBJECT
+
+public:
+  /// The number of cells along the sides of the bricks.
+  static const int BRICK_SIZE = 32;
+
+  OccupancyGrid(DataSource* source);
+  ~OccupancyGrid() override;
+
+  /// The ranges of the bricks, computing them if the data changed since. A 2
+  /// component array named after the scalars, with one tuple per brick, x
+  /// fastest. nullptr if the data has no scalars.
+  vtkDataArray* ranges();
+
+  /// Whether the ranges are those of the current data.
+  bool isReady() const;
+
+  /// The range of the values of the bricks, without computing them. Returns
+  /// false, leaving range alone, when not ready or when some values are
+  /// infinite.
+  bool dataRange(double range[2]) const;
+
+  /// Whether each brick has some opacity in the opacity map, or in the 2D
+  /// transfer function spanning the range of the data.
+  std::vector<bool> occupancy(vtkPiecewiseFunction* opacity);
+  std::vector<bool> occupancy(vtkImageData* transfer2D);
+
+  /// The bounds, in the coordinates of the data, of the bricks that are
+  /// occupied. Returns false if none are.
+  bool occupiedBounds(const std::vector<bool>& occupancy,
+                      double bounds[6]) const;
+
+  /// The number of bricks of brickSize cells along the axes of an image of
+  /// the given dimensions.
+  static void brickCounts(const int dims[3], int brickSize, int counts[3]);
+
+  /// The ranges of the first component of the scalars of an image, in bricks
+  /// of brickSize cells, computed in parallel. NaNs are skipped, a brick
+  /// without any other value has an inverted range.
+  static vtkSmartPointer<vtkDoubleArray> computeRanges(vtkImageData* image,
+                                                       int brickSize);
+
+  /// Whether each brick has some opacity. The ranges of the bricks are tested
+  /// against the intervals where the opacity map is not zero.
+  static std::vector<bool> occupancy(vtkDataArray* ranges,
+                                     vtkPiecewiseFunction* opacity);
+
+  /// Whether each brick has some opacity in the 2D transfer function, the
+  /// scalars spanning the range along its x axis.
+  static std::vector<bool> occupancy(vtkDataArray* ranges,
+                                     vtkImageData* transfer2D,
+                                     const double range[2]);
+
+public slots:
+  /// Drop the ranges, they are computed again when next requested.
+  void reset();
+
+private:
+  Q_DISABLE_COPY(OccupancyGrid)
+
+  DataSource* m_source;
+  vtkSmartPointer<vtkDoubleArray> m_ranges;
+  // What the ranges were computed from.
+  vtkWeakPointer<vtkDataArray> m_scalars;
+  vtkMTimeType m_scalarsTime = 0;
+  int m_dimensions[3] = { 0, 0, 0 };
+  double m_origin[3] = { 0, 0, 0 };
+  double m_spacing[3] = { 1, 1, 1 };
+};
+} // namespace tomviz
+
+#endif
@@ -21,17 +21,24 @@
 #include "EmdFormat.h"
 #include "ModuleManager.h"
 #include "Operator.h"
+#include "PipelineCache.h"
 #include "PipelineExecutor.h"
 #include "Utilities.h"
+#include "tomvizConfig.h"
 
 #include <QMetaEnum>
 
 #include <pqApplicationCore.h>
 #include <pqSettings.h>
 #include <pqView.h>
+#include <vtkDataArray.h>
+#include <vtkNew.h>
+#include <vtkPointData.h>
 #include <vtkSMViewProxy.h>
 #include <vtkTrivialProducer.h>
 
+#include <algorithm>
+
 namespace tomviz {
 
 PipelineSettings::PipelineSettings()
@@ -76,6 +83,27 @@ bool PipelineSettings::dockerRemove()
   return m_settings->value("pipeline/docker.remove", true).toBool();
 }
 
+bool PipelineSettings::dockerSharedMemory()
+{
+  return m_settings->value("pipeline/docker.sharedMemory", false).toBool();
+}
+
+int PipelineSettings::dockerChunkSize()
+{
+  return m_settings->value("pipeline/docker.chunkSize", 0).toInt();
+}
+
+int PipelineSettings::cacheSize()
+{
+  return m_settings->value("pipeline/cache.size", 2048).toInt();
+}
+
+QString PipelineSettings::processPython()
+{
+  return m_settings->value("pipeline/process.python", TOMVIZ_PYTHON_EXECUTABLE)
+    .toString();
+}
+
 void PipelineSettings::setDockerImage(const QString& image)
 {
   m_settings->setValue("pipeline/docker.image", image);
@@ -91,16 +119,45 @@ void PipelineSettings::setDockerRemove(bool remove)
   m_settings->setValue("pipeline/docker.remove", remove);
 }
 
+void PipelineSettings::setDockerSharedMemory(bool sharedMemory)
+{
+  m_settings->setValue("pipeline/docker.sharedMemory", sharedMemory);
+}
+
+void PipelineSettings::setDockerChunkSize(int size)
+{
+  m_settings->setValue("pipeline/docker.chunkSize", size);
+}
+
+void PipelineSettings::setCacheSize(int size)
+{
+  m_settings->setValue("pipeline/cache.size", size);
+}
+
+void PipelineSettings::setProcessPython(const QString& python)
+{
+  m_settings->setValue("pipeline/process.python", python);
+}
+
 Pipeline::Pipeline(DataSource* dataSource, QObject* parent) : QObject(parent)
 {
   m_data = dataSource;
   m_data->setParent(this);
+  m_sliceWorker = new PipelineWorker(this);
 
   addDataSource(dataSource);
 
   PipelineSettings settings;
   auto executor = settings.executionMode();
   setExecutionMode(executor);
+
+  m_cache.reset(
+    new PipelineCache(static_cast<qint64>(settings.cacheSize()) << 20));
+  // The cached outputs all derive from the root data.
+  connect(m_data, &DataSource::dataChanged, this, [this]() {
+    m_cache->clear();
+    m_cacheKeys.clear();
+  });
 }
 
 Pipeline::~Pipeline() = default;
@@ -142,6 +199,16 @@ void Pipeline::execute(DataSource* ds, Operator* start)
     ds = m_data;
   }
 
+  // A live slice is run through the same operators, they can only be run on
+  // the whole volume once it has been canceled.
+  if (m_sliceFuture != nullptr) {
+    m_pendingSlices.clear();
+    m_executeAfterSlice = ds;
+    m_executeAfterSliceStart = start;
+    m_sliceFuture->cancel();
+    return;
+  }
+
   if (beingEdited(ds)) {
     return;
   }
@@ -160,6 +227,7 @@ void Pipeline::execute(DataSource* ds, Operator* start)
     emit finished();
     return;
   }
+  auto keys = cacheKeys(ds, operators);
   int startIndex = 0;
   // We currently only support running the last operator or the entire pipeline.
   if (start == nullptr) {
@@ -185,7 +253,172 @@ void Pipeline::execute(DataSource* ds, Operator* start)
     }
   }
 
-  m_executor->execute(ds->dataObject(), operators, startIndex);
+  vtkSmartPointer<vtkDataObject> data = ds->dataObject();
+  if (startIndex == 0 && !keys.isEmpty()) {
+    // Resume from the deepest cached output, the last operator is always run
+    // to produce the output of the branch.
+    int cached;
+    auto output = m_cache->findDeepest(
+      keys.mid(0, std::min(keys.size(), operators.size() - 1)), cached);
+    if (output) {
+      for (int i = 0; i <= cached; ++i) {
+        operators[i]->completeFromCache();
+      }
+      data = output;
+      startIndex = cached + 1;
+    }
+    emit cacheUsed(m_cache->hits(), m_cache->misses());
+  }
+
+  m_executor->execute(data, operators, startIndex);
+}
+
+void Pipeline::executeSlice(int index)
+{
+  // Slices are run one at a time, in the order they were appended.
+  if (m_sliceFuture != nullptr) {
+    m_pendingSlices.append(index);
+    return;
+  }
+
+  auto operators = m_data->operators();
+  if (operators.isEmpty()) {
+    return;
+  }
+  if (!canExecuteSlice(index)) {
+    m_pendingSlices.clear();
+    operators.first()->setModified();
+    execute();
+    return;
+  }
+
+  // Copy the slice out of the data, its z extent is its position in the
+  // volume, which may not start at zero.
+  auto data = vtkImageData::SafeDownCast(m_data->dataObject());
+  auto scalars = data->GetPointData()->GetScalars();
+  int extent[6];
+  data->GetExtent(extent);
+  extent[4] += index;
+  extent[5] = extent[4];
+  vtkNew<vtkImageData> slice;
+  slice->SetExtent(extent);
+  slice->SetSpacing(data->GetSpacing());
+  slice->SetOrigin(data->GetOrigin());
+  vtkSmartPointer<vtkDataArray> sliceScalars;
+  sliceScalars.TakeReference(scalars->NewInstance());
+  sliceScalars->SetName(scalars->GetName());
+  sliceScalars->SetNumberOfComponents(scalars->GetNumberOfComponents());
+  sliceScalars->SetNumberOfTuples(slice->GetNumberOfPoints());
+  sliceScalars->InsertTuples(0, slice->GetNumberOfPoints(),
+                             index * slice->GetNumberOfPoints(), scalars);
+  slice->GetPointData()->SetScalars(sliceScalars);
+
+  m_sliceFuture = m_sliceWorker->run(slice.Get(), operators);
+  connect(m_sliceFuture, &PipelineWorker::Future::finished, this,
+          [this, index](bool result) { sliceFinished(index, result); });
+  connect(m_sliceFuture, &PipelineWorker::Future::canceled, this,
+          [this, index]() { sliceFinished(index, false); });
+}
+
+bool Pipeline::canExecuteSlice(int index)
+{
+  Operator* firstModified;
+  if (m_executionMode != Threaded || paused() || isRunning() ||
+      editingOperators() || isModified(m_data, &firstModified)) {
+    return false;
+  }
+
+  // The operators producing results or data sources of their own need the
+  // whole volume.
+  foreach (auto op, m_data->operators()) {
+    if (!op->appliesPerSlice() || op->state() != OperatorState::Complete ||
+        op->numberOfResults() > 0 || op->hasChildDataSource()) {
+      return false;
+    }
+  }
+
+  // The transformed data must hold all the slices before this one.
+  auto transformed = transformedDataSource();
+  auto data = vtkImageData::SafeDownCast(m_data->dataObject());
+  auto output = vtkImageData::SafeDownCast(transformed->dataObject());
+  return transformed != m_data && data != nullptr &&
+         data->GetPointData()->GetScalars() != nullptr && output != nullptr &&
+         output->GetDimensions()[2] == index;
+}
+
+void Pipeline::sliceFinished(int index, bool result)
+{
+  auto future = m_sliceFuture;
+  m_sliceFuture = nullptr;
+  future->deleteLater();
+
+  // The whole volume is run now, that includes this slice.
+  if (m_executeAfterSlice) {
+    DataSource* ds = m_executeAfterSlice;
+    Operator* start = m_executeAfterSliceStart;
+    m_executeAfterSlice = nullptr;
+    m_executeAfterSliceStart = nullptr;
+    m_pendingSlices.clear();
+    execute(ds, start);
+    return;
+  }
+
+  auto transformed = transformedDataSource();
+  auto output = vtkImageData::SafeDownCast(transformed->dataObject());
+  auto slice = vtkImageData::SafeDownCast(future->result());
+  if (result && transformed != m_data && output != nullptr &&
+      slice != nullptr && output->GetDimensions()[2] == index &&
+      appendSlice(output, slice)) {
+    emit transformed->sliceAppended(index);
+    transformed->dataModified();
+    emit transformed->dataPropertiesChanged();
+  } else {
+    // Bring the transformed data up to date the slow way.
+    m_pendingSlices.clear();
+    if (!m_data->operators().isEmpty()) {
+      m_data->operators().first()->setModified();
+      execute();
+    }
+    return;
+  }
+
+  if (!m_pendingSlices.isEmpty()) {
+    executeSlice(m_pendingSlices.takeFirst());
+  }
+}
+
+vtkSmartPointer<vtkDataObject> Pipeline::cachedOutput(
+  DataSource* ds, QList<Operator*> operators, int& index)
+{
+  return m_cache->findDeepest(cacheKeys(ds, operators), index);
+}
+
+void Pipeline::cacheOutput(Operator* op, vtkDataObject* data)
+{
+  auto itr = m_cacheKeys.constFind(op);
+  if (itr != m_cacheKeys.constEnd()) {
+    m_cache->insert(*itr, data);
+  }
+}
+
+QList<QByteArray> Pipeline::cacheKeys(DataSource* ds,
+                                      const QList<Operator*>& operators)
+{
+  // Operators producing results or data sources of their own have to run,
+  // so only the outputs of the operators before them can be reused.
+  int count = 0;
+  while (count < operators.size() &&
+         operators[count]->numberOfResults() == 0 &&
+         !operators[count]->hasChildDataSource()) {
+    ++count;
+  }
+
+  auto keys =
+    PipelineCache::stageKeys(ds->dataObject(), operators.mid(0, count));
+  for (int i = 0; i < count; ++i) {
+    m_cacheKeys[operators[i]] = keys[i];
+  }
+  return keys;
 }
 
 bool Pipeline::beingEdited(DataSource* ds) const
@@ -367,6 +600,8 @@ void Pipeline::addDataSource(DataSource* dataSource)
   connect(dataSource, &DataSource::operatorAdded, [this](Operator* op) {
     // Extract out source and execute all.
     connect(op, &Operator::transformModified, this, [this]() { execute(); });
+    connect(op, &Operator::aboutToBeDestroyed, this,
+            [this](Operator* op) { m_cacheKeys.remove(op); });
 
     // Ensure that new child data source signals are correctly wired up.
     connect(op,
@@ -500,6 +735,8 @@ void Pipeline::setExecutionMode(ExecutionMode executor)
   m_executionMode = executor;
   if (executor == ExecutionMode::Docker) {
     m_executor.reset(new DockerPipelineExecutor(this));
+  } else if (executor == ExecutionMode::ProcessPool) {
+    m_executor.reset(new ProcessPipelineExecutor(this));
   } else {
     m_executor.reset(new ThreadPipelineExecutor(this));
   }
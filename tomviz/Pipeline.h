@@ -22,8 +22,10 @@
 
 #include <QFile>
 #include <QFileSystemWatcher>
+#include <QHash>
 #include <QLocalServer>
 #include <QLocalSocket>
+#include <QPointer>
 #include <QProcess>
 #include <QScopedPointer>
 #include <QSettings>
@@ -42,6 +44,7 @@ namespace tomviz {
 class DataSource;
 class Operator;
 class Pipeline;
+class PipelineCache;
 class PipelineExecutor;
 
 namespace docker {
@@ -56,7 +59,8 @@ public:
   enum ExecutionMode
   {
     Threaded,
-    Docker
+    Docker,
+    ProcessPool
   };
   Q_ENUM(ExecutionMode)
 
@@ -107,12 +111,32 @@ public:
 
   ExecutionMode executionMode() { return m_executionMode; };
 
+  /// The cache of the intermediate outputs of the pipeline.
+  PipelineCache* cache() { return m_cache.data(); }
+
+  /// Returns the deepest cached output of the operators, run in order on the
+  /// data source's data, and sets index to the index of the operator that
+  /// produced it. Returns nullptr, with index set to -1, if there is none.
+  vtkSmartPointer<vtkDataObject> cachedOutput(DataSource* dataSource,
+                                              QList<Operator*> operators,
+                                              int& index);
+
+  /// Add the output of an operator to the cache, if it can be reused.
+  void cacheOutput(Operator* op, vtkDataObject* data);
+
 public slots:
   void execute();
   void execute(DataSource* dataSource, Operator* start = nullptr);
 
   void branchFinished(DataSource* start, vtkDataObject* newData);
 
+  /// Run a slice appended to the root data source through the operators and
+  /// append it to the transformed data source, so the cost doesn't grow with
+  /// the number of slices. This is only possible when all the operators apply
+  /// per slice and the rest of the pipeline is up to date, otherwise the
+  /// whole pipeline is executed again.
+  void executeSlice(int index);
+
   /// The user has started/finished editing an operator
   void startedEditingOp(Operator* op);
   void finishedEditingOp(Operator* op);
@@ -129,12 +153,20 @@ signals:
   /// pipeline view (or null if there isn't one).
   void operatorAdded(Operator* op, DataSource* outputDS = nullptr);
 
+  /// This signal is fired when an execution looked for cached outputs, with
+  /// the number of stages the cache has saved and missed so far.
+  void cacheUsed(int hits, int misses);
+
 private:
   DataSource* findTransformedDataSource(DataSource* dataSource);
   Operator* findTransformedDataSourceOperator(DataSource* dataSource);
   void addDataSource(DataSource* dataSource);
   bool beingEdited(DataSource* dataSource) const;
   bool isModified(DataSource* dataSource, Operator** firstModified) const;
+  QList<QByteArray> cacheKeys(DataSource* dataSource,
+                              const QList<Operator*>& operators);
+  bool canExecuteSlice(int index);
+  void sliceFinished(int index, bool result);
 
   DataSource* m_data;
   bool m_paused = false;
@@ -142,6 +174,14 @@ private:
   QScopedPointer<PipelineExecutor> m_executor;
   ExecutionMode m_executionMode = Threaded;
   int m_editingOperators = 0;
+  QScopedPointer<PipelineCache> m_cache;
+  QHash<Operator*, QByteArray> m_cacheKeys;
+  PipelineWorker* m_sliceWorker;
+  PipelineWorker::Future* m_sliceFuture = nullptr;
+  QList<int> m_pendingSlices;
+  // The execution waiting for the live slice to be canceled, if any.
+  QPointer<DataSource> m_executeAfterSlice;
+  QPointer<Operator> m_executeAfterSliceStart;
 };
 
 /// Return from getCopyOfImagePriorTo for caller to track async operation.
@@ -177,12 +217,26 @@ public:
   QString dockerImage();
   bool dockerPull();
   bool dockerRemove();
+  /// Pass the data to the container as raw files in shared memory, mapped by
+  /// the container, rather than as EMD files.
+  bool dockerSharedMemory();
+  /// The side of the chunks of the EMD files passed to the container, written
+  /// in parallel, or 0 to write them contiguously.
+  int dockerChunkSize();
+  /// The memory budget of the pipeline cache in MiB.
+  int cacheSize();
+  /// The Python interpreter the process pool workers are run with.
+  QString processPython();
 
   void setExecutionMode(Pipeline::ExecutionMode executor);
   void setExecutionMode(const QString& executor);
   void setDockerImage(const QString& image);
   void setDockerPull(bool pull);
   void setDockerRemove(bool remove);
+  void setDockerSharedMemory(bool sharedMemory);
+  void setDockerChunkSize(int size);
+  void setCacheSize(int size);
+  void setProcessPython(const QString& python);
 
 private:
   pqSettings* m_settings;
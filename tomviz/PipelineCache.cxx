@@ -0,0 +1,202 @@
+/******************************************************************************
+
+  This source file is part of the tomviz project.
+
+  Copyright Kitware, Inc.
+
+  This source code is released under the New BSD License, (the "License").
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+******************************************************************************/
+#include "PipelineCache.h"
+
+#include "Operator.h"
+#include "OperatorFactory.h"
+
+#include <QCryptographicHash>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include <vtkAbstractArray.h>
+#include <vtkCellData.h>
+#include <vtkDataObject.h>
+#include <vtkDataSet.h>
+#include <vtkFieldData.h>
+#include <vtkPointData.h>
+
+namespace tomviz {
+
+namespace {
+
+void appendArrays(vtkFieldData* fields, QList<vtkAbstractArray*>& arrays)
+{
+  if (!fields) {
+    return;
+  }
+  for (int i = 0; i < fields->GetNumberOfArrays(); ++i) {
+    auto array = fields->GetAbstractArray(i);
+    if (array && !arrays.contains(array)) {
+      arrays.append(array);
+    }
+  }
+}
+
+QList<vtkAbstractArray*> dataArrays(vtkDataObject* data)
+{
+  QList<vtkAbstractArray*> arrays;
+  appendArrays(data->GetFieldData(), arrays);
+  if (auto dataSet = vtkDataSet::SafeDownCast(data)) {
+    appendArrays(dataSet->GetPointData(), arrays);
+    appendArrays(dataSet->GetCellData(), arrays);
+  }
+  return arrays;
+}
+} // namespace
+
+PipelineCache::PipelineCache(qint64 budget) : m_budget(budget)
+{
+}
+
+QByteArray PipelineCache::dataKey(vtkDataObject* data)
+{
+  // The data object is only modified through its data source, which bumps its
+  // modification time, so the pair identifies a version of the data.
+  QCryptographicHash hash(QCryptographicHash::Sha1);
+  auto address = reinterpret_cast<quintptr>(data);
+  auto mtime = static_cast<quint64>(data->GetMTime());
+  hash.addData(reinterpret_cast<const char*>(&address), sizeof(address));
+  hash.addData(reinterpret_cast<const char*>(&mtime), sizeof(mtime));
+  return hash.result();
+}
+
+QByteArray PipelineCache::stageKey(const QByteArray& inputKey, Operator* op)
+{
+  auto json = op->serialize();
+  // The child data sources are outputs, not parameters.
+  json.remove("dataSources");
+
+  QCryptographicHash hash(QCryptographicHash::Sha1);
+  hash.addData(inputKey);
+  hash.addData(OperatorFactory::operatorType(op));
+  hash.addData(QJsonDocument(json).toJson(QJsonDocument::Compact));
+  return hash.result();
+}
+
+QList<QByteArray> PipelineCache::stageKeys(vtkDataObject* data,
+                                           const QList<Operator*>& operators)
+{
+  QList<QByteArray> keys;
+  auto key = dataKey(data);
+  foreach (auto op, operators) {
+    key = stageKey(key, op);
+    keys.append(key);
+  }
+  return keys;
+}
+
+vtkSmartPointer<vtkDataObject> PipelineCache::find(const QByteArray& key)
+{
+  auto itr = m_entries.constFind(key);
+  if (itr == m_entries.constEnd()) {
+    return nullptr;
+  }
+  touch(key);
+
+  auto data = itr->data;
+  vtkSmartPointer<vtkDataObject> copy;
+  copy.TakeReference(data->NewInstance());
+  copy->ShallowCopy(data);
+  return copy;
+}
+
+vtkSmartPointer<vtkDataObject> PipelineCache::findDeepest(
+  const QList<QByteArray>& keys, int& index)
+{
+  for (index = keys.size() - 1; index >= 0; --index) {
+    auto data = find(keys[index]);
+    if (data) {
+      m_hits += index + 1;
+      m_misses += keys.size() - index - 1;
+      return data;
+    }
+  }
+  m_misses += keys.size();
+  return nullptr;
+}
+
+void PipelineCache::insert(const QByteArray& key, vtkDataObject* data)
+{
+  if (contains(key)) {
+    touch(key);
+    return;
+  }
+
+  qint64 size = static_cast<qint64>(data->GetActualMemorySize()) * 1024;
+  if (size > m_budget) {
+    return;
+  }
+
+  Entry entry;
+  entry.data.TakeReference(data->NewInstance());
+  entry.data->ShallowCopy(data);
+  entry.arrays = dataArrays(entry.data);
+  // Arrays already held by other outputs don't take any more memory.
+  foreach (auto array, entry.arrays) {
+    auto& use = m_arrays[array];
+    if (use.count++ == 0) {
+      use.size = static_cast<qint64>(array->GetActualMemorySize()) * 1024;
+      m_size += use.size;
+    }
+  }
+  m_entries.insert(key, entry);
+  m_recent.prepend(key);
+
+  // The new output is the most recently used, and fits on its own.
+  evict(m_budget);
+}
+
+bool PipelineCache::contains(const QByteArray& key) const
+{
+  return m_entries.contains(key);
+}
+
+void PipelineCache::clear()
+{
+  m_entries.clear();
+  m_recent.clear();
+  m_arrays.clear();
+  m_size = 0;
+}
+
+void PipelineCache::setBudget(qint64 budget)
+{
+  m_budget = budget;
+  evict(m_budget);
+}
+
+void PipelineCache::evict(qint64 budget)
+{
+  while (m_size > budget && !m_recent.isEmpty()) {
+    auto key = m_recent.takeLast();
+    foreach (auto array, m_entries.take(key).arrays) {
+      auto use = m_arrays.find(array);
+      if (--use->count == 0) {
+        m_size -= use->size;
+        m_arrays.erase(use);
+      }
+    }
+  }
+}
+
+void PipelineCache::touch(const QByteArray& key)
+{
+  m_recent.removeOne(key);
+  m_recent.prepend(key);
+}
+
+} // namespace tomviz
@@ -0,0 +1,112 @@
+/******************************************************************************
+
+  This source file is part of the tomviz project.
+
+  Copyright Kitware, Inc.
+
+  This source code is released under the New BSD License, (the "License").
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+******************************************************************************/
+#ifndef tomvizPipelineCache_h
+#define tomvizPipelineCache_h
+
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+
+#include <vtkSmartPointer.h>
+
+class vtkAbstractArray;
+class vtkDataObject;
+
+namespace tomviz {
+
+class Operator;
+
+/// A memory budgeted, least recently used cache of the intermediate outputs of
+/// a pipeline. An output is keyed by a hash of the version of the input data
+/// and of the type and serialized parameters of every operator up to and
+/// including the one that produced it, so any change upstream misses the cache.
+///
+/// The cache holds shallow copies, the worker copies arrays on write, so an
+/// output only costs memory once the pipeline has moved on from it. Operators
+/// that pass arrays through share them between the outputs of several stages,
+/// the budget counts each array once however many outputs hold it.
+class PipelineCache
+{
+public:
+  PipelineCache(qint64 budget);
+
+  /// The key of the data at the start of a pipeline.
+  static QByteArray dataKey(vtkDataObject* data);
+
+  /// The key of the output of op given the key of its input.
+  static QByteArray stageKey(const QByteArray& inputKey, Operator* op);
+
+  /// The keys of the outputs of each of the operators, run in order on data.
+  static QList<QByteArray> stageKeys(vtkDataObject* data,
+                                     const QList<Operator*>& operators);
+
+  /// Returns a shallow copy of the cached output with the given key, or
+  /// nullptr if it isn't in the cache.
+  vtkSmartPointer<vtkDataObject> find(const QByteArray& key);
+
+  /// Returns a shallow copy of the deepest cached output of a chain of stage
+  /// keys and sets index to its position in the chain, or to -1 if none of the
+  /// stages are cached. The stages that don't have to be run again count as
+  /// hits, the others as misses.
+  vtkSmartPointer<vtkDataObject> findDeepest(const QList<QByteArray>& keys,
+                                             int& index);
+
+  /// Add the output of a stage, evicting the least recently used outputs to
+  /// stay within the budget. Outputs larger than the budget aren't cached.
+  void insert(const QByteArray& key, vtkDataObject* data);
+
+  bool contains(const QByteArray& key) const;
+  void clear();
+
+  /// The memory budget in bytes.
+  qint64 budget() const { return m_budget; }
+  void setBudget(qint64 budget);
+
+  /// The memory used by the arrays of the cached outputs in bytes.
+  qint64 size() const { return m_size; }
+
+  int hits() const { return m_hits; }
+  int misses() const { return m_misses; }
+
+private:
+  struct Entry
+  {
+    vtkSmartPointer<vtkDataObject> data;
+    QList<vtkAbstractArray*> arrays;
+  };
+
+  struct ArrayUse
+  {
+    int count = 0;
+    qint64 size = 0;
+  };
+
+  void evict(qint64 budget);
+  void touch(const QByteArray& key);
+
+  QHash<QByteArray, Entry> m_entries;
+  // The arrays held by the entries and the number of entries holding them
+  QHash<vtkAbstractArray*, ArrayUse> m_arrays;
+  // Most recently used first
+  QList<QByteArray> m_recent;
+  qint64 m_budget;
+  qint64 m_size = 0;
+  int m_hits = 0;
+  int m_misses = 0;
+};
+} // namespace tomviz
+
+#endif
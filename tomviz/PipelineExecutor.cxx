@@ -25,6 +25,7 @@
 #include "PipelineExecutor.h"
 #include "PipelineWorker.h"
 #include "ProgressDialog.h"
+#include "PythonWorkerPool.h"
 #include "Utilities.h"
 
 #include <QDir>
@@ -35,11 +36,14 @@
 #include <QJsonObject>
 #include <QMessageBox>
 #include <QMetaEnum>
+#include <QStorageInfo>
 #include <QTimer>
 
 #include <pqApplicationCore.h>
 #include <pqSettings.h>
 #include <pqView.h>
+#include <vtkDataArray.h>
+#include <vtkPointData.h>
 #include <vtkSMViewProxy.h>
 #include <vtkTrivialProducer.h>
 
@@ -113,10 +117,14 @@ void ThreadPipelineExecutor::executePipelineBranch(vtkDataObject* data,
     return;
   }
 
+  // The operators get a shallow copy, the arrays they modify in place are
+  // copied on write by the worker.
   auto copy = data->NewInstance();
-  copy->DeepCopy(data);
+  copy->ShallowCopy(data);
   m_future = m_worker->run(copy, operators);
   copy->FastDelete();
+  connect(m_future, &PipelineWorker::Future::transformed, pipeline(),
+          &Pipeline::cacheOutput);
   connect(m_future, &PipelineWorker::Future::finished, this,
           &ThreadPipelineExecutor::pipelineBranchFinished);
   connect(m_future, &PipelineWorker::Future::canceled, this,
@@ -168,7 +176,8 @@ Pipeline::ImageFuture* ThreadPipelineExecutor::getCopyOfImagePriorTo(
   // If the op is new then we can just use the "Output" data source.
   if (!operators.isEmpty() && op->isNew()) {
     auto transformed = pipeline()->transformedDataSource();
-    auto dataObject = vtkImageData::SafeDownCast(transformed->copyData());
+    auto dataObject =
+      vtkImageData::SafeDownCast(transformed->shallowCopyData());
     auto imageFuture = new Pipeline::ImageFuture(op, dataObject);
     dataObject->FastDelete();
     // Delay emitting signal until next event loop
@@ -177,21 +186,30 @@ Pipeline::ImageFuture* ThreadPipelineExecutor::getCopyOfImagePriorTo(
     return imageFuture;
   } else {
     auto dataSource = pipeline()->dataSource();
-    auto dataObject = vtkImageData::SafeDownCast(dataSource->copyData());
-    if (operators.size() > 1) {
-      auto index = operators.indexOf(op);
-      // Only run operators if we have some to run
-      if (index > 0) {
-        auto future = m_worker->run(dataObject, operators.mid(0, index));
-        auto imageFuture = new Pipeline::ImageFuture(op, dataObject, future);
-        dataObject->FastDelete();
-
-        return imageFuture;
-      }
+    auto index = operators.indexOf(op);
+    // Start from the deepest cached output prior to the operator.
+    int cached = -1;
+    vtkSmartPointer<vtkDataObject> dataObject;
+    if (index > 0) {
+      dataObject =
+        pipeline()->cachedOutput(dataSource, operators.mid(0, index), cached);
+    }
+    if (!dataObject) {
+      dataObject.TakeReference(dataSource->shallowCopyData());
+    }
+    auto imageData = vtkImageData::SafeDownCast(dataObject);
+
+    // Only run operators if we have some to run
+    int start = cached + 1;
+    if (start < index) {
+      auto future =
+        m_worker->run(imageData, operators.mid(start, index - start));
+      connect(future, &PipelineWorker::Future::transformed, pipeline(),
+              &Pipeline::cacheOutput);
+      return new Pipeline::ImageFuture(op, imageData, future);
     }
 
-    auto imageFuture = new Pipeline::ImageFuture(op, dataObject);
-    dataObject->FastDelete();
+    auto imageFuture = new Pipeline::ImageFuture(op, imageData);
 
     // Delay emitting signal until next event loop
     QTimer::singleShot(0, [=] { emit imageFuture->finished(true); });
@@ -207,12 +225,216 @@ void ThreadPipelineExecutor::execute(DataSource* dataSource)
 
 const char* ORIGINAL_FILENAME = "original.emd";
 const char* TRANSFORM_FILENAME = "transformed.emd";
+const char* ORIGINAL_HEADER_FILENAME = "original.json";
+const char* ORIGINAL_RAW_FILENAME = "original.raw";
+const char* TRANSFORM_HEADER_FILENAME = "transformed.json";
 const char* STATE_FILENAME = "state.tvsm";
 const char* CONTAINER_MOUNT = "/tomviz";
 const char* PROGRESS_PATH = "progress";
+const char* SHARED_MEMORY_PATH = "/dev/shm";
+
+namespace {
+
+/// Write the scalars of the image to a raw file, C ordered with the slowest
+/// varying axis first, described by a JSON header for the container to map
+/// them as a numpy array.
+bool writeRawData(const QString& headerPath, const QString& rawFileName,
+                  vtkImageData* image)
+{
+  auto scalars = image->GetPointData()->GetScalars();
+  if (scalars == nullptr || scalars->GetNumberOfComponents() != 1 ||
+      numpyType(scalars->GetDataType()).isEmpty()) {
+    return false;
+  }
+
+  int dims[3];
+  image->GetDimensions(dims);
+  double spacing[3];
+  image->GetSpacing(spacing);
+  QJsonObject header;
+  header["file"] = rawFileName;
+  header["dtype"] = numpyType(scalars->GetDataType());
+  header["shape"] = QJsonArray({ dims[2], dims[1], dims[0] });
+  header["spacing"] = QJsonArray({ spacing[0], spacing[1], spacing[2] });
+
+  QFile rawFile(QFileInfo(headerPath).dir().filePath(rawFileName));
+  if (!rawFile.open(QIODevice::WriteOnly)) {
+    return false;
+  }
+  qint64 size = static_cast<qint64>(scalars->GetNumberOfValues()) *
+                scalars->GetDataTypeSize();
+  if (rawFile.write(static_cast<const char*>(scalars->GetVoidPointer(0)),
+                    size) != size) {
+    return false;
+  }
+  rawFile.close();
+
+  QFile headerFile(headerPath);
+  if (!headerFile.open(QIODevice::WriteOnly)) {
+    return false;
+  }
+  headerFile.write(QJsonDocument(header).toJson());
+  return true;
+}
+
+/// Read the raw data described by a JSON header into the image.
+bool readRawData(const QString& headerPath, vtkImageData* image)
+{
+  QFile headerFile(headerPath);
+  if (!headerFile.open(QIODevice::ReadOnly)) {
+    return false;
+  }
+  auto header = QJsonDocument::fromJson(headerFile.readAll()).object();
+  auto shape = header["shape"].toArray();
+  int type = vtkType(header["dtype"].toString());
+  if (shape.isEmpty() || shape.size() > 3 || type < 0) {
+    return false;
+  }
+
+  // The shape is slowest varying first, lower dimensional data is read as a
+  // volume one voxel deep.
+  int dims[3] = { 1, 1, 1 };
+  for (int i = 0; i < shape.size(); ++i) {
+    dims[shape.size() - 1 - i] = shape[i].toInt();
+  }
+  image->SetDimensions(dims);
+  image->AllocateScalars(type, 1);
+  auto spacing = header["spacing"].toArray();
+  if (spacing.size() == 3) {
+    image->SetSpacing(spacing[0].toDouble(), spacing[1].toDouble(),
+                      spacing[2].toDouble());
+  }
+
+  auto scalars = image->GetPointData()->GetScalars();
+  qint64 size = static_cast<qint64>(scalars->GetNumberOfValues()) *
+                scalars->GetDataTypeSize();
+  QFile rawFile(
+    QFileInfo(headerPath).dir().filePath(header["file"].toString()));
+  if (!rawFile.open(QIODevice::ReadOnly) || rawFile.size() < size) {
+    return false;
+  }
+  return rawFile.read(static_cast<char*>(scalars->GetVoidPointer(0)), size) ==
+         size;
+}
+} // namespace
+
+ExternalPipelineExecutor::ExternalPipelineExecutor(Pipeline* pipeline)
+  : PipelineExecutor(pipeline)
+{
+}
+
+ExternalPipelineExecutor::~ExternalPipelineExecutor()
+{
+}
+
+bool ExternalPipelineExecutor::createTemporaryDir(vtkImageData* imageData,
+                                                  bool sharedMemory)
+{
+  auto scalars = imageData->GetPointData()->GetScalars();
+
+  // Raw data is mapped by the other process rather than read from an EMD
+  // file, and is put in shared memory if there is room for the input and
+  // output.
+  m_sharedMemory = sharedMemory && scalars != nullptr &&
+                   scalars->GetNumberOfComponents() == 1 &&
+                   !numpyType(scalars->GetDataType()).isEmpty();
+  m_temporaryDir.reset();
+  if (m_sharedMemory) {
+    QStorageInfo storage(SHARED_MEMORY_PATH);
+    qint64 size = static_cast<qint64>(imageData->GetActualMemorySize()) * 1024;
+    if (storage.isValid() && storage.isReady() &&
+        storage.bytesAvailable() > 2 * size) {
+      m_temporaryDir.reset(new QTemporaryDir(
+        QDir(SHARED_MEMORY_PATH).filePath("tomviz-XXXXXX")));
+    }
+  }
+  if (m_temporaryDir.isNull() || !m_temporaryDir->isValid()) {
+    m_temporaryDir.reset(new QTemporaryDir());
+  }
+  if (!m_temporaryDir->isValid()) {
+    displayError("Directory Error", "Unable to create temporary directory.");
+    return false;
+  }
+
+  return true;
+}
+
+QString ExternalPipelineExecutor::writeInput(vtkImageData* imageData)
+{
+  bool written = false;
+  QString dataFilePath;
+  if (m_sharedMemory) {
+    dataFilePath =
+      QDir(m_temporaryDir->path()).filePath(ORIGINAL_HEADER_FILENAME);
+    written = writeRawData(dataFilePath, ORIGINAL_RAW_FILENAME, imageData);
+  } else {
+    dataFilePath = QDir(m_temporaryDir->path()).filePath(ORIGINAL_FILENAME);
+    EmdFormat emdFile;
+    emdFile.setChunkSize(PipelineSettings().dockerChunkSize());
+    written = emdFile.write(dataFilePath.toLatin1().data(), imageData);
+  }
+  if (!written) {
+    displayError("Write Error",
+                 QString("Unable to write data at: %1").arg(dataFilePath));
+    return QString();
+  }
+
+  return dataFilePath;
+}
+
+QString ExternalPipelineExecutor::outputPath()
+{
+  return QDir(m_temporaryDir->path())
+    .filePath(m_sharedMemory ? TRANSFORM_HEADER_FILENAME : TRANSFORM_FILENAME);
+}
+
+bool ExternalPipelineExecutor::readOutput()
+{
+  vtkNew<vtkImageData> transformedData;
+  auto transformedFilePath = outputPath();
+  bool read = false;
+  if (m_sharedMemory) {
+    read = readRawData(transformedFilePath, transformedData);
+  } else {
+    EmdFormat emdFile;
+    read = emdFile.read(transformedFilePath.toLatin1().data(), transformedData);
+  }
+  if (!read) {
+    displayError("Read Error", QString("Unable to load transformed data at: %1")
+                                 .arg(transformedFilePath));
+    return false;
+  }
+
+  pipeline()->branchFinished(pipeline()->dataSource(), transformedData);
+  emit pipeline()->finished();
+
+  return true;
+}
+
+void ExternalPipelineExecutor::startProgressReader(bool useFiles)
+{
+  auto progressPath = QDir(m_temporaryDir->path()).filePath(PROGRESS_PATH);
+  if (useFiles) {
+    m_progressReader.reset(new FilesProgressReader(progressPath));
+  } else {
+    m_progressReader.reset(new LocalSocketProgressReader(progressPath));
+  }
+
+  m_progressReader->start();
+  connect(m_progressReader.data(), &ProgressReader::progressMessage, this,
+          &ExternalPipelineExecutor::progressReady);
+}
+
+void ExternalPipelineExecutor::cleanUp()
+{
+  if (m_progressReader) {
+    m_progressReader->stop();
+  }
+  m_temporaryDir.reset(nullptr);
+}
 
 DockerPipelineExecutor::DockerPipelineExecutor(Pipeline* pipeline)
-  : PipelineExecutor(pipeline), m_statusCheckTimer(new QTimer(this))
+  : ExternalPipelineExecutor(pipeline), m_statusCheckTimer(new QTimer(this))
 {
   m_statusCheckTimer->setInterval(5000);
   connect(m_statusCheckTimer, &QTimer::timeout, this,
@@ -302,9 +524,9 @@ docker::DockerStopInvocation* DockerPipelineExecutor::stop(
 void DockerPipelineExecutor::execute(vtkDataObject* data,
                                      QList<Operator*> operators, int start)
 {
-  m_temporaryDir.reset(new QTemporaryDir());
-  if (!m_temporaryDir->isValid()) {
-    displayError("Directory Error", "Unable to create temporary directory.");
+  PipelineSettings settings;
+  auto imageData = vtkImageData::SafeDownCast(data);
+  if (!createTemporaryDir(imageData, settings.dockerSharedMemory())) {
     return;
   }
 
@@ -313,7 +535,9 @@ void DockerPipelineExecutor::execute(vtkDataObject* data,
   QJsonObject dataSource;
   QJsonObject reader;
   QJsonArray fileNames;
-  fileNames.append(QDir(CONTAINER_MOUNT).filePath(ORIGINAL_FILENAME));
+  fileNames.append(QDir(CONTAINER_MOUNT)
+                     .filePath(m_sharedMemory ? ORIGINAL_HEADER_FILENAME
+                                              : ORIGINAL_FILENAME));
   reader["fileNames"] = fileNames;
   dataSource["reader"] = reader;
   QJsonArray pipelineOps;
@@ -334,39 +558,28 @@ void DockerPipelineExecutor::execute(vtkDataObject* data,
   stateFile.write(QJsonDocument(state).toJson());
   stateFile.close();
 
-  // Write data to EMD
-  auto dataFilePath = QDir(m_temporaryDir->path()).filePath(ORIGINAL_FILENAME);
-  EmdFormat emdFile;
-  auto imageData = vtkImageData::SafeDownCast(data);
-  if (!emdFile.write(dataFilePath.toLatin1().data(), imageData)) {
-    displayError("Write Error",
-                 QString("Unable to write data at: %1").arg(dataFilePath));
+  // Write data to EMD, or raw for the container to map
+  if (writeInput(imageData).isEmpty()) {
     return;
   }
 
-  // Start reading progress updates
-  auto progressPath = QDir(m_temporaryDir->path()).filePath(PROGRESS_PATH);
-
 // On Windows and MacOS we have to use files to pass progress updates rather
 // than a local socket which we can use on Linux. Looks like docker on MacOS
 // may support sharing local sockets as some point, see
 // https://github.com/docker/for-mac/issues/483
 #if defined(Q_OS_WIN) || defined(Q_OS_MAC)
   QString progressMode("files");
-  m_progressReader.reset(new FilesProgressReader(progressPath));
+  startProgressReader(true);
 #else
   QString progressMode("socket");
-  m_progressReader.reset(new LocalSocketProgressReader(progressPath));
+  startProgressReader(false);
 #endif
 
-  m_progressReader->start();
-  connect(m_progressReader.data(), &ProgressReader::progressMessage, this,
-          &DockerPipelineExecutor::progressReady);
-
   // We are now ready to run the pipeline
   auto mount = QDir(CONTAINER_MOUNT);
   auto stateFilePath = mount.filePath(STATE_FILENAME);
-  auto outputPath = mount.filePath(TRANSFORM_FILENAME);
+  auto outputPath = mount.filePath(
+    m_sharedMemory ? TRANSFORM_HEADER_FILENAME : TRANSFORM_FILENAME);
   QStringList args;
   args << "-s";
   args << stateFilePath;
@@ -397,7 +610,6 @@ void DockerPipelineExecutor::execute(vtkDataObject* data,
             });
   };
 
-  PipelineSettings settings;
   // Pull the latest version of the image, if haven't already
   if (settings.dockerPull() && m_pullImage) {
     auto msg = QString("Pulling docker image: %1").arg(image);
@@ -536,7 +748,7 @@ void DockerPipelineExecutor::checkContainerStatus()
           });
 }
 
-void DockerPipelineExecutor::progressReady(const QString& progressMessage)
+void ExternalPipelineExecutor::progressReady(const QString& progressMessage)
 {
   if (progressMessage.isEmpty()) {
     return;
@@ -570,8 +782,8 @@ void DockerPipelineExecutor::progressReady(const QString& progressMessage)
       auto value = progressObj["value"].toInt();
       operatorProgressStep(op, value);
     } else if (type == "progress.message") {
-      auto value = progressObj["value"].toInt();
-      operatorProgressMaximum(op, value);
+      auto value = progressObj["value"].toString();
+      operatorProgressMessage(op, value);
     } else {
       qCritical() << QString("Unrecognized message type: %1").arg(type);
     }
@@ -588,19 +800,19 @@ void DockerPipelineExecutor::progressReady(const QString& progressMessage)
   }
 }
 
-void DockerPipelineExecutor::operatorStarted(Operator* op)
+void ExternalPipelineExecutor::operatorStarted(Operator* op)
 {
   op->setState(OperatorState::Running);
   emit op->transformingStarted();
 }
 
-void DockerPipelineExecutor::operatorFinished(Operator* op)
+void ExternalPipelineExecutor::operatorFinished(Operator* op)
 {
   op->setState(OperatorState::Complete);
   emit op->transformingDone(TransformResult::Complete);
 }
 
-void DockerPipelineExecutor::operatorError(Operator* op, const QString& error)
+void ExternalPipelineExecutor::operatorError(Operator* op, const QString& error)
 {
   op->setState(OperatorState::Error);
   emit op->transformingDone(TransformResult::Error);
@@ -608,17 +820,17 @@ void DockerPipelineExecutor::operatorError(Operator* op, const QString& error)
   qCritical() << error;
 }
 
-void DockerPipelineExecutor::operatorProgressMaximum(Operator* op, int max)
+void ExternalPipelineExecutor::operatorProgressMaximum(Operator* op, int max)
 {
   op->setTotalProgressSteps(max);
 }
 
-void DockerPipelineExecutor::operatorProgressStep(Operator* op, int step)
+void ExternalPipelineExecutor::operatorProgressStep(Operator* op, int step)
 {
   op->setProgressStep(step);
 }
-void DockerPipelineExecutor::operatorProgressMessage(Operator* op,
-                                                     const QString& msg)
+void ExternalPipelineExecutor::operatorProgressMessage(Operator* op,
+                                                       const QString& msg)
 {
   op->setProgressMessage(msg);
 }
@@ -628,28 +840,19 @@ void DockerPipelineExecutor::pipelineStarted()
   qDebug("Pipeline started in docker container!");
 }
 
+void ExternalPipelineExecutor::pipelineStarted()
+{
+}
+
 void DockerPipelineExecutor::pipelineFinished()
 {
-  auto transformedFilePath =
-    QDir(m_temporaryDir->path()).filePath(TRANSFORM_FILENAME);
-  EmdFormat emdFile;
-  vtkNew<vtkImageData> transformedData;
-  if (emdFile.read(transformedFilePath.toLatin1().data(), transformedData)) {
-    pipeline()->branchFinished(pipeline()->dataSource(), transformedData);
-    emit pipeline()->finished();
-  } else {
-    displayError("Read Error", QString("Unable to load transformed data at: %1")
-                                 .arg(transformedFilePath));
-  }
+  readOutput();
 
   // Cancel status checks
   m_statusCheckTimer->stop();
 
-  // Stop the progress reader
-  m_progressReader->stop();
-
-  // Clean up temp directory
-  m_temporaryDir.reset(nullptr);
+  // Stop the progress reader and clean up the temporary directory
+  cleanUp();
 
   PipelineSettings settings;
   if (settings.dockerRemove()) {
@@ -660,13 +863,163 @@ void DockerPipelineExecutor::pipelineFinished()
   m_containerId = QString();
 }
 
-void DockerPipelineExecutor::displayError(const QString& title,
-                                          const QString& msg)
+void ExternalPipelineExecutor::displayError(const QString& title,
+                                            const QString& msg)
 {
   QMessageBox::critical(tomviz::mainWidget(), title, msg);
   qCritical() << msg;
 }
 
+ProcessPipelineExecutor::ProcessPipelineExecutor(Pipeline* pipeline)
+  : ExternalPipelineExecutor(pipeline),
+    m_preview(new ThreadPipelineExecutor(pipeline))
+{
+  // Have a worker ready by the time the pipeline is first run.
+  PythonWorkerPool::instance().warmUp();
+}
+
+ProcessPipelineExecutor::~ProcessPipelineExecutor()
+{
+  releaseWorker(true);
+  delete m_preview;
+}
+
+void ProcessPipelineExecutor::execute(vtkDataObject* data,
+                                      QList<Operator*> operators, int start)
+{
+  // A new run replaces the one in progress.
+  if (isRunning()) {
+    releaseWorker(true);
+    cleanUp();
+  }
+
+  auto imageData = vtkImageData::SafeDownCast(data);
+  if (!createTemporaryDir(imageData, true)) {
+    return;
+  }
+  auto inputPath = writeInput(imageData);
+  if (inputPath.isEmpty()) {
+    cleanUp();
+    return;
+  }
+
+// Python can't connect to the named pipes QLocalServer uses on Windows.
+#if defined(Q_OS_WIN)
+  QString progressMode("files");
+  startProgressReader(true);
+#else
+  QString progressMode("socket");
+  startProgressReader(false);
+#endif
+
+  QJsonArray pipelineOps;
+  foreach (Operator* op, operators) {
+    pipelineOps.append(op->serialize());
+  }
+  QJsonObject job;
+  job["operators"] = pipelineOps;
+  job["start"] = start;
+  job["input"] = inputPath;
+  job["output"] = outputPath();
+  job["progress"] = progressMode;
+  job["progressPath"] = QDir(m_temporaryDir->path()).filePath(PROGRESS_PATH);
+
+  m_worker = PythonWorkerPool::instance().acquire();
+  connect(m_worker, &PythonWorker::replied, this,
+          &ProcessPipelineExecutor::workerReplied);
+  connect(m_worker, &PythonWorker::exited, this,
+          &ProcessPipelineExecutor::workerExited);
+  m_worker->submit(job);
+}
+
+Pipeline::ImageFuture* ProcessPipelineExecutor::getCopyOfImagePriorTo(
+  Operator* op)
+{
+  // The editors only need the data, it is produced in this process.
+  return m_preview->getCopyOfImagePriorTo(op);
+}
+
+void ProcessPipelineExecutor::cancel(std::function<void()> canceled)
+{
+  releaseWorker(true);
+  cleanUp();
+  // Replace the worker that was killed.
+  PythonWorkerPool::instance().warmUp();
+
+  if (canceled) {
+    canceled();
+  }
+}
+
+bool ProcessPipelineExecutor::cancel(Operator* op)
+{
+  Q_UNUSED(op)
+  // The whole run is abandoned.
+  cancel(nullptr);
+
+  return true;
+}
+
+bool ProcessPipelineExecutor::isRunning()
+{
+  return m_worker != nullptr || !m_temporaryDir.isNull();
+}
+
+void ProcessPipelineExecutor::workerReplied(const QJsonObject& reply)
+{
+  releaseWorker();
+
+  // The output is read once the progress messages report the end of the
+  // pipeline, after those of the operators.
+  if (reply["status"].toString() != "ok") {
+    failRunningOperators(reply["error"].toString());
+    displayError("Pipeline Error", QString("The pipeline failed:\n\n%1")
+                                     .arg(reply["error"].toString()));
+    cleanUp();
+  }
+}
+
+void ProcessPipelineExecutor::workerExited()
+{
+  auto errors = m_worker->errors();
+  releaseWorker();
+
+  failRunningOperators("The pipeline worker exited.");
+  displayError(
+    "Pipeline Error",
+    QString("The pipeline worker exited unexpectedly.\n\n%1").arg(errors));
+  cleanUp();
+}
+
+void ProcessPipelineExecutor::releaseWorker(bool kill)
+{
+  if (m_worker == nullptr) {
+    return;
+  }
+
+  disconnect(m_worker, nullptr, this, nullptr);
+  if (kill) {
+    m_worker->kill();
+  }
+  PythonWorkerPool::instance().release(m_worker);
+  m_worker = nullptr;
+}
+
+void ProcessPipelineExecutor::failRunningOperators(const QString& error)
+{
+  foreach (Operator* op, pipeline()->dataSource()->operators()) {
+    if (op->state() == OperatorState::Running) {
+      operatorError(op, error);
+    }
+  }
+}
+
+void ProcessPipelineExecutor::pipelineFinished()
+{
+  readOutput();
+  cleanUp();
+}
+
 ProgressReader::ProgressReader(const QString& path) : m_path(path)
 {
 }
@@ -22,6 +22,7 @@
 
 #include <QFile>
 #include <QFileSystemWatcher>
+#include <QJsonObject>
 #include <QLocalServer>
 #include <QLocalSocket>
 #include <QProcess>
@@ -95,8 +96,58 @@ private:
 };
 
 class ProgressReader;
+class PythonWorker;
 
-class DockerPipelineExecutor : public PipelineExecutor
+/// Base for the executors running the pipeline in another process. The data
+/// is exchanged through files, raw ones in shared memory when possible, and
+/// the process reports its progress as JSON messages.
+class ExternalPipelineExecutor : public PipelineExecutor
+{
+  Q_OBJECT
+
+public:
+  ExternalPipelineExecutor(Pipeline* pipeline);
+  ~ExternalPipelineExecutor();
+
+protected slots:
+  void progressReady(const QString& progressMessage);
+
+protected:
+  QScopedPointer<QTemporaryDir> m_temporaryDir;
+  // Whether the data is passed as raw files mapped by the other process.
+  bool m_sharedMemory = false;
+  QScopedPointer<ProgressReader> m_progressReader;
+
+  /// Create the temporary directory the data is exchanged through, in shared
+  /// memory if requested and there is room for the input and output.
+  bool createTemporaryDir(vtkImageData* data, bool sharedMemory);
+  /// Write the input to the temporary directory, returns its path or an
+  /// empty string on failure.
+  QString writeInput(vtkImageData* data);
+  /// The path of the transformed data in the temporary directory.
+  QString outputPath();
+  /// Read the output from the temporary directory and hand it to the
+  /// pipeline.
+  bool readOutput();
+  /// Start reading progress updates, using files if useFiles is true or a
+  /// local socket otherwise.
+  void startProgressReader(bool useFiles);
+  /// Stop reading progress updates and remove the temporary directory.
+  void cleanUp();
+
+  void operatorStarted(Operator* op);
+  void operatorFinished(Operator* op);
+  void operatorError(Operator* op, const QString& error);
+  void operatorCanceled(Operator* op);
+  void operatorProgressMaximum(Operator* op, int max);
+  void operatorProgressStep(Operator* op, int step);
+  void operatorProgressMessage(Operator* op, const QString& msg);
+  virtual void pipelineStarted();
+  virtual void pipelineFinished() = 0;
+  void displayError(const QString& title, const QString& msg);
+};
+
+class DockerPipelineExecutor : public ExternalPipelineExecutor
 {
   Q_OBJECT
 
@@ -111,7 +162,6 @@ public:
 
 private slots:
   void error(QProcess::ProcessError error);
-  void progressReady(const QString& progressMessage);
   docker::DockerRunInvocation* run(const QString& image,
                                    const QStringList& args,
                                    const QMap<QString, QString>& bindMounts);
@@ -120,24 +170,44 @@ private slots:
   void containerError(int exitCode);
 
 private:
-  QScopedPointer<QTemporaryDir> m_temporaryDir;
   bool m_pullImage = true;
   QString m_containerId;
-  QScopedPointer<ProgressReader> m_progressReader;
 
   QTimer* m_statusCheckTimer;
 
   void checkContainerStatus();
-  void operatorStarted(Operator* op);
-  void operatorFinished(Operator* op);
-  void operatorError(Operator* op, const QString& error);
-  void operatorCanceled(Operator* op);
-  void operatorProgressMaximum(Operator* op, int max);
-  void operatorProgressStep(Operator* op, int step);
-  void operatorProgressMessage(Operator* op, const QString& msg);
-  void pipelineStarted();
-  void pipelineFinished();
-  void displayError(const QString& title, const QString& msg);
+  void pipelineStarted() override;
+  void pipelineFinished() override;
+};
+
+/// Runs the pipeline in a Python worker from the PythonWorkerPool. The
+/// worker keeps its modules imported between runs, and an operator crashing
+/// only takes the worker down.
+class ProcessPipelineExecutor : public ExternalPipelineExecutor
+{
+  Q_OBJECT
+
+public:
+  ProcessPipelineExecutor(Pipeline* pipeline);
+  ~ProcessPipelineExecutor();
+  void execute(vtkDataObject* data, QList<Operator*> operators, int start = 0);
+  Pipeline::ImageFuture* getCopyOfImagePriorTo(Operator* op);
+  void cancel(std::function<void()> canceled);
+  bool cancel(Operator* op);
+  bool isRunning();
+
+private:
+  PythonWorker* m_worker = nullptr;
+  // Produces the data the operator editors are given.
+  ThreadPipelineExecutor* m_preview;
+
+  void workerReplied(const QJsonObject& reply);
+  void workerExited();
+  /// Stop using the worker, it is returned to the pool unless killed.
+  void releaseWorker(bool kill = false);
+  /// Mark the operators that were running as failed.
+  void failRunningOperators(const QString& error);
+  void pipelineFinished() override;
 };
 
 class ProgressReader : public QObject
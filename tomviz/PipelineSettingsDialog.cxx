@@ -26,6 +26,7 @@
 #include <QPushButton>
 
 #include "PipelineManager.h"
+#include "PythonWorkerPool.h"
 
 namespace tomviz {
 
@@ -42,13 +43,17 @@ PipelineSettingsDialog::PipelineSettingsDialog(QWidget* parent)
     m_executorTypeMetaEnum.valueToKey(Pipeline::ExecutionMode::Threaded));
   m_ui->modeComboBox->addItem(
     m_executorTypeMetaEnum.valueToKey(Pipeline::ExecutionMode::Docker));
+  m_ui->modeComboBox->addItem(
+    m_executorTypeMetaEnum.valueToKey(Pipeline::ExecutionMode::ProcessPool));
 
   readSettings();
 
-  m_ui->dockerGroupBox->setHidden(
-    m_executorTypeMetaEnum.keyToValue(
-      m_ui->modeComboBox->currentText().toLatin1().data()) !=
-    Pipeline::ExecutionMode::Docker);
+  auto executionMode = m_executorTypeMetaEnum.keyToValue(
+    m_ui->modeComboBox->currentText().toLatin1().data());
+  m_ui->dockerGroupBox->setHidden(executionMode !=
+                                  Pipeline::ExecutionMode::Docker);
+  m_ui->processGroupBox->setHidden(executionMode !=
+                                   Pipeline::ExecutionMode::ProcessPool);
 
   connect(m_ui->dockerImageLineEdit, &QLineEdit::textChanged,
           [this](const QString& text) {
@@ -56,12 +61,21 @@ PipelineSettingsDialog::PipelineSettingsDialog(QWidget* parent)
             checkEnableOk();
           });
 
+  connect(m_ui->pythonExecutableLineEdit, &QLineEdit::textChanged,
+          [this](const QString& text) {
+            Q_UNUSED(text);
+            checkEnableOk();
+          });
+
   connect(m_ui->modeComboBox, &QComboBox::currentTextChanged,
           [this](const QString& text) {
             auto executionMode =
               m_executorTypeMetaEnum.keyToValue(text.toLatin1().data());
             m_ui->dockerGroupBox->setHidden(executionMode !=
                                             Pipeline::ExecutionMode::Docker);
+            m_ui->processGroupBox->setHidden(
+              executionMode != Pipeline::ExecutionMode::ProcessPool);
+            checkEnableOk();
           });
 
   connect(this, &QDialog::accepted, this, [this]() {
@@ -104,6 +118,10 @@ void PipelineSettingsDialog::readSettings()
 
   m_ui->pullImageCheckBox->setChecked(pipelineSettings.dockerPull());
   m_ui->removeContainersCheckBox->setChecked(pipelineSettings.dockerRemove());
+  m_ui->sharedMemoryCheckBox->setChecked(
+    pipelineSettings.dockerSharedMemory());
+  m_ui->chunkSizeSpinBox->setValue(pipelineSettings.dockerChunkSize());
+  m_ui->pythonExecutableLineEdit->setText(pipelineSettings.processPython());
 }
 
 void PipelineSettingsDialog::writeSettings()
@@ -116,6 +134,16 @@ void PipelineSettingsDialog::writeSettings()
   pipelineSettings.setDockerImage(m_ui->dockerImageLineEdit->text());
   pipelineSettings.setDockerPull(m_ui->pullImageCheckBox->isChecked());
   pipelineSettings.setDockerRemove(m_ui->removeContainersCheckBox->isChecked());
+  pipelineSettings.setDockerSharedMemory(
+    m_ui->sharedMemoryCheckBox->isChecked());
+  pipelineSettings.setDockerChunkSize(m_ui->chunkSizeSpinBox->value());
+
+  auto python = m_ui->pythonExecutableLineEdit->text();
+  if (python != pipelineSettings.processPython()) {
+    pipelineSettings.setProcessPython(python);
+    // The idle workers were started with the previous interpreter.
+    PythonWorkerPool::instance().clear();
+  }
 }
 
 void PipelineSettingsDialog::checkEnableOk()
@@ -123,10 +151,12 @@ void PipelineSettingsDialog::checkEnableOk()
 
   bool enabled = true;
 
-  if (m_executorTypeMetaEnum.keyToValue(
-        m_ui->modeComboBox->currentText().toLatin1().data()) ==
-      Pipeline::ExecutionMode::Docker) {
+  auto executionMode = m_executorTypeMetaEnum.keyToValue(
+    m_ui->modeComboBox->currentText().toLatin1().data());
+  if (executionMode == Pipeline::ExecutionMode::Docker) {
     enabled = !m_ui->dockerImageLineEdit->text().isEmpty();
+  } else if (executionMode == Pipeline::ExecutionMode::ProcessPool) {
+    enabled = !m_ui->pythonExecutableLineEdit->text().isEmpty();
   }
 
   m_ui->buttonBox->button(QDialogButtonBox::Ok)->setEnabled(enabled);
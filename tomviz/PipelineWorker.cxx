@@ -15,6 +15,7 @@
 ******************************************************************************/
 #include "PipelineWorker.h"
 #include "Operator.h"
+#include "Utilities.h"
 
 #include <QObject>
 #include <QQueue>
@@ -96,6 +97,7 @@ public slots:
 signals:
   void finished(bool result);
   void canceled();
+  void transformed(Operator* op, vtkDataObject* data);
 
 private:
   RunnableOperator* m_running = nullptr;
@@ -118,6 +120,11 @@ PipelineWorker::RunnableOperator::RunnableOperator(Operator* op,
 
 void PipelineWorker::RunnableOperator::run()
 {
+  // The data may share arrays with data sources shown in the UI, copy them
+  // before they are modified.
+  if (m_operator->modifiesDataInPlace()) {
+    detachSharedArrays(m_data);
+  }
   TransformResult result = m_operator->transform(m_data);
   emit complete(result);
 }
@@ -134,13 +141,9 @@ bool PipelineWorker::RunnableOperator::isCanceled()
 
 PipelineWorker::ConfigureThreadPool::ConfigureThreadPool()
 {
-  auto threads = QThread::idealThreadCount();
-  if (threads < 1) {
-    threads = 1;
-  } else {
-    // Use half the threads we have available.
-    threads = threads / 2;
-  }
+  // Use half the threads we have available, each pipeline runs on one of
+  // them. Keep two so that a second pipeline isn't queued behind the first.
+  auto threads = qMax(QThread::idealThreadCount() / 2, 2);
   QThreadPool::globalInstance()->setMaxThreadCount(threads);
 }
 
@@ -158,6 +161,7 @@ PipelineWorker::Future* PipelineWorker::Run::start()
   auto future = new PipelineWorker::Future(this);
   connect(this, SIGNAL(finished(bool)), future, SIGNAL(finished(bool)));
   connect(this, SIGNAL(canceled()), future, SIGNAL(canceled()));
+  connect(this, &Run::transformed, future, &Future::transformed);
 
   QTimer::singleShot(0, this, SLOT(startNextOperator()));
 
@@ -168,6 +172,10 @@ PipelineWorker::Future* PipelineWorker::Run::start()
 
 void PipelineWorker::Run::startNextOperator()
 {
+  // Canceled before the first operator was started.
+  if (m_state == State::CANCELED) {
+    return;
+  }
 
   if (!m_runnableOperators.isEmpty()) {
     m_running = m_runnableOperators.dequeue();
@@ -197,10 +205,12 @@ void PipelineWorker::Run::operatorComplete(TransformResult transformResult)
   }
   // Run next operator
   else if (!m_runnableOperators.isEmpty()) {
+    emit transformed(runnableOperator->op(), m_data);
     startNextOperator();
   }
   // We are done
   else {
+    emit transformed(runnableOperator->op(), m_data);
     m_state = State::COMPLETE;
     emit finished(result);
   }
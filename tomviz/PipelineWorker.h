@@ -80,6 +80,9 @@ public:
 signals:
   void canceled();
   void finished(bool result);
+  /// Emitted as each operator completes, with the data it has transformed,
+  /// before the next operator starts.
+  void transformed(Operator* op, vtkDataObject* data);
   void progressRangeChanged(int minimum, int maximum);
   void progressTextChanged(const QString& progressText);
   void progressValueChanged(int progressValue);
@@ -116,14 +116,13 @@ void ProgressDialogManager::operationStarted()
 
 void ProgressDialogManager::operatorAdded(Operator* op)
 {
-  // Need to ensure that if we are using the docker executor we use a
-  // DirectQueued
-  // connection here, otherwise we will deadlock as the sender and receiver will
-  // will have the same thread affinity.
+  // Need to ensure that if we are using an executor running the operators in
+  // another process we use a DirectQueued connection here, otherwise we will
+  // deadlock as the sender and receiver will have the same thread affinity.
   std::function<void()> connectTransformingStarted = [op, this]() {
     auto connectionType = Qt::BlockingQueuedConnection;
-    if (op->dataSource()->pipeline()->executionMode() ==
-        Pipeline::ExecutionMode::Docker) {
+    if (op->dataSource()->pipeline()->executionMode() !=
+        Pipeline::ExecutionMode::Threaded) {
       connectionType = Qt::DirectConnection;
     }
 
@@ -151,6 +150,11 @@ void ProgressDialogManager::dataSourceAdded(DataSource* ds)
 {
   QObject::connect(ds, SIGNAL(operatorAdded(Operator*)), this,
                    SLOT(operatorAdded(Operator*)));
+  // Child data sources share the pipeline of their root data source.
+  if (auto pipeline = ds->pipeline()) {
+    connect(pipeline, &Pipeline::cacheUsed, this,
+            &ProgressDialogManager::pipelineCacheUsed, Qt::UniqueConnection);
+  }
 }
 
 void ProgressDialogManager::operationProgress(int) {}
@@ -159,4 +163,10 @@ void ProgressDialogManager::showStatusBarMessage(const QString& message)
 {
   this->mainWindow->statusBar()->showMessage(message, 3000);
 }
+
+void ProgressDialogManager::pipelineCacheUsed(int hits, int misses)
+{
+  showStatusBarMessage(
+    QString("Pipeline cache: %1 hits, %2 misses").arg(hits).arg(misses));
+}
 } // namespace tomviz
@@ -40,6 +40,7 @@ private slots:
   void operatorAdded(Operator* op);
   void dataSourceAdded(DataSource* ds);
   void showStatusBarMessage(const QString& message);
+  void pipelineCacheUsed(int hits, int misses);
 
 private:
   QMainWindow* mainWindow;
@@ -0,0 +1,214 @@
+/******************************************************************************
+
+  This source file is part of the tomviz project.
+
+  Copyright Kitware, Inc.
+
+  This source code is released under the New BSD License, (the "License").
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+******************************************************************************/
+#include "PythonWorkerPool.h"
+
+#include "Pipeline.h"
+#include "PythonUtilities.h"
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QJsonDocument>
+
+namespace tomviz {
+
+namespace {
+// Idle workers kept running, enough for a couple of pipelines to start
+// without waiting.
+const int MAX_IDLE_WORKERS = 2;
+// Bytes of stderr kept to report why a worker exited.
+const int MAX_ERRORS_SIZE = 64 * 1024;
+} // namespace
+
+PythonWorker::PythonWorker(const QString& python,
+                           const QProcessEnvironment& environment,
+                           QObject* parent)
+  : QObject(parent), m_process(new QProcess(this))
+{
+  m_process->setProcessEnvironment(environment);
+
+  connect(m_process, &QProcess::readyReadStandardOutput, this,
+          &PythonWorker::readReplies);
+  connect(m_process, &QProcess::readyReadStandardError, this, [this]() {
+    m_errors.append(m_process->readAllStandardError());
+    if (m_errors.size() > MAX_ERRORS_SIZE) {
+      m_errors = m_errors.right(MAX_ERRORS_SIZE);
+    }
+  });
+  connect(m_process, &QProcess::errorOccurred, this,
+          [this](QProcess::ProcessError error) {
+            if (error == QProcess::FailedToStart) {
+              m_errors.append(m_process->errorString().toUtf8());
+              m_busy = false;
+              emit exited();
+            }
+          });
+  connect(m_process, static_cast<void (QProcess::*)(
+                       int exitCode, QProcess::ExitStatus exitStatus)>(
+                       &QProcess::finished),
+          this, [this](int exitCode, QProcess::ExitStatus exitStatus) {
+            Q_UNUSED(exitCode)
+            Q_UNUSED(exitStatus)
+            m_busy = false;
+            emit exited();
+          });
+
+  m_process->start(python, { "-u", "-m", "tomviz.worker" });
+}
+
+PythonWorker::~PythonWorker()
+{
+  if (m_process->state() != QProcess::NotRunning) {
+    // Closing stdin asks an idle worker to exit, a busy one is killed.
+    disconnect(m_process, nullptr, this, nullptr);
+    if (m_busy) {
+      m_process->kill();
+    } else {
+      m_process->closeWriteChannel();
+      if (!m_process->waitForFinished(1000)) {
+        m_process->kill();
+      }
+    }
+    m_process->waitForFinished(1000);
+  }
+}
+
+bool PythonWorker::isRunning() const
+{
+  return m_process->state() != QProcess::NotRunning;
+}
+
+void PythonWorker::submit(const QJsonObject& job)
+{
+  m_busy = true;
+  m_errors.clear();
+  m_process->write(QJsonDocument(job).toJson(QJsonDocument::Compact));
+  m_process->write("\n");
+}
+
+void PythonWorker::kill()
+{
+  m_process->kill();
+}
+
+QString PythonWorker::errors() const
+{
+  return QString::fromUtf8(m_errors);
+}
+
+void PythonWorker::readReplies()
+{
+  while (m_process->canReadLine()) {
+    auto line = m_process->readLine();
+    auto reply = QJsonDocument::fromJson(line);
+    if (!reply.isObject()) {
+      qCritical() << "Invalid reply from the pipeline worker:" << line;
+      continue;
+    }
+    m_busy = false;
+    emit replied(reply.object());
+  }
+}
+
+PythonWorkerPool::PythonWorkerPool(QObject* parent) : QObject(parent)
+{
+  // The workers are stopped with the application rather than when statics
+  // are destroyed.
+  if (QCoreApplication::instance() != nullptr) {
+    connect(QCoreApplication::instance(), &QCoreApplication::aboutToQuit, this,
+            &PythonWorkerPool::clear);
+  }
+}
+
+PythonWorkerPool::~PythonWorkerPool()
+{
+  clear();
+}
+
+PythonWorkerPool& PythonWorkerPool::instance()
+{
+  static PythonWorkerPool theInstance;
+  return theInstance;
+}
+
+void PythonWorkerPool::warmUp()
+{
+  if (m_idle.isEmpty()) {
+    m_idle.append(start());
+  }
+}
+
+PythonWorker* PythonWorkerPool::acquire()
+{
+  while (!m_idle.isEmpty()) {
+    auto worker = m_idle.takeFirst();
+    if (worker->isRunning()) {
+      return worker;
+    }
+    worker->deleteLater();
+  }
+
+  return start();
+}
+
+void PythonWorkerPool::release(PythonWorker* worker)
+{
+  disconnect(worker, nullptr, nullptr, nullptr);
+  if (worker->isRunning() && !worker->isBusy() &&
+      m_idle.size() < MAX_IDLE_WORKERS) {
+    m_idle.append(worker);
+  } else {
+    worker->deleteLater();
+  }
+}
+
+void PythonWorkerPool::clear()
+{
+  qDeleteAll(m_idle);
+  m_idle.clear();
+}
+
+PythonWorker* PythonWorkerPool::start()
+{
+  PipelineSettings settings;
+  return new PythonWorker(settings.processPython(), environment(), this);
+}
+
+QProcessEnvironment PythonWorkerPool::environment()
+{
+  // The workers see the modules the application's interpreter does.
+  if (m_pythonPath.isEmpty()) {
+    Python::initialize();
+    Python python;
+    auto internalModule = python.import("tomviz._internal");
+    if (internalModule.isValid()) {
+      auto pythonPath = internalModule.findFunction("python_path");
+      if (pythonPath.isValid()) {
+        m_pythonPath = pythonPath.call().toString();
+      }
+    }
+  }
+
+  auto environment = QProcessEnvironment::systemEnvironment();
+  // The operators run as they do from the command line, not as if they were
+  // in the application.
+  environment.remove("TOMVIZ_APPLICATION");
+  if (!m_pythonPath.isEmpty()) {
+    environment.insert("PYTHONPATH", m_pythonPath);
+  }
+  return environment;
+}
+
+} // namespace tomviz
@@ -0,0 +1,106 @@
+/******************************************************************************
+
+  This source file is part of the tomviz project.
+
+  Copyright Kitware, Inc.
+
+  This source code is released under the New BSD License, (the "License").
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+******************************************************************************/
+#ifndef tomvizPythonWorkerPool_h
+#define tomvizPythonWorkerPool_h
+
+#include <QJsonObject>
+#include <QList>
+#include <QObject>
+#include <QProcess>
+
+namespace tomviz {
+
+/// A Python process running tomviz.worker, executing the pipelines it is
+/// handed one at a time. It outlives the pipelines so that the modules the
+/// operators import are only imported once.
+class PythonWorker : public QObject
+{
+  Q_OBJECT
+
+public:
+  PythonWorker(const QString& python, const QProcessEnvironment& environment,
+               QObject* parent = nullptr);
+  ~PythonWorker() override;
+
+  /// Whether the process is up, it may still be importing its modules.
+  bool isRunning() const;
+
+  /// Whether a job was submitted that hasn't been replied to.
+  bool isBusy() const { return m_busy; }
+
+  /// Hand the worker a job, see tomviz/worker.py for its keys. replied() is
+  /// emitted once it is done.
+  void submit(const QJsonObject& job);
+
+  /// Kill the process, the job it is running is abandoned.
+  void kill();
+
+  /// The last of what the process wrote to stderr.
+  QString errors() const;
+
+signals:
+  void replied(const QJsonObject& reply);
+
+  /// The process failed to start, exited or crashed.
+  void exited();
+
+private:
+  void readReplies();
+
+  QProcess* m_process;
+  QByteArray m_errors;
+  bool m_busy = false;
+};
+
+/// The Python workers used by the process pool execution mode, shared by all
+/// the pipelines. Workers are returned to the pool once they have run a
+/// pipeline and reused by the next one.
+class PythonWorkerPool : public QObject
+{
+  Q_OBJECT
+
+public:
+  static PythonWorkerPool& instance();
+
+  /// Start a worker ahead of the first pipeline, so that it doesn't wait for
+  /// the interpreter to start and import its modules.
+  void warmUp();
+
+  /// An idle worker, a new one is started if there is none. The caller owns it
+  /// until it is released.
+  PythonWorker* acquire();
+
+  /// Return a worker to the pool. Workers that have exited, and those beyond
+  /// the number kept idle, are deleted.
+  void release(PythonWorker* worker);
+
+  /// Stop the idle workers, the next ones use the current settings.
+  void clear();
+
+private:
+  Q_DISABLE_COPY(PythonWorkerPool)
+  PythonWorkerPool(QObject* parent = nullptr);
+  ~PythonWorkerPool() override;
+
+  PythonWorker* start();
+  QProcessEnvironment environment();
+
+  QList<PythonWorker*> m_idle;
+  QString m_pythonPath;
+};
+} // namespace tomviz
+
+#endif
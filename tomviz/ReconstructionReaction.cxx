@@ -22,15 +22,15 @@
 #include <vtkSMSourceProxy.h>
 #include <vtkTrivialProducer.h>
 
-#include "ReconstructionOperator.h"
-
 #include <QDebug>
 #include <QSharedPointer>
 
 namespace tomviz {
 
-ReconstructionReaction::ReconstructionReaction(QAction* parentObject)
-  : pqReaction(parentObject)
+ReconstructionReaction::ReconstructionReaction(
+  QAction* parentObject, TomographyReconstruction::Filter filter,
+  ReconstructionOperator::Algorithm algorithm)
+  : pqReaction(parentObject), m_filter(filter), m_algorithm(algorithm)
 {
   connect(&ActiveObjects::instance(), SIGNAL(dataSourceChanged(DataSource*)),
           SLOT(updateEnableState()));
@@ -58,7 +58,9 @@ void ReconstructionReaction::recon(DataSource* input)
     return;
   }
 
-  Operator* op = new ReconstructionOperator(input);
+  auto op = new ReconstructionOperator(input);
+  op->setAlgorithm(m_algorithm);
+  op->setFilter(m_filter);
   input->addOperator(op);
 }
 } // namespace tomviz
@@ -18,6 +18,9 @@
 
 #include <pqReaction.h>
 
+#include "ReconstructionOperator.h"
+#include "TomographyReconstruction.h"
+
 namespace tomviz {
 class DataSource;
 
@@ -26,7 +29,11 @@ class ReconstructionReaction : public pqReaction
   Q_OBJECT
 
 public:
-  ReconstructionReaction(QAction* parent);
+  ReconstructionReaction(QAction* parent,
+                         TomographyReconstruction::Filter filter =
+                           TomographyReconstruction::Filter::None,
+                         ReconstructionOperator::Algorithm algorithm =
+                           ReconstructionOperator::Algorithm::BackProjection);
 
   void recon(DataSource* input = NULL);
 
@@ -35,6 +42,8 @@ protected:
   void onTriggered() { recon(); }
 
 private:
+  TomographyReconstruction::Filter m_filter;
+  ReconstructionOperator::Algorithm m_algorithm;
   Q_DISABLE_COPY(ReconstructionReaction)
 };
 } // namespace tomviz
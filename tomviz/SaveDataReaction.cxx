@@ -142,6 +142,7 @@ bool SaveDataReaction::saveData(const QString& filename)
   QFileInfo info(filename);
   if (info.suffix() == "emd") {
     EmdFormat writer;
+    writer.readSettings();
     if (!writer.write(filename.toLatin1().data(), source)) {
       qCritical() << "Failed to write out data.";
       return false;
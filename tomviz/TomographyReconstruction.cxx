@@ -23,24 +23,1356 @@
 #define PI 3.14159265359
 #include "vtkFloatArray.h"
 #include "vtkPointData.h"
+#include "vtkSMPThreadLocal.h"
+#include "vtkSMPTools.h"
 #include "vtkSmartPointer.h"
 
 #include <QDebug>
 
+#include <algorithm>
+#include <atomic>
+#include <complex>
+#include <limits>
+#include <memory>
+#include <vector>
+
 namespace {
 
-// Conversion code
+using tomviz::TomographyReconstruction::Filter;
+using tomviz::TomographyTiltSeries::TiltSeriesView;
+using Complex = std::complex<float>;
+
+// Unscaled in place radix-2 decimation in time FFT of a power of two size.
+// The tables are built once on construction, the object is then used
+// read-only and can be shared by several threads.
+class Fft
+{
+public:
+  explicit Fft(int size) : m_size(size)
+  {
+    m_bitReverse.resize(m_size);
+    int bits = 0;
+    while ((1 << bits) < m_size) {
+      ++bits;
+    }
+    for (int i = 0; i < m_size; ++i) {
+      int r = 0;
+      for (int b = 0; b < bits; ++b) {
+        r |= ((i >> b) & 1) << (bits - 1 - b);
+      }
+      m_bitReverse[i] = r;
+    }
+
+    m_twiddles.resize(m_size / 2);
+    for (int k = 0; k < m_size / 2; ++k) {
+      double phase = -2 * PI * k / m_size;
+      m_twiddles[k] = Complex(static_cast<float>(cos(phase)),
+                              static_cast<float>(sin(phase)));
+    }
+  }
+
+  // The smallest power of two not less than n.
+  static int sizeFor(int n)
+  {
+    int size = 1;
+    while (size < n) {
+      size *= 2;
+    }
+    return size;
+  }
+
+  int size() const { return m_size; }
+
+  void operator()(Complex* data, bool inverse) const
+  {
+    for (int i = 0; i < m_size; ++i) {
+      int j = m_bitReverse[i];
+      if (i < j) {
+        std::swap(data[i], data[j]);
+      }
+    }
+    for (int length = 2; length <= m_size; length *= 2) {
+      const int half = length / 2;
+      const int step = m_size / length;
+      for (int i = 0; i < m_size; i += length) {
+        for (int j = 0; j < half; ++j) {
+          const Complex& w = m_twiddles[j * step];
+          const float wi = inverse ? -w.imag() : w.imag();
+          Complex& a = data[i + j];
+          Complex& b = data[i + j + half];
+          // Written out to avoid the NaN/Inf handling of complex operator*.
+          const float re = b.real() * w.real() - b.imag() * wi;
+          const float im = b.real() * wi + b.imag() * w.real();
+          b = Complex(a.real() - re, a.imag() - im);
+          a = Complex(a.real() + re, a.imag() + im);
+        }
+      }
+    }
+  }
+
+private:
+  int m_size;
+  std::vector<int> m_bitReverse;
+  std::vector<Complex> m_twiddles;
+};
+
+// Weights projections in Fourier space. The projections are zero padded to the
+// next power of two. The filter response is real and even, so two projections
+// are filtered with one complex transform: one in the real part, the other in
+// the imaginary part.
+class SinogramFilter
+{
+public:
+  SinogramFilter(Filter filter, int numOfRays)
+    : m_numOfRays(numOfRays), m_fft(Fft::sizeFor(numOfRays))
+  {
+    const int size = m_fft.size();
+    // Same frequencies as numpy.fft.fftfreq, the inverse transform scaling is
+    // folded into the response.
+    m_response.resize(size);
+    for (int k = 0; k < size; ++k) {
+      double freq =
+        (k < (size + 1) / 2 ? k : k - size) / static_cast<double>(size);
+      double omega = 2 * PI * freq;
+      double response = 2 * fabs(freq);
+      if (k != 0) {
+        switch (filter) {
+          case Filter::SheppLogan:
+            response *= sin(omega) / omega;
+            break;
+          case Filter::Cosine:
+            response *= cos(response);
+            break;
+          case Filter::Hamming:
+            response *= 0.54 + 0.46 * cos(omega / 2);
+            break;
+          case Filter::Hann:
+            response *= (1 + cos(omega / 2)) / 2;
+            break;
+          case Filter::None:
+            response = 1;
+            break;
+          case Filter::Ramp:
+            break;
+        }
+      }
+      m_response[k] = static_cast<float>(response / size);
+    }
+  }
+
+  // Number of complex values needed as work space by operator().
+  int workSize() const { return m_fft.size(); }
+
+  void operator()(float* sinogram, int numOfTilts, Complex* work) const
+  {
+    const int n = m_numOfRays;
+    const int size = m_fft.size();
+    for (int tt = 0; tt < numOfTilts; tt += 2) {
+      float* first = sinogram + static_cast<size_t>(tt) * n;
+      float* second = tt + 1 < numOfTilts ? first + n : nullptr;
+      for (int r = 0; r < n; ++r) {
+        work[r] = Complex(first[r], second ? second[r] : 0.0f);
+      }
+      std::fill(work + n, work + size, Complex(0.0f, 0.0f));
+      m_fft(work, false);
+      for (int k = 0; k < size; ++k) {
+        work[k] *= m_response[k];
+      }
+      m_fft(work, true);
+      for (int r = 0; r < n; ++r) {
+        first[r] = work[r].real();
+      }
+      if (second) {
+        for (int r = 0; r < n; ++r) {
+          second[r] = work[r].imag();
+        }
+      }
+    }
+  }
+
+private:
+  int m_numOfRays;
+  Fft m_fft;
+  std::vector<float> m_response;
+};
+
+// Number of rows of the 2D reconstruction accumulated together. Every tilt is
+// back projected into a block before moving to the next one, so the block
+// stays in cache while the sinogram is streamed through (16 rows of a 2k
+// reconstruction are 128 KiB).
+const int BlockRows = 16;
+
+// Back projects sinograms of a fixed geometry. The trigonometric tables are
+// computed once on construction, the object is then used read-only and can
+// be shared by several threads.
+//
+// For the pixel (iy, iz) and a given tilt the position along the projection,
+// measured from the first ray, is
+//   u = (iy + c0) * cos(angle) + (iz + c0) * sin(angle) + numOfRays / 2
+// with c0 = 0.5 - numOfRays / 2. It is linear in iz, so each row is a
+// contiguous run of pixels between two bounds computed once per row.
+class BackProjector
+{
+public:
+  BackProjector(const double* tiltAngles, int numOfTilts, int numOfRays)
+    : m_numOfTilts(numOfTilts), m_numOfRays(numOfRays),
+      m_cos(numOfTilts), m_sin(numOfTilts)
+  {
+    for (int tt = 0; tt < numOfTilts; ++tt) {
+      double angle = tiltAngles[tt] * PI / 180;
+      m_cos[tt] = cos(angle);
+      m_sin[tt] = sin(angle);
+    }
+  }
+
+  void operator()(const float* sinogram, float* image) const
+  {
+    const int n = m_numOfRays;
+    const double c0 = 0.5 - n / 2.0;
+    const float normalizationFactor =
+      static_cast<float>(PI / double(2 * m_numOfTilts));
+
+    std::fill(image, image + static_cast<size_t>(n) * n, 0.0f);
+    for (int rowBegin = 0; rowBegin < n; rowBegin += BlockRows) {
+      int rowEnd = std::min(rowBegin + BlockRows, n);
+      for (int tt = 0; tt < m_numOfTilts; ++tt) {
+        const float* projection = sinogram + static_cast<size_t>(tt) * n;
+        const double c = m_cos[tt];
+        const double s = m_sin[tt];
+        for (int iy = rowBegin; iy < rowEnd; ++iy) {
+          double origin = (iy + c0) * c + c0 * s + n / 2;
+          int begin, end;
+          validRange(origin, s, begin, end);
+          accumulateRow(image + static_cast<size_t>(iy) * n, projection,
+                        static_cast<float>(origin), static_cast<float>(s),
+                        begin, end);
+        }
+      }
+      float* block = image + static_cast<size_t>(rowBegin) * n;
+      for (size_t i = 0; i < static_cast<size_t>(rowEnd - rowBegin) * n; ++i) {
+        block[i] *= normalizationFactor;
+      }
+    }
+  }
+
+private:
+  // A ray can be interpolated if both of its neighbours are in the
+  // projection, i.e. 0 <= u < numOfRays - 1.
+  bool isValid(double u) const { return u >= 0 && u < m_numOfRays - 1; }
+
+  // Find the range [begin, end) of iz for which origin + iz * s is valid.
+  void validRange(double origin, double s, int& begin, int& end) const
+  {
+    const int n = m_numOfRays;
+    if (s == 0) {
+      begin = 0;
+      end = isValid(origin) ? n : 0;
+      return;
+    }
+    double lower = (0 - origin) / s;
+    double upper = (n - 1 - origin) / s;
+    if (s < 0) {
+      std::swap(lower, upper);
+    }
+    begin = static_cast<int>(std::max(0.0, std::min<double>(n, ceil(lower))));
+    end = static_cast<int>(std::max(0.0, std::min<double>(n, ceil(upper))));
+    // Correct for rounding at the ends so the range matches a per pixel test.
+    while (begin < end && !isValid(origin + begin * s)) {
+      ++begin;
+    }
+    while (begin > 0 && isValid(origin + (begin - 1) * s)) {
+      --begin;
+    }
+    while (end > begin && !isValid(origin + (end - 1) * s)) {
+      --end;
+    }
+    while (end < n && isValid(origin + end * s)) {
+      ++end;
+    }
+  }
+
+  // Branch free linear interpolation of a contiguous run of pixels so the
+  // compiler can vectorize it. The clamp only guards against float rounding
+  // at the ends of the range, which was computed in double precision.
+  void accumulateRow(float* row, const float* projection, float origin,
+                     float s, int begin, int end) const
+  {
+    const int maxIndex = m_numOfRays - 2;
+    for (int iz = begin; iz < end; ++iz) {
+      float u = origin + iz * s;
+      int index = std::min(std::max(static_cast<int>(u), 0), maxIndex);
+      float weight = u - index;
+      float q1 = projection[index];
+      float q2 = projection[index + 1];
+      row[iz] += q1 + weight * (q2 - q1);
+    }
+  }
+
+  int m_numOfTilts;
+  int m_numOfRays;
+  std::vector<double> m_cos;
+  std::vector<double> m_sin;
+};
+
+// Copy a 2D reconstruction (iy * yDim + iz) into the x-slice of the 3D one.
+void storeSlice(const float* slice, int s, int xDim, int yDim, float* recon)
+{
+  for (int iy = 0; iy < yDim; ++iy) {
+    for (int iz = 0; iz < yDim; ++iz) {
+      recon[(static_cast<size_t>(iz) * yDim + iy) * xDim + s] =
+        slice[static_cast<size_t>(iy) * yDim + iz];
+    }
+  }
+}
+
+// vtkSMPTools functor reconstructing a range of x-slices. The sinogram, filter
+// and 2D reconstruction buffers are allocated once per thread. The filter is
+// optional (nullptr for an unweighted back projection).
+template <typename T>
+class ReconstructSlices
+{
+public:
+  ReconstructSlices(const TiltSeriesView<T>& tiltSeries,
+                    const SinogramFilter* filter,
+                    const BackProjector& backProjector, float* recon,
+                    const tomviz::TomographyReconstruction::SliceCallback& cb)
+    : m_tiltSeries(tiltSeries), m_filter(filter),
+      m_backProjector(backProjector), m_recon(recon), m_callback(cb)
+  {
+  }
+
+  void Initialize()
+  {
+    const size_t numOfRays = m_tiltSeries.numberOfRays();
+    m_sinogram.Local().resize(numOfRays * m_tiltSeries.numberOfTilts());
+    m_slice.Local().resize(numOfRays * numOfRays);
+    if (m_filter) {
+      m_work.Local().resize(m_filter->workSize());
+    }
+  }
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    const int xDim = m_tiltSeries.numberOfSlices();
+    const int yDim = m_tiltSeries.numberOfRays();
+    std::vector<float>& sinogram = m_sinogram.Local();
+    std::vector<float>& slice = m_slice.Local();
+    for (vtkIdType s = begin; s < end && !m_canceled; ++s) {
+      m_tiltSeries.sinogram(static_cast<int>(s), sinogram.data());
+      if (m_filter) {
+        (*m_filter)(sinogram.data(), m_tiltSeries.numberOfTilts(),
+                    m_work.Local().data());
+      }
+      m_backProjector(sinogram.data(), slice.data());
+      storeSlice(slice.data(), static_cast<int>(s), xDim, yDim, m_recon);
+      if (m_callback && !m_callback(static_cast<int>(s), slice.data())) {
+        m_canceled = true;
+      }
+    }
+  }
+
+  void Reduce() {}
+
+  bool canceled() const { return m_canceled; }
+
+private:
+  TiltSeriesView<T> m_tiltSeries;
+  const SinogramFilter* m_filter;
+  const BackProjector& m_backProjector;
+  float* m_recon;
+  const tomviz::TomographyReconstruction::SliceCallback& m_callback;
+  std::atomic<bool> m_canceled{ false };
+  vtkSMPThreadLocal<std::vector<float>> m_sinogram;
+  vtkSMPThreadLocal<std::vector<float>> m_slice;
+  vtkSMPThreadLocal<std::vector<Complex>> m_work;
+};
+
+template <typename T>
+bool reconstructSlices(const T* data, const int* dims,
+                       const double* tiltAngles, float* recon, Filter filter,
+                       const tomviz::TomographyReconstruction::SliceCallback& cb)
+{
+  std::unique_ptr<SinogramFilter> sinogramFilter;
+  if (filter != Filter::None) {
+    sinogramFilter.reset(new SinogramFilter(filter, dims[1]));
+  }
+  BackProjector backProjector(tiltAngles, dims[2], dims[1]);
+  ReconstructSlices<T> functor(TiltSeriesView<T>(data, dims),
+                               sinogramFilter.get(), backProjector, recon, cb);
+  // One slice per task, so idle threads can steal the remaining slices.
+  vtkSMPTools::For(0, dims[0], 1, functor);
+  return !functor.canceled();
+}
+
+using tomviz::TomographyReconstruction::Interpolation;
+
+// Half width, in grid pixels, and grid oversampling of the Kaiser-Bessel
+// interpolation.
+const int KaiserBesselRadius = 2;
+const int KaiserBesselOversampling = 2;
+// Samples of the kernel per grid pixel in its lookup table.
+const int KaiserBesselTableDensity = 1024;
+
+// Modified Bessel function of the first kind of order 0, from its series.
+double besselI0(double x)
+{
+  double sum = 1;
+  double term = 1;
+  for (int k = 1; k < 100 && term > 1e-12 * sum; ++k) {
+    term *= (x / (2 * k)) * (x / (2 * k));
+    sum += term;
+  }
+  return sum;
+}
+
+// In place transpose of a square matrix, by blocks to stay in cache.
+void transposeSquare(Complex* data, int m)
+{
+  const int block = 16;
+  for (int i0 = 0; i0 < m; i0 += block) {
+    for (int j0 = i0; j0 < m; j0 += block) {
+      for (int i = i0; i < std::min(i0 + block, m); ++i) {
+        for (int j = std::max(j0, i + 1); j < std::min(j0 + block, m); ++j) {
+          std::swap(data[static_cast<size_t>(i) * m + j],
+                    data[static_cast<size_t>(j) * m + i]);
+        }
+      }
+    }
+  }
+}
+
+// Direct Fourier reconstruction of slices of a fixed geometry. The tables and
+// the gridding weights are computed once on construction, the object is then
+// used read-only and can be shared by several threads.
+//
+// The projections are zero padded to twice the size of the (square, power of
+// two) grid, so the samples of their transforms are half a grid pixel apart
+// along each radial line. Each grid pixel is the weighted average of the
+// samples around it, the sums of the weights only depend on the angles.
+class FourierGridder
+{
+public:
+  FourierGridder(const double* tiltAngles, int numOfTilts, int numOfRays,
+                 Interpolation interpolation)
+    : m_numOfTilts(numOfTilts), m_numOfRays(numOfRays),
+      m_interpolation(interpolation),
+      m_grid(Fft::sizeFor(numOfRays) *
+             (interpolation == Interpolation::KaiserBessel
+                ? KaiserBesselOversampling
+                : 1)),
+      m_projection(2 * m_grid.size()), m_cos(numOfTilts), m_sin(numOfTilts)
+  {
+    for (int tt = 0; tt < numOfTilts; ++tt) {
+      double angle = tiltAngles[tt] * PI / 180;
+      m_cos[tt] = cos(angle);
+      m_sin[tt] = sin(angle);
+    }
+
+    if (interpolation == Interpolation::KaiserBessel) {
+      // Shape parameter from Beatty et al., IEEE TMI 24(6), 2005.
+      const double width = 2 * KaiserBesselRadius;
+      const double sigma = KaiserBesselOversampling;
+      const double beta =
+        PI * sqrt(width * width / (sigma * sigma) * (sigma - 0.5) *
+                    (sigma - 0.5) -
+                  0.8);
+      const int size = KaiserBesselRadius * KaiserBesselTableDensity + 1;
+      m_kernel.resize(size);
+      for (int i = 0; i < size; ++i) {
+        double d = static_cast<double>(i) / (size - 1);
+        m_kernel[i] =
+          static_cast<float>(besselI0(beta * sqrt(1 - d * d)) / besselI0(beta));
+      }
+    }
+
+    // The inverse transform scaling is folded into the weights.
+    const int m = m_grid.size();
+    std::vector<double> weights(static_cast<size_t>(m) * m, 0.0);
+    for (int tt = 0; tt < numOfTilts; ++tt) {
+      for (int j = 0; j < m_projection.size(); ++j) {
+        spread(tt, j, [&weights](size_t index, float weight) {
+          weights[index] += weight;
+        });
+      }
+    }
+    m_inverseWeights.resize(weights.size());
+    for (size_t i = 0; i < weights.size(); ++i) {
+      m_inverseWeights[i] =
+        weights[i] > 0 ? static_cast<float>(1 / (weights[i] * m * m)) : 0.0f;
+    }
+  }
+
+  // Number of complex values needed as work space by operator().
+  size_t workSize() const
+  {
+    const size_t m = m_grid.size();
+    return m_projection.size() + m * m;
+  }
+
+  // Reconstruct the slices of one or two sinograms, second and secondImage
+  // are nullptr for one.
+  void operator()(const float* first, const float* second, float* firstImage,
+                  float* secondImage, Complex* work) const
+  {
+    const int n = m_numOfRays;
+    const int m = m_grid.size();
+    const int padded = m_projection.size();
+    Complex* projection = work;
+    Complex* grid = work + padded;
+    std::fill(grid, grid + static_cast<size_t>(m) * m, Complex(0.0f, 0.0f));
+
+    for (int tt = 0; tt < m_numOfTilts; ++tt) {
+      // Ray numOfRays / 2 is on the tilt axis and goes first, as with
+      // numpy.fft.ifftshift.
+      std::fill(projection, projection + padded, Complex(0.0f, 0.0f));
+      const size_t offset = static_cast<size_t>(tt) * n;
+      for (int r = 0; r < n; ++r) {
+        projection[(r - n / 2) & (padded - 1)] =
+          Complex(first[offset + r], second ? second[offset + r] : 0.0f);
+      }
+      m_projection(projection, false);
+      for (int j = 0; j < padded; ++j) {
+        const Complex value = projection[j];
+        spread(tt, j, [grid, &value](size_t index, float weight) {
+          grid[index] += weight * value;
+        });
+      }
+    }
+
+    const size_t gridSize = static_cast<size_t>(m) * m;
+    for (size_t i = 0; i < gridSize; ++i) {
+      grid[i] *= m_inverseWeights[i];
+    }
+    // 2D inverse transform, by rows then by columns. The result is left
+    // transposed, indexed by iz * m + iy.
+    for (int row = 0; row < m; ++row) {
+      m_grid(grid + static_cast<size_t>(row) * m, true);
+    }
+    transposeSquare(grid, m);
+    for (int row = 0; row < m; ++row) {
+      m_grid(grid + static_cast<size_t>(row) * m, true);
+    }
+
+    // Pixel numOfRays / 2 is the origin, as with numpy.fft.fftshift.
+    const int mask = m - 1;
+    for (int iy = 0; iy < n; ++iy) {
+      for (int iz = 0; iz < n; ++iz) {
+        const Complex& value =
+          grid[static_cast<size_t>((iz - n / 2) & mask) * m +
+               ((iy - n / 2) & mask)];
+        firstImage[static_cast<size_t>(iy) * n + iz] = value.real();
+        if (secondImage) {
+          secondImage[static_cast<size_t>(iy) * n + iz] = value.imag();
+        }
+      }
+    }
+  }
+
+private:
+  // Call f(index, weight) for the grid pixels sample j of the transform of a
+  // projection contributes to. The grid is periodic, negative frequencies
+  // wrap around as in the output of the FFT.
+  template <typename F>
+  void spread(int tilt, int j, F&& f) const
+  {
+    const int m = m_grid.size();
+    const int padded = m_projection.size();
+    if (j == padded / 2) {
+      // The Nyquist sample is both the highest positive and negative
+      // frequency, it is split between them so that the grid stays Hermitian.
+      // Otherwise the two slices reconstructed in the real and imaginary
+      // parts leak into each other.
+      auto half = [&f](size_t index, float weight) { f(index, 0.5f * weight); };
+      spreadAt(tilt, -m / 2.0, half);
+      spreadAt(tilt, m / 2.0, half);
+      return;
+    }
+    const int frequency = j < padded / 2 ? j : j - padded;
+    spreadAt(tilt, frequency * static_cast<double>(m) / padded, f);
+  }
+
+  // Call f(index, weight) for the grid pixels a sample at radius along the
+  // direction of the tilt contributes to.
+  template <typename F>
+  void spreadAt(int tilt, double radius, F&& f) const
+  {
+    const double ky = radius * m_cos[tilt];
+    const double kz = radius * m_sin[tilt];
+
+    if (m_interpolation == Interpolation::Bilinear) {
+      const int iy = static_cast<int>(floor(ky));
+      const int iz = static_cast<int>(floor(kz));
+      const float fy = static_cast<float>(ky - iy);
+      const float fz = static_cast<float>(kz - iz);
+      f(index(iy, iz), (1 - fy) * (1 - fz));
+      f(index(iy + 1, iz), fy * (1 - fz));
+      f(index(iy, iz + 1), (1 - fy) * fz);
+      f(index(iy + 1, iz + 1), fy * fz);
+      return;
+    }
+
+    const int taps = 2 * KaiserBesselRadius + 1;
+    const int y0 = static_cast<int>(ceil(ky - KaiserBesselRadius));
+    const int z0 = static_cast<int>(ceil(kz - KaiserBesselRadius));
+    float wy[taps];
+    float wz[taps];
+    for (int t = 0; t < taps; ++t) {
+      wy[t] = kernel(fabs(y0 + t - ky));
+      wz[t] = kernel(fabs(z0 + t - kz));
+    }
+    for (int a = 0; a < taps; ++a) {
+      for (int b = 0; b < taps; ++b) {
+        float weight = wy[a] * wz[b];
+        if (weight > 0) {
+          f(index(y0 + a, z0 + b), weight);
+        }
+      }
+    }
+  }
+
+  float kernel(double distance) const
+  {
+    int i = static_cast<int>(distance * KaiserBesselTableDensity + 0.5);
+    return i < static_cast<int>(m_kernel.size()) ? m_kernel[i] : 0.0f;
+  }
+
+  size_t index(int iy, int iz) const
+  {
+    const int mask = m_grid.size() - 1;
+    return static_cast<size_t>(iy & mask) * m_grid.size() + (iz & mask);
+  }
+
+  int m_numOfTilts;
+  int m_numOfRays;
+  Interpolation m_interpolation;
+  Fft m_grid;
+  Fft m_projection;
+  std::vector<double> m_cos;
+  std::vector<double> m_sin;
+  std::vector<float> m_kernel;
+  std::vector<float> m_inverseWeights;
+};
+
+// vtkSMPTools functor reconstructing a range of pairs of x-slices with the
+// direct Fourier method. The buffers are allocated once per thread.
 template <typename T>
-vtkSmartPointer<vtkFloatArray> convertToFloatT(T* data, int len)
+class DirectFourierSlices
+{
+public:
+  DirectFourierSlices(const TiltSeriesView<T>& tiltSeries,
+                      const FourierGridder& gridder, float* recon,
+                      const tomviz::TomographyReconstruction::SliceCallback& cb)
+    : m_tiltSeries(tiltSeries), m_gridder(gridder), m_recon(recon),
+      m_callback(cb)
+  {
+  }
+
+  void Initialize()
+  {
+    const size_t numOfRays = m_tiltSeries.numberOfRays();
+    m_sinograms.Local().resize(2 * numOfRays * m_tiltSeries.numberOfTilts());
+    m_slices.Local().resize(2 * numOfRays * numOfRays);
+    m_work.Local().resize(m_gridder.workSize());
+  }
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    const int xDim = m_tiltSeries.numberOfSlices();
+    const int yDim = m_tiltSeries.numberOfRays();
+    const size_t sinogramSize =
+      static_cast<size_t>(yDim) * m_tiltSeries.numberOfTilts();
+    const size_t sliceSize = static_cast<size_t>(yDim) * yDim;
+    float* sinograms = m_sinograms.Local().data();
+    float* slices = m_slices.Local().data();
+    for (vtkIdType pair = begin; pair < end && !m_canceled; ++pair) {
+      const int first = static_cast<int>(2 * pair);
+      const bool paired = first + 1 < xDim;
+      m_tiltSeries.sinogram(first, sinograms);
+      if (paired) {
+        m_tiltSeries.sinogram(first + 1, sinograms + sinogramSize);
+      }
+      m_gridder(sinograms, paired ? sinograms + sinogramSize : nullptr, slices,
+                paired ? slices + sliceSize : nullptr,
+                m_work.Local().data());
+      for (int s = first; s < (paired ? first + 2 : first + 1); ++s) {
+        const float* slice = slices + (s - first) * sliceSize;
+        storeSlice(slice, s, xDim, yDim, m_recon);
+        if (m_callback && !m_callback(s, slice)) {
+          m_canceled = true;
+        }
+      }
+    }
+  }
+
+  void Reduce() {}
+
+  bool canceled() const { return m_canceled; }
+
+private:
+  TiltSeriesView<T> m_tiltSeries;
+  const FourierGridder& m_gridder;
+  float* m_recon;
+  const tomviz::TomographyReconstruction::SliceCallback& m_callback;
+  std::atomic<bool> m_canceled{ false };
+  vtkSMPThreadLocal<std::vector<float>> m_sinograms;
+  vtkSMPThreadLocal<std::vector<float>> m_slices;
+  vtkSMPThreadLocal<std::vector<Complex>> m_work;
+};
+
+template <typename T>
+bool reconstructDirectFourier(
+  const T* data, const int* dims, const double* tiltAngles, float* recon,
+  Interpolation interpolation,
+  const tomviz::TomographyReconstruction::SliceCallback& cb)
+{
+  FourierGridder gridder(tiltAngles, dims[2], dims[1], interpolation);
+  DirectFourierSlices<T> functor(TiltSeriesView<T>(data, dims), gridder,
+                                 recon, cb);
+  // One pair of slices per task, so idle threads can steal the others.
+  vtkSMPTools::For(0, (dims[0] + 1) / 2, 1, functor);
+  return !functor.canceled();
+}
+
+using tomviz::TomographyReconstruction::IterationCallback;
+using tomviz::TomographyReconstruction::JosephProjector;
+using tomviz::TomographyReconstruction::Projection;
+using tomviz::TomographyReconstruction::SirtMethod;
+using tomviz::TomographyReconstruction::SystemMatrix;
+
+// Lengths below this are considered to be zero when tracing rays.
+const double Epsilon = 1e-8;
+
+// Trace the ray of the given angle and offset from the rotation axis through
+// the numOfRays by numOfRays grid of unit pixels centred on the origin, and
+// append the pixels it crosses and the length of the ray in each of them.
+void traceRay(int numOfRays, double angle, double offset,
+              std::vector<int>& columns, std::vector<float>& values)
+{
+  const int n = numOfRays;
+  const double half = n / 2.0;
+  double c = cos(angle);
+  double s = sin(angle);
+  if (fabs(c) < 1e-10) {
+    c = 0;
+  }
+  if (fabs(s) < 1e-10) {
+    s = 0;
+  }
+  // The ray passes through (px, py) with the direction (dx, dy).
+  const double px = c * offset;
+  const double py = s * offset;
+  const double dx = -s;
+  const double dy = c;
+
+  // Clip the ray to the grid, rays running along its right or top edge are
+  // outside of it.
+  double tMin = -std::numeric_limits<double>::infinity();
+  double tMax = std::numeric_limits<double>::infinity();
+  const double p[2] = { px, py };
+  const double d[2] = { dx, dy };
+  for (int i = 0; i < 2; ++i) {
+    if (d[i] == 0) {
+      if (p[i] < -half || p[i] >= half) {
+        return;
+      }
+    } else {
+      double t1 = (-half - p[i]) / d[i];
+      double t2 = (half - p[i]) / d[i];
+      tMin = std::max(tMin, std::min(t1, t2));
+      tMax = std::min(tMax, std::max(t1, t2));
+    }
+  }
+  if (tMax - tMin <= Epsilon) {
+    return;
+  }
+
+  // Where the ray crosses the grid lines, each segment in between lies in a
+  // single pixel.
+  std::vector<double> crossings;
+  crossings.reserve(2 * n + 4);
+  crossings.push_back(tMin);
+  crossings.push_back(tMax);
+  for (int i = 0; i < 2; ++i) {
+    if (d[i] == 0) {
+      continue;
+    }
+    for (int k = 0; k <= n; ++k) {
+      double t = (-half + k - p[i]) / d[i];
+      if (t > tMin && t < tMax) {
+        crossings.push_back(t);
+      }
+    }
+  }
+  std::sort(crossings.begin(), crossings.end());
+
+  for (size_t i = 1; i < crossings.size(); ++i) {
+    double length = crossings[i] - crossings[i - 1];
+    if (length <= Epsilon) {
+      continue;
+    }
+    double t = (crossings[i] + crossings[i - 1]) / 2;
+    int iy = static_cast<int>(floor(half - (py + t * dy)));
+    int iz = static_cast<int>(floor(px + t * dx + half));
+    if (iy >= 0 && iy < n && iz >= 0 && iz < n) {
+      columns.push_back(iy * n + iz);
+      values.push_back(static_cast<float>(length));
+    }
+  }
+}
+
+// vtkSMPTools functor tracing the rays of a range of tilts, each tilt is
+// kept apart so the rows can be assembled in order afterwards.
+class TraceTilts
+{
+public:
+  TraceTilts(const double* tiltAngles, int numOfRays,
+             std::vector<std::vector<size_t>>& rowLengths,
+             std::vector<std::vector<int>>& columns,
+             std::vector<std::vector<float>>& values)
+    : m_tiltAngles(tiltAngles), m_numOfRays(numOfRays),
+      m_rowLengths(rowLengths), m_columns(columns), m_values(values)
+  {
+  }
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    for (vtkIdType tt = begin; tt < end; ++tt) {
+      double angle = m_tiltAngles[tt] * PI / 180;
+      auto& columns = m_columns[tt];
+      auto& values = m_values[tt];
+      auto& rowLengths = m_rowLengths[tt];
+      rowLengths.resize(m_numOfRays);
+      columns.reserve(static_cast<size_t>(2) * m_numOfRays * m_numOfRays);
+      values.reserve(columns.capacity());
+      for (int r = 0; r < m_numOfRays; ++r) {
+        size_t before = columns.size();
+        traceRay(m_numOfRays, angle, r - (m_numOfRays - 1) / 2.0, columns,
+                 values);
+        rowLengths[r] = columns.size() - before;
+      }
+    }
+  }
+
+private:
+  const double* m_tiltAngles;
+  int m_numOfRays;
+  std::vector<std::vector<size_t>>& m_rowLengths;
+  std::vector<std::vector<int>>& m_columns;
+  std::vector<std::vector<float>>& m_values;
+};
+
+// Kaczmarz sweep through the rows of the system matrix, each row in turn
+// projects the image onto the hyperplane of its measurement. The matrix is a
+// SystemMatrix or a JosephProjector.
+template <typename Matrix>
+class ArtSolver
+{
+public:
+  ArtSolver(const Matrix& matrix)
+    : m_matrix(matrix), m_inverseNorms(matrix.numberOfRows(), 0.0f)
+  {
+    for (int row = 0; row < matrix.numberOfRows(); ++row) {
+      double norm = 0;
+      matrix.forEachInRow(row,
+                          [&norm](int, float value) { norm += value * value; });
+      // Rays missing the grid carry no information.
+      if (norm > 0) {
+        m_inverseNorms[row] = static_cast<float>(1 / norm);
+      }
+    }
+  }
+
+  // The relaxation is only changed between iterations, the solver is shared
+  // read-only by the threads while they run.
+  void setRelaxation(float relaxation) { m_relaxation = relaxation; }
+
+  size_t workSize() const { return 0; }
+
+  void operator()(const float* sinogram, float* image, float*) const
+  {
+    for (int row = 0; row < m_matrix.numberOfRows(); ++row) {
+      if (m_inverseNorms[row] == 0) {
+        continue;
+      }
+      double projection = 0;
+      m_matrix.forEachInRow(row, [&](int column, float value) {
+        projection += value * image[column];
+      });
+      const float a = static_cast<float>(
+        m_relaxation * (sinogram[row] - projection) * m_inverseNorms[row]);
+      m_matrix.forEachInRow(
+        row, [&](int column, float value) { image[column] += a * value; });
+    }
+  }
+
+private:
+  const Matrix& m_matrix;
+  std::vector<float> m_inverseNorms;
+  float m_relaxation = 1.0f;
+};
+
+// Simultaneous update from all the rows, f += scale * A^T (W (b - A f)), the
+// diagonal weights W and the scale depend on the method.
+template <typename Matrix>
+class SirtSolver
+{
+public:
+  SirtSolver(const Matrix& matrix, SirtMethod method, double stepSize)
+    : m_matrix(matrix), m_weights(matrix.numberOfRows(), 0.0f),
+      m_scale(static_cast<float>(stepSize))
+  {
+    // Component averaging weights each pixel by the number of rays crossing
+    // it.
+    std::vector<int> columnCounts;
+    if (method == SirtMethod::ComponentAveraging) {
+      columnCounts.resize(matrix.numberOfColumns(), 0);
+      for (int row = 0; row < matrix.numberOfRows(); ++row) {
+        matrix.forEachInRow(
+          row, [&columnCounts](int column, float) { ++columnCounts[column]; });
+      }
+    }
+
+    for (int row = 0; row < matrix.numberOfRows(); ++row) {
+      double norm = 0;
+      matrix.forEachInRow(row, [&](int column, float value) {
+        double weight = method == SirtMethod::ComponentAveraging
+                          ? columnCounts[column]
+                          : 1;
+        norm += value * value * weight;
+      });
+      if (method == SirtMethod::Landweber) {
+        m_weights[row] = 1.0f;
+      } else if (norm > 0) {
+        m_weights[row] = static_cast<float>(1 / norm);
+      }
+    }
+    if (method == SirtMethod::Cimmino) {
+      m_scale /= matrix.numberOfRows();
+    }
+  }
+
+  size_t workSize() const
+  {
+    return m_matrix.numberOfRows() + m_matrix.workSize();
+  }
+
+  void operator()(const float* sinogram, float* image, float* work) const
+  {
+    float* residual = work;
+    float* projectionWork = work + m_matrix.numberOfRows();
+    m_matrix.forward(image, residual, projectionWork);
+    for (int row = 0; row < m_matrix.numberOfRows(); ++row) {
+      residual[row] =
+        m_scale * m_weights[row] * (sinogram[row] - residual[row]);
+    }
+    m_matrix.backward(residual, image, projectionWork);
+  }
+
+private:
+  const Matrix& m_matrix;
+  std::vector<float> m_weights;
+  float m_scale;
+};
+
+// vtkSMPTools functor running iterations of a solver on a range of x-slices.
+// The current estimate is read from recon and the result written back to it,
+// along with the squared change it made. The solver and the system matrix are
+// shared, the sinogram, slice and work buffers are allocated once per thread.
+template <typename T, typename Solver>
+class IterateSlices
+{
+public:
+  IterateSlices(const TiltSeriesView<T>& tiltSeries, const Solver& solver,
+                int iterations, bool positivity, float* recon,
+                const IterationCallback& cb)
+    : m_tiltSeries(tiltSeries), m_solver(solver), m_iterations(iterations),
+      m_positivity(positivity), m_recon(recon), m_callback(cb)
+  {
+  }
+
+  void Initialize()
+  {
+    const size_t numOfRays = m_tiltSeries.numberOfRays();
+    m_sinogram.Local().resize(numOfRays * m_tiltSeries.numberOfTilts());
+    m_slice.Local().resize(numOfRays * numOfRays);
+    m_work.Local().resize(m_solver.workSize());
+    m_change.Local() = 0;
+  }
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    const int xDim = m_tiltSeries.numberOfSlices();
+    const int yDim = m_tiltSeries.numberOfRays();
+    std::vector<float>& sinogram = m_sinogram.Local();
+    std::vector<float>& slice = m_slice.Local();
+    std::vector<float>& work = m_work.Local();
+    double& change = m_change.Local();
+    for (vtkIdType s = begin; s < end && !m_canceled; ++s) {
+      m_tiltSeries.sinogram(static_cast<int>(s), sinogram.data());
+      for (int iy = 0; iy < yDim; ++iy) {
+        for (int iz = 0; iz < yDim; ++iz) {
+          slice[static_cast<size_t>(iy) * yDim + iz] =
+            m_recon[(static_cast<size_t>(iz) * yDim + iy) * xDim + s];
+        }
+      }
+      for (int i = 0; i < m_iterations && !m_canceled; ++i) {
+        m_solver(sinogram.data(), slice.data(), work.data());
+        if (m_callback && !m_callback()) {
+          m_canceled = true;
+        }
+      }
+      for (int iy = 0; iy < yDim; ++iy) {
+        for (int iz = 0; iz < yDim; ++iz) {
+          float value = slice[static_cast<size_t>(iy) * yDim + iz];
+          if (m_positivity && value < 0) {
+            value = 0;
+          }
+          float& voxel =
+            m_recon[(static_cast<size_t>(iz) * yDim + iy) * xDim + s];
+          change += (value - voxel) * (value - voxel);
+          voxel = value;
+        }
+      }
+    }
+  }
+
+  void Reduce()
+  {
+    m_totalChange = 0;
+    for (auto it = m_change.begin(); it != m_change.end(); ++it) {
+      m_totalChange += *it;
+    }
+  }
+
+  bool canceled() const { return m_canceled; }
+
+  // The sum of the squared changes made to the voxels.
+  double change() const { return m_totalChange; }
+
+private:
+  TiltSeriesView<T> m_tiltSeries;
+  const Solver& m_solver;
+  int m_iterations;
+  bool m_positivity;
+  float* m_recon;
+  const IterationCallback& m_callback;
+  std::atomic<bool> m_canceled{ false };
+  double m_totalChange = 0;
+  vtkSMPThreadLocal<std::vector<float>> m_sinogram;
+  vtkSMPThreadLocal<std::vector<float>> m_slice;
+  vtkSMPThreadLocal<std::vector<float>> m_work;
+  vtkSMPThreadLocal<double> m_change;
+};
+
+// Run the iterations of a solver on every x-slice, returns false if they were
+// canceled.
+template <typename T, typename Solver>
+bool iterateSlices(const T* data, const int* dims, const Solver& solver,
+                   int iterations, bool positivity, float* recon,
+                   const IterationCallback& cb, double* change = nullptr)
+{
+  IterateSlices<T, Solver> functor(TiltSeriesView<T>(data, dims), solver,
+                                   iterations, positivity, recon, cb);
+  vtkSMPTools::For(0, dims[0], 1, functor);
+  if (change) {
+    *change = functor.change();
+  }
+  return !functor.canceled();
+}
+
+// Index strides of the axes of a [x, y, z] volume stored x fastest.
+struct Strides
+{
+  Strides(const int* dims)
+    : dims{ dims[0], dims[1], dims[2] },
+      step{ 1, static_cast<size_t>(dims[0]),
+            static_cast<size_t>(dims[0]) * dims[1] }
+  {
+  }
+
+  // The neighbour of the voxel before or after it along an axis, the faces of
+  // the volume are replicated.
+  size_t previous(size_t index, const int* ijk, int axis) const
+  {
+    return ijk[axis] > 0 ? index - step[axis] : index;
+  }
+  size_t next(size_t index, const int* ijk, int axis) const
+  {
+    return ijk[axis] < dims[axis] - 1 ? index + step[axis] : index;
+  }
+
+  int dims[3];
+  size_t step[3];
+};
+
+// vtkSMPTools functor computing the norm of the backward difference gradient
+// of a range of z-slices of the volume. The small constant keeps the norm away
+// from zero in flat regions.
+class GradientNorm
+{
+public:
+  GradientNorm(const float* volume, const Strides& strides, float* norm)
+    : m_volume(volume), m_strides(strides), m_norm(norm)
+  {
+  }
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    int ijk[3];
+    for (ijk[2] = static_cast<int>(begin); ijk[2] < end; ++ijk[2]) {
+      for (ijk[1] = 0; ijk[1] < m_strides.dims[1]; ++ijk[1]) {
+        size_t index = ijk[2] * m_strides.step[2] + ijk[1] * m_strides.step[1];
+        for (ijk[0] = 0; ijk[0] < m_strides.dims[0]; ++ijk[0], ++index) {
+          const float value = m_volume[index];
+          double sum = 1e-8;
+          for (int axis = 0; axis < 3; ++axis) {
+            float d = value - m_volume[m_strides.previous(index, ijk, axis)];
+            sum += d * d;
+          }
+          m_norm[index] = static_cast<float>(sqrt(sum));
+        }
+      }
+    }
+  }
+
+private:
+  const float* m_volume;
+  const Strides& m_strides;
+  float* m_norm;
+};
+
+// vtkSMPTools functor computing the gradient of the total variation of the
+// volume (the sum of the norms computed by GradientNorm) with respect to each
+// voxel of a range of z-slices, and the sum of its squares.
+class TotalVariationGradient
+{
+public:
+  TotalVariationGradient(const float* volume, const float* norm,
+                         const Strides& strides, float* gradient)
+    : m_volume(volume), m_norm(norm), m_strides(strides), m_gradient(gradient)
+  {
+  }
+
+  void Initialize() { m_sum.Local() = 0; }
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    double& sum = m_sum.Local();
+    int ijk[3];
+    for (ijk[2] = static_cast<int>(begin); ijk[2] < end; ++ijk[2]) {
+      for (ijk[1] = 0; ijk[1] < m_strides.dims[1]; ++ijk[1]) {
+        size_t index = ijk[2] * m_strides.step[2] + ijk[1] * m_strides.step[1];
+        for (ijk[0] = 0; ijk[0] < m_strides.dims[0]; ++ijk[0], ++index) {
+          const float value = m_volume[index];
+          // The voxel appears in its own term and in the terms of the voxels
+          // after it along each axis.
+          float own = 0;
+          float others = 0;
+          for (int axis = 0; axis < 3; ++axis) {
+            own += value - m_volume[m_strides.previous(index, ijk, axis)];
+            size_t next = m_strides.next(index, ijk, axis);
+            others += (value - m_volume[next]) / m_norm[next];
+          }
+          const float gradient = own / m_norm[index] + others;
+          m_gradient[index] = gradient;
+          sum += gradient * gradient;
+        }
+      }
+    }
+  }
+
+  void Reduce()
+  {
+    m_total = 0;
+    for (auto it = m_sum.begin(); it != m_sum.end(); ++it) {
+      m_total += *it;
+    }
+  }
+
+  double sumOfSquares() const { return m_total; }
+
+private:
+  const float* m_volume;
+  const float* m_norm;
+  const Strides& m_strides;
+  float* m_gradient;
+  vtkSMPThreadLocal<double> m_sum;
+  double m_total = 0;
+};
+
+// vtkSMPTools functor adding a scaled gradient to the volume.
+class Descend
+{
+public:
+  Descend(float* volume, const float* gradient, float step)
+    : m_volume(volume), m_gradient(gradient), m_step(step)
+  {
+  }
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    for (vtkIdType i = begin; i < end; ++i) {
+      m_volume[i] -= m_step * m_gradient[i];
+    }
+  }
+
+private:
+  float* m_volume;
+  const float* m_gradient;
+  float m_step;
+};
+
+// Take steps along the normalized total variation gradient of the volume,
+// each of the given length.
+void minimizeTotalVariation(float* volume, const int* dims, int steps,
+                            double length)
+{
+  const size_t size = static_cast<size_t>(dims[0]) * dims[1] * dims[2];
+  std::vector<float> norm(size);
+  std::vector<float> gradient(size);
+  Strides strides(dims);
+  for (int i = 0; i < steps; ++i) {
+    GradientNorm gradientNorm(volume, strides, norm.data());
+    vtkSMPTools::For(0, dims[2], 1, gradientNorm);
+    TotalVariationGradient tvGradient(volume, norm.data(), strides,
+                                      gradient.data());
+    vtkSMPTools::For(0, dims[2], 1, tvGradient);
+    double magnitude = sqrt(tvGradient.sumOfSquares());
+    if (magnitude == 0) {
+      return;
+    }
+    Descend descend(volume, gradient.data(),
+                    static_cast<float>(length / magnitude));
+    vtkSMPTools::For(0, static_cast<vtkIdType>(size), descend);
+  }
+}
+
+// The dimensions of the tilt series, and its scalars as a typed pointer.
+struct TiltSeriesData
 {
-  vtkSmartPointer<vtkFloatArray> array = vtkSmartPointer<vtkFloatArray>::New();
-  array->SetNumberOfTuples(len);
-  float* f = static_cast<float*>(array->GetVoidPointer(0));
-  for (int i = 0; i < len; ++i) {
-    f[i] = (float)data[i];
+  TiltSeriesData(vtkImageData* tiltSeries)
+  {
+    int extents[6];
+    tiltSeries->GetExtent(extents);
+    for (int i = 0; i < 3; ++i) {
+      dims[i] = extents[2 * i + 1] - extents[2 * i] + 1;
+    }
+    scalars = tiltSeries->GetPointData()->GetScalars();
+    data = scalars ? scalars->GetVoidPointer(0) : nullptr;
   }
-  return array;
+
+  size_t reconSize() const
+  {
+    return static_cast<size_t>(dims[0]) * dims[1] * dims[1];
+  }
+
+  int dims[3];
+  vtkDataArray* scalars;
+  const void* data;
+};
+
+// Above this size the iterative reconstructions project the slices without a
+// system matrix, see Projection::Automatic.
+const double SystemMatrixBudget = 1024.0 * 1024 * 1024;
+
+// Call reconstruct(matrix) with the system matrix or the projector the
+// reconstruction of the tilt series is to use.
+template <typename Reconstruct>
+bool withProjection(const int* dims, const double* tiltAngles,
+                    Projection projection, const Reconstruct& reconstruct)
+{
+  if (projection == Projection::Automatic) {
+    // The rays cross about 1.3 pixels per row of pixels on average over the
+    // angles, each one taking a column index and a value.
+    double size = 1.3 * dims[1] * static_cast<double>(dims[1]) * dims[2] *
+                  (sizeof(int) + sizeof(float));
+    projection = size > SystemMatrixBudget ? Projection::MatrixFree
+                                           : Projection::SystemMatrix;
+  }
+  if (projection == Projection::SystemMatrix) {
+    SystemMatrix matrix = tomviz::TomographyReconstruction::parallelRay(
+      dims[1], tiltAngles, dims[2]);
+    return reconstruct(matrix);
+  }
+  JosephProjector projector(dims[1], tiltAngles, dims[2]);
+  return reconstruct(projector);
 }
+
+template <typename T>
+struct Art
+{
+  const T* data;
+  const int* dims;
+  float* recon;
+  int iterations;
+  const IterationCallback& callback;
+
+  template <typename Matrix>
+  bool operator()(const Matrix& matrix) const
+  {
+    ArtSolver<Matrix> solver(matrix);
+    return iterateSlices(data, dims, solver, iterations, false, recon,
+                         callback);
+  }
+};
+
+template <typename T>
+struct Sirt
+{
+  const T* data;
+  const int* dims;
+  float* recon;
+  int iterations;
+  double stepSize;
+  SirtMethod method;
+  const IterationCallback& callback;
+
+  template <typename Matrix>
+  bool operator()(const Matrix& matrix) const
+  {
+    SirtSolver<Matrix> solver(matrix, method, stepSize);
+    return iterateSlices(data, dims, solver, iterations, false, recon,
+                         callback);
+  }
+};
+
+// Parameters of the TV minimization, as in the original Python operator.
+const double TvStepRatio = 0.2;
+const int TvSteps = 30;
+const float RelaxationReduction = 0.995f;
+
+// Alternates an ART sweep with positivity (the projections onto the convex
+// sets) and steepest descent of the total variation, whose steps are scaled
+// by the change the projections made.
+template <typename T>
+struct TvMinimization
+{
+  const T* data;
+  const int* dims;
+  float* recon;
+  int iterations;
+  const IterationCallback& callback;
+
+  template <typename Matrix>
+  bool operator()(const Matrix& matrix) const
+  {
+    ArtSolver<Matrix> solver(matrix);
+    const int reconDims[3] = { dims[0], dims[1], dims[1] };
+    float relaxation = 1.0f;
+    for (int i = 0; i < iterations; ++i) {
+      solver.setRelaxation(relaxation);
+      double change = 0;
+      if (!iterateSlices(data, dims, solver, 1, true, recon, callback,
+                         &change)) {
+        return false;
+      }
+      minimizeTotalVariation(recon, reconDims, TvSteps,
+                             TvStepRatio * sqrt(change));
+      relaxation *= RelaxationReduction;
+    }
+    return true;
+  }
+};
 } // namespace
 
 namespace tomviz {
@@ -54,12 +1386,14 @@ void weightedBackProjection3(vtkImageData* tiltSeries, vtkImageData* recon)
   tiltSeries->GetExtent(extents);
   int xDim = extents[1] - extents[0] + 1; // number of slices
   int yDim = extents[3] - extents[2] + 1; // number of rays
-  int zDim = extents[5] - extents[4] + 1; // number of tilts
 
   // Get tilt angles
   vtkDataArray* tiltAnglesArray =
     tiltSeries->GetFieldData()->GetArray("tilt_angles");
-  double* tiltAngles = static_cast<double*>(tiltAnglesArray->GetVoidPointer(0));
+  std::vector<double> tiltAngles(tiltAnglesArray->GetNumberOfTuples());
+  for (size_t i = 0; i < tiltAngles.size(); ++i) {
+    tiltAngles[i] = tiltAnglesArray->GetTuple1(i);
+  }
 
   // Creating the output volume and getting a pointer to it
   int outputSize[3] = { xDim, yDim, yDim };
@@ -70,70 +1404,377 @@ void weightedBackProjection3(vtkImageData* tiltSeries, vtkImageData* recon)
   float* reconPtr = static_cast<float*>(recon->GetScalarPointer());
 
   // Reconstruction
-  float* sinogram = new float[yDim * zDim]; // Placeholder for 2D sinogram
-  float* recon2d =
-    new float[yDim * yDim]; // Placeholder for 2D reconstruction (y-z plane)
-  for (int s = 0; s < xDim; ++s) // Loop through slices (x-direction)
-  {
-    // Get sinogram
-    TomographyTiltSeries::getSinogram(tiltSeries, s, sinogram);
-    // 2D back projection
-    TomographyReconstruction::unweightedBackProjection2(sinogram, tiltAngles,
-                                                        recon2d, zDim, yDim);
-    // Put recon into
-    for (int iy = 0; iy < outputSize[1];
-         ++iy) // Loop through all pixels in reconstructed image (y-z plane)
-      for (int iz = 0; iz < outputSize[2]; ++iz) {
-        reconPtr[iz * outputSize[0] * outputSize[1] + iy * outputSize[0] + s] =
-          recon2d[iy * outputSize[1] + iz];
-      }
+  backProjection3(tiltSeries, tiltAngles.data(), reconPtr, Filter::Ramp);
+}
+
+bool backProjection3(vtkImageData* tiltSeries, const double* tiltAngles,
+                     float* recon, Filter filter, const SliceCallback& callback)
+{
+  int extents[6];
+  tiltSeries->GetExtent(extents);
+  int dims[3] = { extents[1] - extents[0] + 1,   // number of slices
+                  extents[3] - extents[2] + 1,   // number of rays
+                  extents[5] - extents[4] + 1 }; // number of tilts
+
+  vtkDataArray* scalars = tiltSeries->GetPointData()->GetScalars();
+  if (!scalars) {
+    return false;
+  }
+
+  bool completed = false;
+  switch (scalars->GetDataType()) {
+    vtkTemplateMacro(completed = reconstructSlices(
+                       static_cast<const VTK_TT*>(scalars->GetVoidPointer(0)),
+                       dims, tiltAngles, recon, filter, callback));
+    default:
+      qDebug() << "Unsupported tilt series data type";
+  }
+  return completed;
+}
+
+bool directFourier3(vtkImageData* tiltSeries, const double* tiltAngles,
+                    float* recon, Interpolation interpolation,
+                    const SliceCallback& callback)
+{
+  int extents[6];
+  tiltSeries->GetExtent(extents);
+  int dims[3] = { extents[1] - extents[0] + 1,   // number of slices
+                  extents[3] - extents[2] + 1,   // number of rays
+                  extents[5] - extents[4] + 1 }; // number of tilts
+
+  vtkDataArray* scalars = tiltSeries->GetPointData()->GetScalars();
+  if (!scalars) {
+    return false;
   }
-  delete[] recon2d;
-  delete[] sinogram;
+
+  bool completed = false;
+  switch (scalars->GetDataType()) {
+    vtkTemplateMacro(completed = reconstructDirectFourier(
+                       static_cast<const VTK_TT*>(scalars->GetVoidPointer(0)),
+                       dims, tiltAngles, recon, interpolation, callback));
+    default:
+      qDebug() << "Unsupported tilt series data type";
+  }
+  return completed;
+}
+
+void filterSinogram(float* sinogram, int numOfTilts, int numOfRays,
+                    Filter filter)
+{
+  if (filter == Filter::None) {
+    return;
+  }
+  SinogramFilter sinogramFilter(filter, numOfRays);
+  std::vector<Complex> work(sinogramFilter.workSize());
+  sinogramFilter(sinogram, numOfTilts, work.data());
 }
 
 // 2D WBP recon
-void unweightedBackProjection2(float* sinogram, double* tiltAngles,
+void unweightedBackProjection2(const float* sinogram, const double* tiltAngles,
                                float* image, int numOfTilts, int numOfRays)
 {
-  for (int i = 0; i < numOfRays * numOfRays; ++i) {
-    image[i] = 0; // Set all pixels to zero
+  BackProjector backProjector(tiltAngles, numOfTilts, numOfRays);
+  backProjector(sinogram, image);
+}
+
+SystemMatrix parallelRay(int numOfRays, const double* tiltAngles,
+                         int numOfTilts)
+{
+  std::vector<std::vector<size_t>> rowLengths(numOfTilts);
+  std::vector<std::vector<int>> columns(numOfTilts);
+  std::vector<std::vector<float>> values(numOfTilts);
+  TraceTilts traceTilts(tiltAngles, numOfRays, rowLengths, columns, values);
+  vtkSMPTools::For(0, numOfTilts, 1, traceTilts);
+
+  SystemMatrix matrix;
+  matrix.numOfRows = numOfTilts * numOfRays;
+  matrix.numOfColumns = numOfRays * numOfRays;
+  matrix.rowOffsets.reserve(matrix.numOfRows + 1);
+  matrix.rowOffsets.push_back(0);
+  size_t nonZeros = 0;
+  for (int tt = 0; tt < numOfTilts; ++tt) {
+    for (size_t length : rowLengths[tt]) {
+      nonZeros += length;
+      matrix.rowOffsets.push_back(nonZeros);
+    }
   }
+  matrix.columns.reserve(nonZeros);
+  matrix.values.reserve(nonZeros);
+  for (int tt = 0; tt < numOfTilts; ++tt) {
+    matrix.columns.insert(matrix.columns.end(), columns[tt].begin(),
+                          columns[tt].end());
+    matrix.values.insert(matrix.values.end(), values[tt].begin(),
+                         values[tt].end());
+    // Release each tilt once copied, the matrix can be large.
+    std::vector<int>().swap(columns[tt]);
+    std::vector<float>().swap(values[tt]);
+  }
+  return matrix;
+}
 
-  // 2D unweighted Back Projection
-  for (int tt = 0; tt < numOfTilts; ++tt) // Loop through tilts
-  {
+void SystemMatrix::forward(const float* image, float* projections,
+                           float*) const
+{
+  for (int row = 0; row < numOfRows; ++row) {
+    double projection = 0;
+    for (size_t i = rowOffsets[row]; i < rowOffsets[row + 1]; ++i) {
+      projection += values[i] * image[columns[i]];
+    }
+    projections[row] = static_cast<float>(projection);
+  }
+}
+
+void SystemMatrix::backward(const float* projections, float* image,
+                            float*) const
+{
+  for (int row = 0; row < numOfRows; ++row) {
+    const float projection = projections[row];
+    for (size_t i = rowOffsets[row]; i < rowOffsets[row + 1]; ++i) {
+      image[columns[i]] += projection * values[i];
+    }
+  }
+}
+
+JosephProjector::JosephProjector(int numOfRays, const double* tiltAngles,
+                                 int numOfTilts, double axisPosition)
+  : m_numOfRays(numOfRays), m_numOfTilts(numOfTilts), m_tilts(numOfTilts)
+{
+  // Positions are in pixels, pixel i is centered on i. With the slice centred
+  // on the origin, y pointing up and z right, ray r of a tilt at angle a
+  // passes through offset * (cos(a), sin(a)) along (-sin(a), cos(a)).
+  const double center = (numOfRays - 1) / 2.0;
+  const double firstOffset = axisPosition - center;
+  for (int tt = 0; tt < numOfTilts; ++tt) {
     double angle = tiltAngles[tt] * PI / 180;
-    for (int iy = 0; iy < numOfRays; ++iy) // Loop through all pixels in
-                                           // reconstructed image (y-z plane for
-                                           // a tilt series)
-      for (int iz = 0; iz < numOfRays; ++iz) {
-        // Calcualte y,z coord.
-        double y = iy + 0.5 - ((double)numOfRays) / 2.0;
-        double z = iz + 0.5 - ((double)numOfRays) / 2.0;
-        // Calculate ray coord.
-        double t = y * cos(angle) + z * sin(angle);
-
-        if (t >= -numOfRays / 2 &&
-            t <= numOfRays / 2) // check if ray is inside projection
-        {
-          int rayIndex = floor((t + numOfRays / 2));
-          if (rayIndex >= 0 && rayIndex <= numOfRays - 2) {
-            // Linear interpolation
-            double Q1 = sinogram[tt * numOfRays + rayIndex];
-            double Q2 = sinogram[tt * numOfRays + rayIndex + 1];
-            double QDash =
-              Q1 + (t - double(rayIndex - numOfRays / 2)) * (Q2 - Q1);
-            image[iy * numOfRays + iz] += QDash;
-          }
+    double c = cos(angle);
+    double s = sin(angle);
+    Tilt& tilt = m_tilts[tt];
+    tilt.byRows = fabs(c) >= fabs(s);
+    if (tilt.byRows) {
+      // Row k is at y = center - k, where the ray is at
+      // z = (offset - y * sin(a)) / cos(a).
+      tilt.first = (firstOffset - center * s) / c + center;
+      tilt.step = s / c;
+      tilt.slope = 1 / c;
+      tilt.weight = static_cast<float>(1 / fabs(c));
+    } else {
+      // Column k is at z = k - center, where the ray is at
+      // y = (offset - z * cos(a)) / sin(a).
+      tilt.first = center - (firstOffset + center * c) / s;
+      tilt.step = c / s;
+      tilt.slope = -1 / s;
+      tilt.weight = static_cast<float>(1 / fabs(s));
+    }
+  }
+}
+
+void JosephProjector::crossingRays(const Tilt& tilt, int k, int& begin,
+                                   int& end) const
+{
+  const int n = m_numOfRays;
+  const float origin = tilt.origin(k);
+  const float slope = static_cast<float>(tilt.slope);
+  auto crosses = [=](int ray) {
+    float u = origin + ray * slope;
+    return u > -1 && u < n;
+  };
+  double lower = (-1 - origin) / slope;
+  double upper = (n - origin) / slope;
+  if (slope < 0) {
+    std::swap(lower, upper);
+  }
+  begin = static_cast<int>(std::max(0.0, std::min<double>(n, ceil(lower))));
+  end = static_cast<int>(std::max(0.0, std::min<double>(n, ceil(upper))));
+  // Correct for rounding at the ends so the range matches a per ray test.
+  while (begin < end && !crosses(begin)) {
+    ++begin;
+  }
+  while (begin > 0 && crosses(begin - 1)) {
+    --begin;
+  }
+  while (end > begin && !crosses(end - 1)) {
+    --end;
+  }
+  while (end < n && crosses(end)) {
+    ++end;
+  }
+}
+
+namespace {
+
+// Number of pixels of the square blocks the images are transposed by.
+const int TransposeBlock = 32;
+
+// transposed = image^T, or transposed^T is added to image.
+void transpose(const float* image, float* transposed, int n)
+{
+  for (int i0 = 0; i0 < n; i0 += TransposeBlock) {
+    for (int j0 = 0; j0 < n; j0 += TransposeBlock) {
+      for (int i = i0; i < std::min(i0 + TransposeBlock, n); ++i) {
+        for (int j = j0; j < std::min(j0 + TransposeBlock, n); ++j) {
+          transposed[static_cast<size_t>(j) * n + i] =
+            image[static_cast<size_t>(i) * n + j];
+        }
+      }
+    }
+  }
+}
+
+void addTransposed(const float* transposed, float* image, int n)
+{
+  for (int i0 = 0; i0 < n; i0 += TransposeBlock) {
+    for (int j0 = 0; j0 < n; j0 += TransposeBlock) {
+      for (int i = i0; i < std::min(i0 + TransposeBlock, n); ++i) {
+        for (int j = j0; j < std::min(j0 + TransposeBlock, n); ++j) {
+          image[static_cast<size_t>(i) * n + j] +=
+            transposed[static_cast<size_t>(j) * n + i];
+        }
+      }
+    }
+  }
+}
+} // namespace
+
+void JosephProjector::forward(const float* image, float* projections,
+                              float* work) const
+{
+  const int n = m_numOfRays;
+  // The tilts sampling the image by columns read it transposed, so that
+  // they read contiguous pixels too.
+  float* transposed = work;
+  transpose(image, transposed, n);
+
+  std::fill(projections, projections + numberOfRows(), 0.0f);
+  for (int tt = 0; tt < m_numOfTilts; ++tt) {
+    const Tilt& tilt = m_tilts[tt];
+    const float* pixels = tilt.byRows ? image : transposed;
+    const float slope = static_cast<float>(tilt.slope);
+    float* projection = projections + static_cast<size_t>(tt) * n;
+    for (int k = 0; k < n; ++k) {
+      int begin, end;
+      crossingRays(tilt, k, begin, end);
+      const float* line = pixels + static_cast<size_t>(k) * n;
+      const float origin = tilt.origin(k);
+      // Branch free so the compiler can vectorize it, the pixels beyond the
+      // edges of the slice have a zero weight.
+      for (int ray = begin; ray < end; ++ray) {
+        float u = origin + ray * slope;
+        int i = static_cast<int>(u + 1) - 1;
+        float fraction = u - i;
+        float w0 = i >= 0 && i < n ? 1 - fraction : 0.0f;
+        float w1 = i + 1 >= 0 && i + 1 < n ? fraction : 0.0f;
+        int i0 = std::min(std::max(i, 0), n - 1);
+        int i1 = std::min(std::max(i + 1, 0), n - 1);
+        projection[ray] += w0 * line[i0] + w1 * line[i1];
+      }
+    }
+    for (int ray = 0; ray < n; ++ray) {
+      projection[ray] *= tilt.weight;
+    }
+  }
+}
+
+void JosephProjector::backward(const float* projections, float* image,
+                               float* work) const
+{
+  const int n = m_numOfRays;
+  float* transposed = work;
+  std::fill(transposed, transposed + workSize(), 0.0f);
+
+  for (int tt = 0; tt < m_numOfTilts; ++tt) {
+    const Tilt& tilt = m_tilts[tt];
+    float* pixels = tilt.byRows ? image : transposed;
+    const float slope = static_cast<float>(tilt.slope);
+    const float* projection = projections + static_cast<size_t>(tt) * n;
+    for (int k = 0; k < n; ++k) {
+      int begin, end;
+      crossingRays(tilt, k, begin, end);
+      float* line = pixels + static_cast<size_t>(k) * n;
+      const float origin = tilt.origin(k);
+      for (int ray = begin; ray < end; ++ray) {
+        float u = origin + ray * slope;
+        int i = static_cast<int>(u + 1) - 1;
+        float fraction = u - i;
+        float value = projection[ray] * tilt.weight;
+        if (i >= 0 && i < n) {
+          line[i] += (1 - fraction) * value;
+        }
+        if (i + 1 >= 0 && i + 1 < n) {
+          line[i + 1] += fraction * value;
         }
       }
+    }
+  }
+  addTransposed(transposed, image, n);
+}
+
+bool art3(vtkImageData* tiltSeries, const double* tiltAngles, float* recon,
+          int iterations, const IterationCallback& callback,
+          Projection projection)
+{
+  TiltSeriesData input(tiltSeries);
+  if (!input.scalars) {
+    return false;
+  }
+  std::fill(recon, recon + input.reconSize(), 0.0f);
+
+  bool completed = false;
+  switch (input.scalars->GetDataType()) {
+    vtkTemplateMacro(completed = withProjection(
+                       input.dims, tiltAngles, projection,
+                       Art<VTK_TT>{ static_cast<const VTK_TT*>(input.data),
+                                    input.dims, recon, iterations,
+                                    callback }));
+    default:
+      qDebug() << "Unsupported tilt series data type";
+  }
+  return completed;
+}
+
+bool sirt3(vtkImageData* tiltSeries, const double* tiltAngles, float* recon,
+           int iterations, double stepSize, SirtMethod method,
+           const IterationCallback& callback, Projection projection)
+{
+  TiltSeriesData input(tiltSeries);
+  if (!input.scalars) {
+    return false;
+  }
+  std::fill(recon, recon + input.reconSize(), 0.0f);
+
+  bool completed = false;
+  switch (input.scalars->GetDataType()) {
+    vtkTemplateMacro(completed = withProjection(
+                       input.dims, tiltAngles, projection,
+                       Sirt<VTK_TT>{ static_cast<const VTK_TT*>(input.data),
+                                     input.dims, recon, iterations, stepSize,
+                                     method, callback }));
+    default:
+      qDebug() << "Unsupported tilt series data type";
+  }
+  return completed;
+}
+
+bool tvMinimization3(vtkImageData* tiltSeries, const double* tiltAngles,
+                     float* recon, int iterations,
+                     const IterationCallback& callback, Projection projection)
+{
+  TiltSeriesData input(tiltSeries);
+  if (!input.scalars) {
+    return false;
   }
+  std::fill(recon, recon + input.reconSize(), 0.0f);
 
-  double normalizationFactor = PI / double(2 * numOfTilts);
-  for (int i = 0; i < numOfRays * numOfRays; ++i) {
-    image[i] *= normalizationFactor;
+  bool completed = false;
+  switch (input.scalars->GetDataType()) {
+    vtkTemplateMacro(completed = withProjection(
+                       input.dims, tiltAngles, projection,
+                       TvMinimization<VTK_TT>{
+                         static_cast<const VTK_TT*>(input.data), input.dims,
+                         recon, iterations, callback }));
+    default:
+      qDebug() << "Unsupported tilt series data type";
   }
+  return completed;
 }
 } // namespace TomographyReconstruction
 } // namespace tomviz
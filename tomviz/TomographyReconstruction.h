@@ -20,16 +20,54 @@
 #include <pqReaction.h>
 #include <vtkImageData.h>
 
+#include <functional>
+#include <vector>
+
 namespace tomviz {
 class DataSource;
 
 namespace TomographyReconstruction {
 
+// Fourier weighting filters applied to the projections before they are back
+// projected. The definitions match the ones used by Recon_WBP.py.
+enum class Filter
+{
+  None,
+  Ramp,
+  SheppLogan,
+  Cosine,
+  Hamming,
+  Hann
+};
+
 // This takes an image tiltSeries and a vtkImageData in which to place the
 // output (recon)
 void weightedBackProjection3(vtkImageData* tiltSeries,
                              vtkImageData* recon); // 3D WBP recon
 
+// Called once a slice has been reconstructed with the slice index and the 2D
+// reconstruction (numOfRays by numOfRays). It is invoked from the worker
+// threads, so it must be thread safe. Returning false cancels the slices that
+// have not been started yet.
+using SliceCallback = std::function<bool(int slice, const float* recon2d)>;
+
+// Reconstruct every x-slice of the tilt series using back projection. Unless
+// filter is Filter::None each projection is first weighted in Fourier space.
+// The slices are distributed across threads using vtkSMPTools, the filter and
+// trigonometric tables are computed once and shared by all the slices.
+//
+// The output is written to recon, which must point to a float buffer of size
+// [x, y, y] (x varying fastest). Returns false if the callback canceled the
+// reconstruction.
+bool backProjection3(vtkImageData* tiltSeries, const double* tiltAngles,
+                     float* recon, Filter filter = Filter::None,
+                     const SliceCallback& callback = nullptr);
+
+// Apply the Fourier weighting filter to each projection (row of length
+// numOfRays) of the sinogram in place.
+void filterSinogram(float* sinogram, int numOfTilts, int numOfRays,
+                    Filter filter);
+
 // This function takes a y-z slice (sinogram) and the tilt angles as input and
 // creates a slice throught the reconstruction space.  The numOfTilts parameter
 // is the size of the z dimension.
@@ -39,9 +77,204 @@ void weightedBackProjection3(vtkImageData* tiltSeries,
 //
 // The output image will be stored in recon and will be square with size
 // numOfRays by numOfRays.
-void unweightedBackProjection2(float* sinogram, double* tiltAngles,
-                               float* recon, int numOfTilts,
-                               int numOfRays); // 2D WBP recon
+void unweightedBackProjection2(const float* sinogram,
+                               const double* tiltAngles, float* recon,
+                               int numOfTilts, int numOfRays); // 2D WBP recon
+
+// How the direct Fourier method resamples the Fourier transforms of the
+// projections from their polar grid onto the Cartesian grid of the slice.
+// Bilinear matches Recon_DFT.py. KaiserBessel interpolates with a Kaiser-Bessel
+// kernel 4 pixels wide on a grid oversampled twice, which reduces the aliasing
+// of the bilinear interpolation at the cost of a larger transform.
+enum class Interpolation
+{
+  Bilinear,
+  KaiserBessel
+};
+
+// Reconstruct every x-slice of the tilt series using the direct Fourier
+// method: the 1D transform of each projection is a radial line of the 2D
+// transform of the slice, which is inverted once they are all gridded. The
+// gridding weights only depend on the geometry and are shared by all the
+// slices, which are reconstructed two at a time per thread, one in the real
+// part and one in the imaginary part of the transforms.
+//
+// The output and the callback are as for backProjection3(). Returns false if
+// the callback canceled the reconstruction.
+bool directFourier3(vtkImageData* tiltSeries, const double* tiltAngles,
+                    float* recon,
+                    Interpolation interpolation = Interpolation::Bilinear,
+                    const SliceCallback& callback = nullptr);
+
+// Sparse system matrix of the parallel beam geometry, in compressed sparse row
+// format. Row tilt * numOfRays + ray holds the length of that ray through each
+// pixel iy * numOfRays + iz of a numOfRays by numOfRays slice, in the order of
+// the sinograms and of the 2D reconstructions above. It only depends on the
+// geometry, so it is computed once and shared read-only by all the slices.
+struct SystemMatrix
+{
+  int numOfRows = 0;
+  int numOfColumns = 0;
+  std::vector<size_t> rowOffsets; // numOfRows + 1 offsets in columns
+  std::vector<int> columns;
+  std::vector<float> values;
+
+  int numberOfRows() const { return numOfRows; }
+  int numberOfColumns() const { return numOfColumns; }
+
+  // Call f(column, value) for the non zero values of a row.
+  template <typename F>
+  void forEachInRow(int row, F&& f) const
+  {
+    for (size_t i = rowOffsets[row]; i < rowOffsets[row + 1]; ++i) {
+      f(columns[i], values[i]);
+    }
+  }
+
+  // projections = A * image
+  void forward(const float* image, float* projections, float* work) const;
+  // image += A^T * projections
+  void backward(const float* projections, float* image, float* work) const;
+  // Number of floats of work space needed by forward() and backward().
+  size_t workSize() const { return 0; }
+};
+
+// Trace the rays of every tilt through the pixels of a slice, exactly. The
+// pixels and the spacing of the rays are of unit size, and the rays are
+// centered on the tilt axis. The tilts are traced concurrently.
+SystemMatrix parallelRay(int numOfRays, const double* tiltAngles,
+                         int numOfTilts);
+
+// Matrix-free projector with the geometry and interface of the SystemMatrix,
+// for slices too large for it to fit in memory. It only stores a few numbers
+// per tilt. The projections are computed with Joseph's method: each ray is
+// sampled once per pixel row, or column if it is closer to horizontal,
+// interpolating linearly between the two nearest pixels and weighted by the
+// length of the ray across the row. backward() is its exact adjoint.
+//
+// Ray r is at r + axisPosition detector pixels from the first one, as in
+// TomographyTiltSeries::getSinogram() with numOfRays rays. The rays of a tilt
+// are parallel, so in forward() the samples of a pixel row are a linear
+// function of the ray, and the inner loop runs over rays.
+class JosephProjector
+{
+public:
+  JosephProjector(int numOfRays, const double* tiltAngles, int numOfTilts,
+                  double axisPosition = 0);
+
+  int numberOfRows() const { return m_numOfTilts * m_numOfRays; }
+  int numberOfColumns() const { return m_numOfRays * m_numOfRays; }
+
+  template <typename F>
+  void forEachInRow(int row, F&& f) const;
+
+  void forward(const float* image, float* projections, float* work) const;
+  void backward(const float* projections, float* image, float* work) const;
+  // The image, transposed for the tilts sampling it by columns.
+  size_t workSize() const
+  {
+    return static_cast<size_t>(m_numOfRays) * m_numOfRays;
+  }
+
+private:
+  // The rays of a tilt cross the k-th row (or column) of pixels at
+  // first + k * step + ray * slope pixels along it.
+  struct Tilt
+  {
+    bool byRows;
+    double first;
+    double step;
+    double slope;
+    float weight;
+
+    float origin(int k) const { return static_cast<float>(first + k * step); }
+  };
+
+  // The rays [begin, end) crossing the k-th row (or column) of pixels.
+  void crossingRays(const Tilt& tilt, int k, int& begin, int& end) const;
+
+  int m_numOfRays;
+  int m_numOfTilts;
+  std::vector<Tilt> m_tilts;
+};
+
+template <typename F>
+void JosephProjector::forEachInRow(int row, F&& f) const
+{
+  const int n = m_numOfRays;
+  const Tilt& tilt = m_tilts[row / n];
+  const int ray = row % n;
+  const float slope = static_cast<float>(tilt.slope);
+  for (int k = 0; k < n; ++k) {
+    // Computed as in forward() and backward().
+    float u = tilt.origin(k) + ray * slope;
+    if (u <= -1 || u >= n) {
+      continue;
+    }
+    int i = static_cast<int>(u + 1) - 1;
+    float fraction = u - i;
+    int pixels[2] = { i, i + 1 };
+    float weights[2] = { (1 - fraction) * tilt.weight,
+                         fraction * tilt.weight };
+    for (int j = 0; j < 2; ++j) {
+      if (pixels[j] >= 0 && pixels[j] < n && weights[j] > 0) {
+        f(tilt.byRows ? k * n + pixels[j] : pixels[j] * n + k, weights[j]);
+      }
+    }
+  }
+}
+
+// The update of the simultaneous iterative reconstruction, respectively
+// L. Landweber, Amer. J. Math., 73 (1951), pp. 615-624
+// G. Cimmino, La Ric. Sci., XVI, Ser. II, Anno IX, 1 (1938), pp. 326-333
+// Y. Censor et al, Parallel Comput., 27 (2001), pp. 777-808
+enum class SirtMethod
+{
+  Landweber,
+  Cimmino,
+  ComponentAveraging
+};
+
+// How the iterative reconstructions project the slices. The system matrix is
+// the faster of the two, but its size grows with numOfRays^2 * numOfTilts.
+// Automatic uses it unless it would take more than 1 GiB.
+enum class Projection
+{
+  Automatic,
+  SystemMatrix,
+  MatrixFree
+};
+
+// Called each time a slice has been through an iteration. It is invoked from
+// the worker threads, so it must be thread safe. Returning false cancels the
+// reconstruction.
+using IterationCallback = std::function<bool()>;
+
+// Iterative reconstructions of every x-slice of the tilt series, the slices
+// are distributed across threads using vtkSMPTools and all use the same
+// system matrix or projector. The output is written to recon, a float buffer
+// of size [x, y, y] as for backProjection3. They return false if the callback
+// canceled the reconstruction, after iterations * x calls to it otherwise.
+//
+// Algebraic reconstruction technique, each iteration is a sweep through the
+// rays of the slice.
+bool art3(vtkImageData* tiltSeries, const double* tiltAngles, float* recon,
+          int iterations, const IterationCallback& callback = nullptr,
+          Projection projection = Projection::Automatic);
+
+// Simultaneous iterative reconstruction technique.
+bool sirt3(vtkImageData* tiltSeries, const double* tiltAngles, float* recon,
+           int iterations, double stepSize,
+           SirtMethod method = SirtMethod::Landweber,
+           const IterationCallback& callback = nullptr,
+           Projection projection = Projection::Automatic);
+
+// ART with positivity, each iteration followed by steps minimizing the total
+// variation of the whole volume.
+bool tvMinimization3(vtkImageData* tiltSeries, const double* tiltAngles,
+                     float* recon, int iterations,
+                     const IterationCallback& callback = nullptr,
+                     Projection projection = Projection::Automatic);
 } // namespace TomographyReconstruction
 } // namespace tomviz
 
@@ -20,15 +20,108 @@
 #include "pqReaction.h"
 #include "vtkImageData.h"
 
+#include <cmath>
+#include <vector>
+
 namespace tomviz {
 
 class DataSource;
 
 namespace TomographyTiltSeries {
 
+/// Typed, strided view of a tilt series with dimensions [x, y, z] (slices,
+/// rays, tilts) stored x fastest, as in vtkImageData. Sinograms are read
+/// directly from the scalar buffer in its native type, so extracting one costs
+/// O(y * z) regardless of the number of slices. The view does not own the
+/// data and is safe to share between threads.
+template <typename T>
+class TiltSeriesView
+{
+public:
+  TiltSeriesView(const T* data, const int dims[3])
+    : m_data(data), m_dims{ dims[0], dims[1], dims[2] }
+  {
+  }
+
+  int numberOfSlices() const { return m_dims[0]; }
+  int numberOfRays() const { return m_dims[1]; }
+  int numberOfTilts() const { return m_dims[2]; }
+
+  /// The sample of the given slice, ray and tilt.
+  T operator()(int slice, int ray, int tilt) const
+  {
+    return m_data[(static_cast<size_t>(tilt) * m_dims[1] + ray) * m_dims[0] +
+                  slice];
+  }
+
+  /// Copy the y-z slice into sinogram, an array of size [y, z] (y fastest).
+  void sinogram(int slice, float* sinogram) const
+  {
+    for (int t = 0; t < m_dims[2]; ++t) {
+      for (int r = 0; r < m_dims[1]; ++r) {
+        sinogram[t * m_dims[1] + r] = static_cast<float>((*this)(slice, r, t));
+      }
+    }
+  }
+
+  /// Interpolate the y-z slice onto Nray rays centered on axisPosition, the
+  /// sinogram is an array of size [Nray, z] (Nray fastest).
+  void sinogram(int slice, float* sinogram, int Nray,
+                double axisPosition) const
+  {
+    const int yDim = m_dims[1];
+    const double rayWidth = static_cast<double>(yDim) / Nray;
+    std::vector<float> weight1(Nray); // Weights for linear interpolation
+    std::vector<float> weight2(Nray);
+    std::vector<int> index1(Nray); // Indices for linear interpolation
+    std::vector<int> index2(Nray);
+    for (int r = 0; r < Nray; ++r) {
+      double rayCoord = (r - Nray / 2) * rayWidth + axisPosition;
+      index1[r] = static_cast<int>(std::floor(rayCoord)) + yDim / 2;
+      index2[r] = index1[r] + 1;
+      weight1[r] =
+        static_cast<float>(std::fabs(rayCoord - std::floor(rayCoord)));
+      weight2[r] = 1 - weight1[r];
+    }
+
+    for (int t = 0; t < m_dims[2]; ++t) {
+      for (int r = 0; r < Nray; ++r) {
+        float value = 0;
+        if (index1[r] >= 0 && index1[r] < yDim) {
+          value += (*this)(slice, index1[r], t) * weight1[r];
+        }
+        if (index2[r] >= 0 && index2[r] < yDim) {
+          value += (*this)(slice, index2[r], t) * weight2[r];
+        }
+        sinogram[t * Nray + r] = value;
+      }
+    }
+  }
+
+  /// Average all the tilts, average is an array of size [x, y] (x fastest).
+  void average(float* average) const
+  {
+    const size_t imageSize = static_cast<size_t>(m_dims[0]) * m_dims[1];
+    std::vector<double> sum(imageSize, 0.0);
+    for (int t = 0; t < m_dims[2]; ++t) {
+      const T* image = m_data + t * imageSize;
+      for (size_t i = 0; i < imageSize; ++i) {
+        sum[i] += image[i];
+      }
+    }
+    for (size_t i = 0; i < imageSize; ++i) {
+      average[i] = static_cast<float>(sum[i] / m_dims[2]);
+    }
+  }
+
+private:
+  const T* m_data;
+  int m_dims[3];
+};
+
 /// Extract sinogram from tilt series. This takes as input an image and a slice
 /// number.  If the input image has dimensions [x, y, z] the slice number must
-/// be in the interval [0,y-1].  The output is stored in the sinogram pointer,
+/// be in the interval [0,x-1].  The output is stored in the sinogram pointer,
 /// which should be a pointer to an array with dimensions [y, z, 1].
 /// Simply takes a y-z slice of the input image. Useful for reconstruction
 void getSinogram(vtkImageData* tiltSeries, int, float* sinogram);
@@ -38,17 +38,25 @@
 
 #include <vtkBoundingBox.h>
 #include <vtkCamera.h>
+#include <vtkCellData.h>
 #include <vtkColorTransferFunction.h>
+#include <vtkDataArray.h>
+#include <vtkDataSet.h>
+#include <vtkDataSetAttributes.h>
+#include <vtkFieldData.h>
 #include <vtkImageData.h>
 #include <vtkImageSliceMapper.h>
 #include <vtkNew.h>
 #include <vtkPiecewiseFunction.h>
+#include <vtkPointData.h>
 #include <vtkPoints.h>
 #include <vtkRenderer.h>
 #include <vtkSmartPointer.h>
 #include <vtkStringList.h>
 #include <vtkTrivialProducer.h>
 
+#include <algorithm>
+#include <cstring>
 #include <sstream>
 #include <vector>
 
@@ -144,6 +152,48 @@ void createXmlProperty(pugi::xml_node& n, const char* name, int id,
     element.append_attribute("value").set_value(arr[i].toDouble(-1));
   }
 }
+
+vtkIdType detachSharedArrays(vtkFieldData* fields)
+{
+  if (!fields) {
+    return 0;
+  }
+  // Collect the shared arrays first, replacing them can reorder the arrays.
+  // The field data holds one reference, any other one is a share.
+  std::vector<vtkAbstractArray*> shared;
+  for (int i = 0; i < fields->GetNumberOfArrays(); ++i) {
+    vtkAbstractArray* array = fields->GetAbstractArray(i);
+    if (array && array->GetReferenceCount() > 1) {
+      shared.push_back(array);
+    }
+  }
+
+  auto attributes = vtkDataSetAttributes::SafeDownCast(fields);
+  vtkIdType copied = 0;
+  for (auto array : shared) {
+    vtkSmartPointer<vtkAbstractArray> copy;
+    copy.TakeReference(array->NewInstance());
+    copy->DeepCopy(array);
+    int attribute = -1;
+    for (int i = 0; attributes && i < vtkDataSetAttributes::NUM_ATTRIBUTES;
+         ++i) {
+      if (attributes->GetAbstractAttribute(i) == array) {
+        attribute = i;
+        break;
+      }
+    }
+    if (attribute >= 0) {
+      attributes->SetAttribute(copy, attribute);
+    } else if (array->GetName()) {
+      // Replaces the array with the same name, keeping its index.
+      fields->AddArray(copy);
+    } else {
+      continue;
+    }
+    copied += copy->GetActualMemorySize() * 1024;
+  }
+  return copied;
+}
 } // namespace
 
 QJsonObject serialize(vtkSMProxy* proxy)
@@ -762,6 +812,112 @@ QWidget* mainWidget()
   return pqCoreUtilities::mainWidget();
 }
 
+vtkIdType detachSharedArrays(vtkDataObject* data)
+{
+  vtkIdType copied = detachSharedArrays(data->GetFieldData());
+  if (auto dataSet = vtkDataSet::SafeDownCast(data)) {
+    copied += detachSharedArrays(dataSet->GetPointData());
+    copied += detachSharedArrays(dataSet->GetCellData());
+  }
+  return copied;
+}
+
+bool appendSlice(vtkImageData* image, vtkImageData* slice)
+{
+  auto scalars = image->GetPointData()->GetScalars();
+  auto sliceScalars = slice->GetPointData()->GetScalars();
+  if (!scalars || !sliceScalars ||
+      scalars->GetNumberOfComponents() !=
+        sliceScalars->GetNumberOfComponents()) {
+    return false;
+  }
+
+  int extent[6], sliceExtent[6];
+  image->GetExtent(extent);
+  slice->GetExtent(sliceExtent);
+  for (int i = 0; i < 4; ++i) {
+    if (extent[i] != sliceExtent[i]) {
+      return false;
+    }
+  }
+
+  int components = scalars->GetNumberOfComponents();
+  vtkIdType tuples = scalars->GetNumberOfTuples();
+  vtkIdType sliceTuples = static_cast<vtkIdType>(extent[1] - extent[0] + 1) *
+                          (extent[3] - extent[2] + 1);
+  if (sliceScalars->GetNumberOfTuples() < sliceTuples) {
+    return false;
+  }
+
+  if (scalars->GetReferenceCount() > 1) {
+    // Others may be reading the array, append to a copy with room to grow.
+    vtkSmartPointer<vtkDataArray> copy;
+    copy.TakeReference(scalars->NewInstance());
+    copy->SetName(scalars->GetName());
+    copy->SetNumberOfComponents(components);
+    copy->Allocate(std::max(2 * tuples, tuples + sliceTuples) * components);
+    std::memcpy(copy->WriteVoidPointer(0, tuples * components),
+                scalars->GetVoidPointer(0),
+                tuples * components * scalars->GetDataTypeSize());
+    image->GetPointData()->SetScalars(copy);
+    scalars = copy;
+  }
+
+  // WriteVoidPointer() at least doubles the size of the array when it is too
+  // small and never shrinks it, unlike SetNumberOfTuples(), so the copies are
+  // amortised.
+  void* end = scalars->WriteVoidPointer(tuples * components,
+                                        sliceTuples * components);
+  if (scalars->GetDataType() == sliceScalars->GetDataType()) {
+    std::memcpy(end, sliceScalars->GetVoidPointer(0),
+                sliceTuples * components * scalars->GetDataTypeSize());
+  } else {
+    scalars->InsertTuples(tuples, sliceTuples, 0, sliceScalars);
+  }
+  scalars->Modified();
+
+  ++extent[5];
+  image->SetExtent(extent);
+  image->Modified();
+  return true;
+}
+
+namespace {
+
+// The numpy names of the scalar types, the ones numpy and VTK have in common.
+const struct
+{
+  int vtkType;
+  const char* numpyType;
+} NUMPY_TYPES[] = {
+  { VTK_FLOAT, "float32" },   { VTK_DOUBLE, "float64" },
+  { VTK_SIGNED_CHAR, "int8" }, { VTK_UNSIGNED_CHAR, "uint8" },
+  { VTK_SHORT, "int16" },      { VTK_UNSIGNED_SHORT, "uint16" },
+  { VTK_INT, "int32" },        { VTK_UNSIGNED_INT, "uint32" },
+  { VTK_LONG_LONG, "int64" },  { VTK_UNSIGNED_LONG_LONG, "uint64" }
+};
+} // namespace
+
+QString numpyType(int vtkType)
+{
+  for (const auto& type : NUMPY_TYPES) {
+    if (type.vtkType == vtkType) {
+      return type.numpyType;
+    }
+  }
+  return QString();
+}
+
+int vtkType(const QString& numpyType)
+{
+  for (const auto& type : NUMPY_TYPES) {
+    if (numpyType == type.numpyType) {
+      return type.vtkType;
+    }
+  }
+  return -1;
+}
+
 QJsonValue toJson(vtkVariant variant)
 {
   auto type = variant.GetType();
@@ -34,7 +34,9 @@
 
 class pqAnimationScene;
 
+class vtkDataObject;
 class vtkDiscretizableColorTransferFunction;
+class vtkImageData;
 class vtkImageSliceMapper;
 class vtkRenderer;
 class vtkSMProxyLocator;
@@ -204,6 +206,28 @@ QString findPrefix(const QStringList& fileNames);
 /// Convenience function to get the main widget (useful for dialog parenting).
 QWidget* mainWidget();
 
+/// Copy on write support for data objects that share their arrays, e.g. after
+/// a ShallowCopy. Replaces the arrays of the data object that are referenced
+/// elsewhere with deep copies, so they can be modified in place without
+/// affecting the other data objects. Arrays only referenced by this data
+/// object are left alone. Returns the number of bytes copied.
+vtkIdType detachSharedArrays(vtkDataObject* data);
+
+/// Append a slice to the end of the z axis of an image, growing the capacity
+/// of its scalars geometrically so repeated appends are amortised constant
+/// time. The slice must have the same x and y extent and number of components
+/// as the image, its values are converted to the scalar type of the image.
+/// Scalars shared with other data objects are copied rather than grown in
+/// place. Returns false, leaving the image untouched, if the slice can't be
+/// appended.
+bool appendSlice(vtkImageData* image, vtkImageData* slice);
+
+/// The numpy name of a VTK scalar type, e.g. "uint16" for VTK_UNSIGNED_SHORT,
+/// or an empty string if numpy has no equivalent.
+QString numpyType(int vtkType);
+/// The VTK scalar type of a numpy dtype name, or -1 if there is none.
+int vtkType(const QString& numpyType);
+
 QJsonValue toJson(vtkVariant variant);
 QJsonValue toJson(vtkSMProperty* prop);
 bool setProperties(const QJsonObject& props, vtkSMProxy* proxy);
@@ -18,12 +18,15 @@
 
 #include "JsonRpcClient.h"
 
+#include <QJsonDocument>
 #include <QNetworkAccessManager>
+#include <QUrl>
 
 namespace tomviz {
 
 AcquisitionClient::AcquisitionClient(const QString& url, QObject* parent)
-  : QObject(parent), m_jsonRpcClient(new JsonRpcClient(url, this))
+  : QObject(parent), m_jsonRpcClient(new JsonRpcClient(url, this)),
+    m_networkAccessManager(new QNetworkAccessManager(this))
 {}
 
 AcquisitionClient::~AcquisitionClient() = default;
@@ -71,6 +74,49 @@ AcquisitionClientImageRequest* AcquisitionClient::stem_acquire()
   return makeImageRequest("stem_acquire");
 }
 
+AcquisitionClientFrameRequest* AcquisitionClient::next_frame(int timeout)
+{
+  // Frames are served by the same server as the JSON-RPC endpoint.
+  QUrl frameUrl(url());
+  frameUrl.setPath("/frames/next");
+  frameUrl.setQuery(QString("timeout=%1").arg(timeout));
+
+  auto networkReply = m_networkAccessManager->get(QNetworkRequest(frameUrl));
+  auto request = new AcquisitionClientFrameRequest(this);
+  QObject::connect(
+    networkReply, &QNetworkReply::finished, [request, networkReply]() {
+      networkReply->deleteLater();
+      request->deleteLater();
+      if (networkReply->error() != QNetworkReply::NoError) {
+        QJsonValue data(networkReply->error());
+        emit request->error(networkReply->errorString(), data);
+        return;
+      }
+
+      QByteArray pixels;
+      QString dtype;
+      QVector<int> shape;
+      QJsonObject meta;
+      auto status =
+        networkReply->attribute(QNetworkRequest::HttpStatusCodeAttribute);
+      // No content if the request timed out
+      if (status.toInt() != 204) {
+        dtype = networkReply->rawHeader("X-Tomviz-Dtype");
+        auto dims = networkReply->rawHeader("X-Tomviz-Shape").split(',');
+        foreach (auto dim, dims) {
+          shape.append(dim.toInt());
+        }
+        meta =
+          QJsonDocument::fromJson(networkReply->rawHeader("X-Tomviz-Meta"))
+            .object();
+        pixels = networkReply->readAll();
+      }
+      emit request->finished(pixels, dtype, shape, meta);
+    });
+
+  return request;
+}
+
 AcquisitionClientRequest* AcquisitionClient::describe(const QString& method)
 {
   QJsonObject params;
@@ -21,6 +21,9 @@
 
 #include <QJsonObject>
 #include <QJsonValue>
+#include <QVector>
+
+class QNetworkAccessManager;
 
 namespace tomviz {
 
@@ -66,6 +69,23 @@ signals:
                 const QJsonObject& meta);
 };
 
+class AcquisitionClientFrameRequest : public AcquisitionClientBaseRequest
+{
+  Q_OBJECT
+
+public:
+  explicit AcquisitionClientFrameRequest(QObject* parent = 0)
+    : AcquisitionClientBaseRequest(parent)
+  {}
+
+signals:
+  /// The raw, C ordered pixels of the frame with their numpy dtype name and
+  /// shape, rows first. The pixels are empty if no frame was acquired before
+  /// the request timed out.
+  void finished(const QByteArray& pixels, const QString& dtype,
+                const QVector<int>& shape, const QJsonObject& meta);
+};
+
 class AcquisitionClient : public QObject
 {
   Q_OBJECT
@@ -91,6 +111,9 @@ public slots:
 
   AcquisitionClientImageRequest* stem_acquire();
 
+  /// Wait up to timeout seconds for the source to acquire the next frame.
+  AcquisitionClientFrameRequest* next_frame(int timeout);
+
   AcquisitionClientRequest* describe(const QString& method);
 
   AcquisitionClientRequest* describe();
@@ -109,6 +132,7 @@ private slots:
 
 private:
   JsonRpcClient* m_jsonRpcClient;
+  QNetworkAccessManager* m_networkAccessManager;
 };
 } // namespace tomviz
 
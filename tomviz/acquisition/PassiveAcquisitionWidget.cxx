@@ -23,6 +23,7 @@
 #include "ConnectionDialog.h"
 #include "InterfaceBuilder.h"
 #include "StartServerDialog.h"
+#include "Utilities.h"
 
 #include "DataSource.h"
 #include "ModuleManager.h"
@@ -42,14 +43,13 @@
 #include <vtkRenderWindow.h>
 #include <vtkRenderer.h>
 #include <vtkScalarsToColors.h>
-#include <vtkTIFFReader.h>
+#include <vtkTIFFWriter.h>
 
 #include <QBuffer>
 #include <QCloseEvent>
 #include <QCoreApplication>
 #include <QDebug>
 #include <QDir>
-#include <QFile>
 #include <QJsonValueRef>
 #include <QMessageBox>
 #include <QNetworkReply>
@@ -61,16 +61,67 @@
 #include <QTabWidget>
 #include <QTimer>
 #include <QVBoxLayout>
+#include <QtConcurrent>
+
+#include <cstring>
 
 namespace tomviz {
 
 const char* PASSIVE_ADAPTER =
   "tomviz.acquisition.vendors.passive.PassiveWatchSource";
+// Seconds the server waits for a frame before answering a request for one.
+const int FRAME_TIMEOUT = 10;
+// Failed frame requests are retried this many times, the first after
+// FRAME_RETRY_DELAY milliseconds, then waiting twice as long each time.
+const int FRAME_RETRIES = 5;
+const int FRAME_RETRY_DELAY = 500;
+
+namespace {
+
+// Build an image from the raw, C ordered pixels of a frame. The first row is
+// the top of the frame, it ends up at the largest y as the TIFF reader would
+// put it.
+vtkSmartPointer<vtkImageData> frameToImage(const QByteArray& pixels,
+                                           const QString& dtype,
+                                           const QVector<int>& shape)
+{
+  int type = vtkType(dtype);
+  if (type < 0 || shape.size() < 2 || shape.size() > 3) {
+    return nullptr;
+  }
+  int height = shape[0];
+  int width = shape[1];
+  int components = shape.size() == 3 ? shape[2] : 1;
+
+  auto image = vtkSmartPointer<vtkImageData>::New();
+  image->SetDimensions(width, height, 1);
+  image->AllocateScalars(type, components);
+  size_t rowSize =
+    static_cast<size_t>(width) * components * image->GetScalarSize();
+  if (static_cast<size_t>(pixels.size()) != rowSize * height) {
+    return nullptr;
+  }
+  auto scalars = static_cast<char*>(image->GetScalarPointer());
+  for (int y = 0; y < height; ++y) {
+    std::memcpy(scalars + y * rowSize,
+                pixels.constData() + (height - 1 - y) * rowSize, rowSize);
+  }
+  return image;
+}
+
+void saveFrame(vtkSmartPointer<vtkImageData> frame, const QString& fileName)
+{
+  vtkNew<vtkTIFFWriter> writer;
+  writer->SetFileName(fileName.toLatin1());
+  writer->SetInputData(frame);
+  writer->Write();
+}
+} // namespace
 
 PassiveAcquisitionWidget::PassiveAcquisitionWidget(QWidget* parent)
   : QDialog(parent), m_ui(new Ui::PassiveAcquisitionWidget),
     m_client(new AcquisitionClient("http://localhost:8080/acquisition", this)),
-    m_connectParamsWidget(new QWidget), m_watchTimer(new QTimer)
+    m_connectParamsWidget(new QWidget)
 {
   m_ui->setupUi(this);
 
@@ -216,12 +267,14 @@ void PassiveAcquisitionWidget::connectToServer(bool startServer)
           });
 }
 
-void PassiveAcquisitionWidget::imageReady(QString mimeType, QByteArray result,
+void PassiveAcquisitionWidget::frameReady(const QByteArray& pixels,
+                                          const QString& dtype,
+                                          const QVector<int>& shape,
                                           float angle)
 {
-  if (mimeType != "image/tiff") {
-    qDebug() << "image/tiff is the only supported mime type right now.\n"
-             << mimeType << "\n";
+  auto image = frameToImage(pixels, dtype, shape);
+  if (!image) {
+    qWarning() << "Unsupported frame, dtype:" << dtype << "shape:" << shape;
     return;
   }
 
@@ -238,16 +291,24 @@ void PassiveAcquisitionWidget::imageReady(QString mimeType, QByteArray result,
   path.append(QString::number(angle, 'g', 2));
   path.append(".tiff");
 
-  QFile file(dir.path() + path);
-  file.open(QIODevice::WriteOnly);
-  file.write(result);
-  qDebug() << "Data file:" << file.fileName();
-  file.close();
+  // Keep a copy on disk without holding up the display of the frame, the
+  // shallow copy keeps the pixels from being modified while they are written.
+  auto frame = vtkSmartPointer<vtkImageData>::New();
+  frame->ShallowCopy(image);
+  auto fileName = dir.path() + path;
+  // Only hold on to the saves still running, those are waited for when the
+  // widget is destroyed.
+  auto saves = m_saving.futures();
+  m_saving.clearFutures();
+  for (auto& save : saves) {
+    if (!save.isFinished()) {
+      m_saving.addFuture(save);
+    }
+  }
+  m_saving.addFuture(QtConcurrent::run(saveFrame, frame, fileName));
+  qDebug() << "Data file:" << fileName;
 
-  vtkNew<vtkTIFFReader> reader;
-  reader->SetFileName(file.fileName().toLatin1());
-  reader->Update();
-  m_imageData = reader->GetOutput();
+  m_imageData = image;
   m_imageSlice->GetProperty()->SetInterpolationTypeToNearest();
   m_imageSliceMapper->SetInputData(m_imageData.Get());
   m_imageSliceMapper->Update();
@@ -298,25 +359,54 @@ void PassiveAcquisitionWidget::watchSource()
 {
   m_ui->watchButton->setEnabled(false);
   m_ui->stopWatchingButton->setEnabled(true);
-  connect(m_watchTimer, &QTimer::timeout, this,
-          [this]() {
-            auto request = m_client->stem_acquire();
-            connect(request, &AcquisitionClientImageRequest::finished,
-                    [this](const QString mimeType, const QByteArray& result,
-                           const QJsonObject& meta) {
-                      if (!result.isNull()) {
-                        float angle = 0;
-                        if (meta.contains("angle")) {
-                          angle = meta["angle"].toString().toFloat();
-                        }
-                        imageReady(mimeType, result, angle);
-                      }
-                    });
-            connect(request, &AcquisitionClientRequest::error, this,
-                    &PassiveAcquisitionWidget::onError);
-          },
-          Qt::UniqueConnection);
-  m_watchTimer->start(1000);
+  m_watching = true;
+  m_frameRetries = 0;
+  // The request from before watching was stopped may still be waiting.
+  if (!m_frameRequest) {
+    requestFrame();
+  }
+}
+
+void PassiveAcquisitionWidget::requestFrame()
+{
+  m_frameRequest = m_client->next_frame(FRAME_TIMEOUT);
+  connect(m_frameRequest, &AcquisitionClientFrameRequest::finished, this,
+          [this](const QByteArray& pixels, const QString& dtype,
+                 const QVector<int>& shape, const QJsonObject& meta) {
+            m_frameRequest = nullptr;
+            m_frameRetries = 0;
+            if (!pixels.isEmpty()) {
+              float angle = 0;
+              if (meta.contains("angle")) {
+                angle = meta["angle"].toString().toFloat();
+              }
+              frameReady(pixels, dtype, shape, angle);
+            }
+            // Wait for the next frame straight away, the server answers as
+            // soon as it arrives.
+            if (m_watching) {
+              requestFrame();
+            }
+          });
+  connect(m_frameRequest, &AcquisitionClientFrameRequest::error, this,
+          [this](const QString& errorMessage, const QJsonValue& errorData) {
+            m_frameRequest = nullptr;
+            if (!m_watching) {
+              return;
+            }
+            // Ride out transient errors, backing off, before giving up.
+            if (m_frameRetries < FRAME_RETRIES) {
+              int delay = FRAME_RETRY_DELAY << m_frameRetries++;
+              QTimer::singleShot(delay, this, [this]() {
+                if (m_watching && !m_frameRequest) {
+                  requestFrame();
+                }
+              });
+              return;
+            }
+            // Stops watching.
+            onError(errorMessage, errorData);
+          });
 }
 
 QJsonObject PassiveAcquisitionWidget::connectParams()
@@ -442,7 +532,7 @@ void PassiveAcquisitionWidget::checkEnableWatchButton()
 
 void PassiveAcquisitionWidget::stopWatching()
 {
-  m_watchTimer->stop();
+  m_watching = false;
   m_ui->stopWatchingButton->setEnabled(false);
   m_ui->watchButton->setEnabled(true);
 }
@@ -20,10 +20,12 @@
 
 #include "MatchInfo.h"
 
+#include <QFutureSynchronizer>
 #include <QLabel>
 #include <QPointer>
 #include <QScopedPointer>
 #include <QString>
+#include <QVector>
 
 #include <vtkNew.h>
 #include <vtkSmartPointer.h>
@@ -44,6 +46,7 @@ class PassiveAcquisitionWidget;
 namespace tomviz {
 
 class AcquisitionClient;
+class AcquisitionClientFrameRequest;
 class DataSource;
 
 class PassiveAcquisitionWidget : public QDialog
@@ -63,7 +66,8 @@ protected:
 private slots:
   void connectToServer(bool startServer = true);
 
-  void imageReady(QString mimeType, QByteArray result, float angle = 0);
+  void frameReady(const QByteArray& pixels, const QString& dtype,
+                  const QVector<int>& shape, float angle = 0);
 
   void onError(const QString& errorMessage, const QJsonValue& errorData);
   void watchSource();
@@ -96,7 +100,10 @@ private:
   double m_calX = 0.0;
   double m_calY = 0.0;
   QPointer<QWidget> m_connectParamsWidget;
-  QPointer<QTimer> m_watchTimer;
+  QPointer<AcquisitionClientFrameRequest> m_frameRequest;
+  bool m_watching = false;
+  int m_frameRetries = 0;
+  QFutureSynchronizer<void> m_saving;
   int m_retryCount = 5;
   QProcess* m_serverProcess = nullptr;
 
@@ -108,6 +115,7 @@ private:
   void startLocalServer();
   void displayError(const QString& errorMessage);
   void stopWatching();
+  void requestFrame();
   void validateTestFileName();
 
   void setupTestTable();
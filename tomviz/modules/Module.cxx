@@ -17,6 +17,7 @@
 
 #include "ActiveObjects.h"
 #include "DataSource.h"
+#include "ImagePyramid.h"
 #include "Utilities.h"
 
 #include <pqAnimationCue.h>
@@ -28,9 +29,12 @@
 #include <pqView.h>
 #include <vtkColorTransferFunction.h>
 #include <vtkCommand.h>
+#include <vtkEventQtSlotConnect.h>
 #include <vtkImageData.h>
 #include <vtkNew.h>
 #include <vtkPiecewiseFunction.h>
+#include <vtkRenderWindow.h>
+#include <vtkRenderWindowInteractor.h>
 #include <vtkSMProperty.h>
 #include <vtkSMPropertyHelper.h>
 #include <vtkSMRenderViewProxy.h>
@@ -40,6 +44,9 @@
 #include <vtkSMViewProxy.h>
 #include <vtkSmartPointer.h>
 
+#include <QCheckBox>
+#include <QTimer>
+
 namespace tomviz {
 
 class Module::MInternals
@@ -54,6 +61,9 @@ public:
 
   Module::TransferMode m_transferMode;
   vtkNew<vtkImageData> m_transfer2D;
+
+  vtkNew<vtkEventQtSlotConnect> m_interactionConnect;
+  QTimer m_wheelTimer;
   vtkSMProxy* detachedColorMap()
   {
     if (!m_detachedColorMap) {
@@ -104,6 +114,48 @@ bool Module::initialize(DataSource* data, vtkSMViewProxy* vtkView)
             SIGNAL(displayPositionChanged(double, double, double)),
             SLOT(dataSourceMoved(double, double, double)));
   }
+
+  if (m_view && m_activeDataSource && supportsLevelOfDetail()) {
+    // The module observes the interactor ahead of the interactor style, so the
+    // data is switched before the interaction renders.
+    auto rwi = vtkView->GetRenderWindow()
+                 ? vtkView->GetRenderWindow()->GetInteractor()
+                 : nullptr;
+    if (rwi) {
+      auto connector = d->m_interactionConnect.Get();
+      for (auto event : { vtkCommand::LeftButtonPressEvent,
+                          vtkCommand::MiddleButtonPressEvent,
+                          vtkCommand::RightButtonPressEvent }) {
+        connector->Connect(rwi, event, this, SLOT(startInteraction()),
+                           nullptr, 1.0);
+      }
+      for (auto event : { vtkCommand::LeftButtonReleaseEvent,
+                          vtkCommand::MiddleButtonReleaseEvent,
+                          vtkCommand::RightButtonReleaseEvent }) {
+        connector->Connect(rwi, event, this, SLOT(endInteraction()), nullptr,
+                           1.0);
+      }
+      for (auto event : { vtkCommand::MouseWheelForwardEvent,
+                          vtkCommand::MouseWheelBackwardEvent }) {
+        connector->Connect(rwi, event, this, SLOT(onMouseWheel()), nullptr,
+                           1.0);
+      }
+    }
+    d->m_wheelTimer.setSingleShot(true);
+    d->m_wheelTimer.setInterval(500);
+    connect(&d->m_wheelTimer, &QTimer::timeout, this,
+            &Module::endInteraction);
+
+    // Go back to the data when the levels are dropped, and have them built
+    // again for the new data.
+    auto pyramid = m_activeDataSource->pyramid();
+    connect(pyramid, &ImagePyramid::dropped, this, &Module::endInteraction);
+    connect(m_activeDataSource, &DataSource::dataChanged, this, [this]() {
+      if (m_useLevelOfDetail) {
+        dataSource()->pyramid()->build();
+      }
+    });
+  }
   return (m_view && m_activeDataSource);
 }
 
@@ -192,6 +244,9 @@ QJsonObject Module::serialize() const
   QJsonObject json;
   QJsonObject props;
   props["visibility"] = visibility();
+  if (supportsLevelOfDetail()) {
+    props["useLevelOfDetail"] = m_useLevelOfDetail;
+  }
   if (isColorMapNeeded()) {
     json["useDetachedColorMap"] = m_useDetachedColorMap;
     if (m_useDetachedColorMap) {
@@ -208,6 +263,9 @@ bool Module::deserialize(const QJsonObject& json)
   if (json["properties"].isObject()) {
     auto props = json["properties"].toObject();
     setVisibility(props["visibility"].toBool());
+    if (supportsLevelOfDetail() && props.contains("useLevelOfDetail")) {
+      setUseLevelOfDetail(props["useLevelOfDetail"].toBool());
+    }
   }
 
   if (isColorMapNeeded() && json.contains("useDetachedColorMap")) {
@@ -233,6 +291,66 @@ void Module::onColorMapChanged()
   emit colorMapChanged();
 }
 
+void Module::setUseLevelOfDetail(bool val)
+{
+  m_useLevelOfDetail = val;
+  if (!supportsLevelOfDetail() || !dataSource()) {
+    return;
+  }
+
+  if (m_useLevelOfDetail) {
+    dataSource()->pyramid()->build();
+  } else {
+    endInteraction();
+  }
+}
+
+QCheckBox* Module::createLevelOfDetailCheckBox()
+{
+  auto checkBox = new QCheckBox("Coarse Data While Interacting");
+  checkBox->setToolTip("Render a downsampled copy of the data while the view "
+                       "is rotated, panned or zoomed.");
+  checkBox->setChecked(m_useLevelOfDetail);
+  connect(checkBox, &QCheckBox::toggled, this, &Module::setUseLevelOfDetail);
+  return checkBox;
+}
+
+void Module::startInteraction()
+{
+  if (!m_useLevelOfDetail || m_interacting || !dataSource()) {
+    return;
+  }
+
+  // Nothing to switch to until the levels are built.
+  auto coarse = dataSource()->pyramid()->interactiveProxy();
+  if (!coarse) {
+    return;
+  }
+  m_interacting = true;
+  setInputProxy(coarse);
+}
+
+void Module::endInteraction()
+{
+  if (!m_interacting) {
+    return;
+  }
+  m_interacting = false;
+  d->m_wheelTimer.stop();
+  if (dataSource()) {
+    setInputProxy(dataSource()->proxy());
+  }
+  emit renderNeeded();
+}
+
+void Module::onMouseWheel()
+{
+  startInteraction();
+  if (m_interacting) {
+    d->m_wheelTimer.start();
+  }
+}
+
 void Module::setTransferMode(const TransferMode mode)
 {
   d->m_transferMode = static_cast<Module::TransferMode>(mode);
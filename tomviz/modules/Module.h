@@ -24,10 +24,12 @@
 #include <vtkSmartPointer.h>
 #include <vtkWeakPointer.h>
 
+class QCheckBox;
 class QWidget;
 class pqAnimationCue;
 class vtkImageData;
 class vtkSMProxy;
+class vtkSMSourceProxy;
 class vtkSMViewProxy;
 class vtkPiecewiseFunction;
 class vtkDataObject;
@@ -108,6 +110,17 @@ public:
 
   virtual bool supportsGradientOpacity() { return false; }
 
+  /// Modules that can render a coarser level of the data (see ImagePyramid)
+  /// while the view is interacted with should override this method to return
+  /// true, and setInputProxy() to switch between the levels.
+  virtual bool supportsLevelOfDetail() const { return false; }
+
+  /// Flag indicating whether the module renders a coarser level of the data
+  /// while the view is interacted with, and the full data once it stops. This
+  /// is only applicable when supportsLevelOfDetail() returns true.
+  void setUseLevelOfDetail(bool);
+  bool useLevelOfDetail() const { return m_useLevelOfDetail; }
+
   /// A description of the data type that will be exported.  For instance if
   /// exporting a mesh, this would return "Mesh".  Returning an empty string
   /// indicates that this module has nothing of interest to be exported.
@@ -151,6 +164,14 @@ protected:
   /// setUseDetachedColorMap is toggled.
   virtual void updateColorMap() {}
 
+  /// Modules that support level of detail should override this method to
+  /// render the given proxy, either the data source's proxy or the one
+  /// producing its coarser level.
+  virtual void setInputProxy(vtkSMSourceProxy*) {}
+
+  /// A check box toggling the use of level of detail, for the panel.
+  QCheckBox* createLevelOfDetailCheckBox();
+
   /// Returns a string for the save file indicating which proxy within the
   /// module is passed to it.  These should be unique within the module, but
   /// different modules can reuse common strings such as "representation".
@@ -181,11 +202,19 @@ signals:
 private slots:
   void onColorMapChanged();
 
+  /// Switch to the coarser level of the data and back, when the mouse is
+  /// pressed in the view and released. Scrolling switches until it pauses.
+  void startInteraction();
+  void endInteraction();
+  void onMouseWheel();
+
 private:
   Q_DISABLE_COPY(Module)
   QPointer<DataSource> m_activeDataSource;
   vtkWeakPointer<vtkSMViewProxy> m_view;
   bool m_useDetachedColorMap = false;
+  bool m_useLevelOfDetail = false;
+  bool m_interacting = false;
 
   class MInternals;
   const QScopedPointer<MInternals> d;
@@ -19,6 +19,7 @@
 #include "ActiveObjects.h"
 #include "DataSource.h"
 #include "DoubleSliderWidget.h"
+#include "OccupancyGrid.h"
 #include "Operator.h"
 #include "Utilities.h"
 
@@ -27,6 +28,8 @@
 #include "pqSignalAdaptors.h"
 #include "pqWidgetRangeDomain.h"
 
+#include "pvextensions/vtkImageBrickContour.h"
+
 #include "vtkAlgorithm.h"
 #include "vtkDataObject.h"
 #include "vtkNew.h"
@@ -95,7 +98,7 @@ bool ModuleContour::initialize(DataSource* data, vtkSMViewProxy* vtkView)
   vtkSMSessionProxyManager* pxm = producer->GetSessionProxyManager();
 
   vtkSmartPointer<vtkSMProxy> contourProxy;
-  contourProxy.TakeReference(pxm->NewProxy("filters", "FlyingEdges"));
+  contourProxy.TakeReference(pxm->NewProxy("filters", "ImageBrickContour"));
 
   m_contourFilter = vtkSMSourceProxy::SafeDownCast(contourProxy);
   Q_ASSERT(m_contourFilter);
@@ -117,6 +120,7 @@ bool ModuleContour::initialize(DataSource* data, vtkSMViewProxy* vtkView)
   }
 
   connect(data, SIGNAL(activeScalarsChanged()), SLOT(onScalarArrayChanged()));
+  connect(data, SIGNAL(dataChanged()), SLOT(updateBrickRanges()));
   onScalarArrayChanged();
 
   return true;
@@ -134,6 +138,13 @@ void ModuleContour::updateColorMap()
   m_activeRepresentation->UpdateVTKObjects();
 }
 
+void ModuleContour::setInputProxy(vtkSMSourceProxy* proxy)
+{
+  vtkSMPropertyHelper(m_contourFilter, "Input").Set(proxy);
+  m_contourFilter->UpdateVTKObjects();
+  updateBrickRanges();
+}
+
 bool ModuleContour::finalize()
 {
   vtkNew<vtkSMParaViewPipelineControllerWithRendering> controller;
@@ -182,6 +193,7 @@ void ModuleContour::addToPanel(QWidget* panel)
   // Create, update and connect
   m_controllers = new ModuleContourWidget;
   layout->addWidget(m_controllers);
+  layout->addWidget(createLevelOfDetailCheckBox());
 
   m_controllers->setUseSolidColor(d->UseSolidColor);
 
@@ -221,12 +233,29 @@ void ModuleContour::onScalarArrayChanged()
     .SetInputArrayToProcess(vtkDataObject::FIELD_ASSOCIATION_POINTS,
                             arrayName.toLatin1().data());
   m_contourFilter->UpdateVTKObjects();
+  updateBrickRanges();
 
   onPropertyChanged();
 
   emit renderNeeded();
 }
 
+void ModuleContour::updateBrickRanges()
+{
+  if (!m_contourFilter) {
+    return;
+  }
+
+  // The ranges are those of the data, not of its coarser level contoured
+  // while interacting.
+  auto filter =
+    vtkImageBrickContour::SafeDownCast(m_contourFilter->GetClientSideObject());
+  const bool isData = vtkSMPropertyHelper(m_contourFilter, "Input")
+                        .GetAsProxy() == dataSource()->proxy();
+  filter->SetBrickRanges(isData ? dataSource()->occupancyGrid()->ranges()
+                                : nullptr);
+}
+
 QJsonObject ModuleContour::serialize() const
 {
   auto json = Module::serialize();
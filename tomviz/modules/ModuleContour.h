@@ -54,12 +54,15 @@ public:
 
   bool isProxyPartOfModule(vtkSMProxy* proxy) override;
 
+  bool supportsLevelOfDetail() const override { return true; }
+
   QString exportDataTypeString() override { return "Mesh"; }
 
   vtkSmartPointer<vtkDataObject> getDataToExport() override;
 
 protected:
   void updateColorMap() override;
+  void setInputProxy(vtkSMSourceProxy* proxy) override;
   std::string getStringForProxy(vtkSMProxy* proxy) override;
   vtkSMProxy* getProxyForString(const std::string& str) override;
   QList<DataSource*> getChildDataSources();
@@ -81,6 +84,10 @@ private slots:
 
   void onScalarArrayChanged();
 
+  /// Give the filter the ranges of the bricks of the data, shared with the
+  /// other modules, rather than it computing its own.
+  void updateBrickRanges();
+
   void setUseSolidColor(const bool useSolidColor);
 
 private:
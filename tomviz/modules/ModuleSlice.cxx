@@ -113,6 +113,8 @@ bool ModuleSlice::initialize(DataSource* data, vtkSMViewProxy* vtkView)
     connect(data, SIGNAL(dataChanged()), this, SLOT(dataUpdated()));
   }
 
+  setUseLevelOfDetail(true);
+
   Q_ASSERT(m_widget);
   return widgetSetup;
 }
@@ -184,6 +186,13 @@ void ModuleSlice::updateColorMap()
   m_widget->SetLookupTable(stc);
 }
 
+void ModuleSlice::setInputProxy(vtkSMSourceProxy* proxy)
+{
+  vtkSMPropertyHelper(m_passThrough, "Input").Set(proxy);
+  m_passThrough->UpdateVTKObjects();
+  m_passThrough->UpdatePipeline();
+}
+
 bool ModuleSlice::finalize()
 {
   vtkNew<vtkSMParaViewPipelineControllerWithRendering> controller;
@@ -291,6 +300,8 @@ void ModuleSlice::addToPanel(QWidget* panel)
                           m_propsPanelProxy->GetProperty("MapScalars"), 0);
   connect(mapScalarsCheckBox, SIGNAL(toggled(bool)), this, SLOT(dataUpdated()));
 
+  layout->addWidget(createLevelOfDetailCheckBox());
+
   layout->addStretch();
 
   panel->setLayout(layout);
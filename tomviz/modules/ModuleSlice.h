@@ -52,12 +52,15 @@ public:
 
   bool isProxyPartOfModule(vtkSMProxy* proxy) override;
 
+  bool supportsLevelOfDetail() const override { return true; }
+
   QString exportDataTypeString() override { return "Image"; }
 
   vtkSmartPointer<vtkDataObject> getDataToExport() override;
 
 protected:
   void updateColorMap() override;
+  void setInputProxy(vtkSMSourceProxy* proxy) override;
   std::string getStringForProxy(vtkSMProxy* proxy) override;
   vtkSMProxy* getProxyForString(const std::string& str) override;
 
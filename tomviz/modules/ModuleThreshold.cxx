@@ -64,9 +64,10 @@ bool ModuleThreshold::initialize(DataSource* data, vtkSMViewProxy* vtkView)
 
   vtkSMSessionProxyManager* pxm = producer->GetSessionProxyManager();
 
-  // Create the contour filter.
+  // Create the threshold filter, it only generates the surface of the
+  // selected cells.
   vtkSmartPointer<vtkSMProxy> proxy;
-  proxy.TakeReference(pxm->NewProxy("filters", "Threshold"));
+  proxy.TakeReference(pxm->NewProxy("filters", "ImageThresholdSurface"));
 
   m_thresholdFilter = vtkSMSourceProxy::SafeDownCast(proxy);
   Q_ASSERT(m_thresholdFilter);
@@ -119,6 +120,12 @@ void ModuleThreshold::updateColorMap()
   m_thresholdRepresentation->UpdateVTKObjects();
 }
 
+void ModuleThreshold::setInputProxy(vtkSMSourceProxy* proxy)
+{
+  vtkSMPropertyHelper(m_thresholdFilter, "Input").Set(proxy);
+  m_thresholdFilter->UpdateVTKObjects();
+}
+
 bool ModuleThreshold::finalize()
 {
   vtkNew<vtkSMParaViewPipelineControllerWithRendering> controller;
@@ -192,6 +199,8 @@ void ModuleThreshold::addToPanel(QWidget* panel)
   QCheckBox* mapScalarsCheckBox = new QCheckBox();
   formLayout->addRow("Color Map Data", mapScalarsCheckBox);
 
+  layout->addWidget(createLevelOfDetailCheckBox());
+
   layout->addStretch();
   panel->setLayout(layout);
 
@@ -49,8 +49,11 @@ public:
 
   bool isProxyPartOfModule(vtkSMProxy* proxy) override;
 
+  bool supportsLevelOfDetail() const override { return true; }
+
 protected:
   void updateColorMap() override;
+  void setInputProxy(vtkSMSourceProxy* proxy) override;
   std::string getStringForProxy(vtkSMProxy* proxy) override;
   vtkSMProxy* getProxyForString(const std::string& str) override;
 
@@ -16,14 +16,22 @@
 #include "ModuleVolume.h"
 #include "ModuleVolumeWidget.h"
 
+#include "CpuVolumeRendering.h"
 #include "DataSource.h"
+#include "OccupancyGrid.h"
 #include "Utilities.h"
 
+#include <vtkAlgorithm.h>
 #include <vtkColorTransferFunction.h>
+#include <vtkCommand.h>
+#include <vtkDataArray.h>
+#include <vtkFixedPointVolumeRayCastMapper.h>
 #include <vtkGPUVolumeRayCastMapper.h>
 #include <vtkImageData.h>
 #include <vtkNew.h>
 #include <vtkPiecewiseFunction.h>
+#include <vtkPointData.h>
+#include <vtkRenderer.h>
 #include <vtkSmartPointer.h>
 #include <vtkTrivialProducer.h>
 #include <vtkVector.h>
@@ -31,6 +39,7 @@
 #include <vtkVolume.h>
 #include <vtkVolumeProperty.h>
 
+#include <pqCoreUtilities.h>
 #include <pqProxiesWidget.h>
 #include <vtkPVRenderView.h>
 #include <vtkSMPVRepresentationProxy.h>
@@ -66,13 +75,21 @@ bool ModuleVolume::initialize(DataSource* data, vtkSMViewProxy* vtkView)
   // Default parameters
   vtkTrivialProducer* trv = data->producer();
   m_volumeMapper->SetInputConnection(trv->GetOutputPort());
-  m_volume->SetMapper(m_volumeMapper.Get());
+  m_cpuMapper->SetInputConnection(trv->GetOutputPort());
+  m_useCpu = rendersOnCpu(m_renderer);
+  m_volume->SetMapper(mapper(false));
   m_volume->SetProperty(m_volumeProperty.Get());
   const double* displayPosition = data->displayPosition();
   m_volume->SetPosition(displayPosition[0], displayPosition[1],
                         displayPosition[2]);
-  m_volumeMapper->UseJitteringOn();
-  m_volumeMapper->SetBlendMode(vtkVolumeMapper::COMPOSITE_BLEND);
+  for (auto gpuMapper : { m_volumeMapper.Get(), m_interactiveMapper.Get() }) {
+    gpuMapper->UseJitteringOn();
+    gpuMapper->SetBlendMode(vtkVolumeMapper::COMPOSITE_BLEND);
+  }
+  for (auto cpuMapper : { m_cpuMapper.Get(), m_cpuInteractiveMapper.Get() }) {
+    setupCpuVolumeMapper(cpuMapper);
+    cpuMapper->SetBlendMode(vtkVolumeMapper::COMPOSITE_BLEND);
+  }
   m_volumeProperty->SetInterpolationType(VTK_LINEAR_INTERPOLATION);
   m_volumeProperty->SetAmbient(0.0);
   m_volumeProperty->SetDiffuse(1.0);
@@ -84,6 +101,10 @@ bool ModuleVolume::initialize(DataSource* data, vtkSMViewProxy* vtkView)
   m_view = vtkPVRenderView::SafeDownCast(vtkView->GetClientSideView());
   m_view->AddPropToRenderer(m_volume.Get());
   m_view->Update();
+  pqCoreUtilities::connect(m_view->GetRenderer(), vtkCommand::StartEvent, this,
+                           SLOT(onRenderStart()));
+
+  setUseLevelOfDetail(true);
 
   return true;
 }
@@ -105,6 +126,13 @@ void ModuleVolume::updateColorMap()
       m_volumeProperty->SetGradientOpacity(gradientOpacityMap());
       break;
     case (Module::GRADIENT_2D):
+      if (m_useCpu) {
+        updateCpuTransferFunction2D();
+        m_volumeProperty->SetScalarOpacity(m_separableOpacity.Get());
+        m_volumeProperty->SetColor(m_separableColor.Get());
+        m_volumeProperty->SetGradientOpacity(m_separableGradientOpacity.Get());
+        break;
+      }
       propertyMode = vtkVolumeProperty::TF_2D;
       if (transferFunction2D() && transferFunction2D()->GetExtent()[1] > 0) {
         m_volumeProperty->SetTransferFunction2D(transferFunction2D());
@@ -117,6 +145,107 @@ void ModuleVolume::updateColorMap()
   // BUG: volume mappers don't update property when LUT is changed and has an
   // older Mtime. Fix for now by forcing the LUT to update.
   vtkObject::SafeDownCast(colorMap()->GetClientSideObject())->Modified();
+
+  updateCropping();
+}
+
+void ModuleVolume::updateCpuTransferFunction2D()
+{
+  double range[2];
+  vtkColorTransferFunction::SafeDownCast(colorMap()->GetClientSideObject())
+    ->GetRange(range);
+
+  // The gradient magnitude spans a quarter of the scalar range, as for the
+  // gradient opacity of the 1D mode.
+  separateTransferFunction2D(transferFunction2D(), range,
+                             (range[1] - range[0]) / 4.0,
+                             m_separableColor.Get(), m_separableOpacity.Get(),
+                             m_separableGradientOpacity.Get());
+  m_separableTime.Modified();
+}
+
+void ModuleVolume::updateCropping()
+{
+  // Only the bounds of the bricks with some opacity are ray cast. The other
+  // blend modes than compositing see the transparent voxels too.
+  double bounds[6];
+  bool crop = false;
+  auto image = vtkImageData::SafeDownCast(dataSource()->dataObject());
+  auto scalars = image ? image->GetPointData()->GetScalars() : nullptr;
+  if (m_volumeMapper->GetBlendMode() == vtkVolumeMapper::COMPOSITE_BLEND &&
+      scalars && scalars->GetNumberOfComponents() == 1) {
+    auto grid = dataSource()->occupancyGrid();
+    crop = grid->occupiedBounds(
+      m_volumeProperty->GetTransferFunctionMode() == vtkVolumeProperty::TF_2D
+        ? grid->occupancy(transferFunction2D())
+        : grid->occupancy(m_volumeProperty->GetScalarOpacity()),
+      bounds);
+  }
+
+  vtkVolumeMapper* mappers[] = { m_volumeMapper.Get(),
+                                 m_interactiveMapper.Get(), m_cpuMapper.Get(),
+                                 m_cpuInteractiveMapper.Get() };
+  for (auto volumeMapper : mappers) {
+    volumeMapper->SetCropping(crop ? 1 : 0);
+    if (crop) {
+      volumeMapper->SetCroppingRegionPlanes(bounds);
+      volumeMapper->SetCroppingRegionFlagsToSubVolume();
+    }
+  }
+  m_croppingTime.Modified();
+}
+
+void ModuleVolume::onRenderStart()
+{
+  // The transfer functions are edited in place, bring what depends on them up
+  // to date before the mappers render with them.
+  auto transfer2D = transferFunction2D();
+  if (m_useCpu && getTransferMode() == Module::GRADIENT_2D) {
+    auto lut = vtkObject::SafeDownCast(colorMap()->GetClientSideObject());
+    if ((transfer2D && transfer2D->GetMTime() > m_separableTime) ||
+        lut->GetMTime() > m_separableTime) {
+      updateCpuTransferFunction2D();
+    }
+  }
+
+  // The occupied bricks change with the opacity and with the data.
+  if (!dataSource()->occupancyGrid()->isReady() ||
+      m_volumeProperty->GetScalarOpacity()->GetMTime() > m_croppingTime ||
+      (transfer2D && transfer2D->GetMTime() > m_croppingTime)) {
+    updateCropping();
+  }
+}
+
+bool ModuleVolume::rendersOnCpu(int renderer) const
+{
+  switch (renderer) {
+    case GPU:
+      return false;
+    case CPU:
+      return true;
+    default:
+      return !hasHardwareGpu(view() ? view()->GetRenderWindow() : nullptr);
+  }
+}
+
+vtkVolumeMapper* ModuleVolume::mapper(bool interactive) const
+{
+  if (m_useCpu) {
+    return interactive ? m_cpuInteractiveMapper.Get() : m_cpuMapper.Get();
+  }
+  return interactive ? m_interactiveMapper.Get() : m_volumeMapper.Get();
+}
+
+void ModuleVolume::setInputProxy(vtkSMSourceProxy* proxy)
+{
+  if (proxy == dataSource()->proxy()) {
+    m_volume->SetMapper(mapper(false));
+  } else {
+    auto producer = vtkAlgorithm::SafeDownCast(proxy->GetClientSideObject());
+    auto interactiveMapper = mapper(true);
+    interactiveMapper->SetInputConnection(producer->GetOutputPort());
+    m_volume->SetMapper(interactiveMapper);
+  }
 }
 
 bool ModuleVolume::finalize()
@@ -148,6 +277,7 @@ QJsonObject ModuleVolume::serialize() const
   props["interpolation"] = m_volumeProperty->GetInterpolationType();
   props["blendingMode"] = m_volumeMapper->GetBlendMode();
   props["rayJittering"] = m_volumeMapper->GetUseJittering() == 1;
+  props["renderer"] = m_renderer;
 
   QJsonObject lighting;
   lighting["enabled"] = m_volumeProperty->GetShade() == 1;
@@ -174,6 +304,9 @@ bool ModuleVolume::deserialize(const QJsonObject& json)
     onInterpolationChanged(props["interpolation"].toInt());
     setBlendingMode(props["blendingMode"].toInt());
     setJittering(props["rayJittering"].toBool());
+    if (props.contains("renderer")) {
+      setRenderer(props["renderer"].toInt());
+    }
 
     if (props["lighting"].isObject()) {
       auto lighting = props["lighting"].toObject();
@@ -204,6 +337,7 @@ void ModuleVolume::addToPanel(QWidget* panel)
 
   // Create, update and connect
   layout->addWidget(m_controllers);
+  layout->addWidget(createLevelOfDetailCheckBox());
   updatePanel();
 
   connect(m_controllers, SIGNAL(jitteringToggled(const bool)), this,
@@ -224,6 +358,8 @@ void ModuleVolume::addToPanel(QWidget* panel)
           SLOT(onSpecularPowerChanged(const double)));
   connect(m_controllers, SIGNAL(transferModeChanged(const int)), this,
           SLOT(onTransferModeChanged(const int)));
+  connect(m_controllers, SIGNAL(rendererChanged(const int)), this,
+          SLOT(setRenderer(const int)));
 }
 
 void ModuleVolume::updatePanel()
@@ -245,6 +381,7 @@ void ModuleVolume::updatePanel()
 
   const auto tfMode = getTransferMode();
   m_controllers->setTransferMode(tfMode);
+  m_controllers->setRenderer(m_renderer);
 }
 
 void ModuleVolume::onTransferModeChanged(const int mode)
@@ -324,12 +461,35 @@ void ModuleVolume::setLighting(const bool val)
 void ModuleVolume::setBlendingMode(const int mode)
 {
   m_volumeMapper->SetBlendMode(mode);
+  m_interactiveMapper->SetBlendMode(mode);
+
+  // The CPU mappers have no average or additive blending.
+  const int cpuMode = mode == vtkVolumeMapper::MAXIMUM_INTENSITY_BLEND ||
+                          mode == vtkVolumeMapper::MINIMUM_INTENSITY_BLEND
+                        ? mode
+                        : vtkVolumeMapper::COMPOSITE_BLEND;
+  m_cpuMapper->SetBlendMode(cpuMode);
+  m_cpuInteractiveMapper->SetBlendMode(cpuMode);
+  updateCropping();
+  emit renderNeeded();
+}
+
+void ModuleVolume::setRenderer(const int renderer)
+{
+  m_renderer = renderer;
+  const bool useCpu = rendersOnCpu(renderer);
+  if (useCpu != m_useCpu) {
+    m_useCpu = useCpu;
+    m_volume->SetMapper(mapper(false));
+    updateColorMap();
+  }
   emit renderNeeded();
 }
 
 void ModuleVolume::setJittering(const bool val)
 {
   m_volumeMapper->SetUseJittering(val ? 1 : 0);
+  m_interactiveMapper->SetUseJittering(val ? 1 : 0);
   emit renderNeeded();
 }
 
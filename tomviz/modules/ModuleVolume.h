@@ -19,6 +19,7 @@
 #include "Module.h"
 
 #include <vtkNew.h>
+#include <vtkTimeStamp.h>
 #include <vtkWeakPointer.h>
 
 #include <QPointer>
@@ -28,7 +29,11 @@ class vtkSMSourceProxy;
 
 class vtkPVRenderView;
 
+class vtkColorTransferFunction;
+class vtkFixedPointVolumeRayCastMapper;
 class vtkGPUVolumeRayCastMapper;
+class vtkPiecewiseFunction;
+class vtkVolumeMapper;
 class vtkVolumeProperty;
 class vtkVolume;
 
@@ -44,6 +49,16 @@ public:
   ModuleVolume(QObject* parent = nullptr);
   virtual ~ModuleVolume();
 
+  /// Where the volume is ray cast. This enum needs to be synchronized with the
+  /// order of the items in ModuleVolumeWidget's renderer combo box. AUTOMATIC
+  /// casts on the CPU when the view has no hardware GPU.
+  enum Renderer
+  {
+    AUTOMATIC = 0,
+    GPU,
+    CPU
+  };
+
   QString label() const override { return "Volume"; }
   QIcon icon() const override;
   bool initialize(DataSource* dataSource, vtkSMViewProxy* view) override;
@@ -62,21 +77,44 @@ public:
 
   bool supportsGradientOpacity() override { return true; }
 
+  bool supportsLevelOfDetail() const override { return true; }
+
   QString exportDataTypeString() override { return "Volume"; }
 
   vtkSmartPointer<vtkDataObject> getDataToExport() override;
 
 protected:
   void updateColorMap() override;
+  void setInputProxy(vtkSMSourceProxy* proxy) override;
   std::string getStringForProxy(vtkSMProxy* proxy) override;
   vtkSMProxy* getProxyForString(const std::string& str) override;
 
 private:
   Q_DISABLE_COPY(ModuleVolume)
 
+  bool rendersOnCpu(int renderer) const;
+  vtkVolumeMapper* mapper(bool interactive) const;
+  void updateCpuTransferFunction2D();
+  void updateCropping();
+
   vtkWeakPointer<vtkPVRenderView> m_view;
   vtkNew<vtkVolume> m_volume;
   vtkNew<vtkGPUVolumeRayCastMapper> m_volumeMapper;
+  // Renders the coarser level of the data while interacting, each mapper keeps
+  // its own texture so switching doesn't upload the data again.
+  vtkNew<vtkGPUVolumeRayCastMapper> m_interactiveMapper;
+  vtkNew<vtkFixedPointVolumeRayCastMapper> m_cpuMapper;
+  vtkNew<vtkFixedPointVolumeRayCastMapper> m_cpuInteractiveMapper;
+  int m_renderer = AUTOMATIC;
+  bool m_useCpu = false;
+  // The CPU mappers don't have 2D transfer functions, it is separated into
+  // scalar and gradient magnitude ones.
+  vtkNew<vtkColorTransferFunction> m_separableColor;
+  vtkNew<vtkPiecewiseFunction> m_separableOpacity;
+  vtkNew<vtkPiecewiseFunction> m_separableGradientOpacity;
+  vtkTimeStamp m_separableTime;
+  // When the mappers were last cropped to the bricks with some opacity.
+  vtkTimeStamp m_croppingTime;
   vtkNew<vtkVolumeProperty> m_volumeProperty;
   QPointer<ModuleVolumeWidget> m_controllers;
 
@@ -94,6 +132,8 @@ private slots:
   void onSpecularChanged(const double value);
   void onSpecularPowerChanged(const double value);
   void onTransferModeChanged(const int mode);
+  void setRenderer(const int renderer);
+  void onRenderStart();
 };
 } // namespace tomviz
 
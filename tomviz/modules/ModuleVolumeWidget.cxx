@@ -42,6 +42,13 @@ ModuleVolumeWidget::ModuleVolumeWidget(QWidget* parent_)
   labelsInterp << tr("Nearest Neighbor") << tr("Linear");
   m_ui->cbInterpolation->addItems(labelsInterp);
 
+  QStringList labelsRenderer;
+  labelsRenderer << tr("Automatic") << tr("GPU") << tr("CPU");
+  m_ui->cbRenderer->addItems(labelsRenderer);
+  m_ui->cbRenderer->setToolTip(
+    tr("Automatic casts the rays on the CPU, with all its cores, when there "
+       "is no hardware GPU"));
+
   connect(m_ui->cbJittering, SIGNAL(toggled(bool)), this,
           SIGNAL(jitteringToggled(const bool)));
   connect(m_ui->cbBlending, SIGNAL(currentIndexChanged(int)), this,
@@ -50,6 +57,8 @@ ModuleVolumeWidget::ModuleVolumeWidget(QWidget* parent_)
           SIGNAL(interpolationChanged(const int)));
   connect(m_ui->cbTransferMode, SIGNAL(currentIndexChanged(int)), this,
           SIGNAL(transferModeChanged(const int)));
+  connect(m_ui->cbRenderer, SIGNAL(currentIndexChanged(int)), this,
+          SIGNAL(rendererChanged(const int)));
 
   connect(m_uiLighting->gbLighting, SIGNAL(toggled(bool)), this,
           SIGNAL(lightingToggled(const bool)));
@@ -125,4 +134,9 @@ void ModuleVolumeWidget::setTransferMode(const int transferMode)
 {
   m_ui->cbTransferMode->setCurrentIndex(transferMode);
 }
+
+void ModuleVolumeWidget::setRenderer(const int renderer)
+{
+  m_ui->cbRenderer->setCurrentIndex(renderer);
+}
 } // namespace tomviz
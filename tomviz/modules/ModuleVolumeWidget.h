@@ -56,6 +56,7 @@ public:
   void setSpecular(const double value);
   void setSpecularPower(const double value);
   void setTransferMode(const int transferMode);
+  void setRenderer(const int renderer);
   //@}
 
 signals:
@@ -72,6 +73,7 @@ signals:
   void specularChanged(const double value);
   void specularPowerChanged(const double value);
   void transferModeChanged(const int mode);
+  void rendererChanged(const int renderer);
   //@}
 
 private:
@@ -30,6 +30,7 @@ public:
   QString label() const override { return "Convert to Float"; }
   QIcon icon() const override;
   Operator* clone() const override;
+  bool modifiesDataInPlace() const override { return false; }
 
   bool applyTransform(vtkDataObject* data) override;
 
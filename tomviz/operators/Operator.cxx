@@ -90,6 +90,12 @@ TransformResult Operator::transform(vtkDataObject* data)
   return transformResult;
 }
 
+void Operator::completeFromCache()
+{
+  m_state = OperatorState::Complete;
+  emit transformingDone(TransformResult::Complete);
+}
+
 void Operator::setNumberOfResults(int n)
 {
   int previousSize = m_results.size();
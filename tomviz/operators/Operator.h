@@ -124,8 +124,8 @@ public:
   /// operator or nullptr if there is nothing to edit.  The vtkImageData
   /// is a copy of the DataSource's image with all Operators prior in the
   /// pipeline applied to it.  This should be used if the widget needs to
-  /// display the VTK data, but modifications to it will not affect the
-  /// DataSource.
+  /// display the VTK data. The copy may share its arrays with the DataSource,
+  /// so they must not be modified in place.
   virtual EditOperatorWidget* getEditorContentsWithData(
     QWidget* parent_,
     vtkSmartPointer<vtkImageData> vtkNotUsed(inputDataForDisplay))
@@ -137,6 +137,21 @@ public:
   /// getEditorContents.
   virtual bool hasCustomUI() const { return false; }
 
+  /// Returns true if applyTransform writes into the arrays of the data it is
+  /// given. The pipeline hands the operators data that may share its arrays
+  /// with the data sources shown in the UI, and only copies the shared arrays
+  /// before running an operator that modifies them in place. Operators that
+  /// just read the data, or replace its arrays with new ones, should return
+  /// false to avoid the copy.
+  virtual bool modifiesDataInPlace() const { return true; }
+
+  /// Returns true if the operator transforms each slice along the z axis, e.g.
+  /// each image of a tilt series, independently of the others. Transforming a
+  /// single slice, with its z extent set to its index in the volume, must give
+  /// the same slice as transforming the whole volume. The pipeline then only
+  /// runs the slices appended to a data source through the operator.
+  virtual bool appliesPerSlice() const { return false; }
+
   /// If this operator has a dialog active, this should return that dialog (the
   /// dialog will register itself using setCustomDialog in its constructor).
   /// Otherwise this will return nullptr.
@@ -258,6 +273,9 @@ public slots:
   void resetState() { m_state = OperatorState::Queued; }
   void setEditing() { m_state = OperatorState::Edit; }
   void setComplete() { m_state = OperatorState::Complete; }
+  /// Mark the operator as having transformed the data without running it,
+  /// used when its output is taken from the pipeline cache.
+  void completeFromCache();
 
 protected slots:
   // Create a new child datasource and set it on this operator
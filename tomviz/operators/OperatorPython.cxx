@@ -129,6 +129,7 @@ public:
   Python::Module InternalModule;
   Python::Function FindTransformScalarsFunction;
   Python::Function IsCancelableFunction;
+  Python::Function IsPerSliceFunction;
   Python::Function DeleteModuleFunction;
 };
 
@@ -155,6 +156,11 @@ OperatorPython::OperatorPython(QObject* parentObject)
       qCritical() << "Unable to locate is_cancelable.";
     }
 
+    d->IsPerSliceFunction = d->InternalModule.findFunction("is_per_slice");
+    if (!d->IsPerSliceFunction.isValid()) {
+      qCritical() << "Unable to locate is_per_slice.";
+    }
+
     d->FindTransformScalarsFunction =
       d->InternalModule.findFunction("find_transform_scalars");
     if (!d->FindTransformScalarsFunction.isValid()) {
@@ -296,6 +302,7 @@ void OperatorPython::setScript(const QString& str)
     m_script = str;
 
     Python::Object result;
+    Python::Object perSlice;
     {
       Python python;
       QString moduleName = QString("tomviz_%1").arg(label());
@@ -336,9 +343,16 @@ void OperatorPython::setScript(const QString& str)
         qCritical("Error calling is_cancelable.");
         return;
       }
+
+      perSlice = d->IsPerSliceFunction.call(isArgs);
+      if (!perSlice.isValid()) {
+        qCritical("Error calling is_per_slice.");
+        return;
+      }
     }
 
     setSupportsCancel(result.toBool());
+    m_perSlice = perSlice.toBool();
 
     emit transformModified();
   }
@@ -59,6 +59,10 @@ public:
     vtkSmartPointer<vtkImageData> inputDataForDisplay) override;
   bool hasCustomUI() const override { return true; }
 
+  /// Python operators declare that they apply per slice with a module level
+  /// PER_SLICE = True.
+  bool appliesPerSlice() const override { return m_perSlice; }
+
   /// Set the arguments to pass to the transform_scalars function
   void setArguments(QMap<QString, QVariant> args);
 
@@ -95,6 +99,7 @@ private:
   QString m_script;
 
   QString m_customWidgetID;
+  bool m_perSlice = false;
 
   QList<QString> m_resultNames;
   QList<QPair<QString, QString>> m_childDataSourceNamesAndLabels;
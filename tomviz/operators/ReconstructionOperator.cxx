@@ -17,9 +17,8 @@
 #include "ReconstructionOperator.h"
 
 #include "DataSource.h"
+#include "EditOperatorWidget.h"
 #include "ReconstructionWidget.h"
-#include "TomographyReconstruction.h"
-#include "TomographyTiltSeries.h"
 
 #include "pqSMProxy.h"
 #include "vtkDataArray.h"
@@ -31,8 +30,110 @@
 #include "vtkSMSourceProxy.h"
 #include "vtkTrivialProducer.h"
 
-#include <QCoreApplication>
+#include <QComboBox>
 #include <QDebug>
+#include <QElapsedTimer>
+#include <QFormLayout>
+#include <QJsonObject>
+#include <QPointer>
+
+#include <atomic>
+#include <mutex>
+
+namespace {
+
+using Algorithm = tomviz::ReconstructionOperator::Algorithm;
+using tomviz::TomographyReconstruction::Filter;
+using tomviz::TomographyReconstruction::Interpolation;
+
+// Names used in the UI and the serialized state, in the enum orders.
+const char* const AlgorithmLabels[] = { "Back Projection", "Direct Fourier" };
+const char* const AlgorithmNames[] = { "back-projection", "direct-fourier" };
+const int NumberOfAlgorithms = 2;
+
+const char* const FilterLabels[] = { "None",    "Ramp",    "Shepp-Logan",
+                                     "Cosine",  "Hamming", "Hann" };
+const char* const FilterNames[] = { "none",   "ramp",    "shepp-logan",
+                                    "cosine", "hamming", "hann" };
+const int NumberOfFilters = 6;
+
+const char* const InterpolationLabels[] = { "Bilinear", "Kaiser-Bessel" };
+const char* const InterpolationNames[] = { "bilinear", "kaiser-bessel" };
+const int NumberOfInterpolations = 2;
+
+// Index of name in names, or -1.
+int nameIndex(const QString& name, const char* const names[], int count)
+{
+  for (int i = 0; i < count; ++i) {
+    if (name == names[i]) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+class ReconstructionEditWidget : public tomviz::EditOperatorWidget
+{
+  Q_OBJECT
+
+public:
+  ReconstructionEditWidget(tomviz::ReconstructionOperator* op, QWidget* p)
+    : tomviz::EditOperatorWidget(p), m_operator(op)
+  {
+    m_algorithms = new QComboBox(this);
+    for (int i = 0; i < NumberOfAlgorithms; ++i) {
+      m_algorithms->addItem(AlgorithmLabels[i]);
+    }
+    m_algorithms->setCurrentIndex(static_cast<int>(op->algorithm()));
+    m_filters = new QComboBox(this);
+    for (int i = 0; i < NumberOfFilters; ++i) {
+      m_filters->addItem(FilterLabels[i]);
+    }
+    m_filters->setCurrentIndex(static_cast<int>(op->filter()));
+    m_interpolations = new QComboBox(this);
+    for (int i = 0; i < NumberOfInterpolations; ++i) {
+      m_interpolations->addItem(InterpolationLabels[i]);
+    }
+    m_interpolations->setCurrentIndex(static_cast<int>(op->interpolation()));
+    auto layout = new QFormLayout;
+    layout->addRow("Algorithm", m_algorithms);
+    layout->addRow("Fourier Weighting Filter", m_filters);
+    layout->addRow("Fourier Interpolation", m_interpolations);
+    setLayout(layout);
+
+    // Only the options of the selected algorithm can be edited.
+    auto updateEnabled = [this]() {
+      bool directFourier = m_algorithms->currentIndex() ==
+                           static_cast<int>(Algorithm::DirectFourier);
+      m_filters->setEnabled(!directFourier);
+      m_interpolations->setEnabled(directFourier);
+    };
+    connect(m_algorithms, static_cast<void (QComboBox::*)(int)>(
+                            &QComboBox::currentIndexChanged),
+            this, updateEnabled);
+    updateEnabled();
+  }
+
+  void applyChangesToOperator() override
+  {
+    if (m_operator) {
+      m_operator->setAlgorithm(
+        static_cast<Algorithm>(m_algorithms->currentIndex()));
+      m_operator->setFilter(static_cast<Filter>(m_filters->currentIndex()));
+      m_operator->setInterpolation(
+        static_cast<Interpolation>(m_interpolations->currentIndex()));
+    }
+  }
+
+private:
+  QPointer<tomviz::ReconstructionOperator> m_operator;
+  QComboBox* m_algorithms;
+  QComboBox* m_filters;
+  QComboBox* m_interpolations;
+};
+} // namespace
+
+#include "ReconstructionOperator.moc"
 
 namespace tomviz {
 ReconstructionOperator::ReconstructionOperator(DataSource* source, QObject* p)
@@ -68,7 +169,62 @@ QIcon ReconstructionOperator::icon() const
 
 Operator* ReconstructionOperator::clone() const
 {
-  return new ReconstructionOperator(m_dataSource);
+  auto other = new ReconstructionOperator(m_dataSource);
+  other->setAlgorithm(m_algorithm);
+  other->setFilter(m_filter);
+  other->setInterpolation(m_interpolation);
+  return other;
+}
+
+QJsonObject ReconstructionOperator::serialize() const
+{
+  auto json = Operator::serialize();
+  json["algorithm"] = AlgorithmNames[static_cast<int>(m_algorithm)];
+  json["filter"] = FilterNames[static_cast<int>(m_filter)];
+  json["interpolation"] = InterpolationNames[static_cast<int>(m_interpolation)];
+  return json;
+}
+
+bool ReconstructionOperator::deserialize(const QJsonObject& json)
+{
+  // State files written before the other algorithms were added are back
+  // projections, those written before filtering was supported have no
+  // filter: they correspond to the simple back projection.
+  int index = nameIndex(json["algorithm"].toString(), AlgorithmNames,
+                        NumberOfAlgorithms);
+  m_algorithm = index < 0 ? Algorithm::BackProjection
+                          : static_cast<Algorithm>(index);
+  index = nameIndex(json["filter"].toString(), FilterNames, NumberOfFilters);
+  m_filter = index < 0 ? Filter::None : static_cast<Filter>(index);
+  index = nameIndex(json["interpolation"].toString(), InterpolationNames,
+                    NumberOfInterpolations);
+  m_interpolation = index < 0 ? Interpolation::Bilinear
+                              : static_cast<Interpolation>(index);
+  return true;
+}
+
+EditOperatorWidget* ReconstructionOperator::getEditorContents(QWidget* p)
+{
+  return new ReconstructionEditWidget(this, p);
+}
+
+void ReconstructionOperator::setAlgorithm(Algorithm algorithm)
+{
+  m_algorithm = algorithm;
+  emit transformModified();
+}
+
+void ReconstructionOperator::setFilter(TomographyReconstruction::Filter filter)
+{
+  m_filter = filter;
+  emit transformModified();
+}
+
+void ReconstructionOperator::setInterpolation(
+  TomographyReconstruction::Interpolation interpolation)
+{
+  m_interpolation = interpolation;
+  emit transformModified();
 }
 
 QWidget* ReconstructionOperator::getCustomProgressWidget(QWidget* p) const
@@ -99,11 +255,8 @@ bool ReconstructionOperator::applyTransform(vtkDataObject* dataObject)
   }
   setTotalProgressSteps(m_extent[1] - m_extent[0] + 1);
 
-  int numXSlices = dataExtent[1] - dataExtent[0] + 1;
   int numYSlices = dataExtent[3] - dataExtent[2] + 1;
   int numZSlices = dataExtent[5] - dataExtent[4] + 1;
-  std::vector<float> sinogramPtr(numYSlices * numZSlices);
-  std::vector<float> reconstructionPtr(numYSlices * numYSlices);
   QVector<double> tiltAngles;
 
   vtkFieldData* fd = dataObject->GetFieldData();
@@ -132,20 +285,30 @@ bool ReconstructionOperator::applyTransform(vtkDataObject* dataObject)
 
   // TODO: talk to Dave Lonie about how to do this in new data array API
   float* reconstruction = (float*)darray->GetVoidPointer(0);
-  for (int i = 0; i < numXSlices && !isCanceled(); ++i) {
-    QCoreApplication::processEvents();
-    TomographyTiltSeries::getSinogram(imageData, i, &sinogramPtr[0]);
-    TomographyReconstruction::unweightedBackProjection2(
-      &sinogramPtr[0], tiltAngles.data(), &reconstructionPtr[0], numZSlices,
-      numYSlices);
-    for (int j = 0; j < numYSlices; ++j) {
-      for (int k = 0; k < numYSlices; ++k) {
-        reconstruction[j * (numYSlices * numXSlices) + k * numXSlices + i] =
-          reconstructionPtr[k * numYSlices + j];
-      }
+
+  // The slices are reconstructed concurrently, the callback runs on the worker
+  // threads. Intermediate results are throttled so the widget isn't flooded
+  // with copies of slices it has no time to display.
+  std::atomic<int> slicesDone(0);
+  std::mutex intermediateMutex;
+  QElapsedTimer intermediateTimer;
+  auto sliceDone = [&](int, const float* slice) {
+    setProgressStep(slicesDone++);
+    std::unique_lock<std::mutex> lock(intermediateMutex, std::try_to_lock);
+    if (lock.owns_lock() &&
+        (!intermediateTimer.isValid() || intermediateTimer.elapsed() > 100)) {
+      intermediateTimer.start();
+      emit intermediateResults(
+        std::vector<float>(slice, slice + numYSlices * numYSlices));
     }
-    emit intermediateResults(reconstructionPtr);
-    setProgressStep(i);
+    return !isCanceled();
+  };
+  if (m_algorithm == Algorithm::DirectFourier) {
+    TomographyReconstruction::directFourier3(
+      imageData, tiltAngles.data(), reconstruction, m_interpolation, sliceDone);
+  } else {
+    TomographyReconstruction::backProjection3(
+      imageData, tiltAngles.data(), reconstruction, m_filter, sliceDone);
   }
   if (isCanceled()) {
     return false;
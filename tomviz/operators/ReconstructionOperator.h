@@ -18,6 +18,8 @@
 
 #include "Operator.h"
 
+#include "TomographyReconstruction.h"
+
 namespace tomviz {
 class DataSource;
 
@@ -36,6 +38,35 @@ public:
 
   QWidget* getCustomProgressWidget(QWidget*) const override;
 
+  QJsonObject serialize() const override;
+  bool deserialize(const QJsonObject& json) override;
+
+  EditOperatorWidget* getEditorContents(QWidget* parent) override;
+  bool hasCustomUI() const override { return true; }
+  bool modifiesDataInPlace() const override { return false; }
+
+  enum class Algorithm
+  {
+    BackProjection,
+    DirectFourier
+  };
+
+  void setAlgorithm(Algorithm algorithm);
+  Algorithm algorithm() const { return m_algorithm; }
+
+  /// The Fourier weighting filter applied to the projections before they are
+  /// back projected, TomographyReconstruction::Filter::None gives a simple
+  /// (unweighted) back projection.
+  void setFilter(TomographyReconstruction::Filter filter);
+  TomographyReconstruction::Filter filter() const { return m_filter; }
+
+  /// The gridding of the direct Fourier method.
+  void setInterpolation(TomographyReconstruction::Interpolation interpolation);
+  TomographyReconstruction::Interpolation interpolation() const
+  {
+    return m_interpolation;
+  }
+
 protected:
   bool applyTransform(vtkDataObject* data) override;
 
@@ -48,6 +79,11 @@ signals:
 private:
   DataSource* m_dataSource;
   int m_extent[6];
+  Algorithm m_algorithm = Algorithm::BackProjection;
+  TomographyReconstruction::Filter m_filter =
+    TomographyReconstruction::Filter::None;
+  TomographyReconstruction::Interpolation m_interpolation =
+    TomographyReconstruction::Interpolation::Bilinear;
   Q_DISABLE_COPY(ReconstructionOperator)
 };
 } // namespace tomviz
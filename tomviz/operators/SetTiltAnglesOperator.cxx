@@ -441,30 +441,29 @@ bool SetTiltAnglesOperator::applyTransform(vtkDataObject* dataObject)
   image->GetExtent(extent);
   int totalSlices = extent[5] - extent[4] + 1;
   vtkFieldData* fd = dataObject->GetFieldData();
+  // The field data arrays may be shared with the input data source, so new
+  // arrays replace them rather than modifying them in place.
   // Make sure the data is marked as a tilt series
-  vtkTypeInt8Array* dataType =
-    vtkTypeInt8Array::SafeDownCast(fd->GetArray("tomviz_data_source_type"));
-  if (!dataType) {
-    vtkNew<vtkTypeInt8Array> array;
-    array->SetNumberOfTuples(1);
-    array->SetName("tomviz_data_source_type");
-    fd->AddArray(array.Get());
-    dataType = array.Get();
-  }
-  // It should already be this value...
+  vtkNew<vtkTypeInt8Array> dataType;
+  dataType->SetNumberOfTuples(1);
+  dataType->SetName("tomviz_data_source_type");
   dataType->SetTuple1(0, DataSource::TiltSeries);
+  fd->AddArray(dataType.Get());
   // Set the tilt angles
-  vtkDataArray* dataTiltAngles = fd->GetArray("tilt_angles");
-  if (!dataTiltAngles) {
-    vtkNew<vtkDoubleArray> angles;
-    angles->SetNumberOfTuples(totalSlices);
-    angles->FillComponent(0, 0.0);
-    angles->SetName("tilt_angles");
-    fd->AddArray(angles.Get());
-    dataTiltAngles = angles.Get();
-  } else if (dataTiltAngles->GetNumberOfTuples() < totalSlices) {
+  vtkNew<vtkDoubleArray> dataTiltAngles;
+  vtkDataArray* oldTiltAngles = fd->GetArray("tilt_angles");
+  if (oldTiltAngles) {
+    dataTiltAngles->DeepCopy(oldTiltAngles);
+  }
+  dataTiltAngles->SetName("tilt_angles");
+  if (dataTiltAngles->GetNumberOfTuples() < totalSlices) {
+    vtkIdType oldSize = dataTiltAngles->GetNumberOfTuples();
     dataTiltAngles->SetNumberOfTuples(totalSlices);
+    for (vtkIdType i = oldSize; i < totalSlices; ++i) {
+      dataTiltAngles->SetTuple1(i, 0.0);
+    }
   }
+  fd->AddArray(dataTiltAngles.Get());
   for (auto itr = std::begin(m_tiltAngles); itr != std::end(m_tiltAngles);
        ++itr) {
     dataTiltAngles->SetTuple(itr.key(), &itr.value());
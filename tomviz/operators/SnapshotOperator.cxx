@@ -98,8 +98,10 @@ bool SnapshotOperator::applyTransform(vtkDataObject* dataObject)
     return false;
   }
 
+  // The arrays are shared, they are copied on write if a later operator in
+  // the pipeline modifies them in place.
   vtkNew<vtkImageData> cacheImage;
-  cacheImage->DeepCopy(imageData);
+  cacheImage->ShallowCopy(imageData);
 
   emit newChildDataSource("Snapshot", cacheImage.Get());
   return true;
@@ -39,6 +39,8 @@ public:
 
   QWidget* getCustomProgressWidget(QWidget*) const override;
 
+  bool modifiesDataInPlace() const override { return false; }
+
 protected:
   bool applyTransform(vtkDataObject* data) override;
 
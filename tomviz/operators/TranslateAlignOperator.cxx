@@ -19,8 +19,11 @@
 #include "AlignWidget.h"
 #include "DataSource.h"
 
+#include "vtkDataArray.h"
 #include "vtkImageData.h"
 #include "vtkNew.h"
+#include "vtkPointData.h"
+#include "vtkSmartPointer.h"
 
 #include <QJsonArray>
 
@@ -50,8 +53,13 @@ void applyImageOffsets(T* in, T* out, vtkImageData* image,
   }
 
   // We need to go slice by slice, applying the pixel offsets to the new image.
+  // The offsets are indexed by the z extent, slices without one aren't moved.
   for (int i = 0; i < extent[2]; ++i) {
-    vtkVector2i offset = offsets[i];
+    int slice = extents[4] + i;
+    vtkVector2i offset(0, 0);
+    if (slice >= 0 && slice < offsets.size()) {
+      offset = offsets[slice];
+    }
     int idx = imageIndex(incs, vtkVector3i(0, 0, i));
     T* inPtr = in + idx;
     T* outPtr = out + idx;
@@ -94,17 +102,23 @@ QIcon TranslateAlignOperator::icon() const
 
 bool TranslateAlignOperator::applyTransform(vtkDataObject* data)
 {
-  vtkNew<vtkImageData> outImage;
   vtkImageData* inImage = vtkImageData::SafeDownCast(data);
   assert(inImage);
-  outImage->DeepCopy(data);
+  // The offset slices are written to a new array that replaces the scalars,
+  // so the input array is only read and never needs to be copied.
+  vtkDataArray* inScalars = inImage->GetPointData()->GetScalars();
+  vtkSmartPointer<vtkDataArray> outScalars;
+  outScalars.TakeReference(inScalars->NewInstance());
+  outScalars->SetNumberOfComponents(inScalars->GetNumberOfComponents());
+  outScalars->SetNumberOfTuples(inScalars->GetNumberOfTuples());
+  outScalars->SetName(inScalars->GetName());
   switch (inImage->GetScalarType()) {
     vtkTemplateMacro(
-      applyImageOffsets(reinterpret_cast<VTK_TT*>(inImage->GetScalarPointer()),
-                        reinterpret_cast<VTK_TT*>(outImage->GetScalarPointer()),
+      applyImageOffsets(reinterpret_cast<VTK_TT*>(inScalars->GetVoidPointer(0)),
+                        reinterpret_cast<VTK_TT*>(outScalars->GetVoidPointer(0)),
                         inImage, offsets));
   }
-  data->ShallowCopy(outImage.Get());
+  inImage->GetPointData()->SetScalars(outScalars);
   return true;
 }
 
@@ -55,6 +55,8 @@ public:
   DataSource* getDataSource() const { return this->dataSource; }
 
   bool hasCustomUI() const override { return true; }
+  bool modifiesDataInPlace() const override { return false; }
+  bool appliesPerSlice() const override { return true; }
 
 protected:
   bool applyTransform(vtkDataObject* data) override;
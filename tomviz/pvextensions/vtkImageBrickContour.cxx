@@ -0,0 +1,702 @@
+/******************************************************************************
+
+  This source file is part of the tomviz project.
+
+  Copyright Kitware, Inc.
+
+  This source code is released under the New BSD License, (the "License").
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+******************************************************************************/
+#include "vtkImageBrickContour.h"
+
+#include "vtkAppendPolyData.h"
+#include "vtkCellArray.h"
+#include "vtkContourValues.h"
+#include "vtkDataArray.h"
+#include "vtkFloatArray.h"
+#include "vtkIdTypeArray.h"
+#include "vtkImageData.h"
+#include "vtkInformation.h"
+#include "vtkInformationVector.h"
+#include "vtkMarchingCubesTriangleCases.h"
+#include "vtkMath.h"
+#include "vtkNew.h"
+#include "vtkObjectFactory.h"
+#include "vtkPointData.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkSMPThreadLocal.h"
+#include "vtkSMPTools.h"
+#include "vtkSmartPointer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <list>
+#include <utility>
+#include <vector>
+
+namespace {
+
+// The order of the points of a cell and of its edges in the marching cubes
+// cases, edges go from their first point along an axis.
+const int CELL_POINTS[8][3] = { { 0, 0, 0 }, { 1, 0, 0 }, { 1, 1, 0 },
+                                { 0, 1, 0 }, { 0, 0, 1 }, { 1, 0, 1 },
+                                { 1, 1, 1 }, { 0, 1, 1 } };
+const int CELL_EDGES[12][2] = { { 0, 1 }, { 1, 2 }, { 3, 2 }, { 0, 3 },
+                                { 4, 5 }, { 5, 6 }, { 7, 6 }, { 4, 7 },
+                                { 0, 4 }, { 1, 5 }, { 3, 7 }, { 2, 6 } };
+const int EDGE_AXES[12] = { 0, 1, 0, 1, 0, 1, 0, 1, 2, 2, 2, 2 };
+
+// A block of cells of the image, its extent includes the points it shares
+// with its neighbors. The range is that of the scalars of its points.
+struct Brick
+{
+  int Extent[6];
+  double Min;
+  double Max;
+};
+
+// The scalars of an image, with the first component of point (i, j, k) at
+// (i + j * dims[0] + k * dims[0] * dims[1]) * numberOfComponents.
+template <typename T>
+class ImageScalars
+{
+public:
+  ImageScalars(const T* scalars, int numberOfComponents, const int dims[3])
+    : Scalars(scalars), NumberOfComponents(numberOfComponents)
+  {
+    std::copy(dims, dims + 3, this->Dims);
+    this->Strides[0] = numberOfComponents;
+    this->Strides[1] = this->Strides[0] * dims[0];
+    this->Strides[2] = this->Strides[1] * dims[1];
+  }
+
+  double Value(int i, int j, int k) const
+  {
+    return static_cast<double>(this->Scalars[i * this->Strides[0] +
+                                             j * this->Strides[1] +
+                                             k * this->Strides[2]]);
+  }
+
+  // Central differences, one sided on the boundary of the image.
+  void Gradient(int i, int j, int k, const double spacing[3],
+                double g[3]) const
+  {
+    const int ijk[3] = { i, j, k };
+    for (int a = 0; a < 3; ++a) {
+      int before[3] = { i, j, k };
+      int after[3] = { i, j, k };
+      before[a] = std::max(ijk[a] - 1, 0);
+      after[a] = std::min(ijk[a] + 1, this->Dims[a] - 1);
+      const double h = (after[a] - before[a]) * spacing[a];
+      g[a] = h > 0 ? (this->Value(after[0], after[1], after[2]) -
+                      this->Value(before[0], before[1], before[2])) /
+                       h
+                   : 0;
+    }
+  }
+
+private:
+  const T* Scalars;
+  int NumberOfComponents;
+  int Dims[3];
+  vtkIdType Strides[3];
+};
+
+template <typename T>
+class ComputeRanges
+{
+public:
+  ComputeRanges(const ImageScalars<T>& scalars, std::vector<Brick>& bricks)
+    : Scalars(scalars), Bricks(bricks)
+  {
+  }
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    for (vtkIdType b = begin; b < end; ++b) {
+      Brick& brick = this->Bricks[b];
+      const int* e = brick.Extent;
+      double min = std::numeric_limits<double>::infinity();
+      double max = -std::numeric_limits<double>::infinity();
+      for (int k = e[4]; k <= e[5]; ++k) {
+        for (int j = e[2]; j <= e[3]; ++j) {
+          for (int i = e[0]; i <= e[1]; ++i) {
+            const double value = this->Scalars.Value(i, j, k);
+            // Comparisons with NaN are false, they are skipped.
+            if (value < min) {
+              min = value;
+            }
+            if (value > max) {
+              max = value;
+            }
+          }
+        }
+      }
+      brick.Min = min;
+      brick.Max = max;
+    }
+  }
+
+private:
+  const ImageScalars<T>& Scalars;
+  std::vector<Brick>& Bricks;
+};
+
+// The part of a surface in a brick.
+struct BrickSurface
+{
+  std::vector<float> Points;
+  std::vector<float> Normals;
+  std::vector<vtkIdType> Triangles;
+};
+
+template <typename T>
+class ContourBricks
+{
+public:
+  ContourBricks(const ImageScalars<T>& scalars, const int dims[3],
+                const double origin[3], const double spacing[3], double value,
+                bool computeNormals, int brickSize,
+                const std::vector<const Brick*>& bricks,
+                std::vector<BrickSurface>& surfaces)
+    : Scalars(scalars), ContourValue(value), ComputeNormals(computeNormals),
+      Bricks(bricks), Surfaces(surfaces)
+  {
+    std::copy(origin, origin + 3, this->Origin);
+    std::copy(spacing, spacing + 3, this->Spacing);
+    // The largest number of points of a brick along each axis.
+    for (int a = 0; a < 3; ++a) {
+      this->BrickPoints[a] = std::min(brickSize, dims[a] - 1) + 1;
+    }
+  }
+
+  void Initialize()
+  {
+    // An output point id for each edge of a brick, -1 until it is generated.
+    this->EdgePoints.Local().assign(
+      3 * this->BrickPoints[0] * this->BrickPoints[1] * this->BrickPoints[2],
+      -1);
+  }
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    for (vtkIdType b = begin; b < end; ++b) {
+      this->Contour(*this->Bricks[b], this->Surfaces[b]);
+    }
+  }
+
+  void Reduce() {}
+
+private:
+  void Contour(const Brick& brick, BrickSurface& surface)
+  {
+    vtkMarchingCubesTriangleCases* cases =
+      vtkMarchingCubesTriangleCases::GetCases();
+    std::vector<vtkIdType>& edgePoints = this->EdgePoints.Local();
+    std::vector<size_t>& generated = this->Generated.Local();
+    const int* e = brick.Extent;
+    double s[8];
+    for (int k = e[4]; k < e[5]; ++k) {
+      for (int j = e[2]; j < e[3]; ++j) {
+        for (int i = e[0]; i < e[1]; ++i) {
+          int index = 0;
+          for (int c = 0; c < 8; ++c) {
+            s[c] = this->Scalars.Value(i + CELL_POINTS[c][0],
+                                       j + CELL_POINTS[c][1],
+                                       k + CELL_POINTS[c][2]);
+            if (s[c] >= this->ContourValue) {
+              index |= 1 << c;
+            }
+          }
+          if (index == 0 || index == 255) {
+            continue;
+          }
+          for (const int* edge = cases[index].edges; edge[0] > -1;
+               edge += 3) {
+            for (int v = 0; v < 3; ++v) {
+              surface.Triangles.push_back(this->EdgePoint(
+                brick, i, j, k, edge[v], s, surface, edgePoints, generated));
+            }
+          }
+        }
+      }
+    }
+
+    for (size_t edge : generated) {
+      edgePoints[edge] = -1;
+    }
+    generated.clear();
+  }
+
+  // The id of the point where the surface crosses an edge of cell (i, j, k),
+  // generated the first time a cell of the brick uses the edge.
+  vtkIdType EdgePoint(const Brick& brick, int i, int j, int k, int edge,
+                      const double s[8], BrickSurface& surface,
+                      std::vector<vtkIdType>& edgePoints,
+                      std::vector<size_t>& generated)
+  {
+    const int* e = brick.Extent;
+    const int* first = CELL_POINTS[CELL_EDGES[edge][0]];
+    const int ijk[3] = { i + first[0], j + first[1], k + first[2] };
+    const int axis = EDGE_AXES[edge];
+    const size_t key =
+      3 * (((ijk[2] - e[4]) * this->BrickPoints[1] + (ijk[1] - e[2])) *
+             this->BrickPoints[0] +
+           (ijk[0] - e[0])) +
+      axis;
+    if (edgePoints[key] >= 0) {
+      return edgePoints[key];
+    }
+
+    const double s0 = s[CELL_EDGES[edge][0]];
+    const double s1 = s[CELL_EDGES[edge][1]];
+    const double t = (this->ContourValue - s0) / (s1 - s0);
+    const vtkIdType id = static_cast<vtkIdType>(surface.Points.size() / 3);
+    for (int a = 0; a < 3; ++a) {
+      const double x = ijk[a] + (a == axis ? t : 0);
+      surface.Points.push_back(
+        static_cast<float>(this->Origin[a] + x * this->Spacing[a]));
+    }
+    if (this->ComputeNormals) {
+      int next[3] = { ijk[0], ijk[1], ijk[2] };
+      ++next[axis];
+      double g0[3], g1[3], n[3];
+      this->Scalars.Gradient(ijk[0], ijk[1], ijk[2], this->Spacing, g0);
+      this->Scalars.Gradient(next[0], next[1], next[2], this->Spacing, g1);
+      // Pointing towards lower values, out of the brighter regions.
+      for (int a = 0; a < 3; ++a) {
+        n[a] = -(g0[a] + t * (g1[a] - g0[a]));
+      }
+      vtkMath::Normalize(n);
+      surface.Normals.insert(surface.Normals.end(), n, n + 3);
+    }
+
+    edgePoints[key] = id;
+    generated.push_back(key);
+    return id;
+  }
+
+  const ImageScalars<T>& Scalars;
+  double Origin[3];
+  double Spacing[3];
+  double ContourValue;
+  bool ComputeNormals;
+  size_t BrickPoints[3];
+  const std::vector<const Brick*>& Bricks;
+  std::vector<BrickSurface>& Surfaces;
+  vtkSMPThreadLocal<std::vector<vtkIdType>> EdgePoints;
+  vtkSMPThreadLocal<std::vector<size_t>> Generated;
+};
+
+// Copy the surfaces of the bricks to the output arrays, at the given offsets.
+class MergeBricks
+{
+public:
+  MergeBricks(const std::vector<BrickSurface>& surfaces,
+              const std::vector<vtkIdType>& pointOffsets,
+              const std::vector<vtkIdType>& triangleOffsets, float* points,
+              float* normals, vtkIdType* cells)
+    : Surfaces(surfaces), PointOffsets(pointOffsets),
+      TriangleOffsets(triangleOffsets), Points(points), Normals(normals),
+      Cells(cells)
+  {
+  }
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    for (vtkIdType b = begin; b < end; ++b) {
+      const BrickSurface& surface = this->Surfaces[b];
+      const vtkIdType offset = this->PointOffsets[b];
+      std::copy(surface.Points.begin(), surface.Points.end(),
+                this->Points + 3 * offset);
+      if (this->Normals) {
+        std::copy(surface.Normals.begin(), surface.Normals.end(),
+                  this->Normals + 3 * offset);
+      }
+      vtkIdType* cell = this->Cells + 4 * this->TriangleOffsets[b];
+      for (size_t t = 0; t < surface.Triangles.size(); t += 3) {
+        cell[0] = 3;
+        for (int v = 0; v < 3; ++v) {
+          cell[v + 1] = offset + surface.Triangles[t + v];
+        }
+        cell += 4;
+      }
+    }
+  }
+
+private:
+  const std::vector<BrickSurface>& Surfaces;
+  const std::vector<vtkIdType>& PointOffsets;
+  const std::vector<vtkIdType>& TriangleOffsets;
+  float* Points;
+  float* Normals;
+  vtkIdType* Cells;
+};
+
+// The number of bricks along the axes of an image.
+void BrickCounts(const int dims[3], int brickSize, int counts[3])
+{
+  for (int a = 0; a < 3; ++a) {
+    counts[a] = (dims[a] - 2) / brickSize + 1;
+  }
+}
+
+// Whether the ranges computed elsewhere are those of the bricks of the
+// scalars, rather than of other scalars or of an older version of them.
+bool AreBrickRanges(vtkDataArray* ranges, vtkDataArray* scalars,
+                    const int dims[3], int brickSize)
+{
+  if (!ranges || ranges->GetNumberOfComponents() != 2 ||
+      ranges->GetMTime() <= scalars->GetMTime()) {
+    return false;
+  }
+  int counts[3];
+  BrickCounts(dims, brickSize, counts);
+  if (ranges->GetNumberOfTuples() !=
+      static_cast<vtkIdType>(counts[0]) * counts[1] * counts[2]) {
+    return false;
+  }
+  const char* name = ranges->GetName();
+  const char* scalarsName = scalars->GetName();
+  return strcmp(name ? name : "", scalarsName ? scalarsName : "") == 0;
+}
+
+template <typename T>
+void ComputeBricks(const ImageScalars<T>& scalars, const int dims[3],
+                   int brickSize, vtkDataArray* ranges,
+                   std::vector<Brick>& bricks)
+{
+  int counts[3];
+  BrickCounts(dims, brickSize, counts);
+  bricks.clear();
+  for (int k = 0; k < counts[2]; ++k) {
+    for (int j = 0; j < counts[1]; ++j) {
+      for (int i = 0; i < counts[0]; ++i) {
+        Brick brick;
+        const int index[3] = { i, j, k };
+        for (int a = 0; a < 3; ++a) {
+          const int first = index[a] * brickSize;
+          brick.Extent[2 * a] = first;
+          brick.Extent[2 * a + 1] =
+            first + std::min(brickSize, dims[a] - 1 - first);
+        }
+        bricks.push_back(brick);
+      }
+    }
+  }
+
+  if (ranges) {
+    // Computed elsewhere, for the bricks in the same order.
+    for (size_t b = 0; b < bricks.size(); ++b) {
+      bricks[b].Min = ranges->GetComponent(static_cast<vtkIdType>(b), 0);
+      bricks[b].Max = ranges->GetComponent(static_cast<vtkIdType>(b), 1);
+    }
+  } else {
+    ComputeRanges<T> compute(scalars, bricks);
+    vtkSMPTools::For(0, static_cast<vtkIdType>(bricks.size()), compute);
+  }
+
+  // Sorted by minimum, the bricks whose minimum is below a contour value are
+  // a prefix.
+  std::stable_sort(
+    bricks.begin(), bricks.end(),
+    [](const Brick& a, const Brick& b) { return a.Min < b.Min; });
+}
+
+template <typename T>
+vtkSmartPointer<vtkPolyData> Contour(const ImageScalars<T>& scalars,
+                                     vtkImageData* image,
+                                     const std::vector<Brick>& bricks,
+                                     int brickSize, double value,
+                                     bool computeNormals)
+{
+  // The bricks the surface goes through, some of their points are below the
+  // value and some are not.
+  std::vector<const Brick*> active;
+  auto end = std::lower_bound(
+    bricks.begin(), bricks.end(), value,
+    [](const Brick& brick, double v) { return brick.Min < v; });
+  for (auto brick = bricks.begin(); brick != end; ++brick) {
+    if (brick->Max >= value) {
+      active.push_back(&*brick);
+    }
+  }
+
+  double origin[3], spacing[3];
+  int dims[3], extent[6];
+  image->GetDimensions(dims);
+  image->GetOrigin(origin);
+  image->GetSpacing(spacing);
+  image->GetExtent(extent);
+  for (int a = 0; a < 3; ++a) {
+    origin[a] += extent[2 * a] * spacing[a];
+  }
+
+  std::vector<BrickSurface> surfaces(active.size());
+  ContourBricks<T> contour(scalars, dims, origin, spacing, value,
+                           computeNormals, brickSize, active, surfaces);
+  vtkSMPTools::For(0, static_cast<vtkIdType>(active.size()), 1, contour);
+
+  std::vector<vtkIdType> pointOffsets(surfaces.size() + 1, 0);
+  std::vector<vtkIdType> triangleOffsets(surfaces.size() + 1, 0);
+  for (size_t b = 0; b < surfaces.size(); ++b) {
+    pointOffsets[b + 1] = pointOffsets[b] + surfaces[b].Points.size() / 3;
+    triangleOffsets[b + 1] =
+      triangleOffsets[b] + surfaces[b].Triangles.size() / 3;
+  }
+  const vtkIdType numberOfPoints = pointOffsets.back();
+  const vtkIdType numberOfTriangles = triangleOffsets.back();
+
+  vtkNew<vtkPoints> points;
+  points->SetDataTypeToFloat();
+  points->SetNumberOfPoints(numberOfPoints);
+  vtkNew<vtkFloatArray> normals;
+  normals->SetName("Normals");
+  normals->SetNumberOfComponents(3);
+  normals->SetNumberOfTuples(computeNormals ? numberOfPoints : 0);
+  vtkNew<vtkIdTypeArray> connectivity;
+  connectivity->SetNumberOfValues(4 * numberOfTriangles);
+
+  MergeBricks merge(surfaces, pointOffsets, triangleOffsets,
+                    static_cast<float*>(points->GetVoidPointer(0)),
+                    computeNormals ? normals->GetPointer(0) : nullptr,
+                    connectivity->GetPointer(0));
+  vtkSMPTools::For(0, static_cast<vtkIdType>(surfaces.size()), 1, merge);
+
+  auto surface = vtkSmartPointer<vtkPolyData>::New();
+  vtkNew<vtkCellArray> triangles;
+  triangles->SetCells(numberOfTriangles, connectivity.Get());
+  surface->SetPoints(points.Get());
+  surface->SetPolys(triangles.Get());
+  if (computeNormals) {
+    surface->GetPointData()->SetNormals(normals.Get());
+  }
+  return surface;
+}
+} // namespace
+
+class vtkImageBrickContour::vtkInternals
+{
+public:
+  // The bricks and the surfaces computed from an input.
+  struct State
+  {
+    vtkMTimeType InputTime;
+    vtkDataArray* Scalars;
+    int BrickSize;
+    int ComputeNormals;
+    std::vector<Brick> Bricks;
+    // The most recently used first.
+    std::list<std::pair<double, vtkSmartPointer<vtkPolyData>>> Surfaces;
+  };
+
+  // Make the state of these the current one, returns whether its bricks were
+  // computed already. The states of the last two inputs are kept, so that
+  // going back and forth between an image and a coarser version of it (while
+  // interacting) doesn't compute them again.
+  bool Select(vtkImageData* input, vtkDataArray* scalars, int brickSize,
+              int computeNormals)
+  {
+    for (auto it = this->States.begin(); it != this->States.end(); ++it) {
+      if (it->InputTime == input->GetMTime() && it->Scalars == scalars &&
+          it->BrickSize == brickSize && it->ComputeNormals == computeNormals) {
+        this->States.splice(this->States.begin(), this->States, it);
+        return true;
+      }
+    }
+    State state;
+    state.InputTime = input->GetMTime();
+    state.Scalars = scalars;
+    state.BrickSize = brickSize;
+    state.ComputeNormals = computeNormals;
+    this->States.push_front(state);
+    while (this->States.size() > 2) {
+      this->States.pop_back();
+    }
+    return false;
+  }
+
+  std::vector<Brick>& Bricks() { return this->States.front().Bricks; }
+
+  // The surface of a value, which becomes the most recently used.
+  vtkPolyData* Find(double value)
+  {
+    auto& surfaces = this->States.front().Surfaces;
+    for (auto it = surfaces.begin(); it != surfaces.end(); ++it) {
+      if (it->first == value) {
+        surfaces.splice(surfaces.begin(), surfaces, it);
+        return it->second;
+      }
+    }
+    return nullptr;
+  }
+
+  void Insert(double value, vtkPolyData* surface, size_t cacheSize)
+  {
+    auto& surfaces = this->States.front().Surfaces;
+    surfaces.push_front(std::make_pair(value, surface));
+    while (surfaces.size() > cacheSize) {
+      surfaces.pop_back();
+    }
+  }
+
+private:
+  // The current state first.
+  std::list<State> States;
+};
+
+vtkStandardNewMacro(vtkImageBrickContour)
+vtkCxxSetObjectMacro(vtkImageBrickContour, BrickRanges, vtkDataArray)
+
+vtkImageBrickContour::vtkImageBrickContour()
+  : ContourValues(vtkContourValues::New()), ComputeNormals(1),
+    ComputeScalars(0), BrickSize(32), CacheSize(8), BrickRanges(nullptr),
+    Internals(new vtkInternals)
+{
+  // By default process the active point scalars.
+  this->SetInputArrayToProcess(0, 0, 0, vtkDataObject::FIELD_ASSOCIATION_POINTS,
+                               vtkDataSetAttributes::SCALARS);
+}
+
+vtkImageBrickContour::~vtkImageBrickContour()
+{
+  this->ContourValues->Delete();
+  this->SetBrickRanges(nullptr);
+  delete this->Internals;
+}
+
+void vtkImageBrickContour::SetValue(int i, double value)
+{
+  this->ContourValues->SetValue(i, value);
+}
+
+double vtkImageBrickContour::GetValue(int i)
+{
+  return this->ContourValues->GetValue(i);
+}
+
+void vtkImageBrickContour::SetNumberOfContours(int number)
+{
+  this->ContourValues->SetNumberOfContours(number);
+}
+
+int vtkImageBrickContour::GetNumberOfContours()
+{
+  return this->ContourValues->GetNumberOfContours();
+}
+
+vtkMTimeType vtkImageBrickContour::GetMTime()
+{
+  return std::max(this->Superclass::GetMTime(),
+                  this->ContourValues->GetMTime());
+}
+
+int vtkImageBrickContour::FillInputPortInformation(int, vtkInformation* info)
+{
+  info->Set(vtkAlgorithm::INPUT_REQUIRED_DATA_TYPE(), "vtkImageData");
+  return 1;
+}
+
+int vtkImageBrickContour::RequestData(vtkInformation*,
+                                      vtkInformationVector** inputVector,
+                                      vtkInformationVector* outputVector)
+{
+  vtkImageData* input = vtkImageData::GetData(inputVector[0]);
+  vtkPolyData* output = vtkPolyData::GetData(outputVector);
+
+  vtkDataArray* scalars = this->GetInputArrayToProcess(0, inputVector);
+  if (!scalars) {
+    vtkErrorMacro("No point scalars to contour.");
+    return 0;
+  }
+  int dims[3];
+  input->GetDimensions(dims);
+  if (dims[0] < 2 || dims[1] < 2 || dims[2] < 2) {
+    return 1;
+  }
+
+  vtkInternals* internals = this->Internals;
+  const int numberOfComponents = scalars->GetNumberOfComponents();
+  if (!internals->Select(input, scalars, this->BrickSize,
+                         this->ComputeNormals)) {
+    vtkDataArray* ranges =
+      AreBrickRanges(this->BrickRanges, scalars, dims, this->BrickSize)
+        ? this->BrickRanges
+        : nullptr;
+    switch (scalars->GetDataType()) {
+      vtkTemplateMacro(ComputeBricks(
+        ImageScalars<VTK_TT>(static_cast<VTK_TT*>(scalars->GetVoidPointer(0)),
+                             numberOfComponents, dims),
+        dims, this->BrickSize, ranges, internals->Bricks()));
+      default:
+        vtkErrorMacro("Unsupported scalar type.");
+        return 0;
+    }
+  }
+
+  const int numberOfContours = this->ContourValues->GetNumberOfContours();
+  std::vector<vtkSmartPointer<vtkPolyData>> surfaces;
+  for (int i = 0; i < numberOfContours; ++i) {
+    const double value = this->ContourValues->GetValue(i);
+    vtkSmartPointer<vtkPolyData> surface = internals->Find(value);
+    if (!surface) {
+      switch (scalars->GetDataType()) {
+        vtkTemplateMacro(
+          surface = Contour(ImageScalars<VTK_TT>(
+                              static_cast<VTK_TT*>(scalars->GetVoidPointer(0)),
+                              numberOfComponents, dims),
+                            input, internals->Bricks(), this->BrickSize, value,
+                            this->ComputeNormals != 0));
+      }
+      internals->Insert(value, surface, this->CacheSize);
+    }
+
+    // The cached surfaces don't carry the scalars, they are added to a copy.
+    if (this->ComputeScalars) {
+      auto copy = vtkSmartPointer<vtkPolyData>::New();
+      copy->ShallowCopy(surface);
+      vtkSmartPointer<vtkDataArray> values;
+      values.TakeReference(scalars->NewInstance());
+      values->SetName(scalars->GetName());
+      values->SetNumberOfComponents(1);
+      values->SetNumberOfTuples(copy->GetNumberOfPoints());
+      values->FillComponent(0, value);
+      copy->GetPointData()->SetScalars(values);
+      surface = copy;
+    }
+    surfaces.push_back(surface);
+    this->UpdateProgress(static_cast<double>(i + 1) / numberOfContours);
+  }
+
+  if (surfaces.size() == 1) {
+    output->ShallowCopy(surfaces[0]);
+  } else if (surfaces.size() > 1) {
+    vtkNew<vtkAppendPolyData> append;
+    for (auto& surface : surfaces) {
+      append->AddInputData(surface);
+    }
+    append->Update();
+    output->ShallowCopy(append->GetOutput());
+  }
+  return 1;
+}
+
+void vtkImageBrickContour::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+  this->ContourValues->PrintSelf(os, indent.GetNextIndent());
+  os << indent << "ComputeNormals: " << this->ComputeNormals << endl;
+  os << indent << "ComputeScalars: " << this->ComputeScalars << endl;
+  os << indent << "BrickSize: " << this->BrickSize << endl;
+  os << indent << "CacheSize: " << this->CacheSize << endl;
+  os << indent << "BrickRanges: " << this->BrickRanges << endl;
+}
@@ -0,0 +1,112 @@
+/******************************************************************************
+
+  This source file is part of the tomviz project.
+
+  Copyright Kitware, Inc.
+
+  This source code is released under the New BSD License, (the "License").
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+******************************************************************************/
+
+#ifndef vtkImageBrickContour_h
+#define vtkImageBrickContour_h
+
+#include "vtkPolyDataAlgorithm.h"
+
+class vtkContourValues;
+class vtkDataArray;
+
+/**
+ * Isosurfaces of an image, extracted by marching cubes. The image is split
+ * into bricks and the range of the scalars of each brick is computed once,
+ * so that only the bricks an isosurface goes through are visited, in
+ * parallel. The surfaces of the last contour values are kept, going back to
+ * one of them (scrubbing a slider) doesn't extract it again. The bricks and
+ * surfaces of the last two inputs are kept, switching to a coarser input
+ * while interacting and back doesn't compute them again.
+ *
+ * Neighboring bricks don't share the points on their common faces, the
+ * points are duplicated there.
+ */
+class vtkImageBrickContour : public vtkPolyDataAlgorithm
+{
+public:
+  static vtkImageBrickContour* New();
+  vtkTypeMacro(vtkImageBrickContour, vtkPolyDataAlgorithm)
+  void PrintSelf(ostream& os, vtkIndent indent) VTK_OVERRIDE;
+
+  /**
+   * The contour values, as for vtkFlyingEdges3D.
+   */
+  void SetValue(int i, double value);
+  double GetValue(int i);
+  void SetNumberOfContours(int number);
+  int GetNumberOfContours();
+
+  /**
+   * Generate point normals from the gradient of the scalars, on by default.
+   */
+  vtkSetMacro(ComputeNormals, int)
+  vtkGetMacro(ComputeNormals, int)
+  vtkBooleanMacro(ComputeNormals, int)
+
+  /**
+   * Add point scalars holding the contour value, off by default.
+   */
+  vtkSetMacro(ComputeScalars, int)
+  vtkGetMacro(ComputeScalars, int)
+  vtkBooleanMacro(ComputeScalars, int)
+
+  /**
+   * The number of cells along the sides of the bricks, 32 by default.
+   */
+  vtkSetClampMacro(BrickSize, int, 1, VTK_INT_MAX)
+  vtkGetMacro(BrickSize, int)
+
+  /**
+   * The number of contour values whose surface is kept, 8 by default.
+   */
+  vtkSetClampMacro(CacheSize, int, 0, VTK_INT_MAX)
+  vtkGetMacro(CacheSize, int)
+
+  /**
+   * The ranges of the scalars in the bricks, computed elsewhere, a 2
+   * component array with a tuple per brick, x fastest. They are used instead
+   * of computing them when they are named after the scalars, newer than
+   * them, and there are as many as bricks. nullptr by default.
+   */
+  virtual void SetBrickRanges(vtkDataArray* ranges);
+  vtkGetObjectMacro(BrickRanges, vtkDataArray)
+
+  vtkMTimeType GetMTime() VTK_OVERRIDE;
+
+protected:
+  vtkImageBrickContour();
+  ~vtkImageBrickContour() VTK_OVERRIDE;
+
+  int FillInputPortInformation(int port, vtkInformation* info) VTK_OVERRIDE;
+  int RequestData(vtkInformation* request, vtkInformationVector** inputVector,
+                  vtkInformationVector* outputVector) VTK_OVERRIDE;
+
+  vtkContourValues* ContourValues;
+  int ComputeNormals;
+  int ComputeScalars;
+  int BrickSize;
+  int CacheSize;
+  vtkDataArray* BrickRanges;
+
+private:
+  vtkImageBrickContour(const vtkImageBrickContour&) VTK_DELETE_FUNCTION;
+  void operator=(const vtkImageBrickContour&) VTK_DELETE_FUNCTION;
+
+  class vtkInternals;
+  vtkInternals* Internals;
+};
+
+#endif
@@ -0,0 +1,457 @@
+/******************************************************************************
+
+  This source file is part of the tomviz project.
+
+  Copyright Kitware, Inc.
+
+  This source code is released under the New BSD License, (the "License").
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+******************************************************************************/
+#include "vtkImageThresholdSurface.h"
+
+#include "vtkCellArray.h"
+#include "vtkDataArray.h"
+#include "vtkIdTypeArray.h"
+#include "vtkImageData.h"
+#include "vtkInformation.h"
+#include "vtkInformationVector.h"
+#include "vtkNew.h"
+#include "vtkObjectFactory.h"
+#include "vtkPointData.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkSMPThreadLocal.h"
+#include "vtkSMPTools.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+namespace {
+
+// The cells of an image, which of them are selected, and the faces of the
+// surface of the selection. Point (i, j, k) of the image is the point
+// i + j * dims[0] + k * dims[0] * dims[1], the first point of cell (i, j, k).
+// Along an axis of a single point (a 2D image) the cells are flat.
+class Surface
+{
+public:
+  Surface(const int dims[3])
+  {
+    size_t numberOfCells = 1;
+    for (int a = 0; a < 3; ++a) {
+      this->Dims[a] = dims[a];
+      this->Steps[a] = dims[a] > 1 ? 1 : 0;
+      this->CellDims[a] = std::max(dims[a] - 1, 1);
+      numberOfCells *= this->CellDims[a];
+    }
+    this->Strides[0] = 1;
+    this->Strides[1] = dims[0];
+    this->Strides[2] = static_cast<vtkIdType>(dims[0]) * dims[1];
+    // Faces are only generated across an axis if the cells are not flat
+    // along the other two, and across a flat axis only on one side.
+    for (int a = 0; a < 3; ++a) {
+      bool square = this->Steps[(a + 1) % 3] && this->Steps[(a + 2) % 3];
+      this->Sides[a] = square ? 1 + this->Steps[a] : 0;
+    }
+    this->Selected.assign(numberOfCells, 0);
+  }
+
+  int NumberOfPlanes() const { return this->Dims[2]; }
+  int NumberOfSlabs() const { return this->CellDims[2]; }
+  vtkIdType SliceSize() const { return this->Strides[2]; }
+
+  // The plane after the first plane of points of a slab.
+  int NextPlane(int slab) const { return slab + this->Steps[2]; }
+
+  // Select the cells of slab k whose points are all within the range.
+  template <typename T>
+  void SelectSlab(const T* scalars, int numberOfComponents, double lower,
+                  double upper, int k)
+  {
+    for (int j = 0; j < this->CellDims[1]; ++j) {
+      for (int i = 0; i < this->CellDims[0]; ++i) {
+        const vtkIdType first =
+          i + j * this->Strides[1] + k * this->Strides[2];
+        bool selected = true;
+        for (int c = 0; c < 8 && selected; ++c) {
+          const vtkIdType point =
+            first + (c & 1) * this->Steps[0] * this->Strides[0] +
+            (c >> 1 & 1) * this->Steps[1] * this->Strides[1] +
+            (c >> 2) * this->Steps[2] * this->Strides[2];
+          const double value = scalars[point * numberOfComponents];
+          selected = value >= lower && value <= upper;
+        }
+        this->Selected[this->Cell(i, j, k)] = selected ? 1 : 0;
+      }
+    }
+  }
+
+  // Call f(corners) for each face of the surface in slab k, the corners are
+  // the ids of the points of the quad, counterclockwise seen from outside.
+  template <typename F>
+  void ForEachFace(int k, F&& f) const
+  {
+    vtkIdType corners[4];
+    for (int j = 0; j < this->CellDims[1]; ++j) {
+      for (int i = 0; i < this->CellDims[0]; ++i) {
+        if (!this->Selected[this->Cell(i, j, k)]) {
+          continue;
+        }
+        const int cell[3] = { i, j, k };
+        for (int a = 0; a < 3; ++a) {
+          for (int side = 0; side < this->Sides[a]; ++side) {
+            int neighbor[3] = { i, j, k };
+            neighbor[a] += side ? 1 : -1;
+            if (neighbor[a] >= 0 && neighbor[a] < this->CellDims[a] &&
+                this->Selected[this->Cell(neighbor[0], neighbor[1],
+                                          neighbor[2])]) {
+              continue;
+            }
+            vtkIdType base = 0;
+            for (int axis = 0; axis < 3; ++axis) {
+              base += cell[axis] * this->Strides[axis];
+            }
+            base += side * this->Steps[a] * this->Strides[a];
+            // (b, c, a) is right handed, so going around the face along b
+            // then c faces +a.
+            vtkIdType b = this->Strides[(a + 1) % 3];
+            vtkIdType c = this->Strides[(a + 2) % 3];
+            if (!side) {
+              std::swap(b, c);
+            }
+            corners[0] = base;
+            corners[1] = base + b;
+            corners[2] = base + b + c;
+            corners[3] = base + c;
+            f(corners);
+          }
+        }
+      }
+    }
+  }
+
+private:
+  size_t Cell(int i, int j, int k) const
+  {
+    return (static_cast<size_t>(k) * this->CellDims[1] + j) *
+             this->CellDims[0] +
+           i;
+  }
+
+  int Dims[3];
+  int Steps[3];
+  int CellDims[3];
+  int Sides[3];
+  vtkIdType Strides[3];
+  std::vector<unsigned char> Selected;
+};
+
+template <typename T>
+class SelectCells
+{
+public:
+  SelectCells(Surface& surface, const T* scalars, int numberOfComponents,
+              double lower, double upper)
+    : Output(surface), Scalars(scalars),
+      NumberOfComponents(numberOfComponents), Lower(lower), Upper(upper)
+  {
+  }
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    for (vtkIdType k = begin; k < end; ++k) {
+      this->Output.SelectSlab(this->Scalars, this->NumberOfComponents,
+                              this->Lower, this->Upper, static_cast<int>(k));
+    }
+  }
+
+private:
+  Surface& Output;
+  const T* Scalars;
+  int NumberOfComponents;
+  double Lower;
+  double Upper;
+};
+
+// Find the points of each plane used by the surface, in increasing order,
+// and count the faces of each slab.
+class CountSurface
+{
+public:
+  CountSurface(const Surface& surface,
+               std::vector<std::vector<vtkIdType>>& planePoints,
+               std::vector<vtkIdType>& faceCounts)
+    : Input(surface), PlanePoints(planePoints), FaceCounts(faceCounts)
+  {
+  }
+
+  void Initialize()
+  {
+    this->Used.Local().assign(this->Input.SliceSize(), 0);
+  }
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    std::vector<unsigned char>& used = this->Used.Local();
+    const vtkIdType sliceSize = this->Input.SliceSize();
+    for (vtkIdType p = begin; p < end; ++p) {
+      const int plane = static_cast<int>(p);
+      // The points of the plane are used by the faces of the slab before it
+      // and of the slab starting on it.
+      for (int slab = std::max(plane - 1, 0);
+           slab <= std::min(plane, this->Input.NumberOfSlabs() - 1); ++slab) {
+        const vtkIdType planeBegin = plane * sliceSize;
+        vtkIdType faces = 0;
+        this->Input.ForEachFace(slab, [&](const vtkIdType* corners) {
+          ++faces;
+          for (int c = 0; c < 4; ++c) {
+            vtkIdType local = corners[c] - planeBegin;
+            if (local >= 0 && local < sliceSize) {
+              used[local] = 1;
+            }
+          }
+        });
+        if (slab == plane) {
+          this->FaceCounts[slab] = faces;
+        }
+      }
+
+      std::vector<vtkIdType>& points = this->PlanePoints[plane];
+      for (vtkIdType i = 0; i < sliceSize; ++i) {
+        if (used[i]) {
+          points.push_back(i);
+          used[i] = 0;
+        }
+      }
+    }
+  }
+
+  void Reduce() {}
+
+private:
+  const Surface& Input;
+  std::vector<std::vector<vtkIdType>>& PlanePoints;
+  std::vector<vtkIdType>& FaceCounts;
+  vtkSMPThreadLocal<std::vector<unsigned char>> Used;
+};
+
+// Write the points of each plane, with their point data, and the quads of
+// each slab.
+class FillSurface
+{
+public:
+  FillSurface(const Surface& surface, vtkImageData* image,
+              const std::vector<std::vector<vtkIdType>>& planePoints,
+              const std::vector<vtkIdType>& pointOffsets,
+              const std::vector<vtkIdType>& faceOffsets, vtkPointData* inPD,
+              vtkPointData* outPD, float* points, vtkIdType* cells)
+    : Input(surface), PlanePoints(planePoints), PointOffsets(pointOffsets),
+      FaceOffsets(faceOffsets), Points(points), Cells(cells)
+  {
+    image->GetOrigin(this->Origin);
+    image->GetSpacing(this->Spacing);
+    image->GetDimensions(this->Dims);
+    int extent[6];
+    image->GetExtent(extent);
+    for (int a = 0; a < 3; ++a) {
+      this->Origin[a] += extent[2 * a] * this->Spacing[a];
+    }
+    for (int i = 0; i < outPD->GetNumberOfArrays(); ++i) {
+      vtkAbstractArray* out = outPD->GetAbstractArray(i);
+      vtkAbstractArray* in = inPD->GetAbstractArray(out->GetName());
+      if (in) {
+        this->Arrays.push_back(std::make_pair(in, out));
+      }
+    }
+  }
+
+  void Initialize()
+  {
+    this->Ids.Local().resize(2 * this->Input.SliceSize());
+  }
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    const vtkIdType sliceSize = this->Input.SliceSize();
+    for (vtkIdType p = begin; p < end; ++p) {
+      const int plane = static_cast<int>(p);
+      const std::vector<vtkIdType>& points = this->PlanePoints[plane];
+      vtkIdType id = this->PointOffsets[plane];
+      for (vtkIdType local : points) {
+        const vtkIdType i = local % this->Dims[0];
+        const vtkIdType j = local / this->Dims[0];
+        float* x = this->Points + 3 * id;
+        x[0] = static_cast<float>(this->Origin[0] + i * this->Spacing[0]);
+        x[1] = static_cast<float>(this->Origin[1] + j * this->Spacing[1]);
+        x[2] = static_cast<float>(this->Origin[2] + plane * this->Spacing[2]);
+        for (auto& array : this->Arrays) {
+          array.second->SetTuple(id, plane * sliceSize + local, array.first);
+        }
+        ++id;
+      }
+
+      if (plane < this->Input.NumberOfSlabs()) {
+        this->WriteSlab(plane);
+      }
+    }
+  }
+
+  void Reduce() {}
+
+private:
+  void WriteSlab(int slab)
+  {
+    // The output ids of the points of the two planes of the slab.
+    const vtkIdType sliceSize = this->Input.SliceSize();
+    std::vector<vtkIdType>& ids = this->Ids.Local();
+    const int planes[2] = { slab, this->Input.NextPlane(slab) };
+    for (int n = 0; n < 2; ++n) {
+      vtkIdType id = this->PointOffsets[planes[n]];
+      for (vtkIdType local : this->PlanePoints[planes[n]]) {
+        ids[n * sliceSize + local] = id++;
+      }
+    }
+
+    const vtkIdType planeBegin = slab * sliceSize;
+    vtkIdType* cell = this->Cells + 5 * this->FaceOffsets[slab];
+    this->Input.ForEachFace(slab, [&](const vtkIdType* corners) {
+      cell[0] = 4;
+      for (int c = 0; c < 4; ++c) {
+        // Relative to the first plane, ids is laid out the same way.
+        cell[c + 1] = ids[corners[c] - planeBegin];
+      }
+      cell += 5;
+    });
+  }
+
+  const Surface& Input;
+  const std::vector<std::vector<vtkIdType>>& PlanePoints;
+  const std::vector<vtkIdType>& PointOffsets;
+  const std::vector<vtkIdType>& FaceOffsets;
+  float* Points;
+  vtkIdType* Cells;
+  double Origin[3];
+  double Spacing[3];
+  int Dims[3];
+  std::vector<std::pair<vtkAbstractArray*, vtkAbstractArray*>> Arrays;
+  vtkSMPThreadLocal<std::vector<vtkIdType>> Ids;
+};
+} // namespace
+
+vtkStandardNewMacro(vtkImageThresholdSurface)
+
+vtkImageThresholdSurface::vtkImageThresholdSurface()
+  : LowerThreshold(0), UpperThreshold(1)
+{
+  // By default process the active point scalars.
+  this->SetInputArrayToProcess(0, 0, 0, vtkDataObject::FIELD_ASSOCIATION_POINTS,
+                               vtkDataSetAttributes::SCALARS);
+}
+
+vtkImageThresholdSurface::~vtkImageThresholdSurface() = default;
+
+void vtkImageThresholdSurface::ThresholdBetween(double lower, double upper)
+{
+  if (this->LowerThreshold != lower || this->UpperThreshold != upper) {
+    this->LowerThreshold = lower;
+    this->UpperThreshold = upper;
+    this->Modified();
+  }
+}
+
+int vtkImageThresholdSurface::FillInputPortInformation(int,
+                                                       vtkInformation* info)
+{
+  info->Set(vtkAlgorithm::INPUT_REQUIRED_DATA_TYPE(), "vtkImageData");
+  return 1;
+}
+
+int vtkImageThresholdSurface::RequestData(vtkInformation*,
+                                          vtkInformationVector** inputVector,
+                                          vtkInformationVector* outputVector)
+{
+  vtkImageData* input = vtkImageData::GetData(inputVector[0]);
+  vtkPolyData* output = vtkPolyData::GetData(outputVector);
+
+  vtkDataArray* scalars = this->GetInputArrayToProcess(0, inputVector);
+  if (!scalars) {
+    vtkErrorMacro("No point scalars to threshold.");
+    return 0;
+  }
+  int dims[3];
+  input->GetDimensions(dims);
+  if (input->GetNumberOfPoints() == 0) {
+    return 1;
+  }
+
+  Surface surface(dims);
+  const int numberOfComponents = scalars->GetNumberOfComponents();
+  switch (scalars->GetDataType()) {
+    vtkTemplateMacro({
+      SelectCells<VTK_TT> select(
+        surface, static_cast<const VTK_TT*>(scalars->GetVoidPointer(0)),
+        numberOfComponents, this->LowerThreshold, this->UpperThreshold);
+      vtkSMPTools::For(0, surface.NumberOfSlabs(), select);
+    });
+    default:
+      vtkErrorMacro("Unsupported scalar type.");
+      return 0;
+  }
+  this->UpdateProgress(0.3);
+
+  const int numberOfPlanes = surface.NumberOfPlanes();
+  std::vector<std::vector<vtkIdType>> planePoints(numberOfPlanes);
+  std::vector<vtkIdType> faceCounts(surface.NumberOfSlabs(), 0);
+  CountSurface count(surface, planePoints, faceCounts);
+  vtkSMPTools::For(0, numberOfPlanes, 1, count);
+  this->UpdateProgress(0.6);
+
+  std::vector<vtkIdType> pointOffsets(numberOfPlanes + 1, 0);
+  for (int p = 0; p < numberOfPlanes; ++p) {
+    pointOffsets[p + 1] = pointOffsets[p] + planePoints[p].size();
+  }
+  std::vector<vtkIdType> faceOffsets(faceCounts.size() + 1, 0);
+  for (size_t s = 0; s < faceCounts.size(); ++s) {
+    faceOffsets[s + 1] = faceOffsets[s] + faceCounts[s];
+  }
+  const vtkIdType numberOfPoints = pointOffsets.back();
+  const vtkIdType numberOfFaces = faceOffsets.back();
+
+  vtkNew<vtkPoints> points;
+  points->SetDataTypeToFloat();
+  points->SetNumberOfPoints(numberOfPoints);
+  vtkNew<vtkIdTypeArray> connectivity;
+  connectivity->SetNumberOfValues(5 * numberOfFaces);
+
+  vtkPointData* inPD = input->GetPointData();
+  vtkPointData* outPD = output->GetPointData();
+  outPD->CopyAllocate(inPD, numberOfPoints);
+  for (int i = 0; i < outPD->GetNumberOfArrays(); ++i) {
+    outPD->GetAbstractArray(i)->SetNumberOfTuples(numberOfPoints);
+  }
+
+  FillSurface fill(surface, input, planePoints, pointOffsets, faceOffsets,
+                   inPD, outPD, static_cast<float*>(points->GetVoidPointer(0)),
+                   connectivity->GetPointer(0));
+  vtkSMPTools::For(0, numberOfPlanes, 1, fill);
+
+  vtkNew<vtkCellArray> polys;
+  polys->SetCells(numberOfFaces, connectivity.Get());
+  output->SetPoints(points.Get());
+  output->SetPolys(polys.Get());
+  return 1;
+}
+
+void vtkImageThresholdSurface::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+  os << indent << "LowerThreshold: " << this->LowerThreshold << endl;
+  os << indent << "UpperThreshold: " << this->UpperThreshold << endl;
+}
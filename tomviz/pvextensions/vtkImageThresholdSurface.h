@@ -0,0 +1,64 @@
+/******************************************************************************
+
+  This source file is part of the tomviz project.
+
+  Copyright Kitware, Inc.
+
+  This source code is released under the New BSD License, (the "License").
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+******************************************************************************/
+
+#ifndef vtkImageThresholdSurface_h
+#define vtkImageThresholdSurface_h
+
+#include "vtkPolyDataAlgorithm.h"
+
+/**
+ * The surface of the cells of an image whose points all have a scalar in a
+ * range, as rendered from the output of vtkThreshold. Only the quads between
+ * a selected cell and an unselected (or missing) one are generated, so the
+ * output grows with the area of the surface rather than with the volume
+ * selected. The points are points of the image and carry its point data.
+ *
+ * The image is processed by z slabs in parallel. Besides the output it only
+ * allocates a byte per cell for the selection, and a few slices per thread.
+ */
+class vtkImageThresholdSurface : public vtkPolyDataAlgorithm
+{
+public:
+  static vtkImageThresholdSurface* New();
+  vtkTypeMacro(vtkImageThresholdSurface, vtkPolyDataAlgorithm)
+  void PrintSelf(ostream& os, vtkIndent indent) VTK_OVERRIDE;
+
+  /**
+   * Select the cells whose points are all within [lower, upper], the same
+   * as vtkThreshold::ThresholdBetween().
+   */
+  void ThresholdBetween(double lower, double upper);
+  vtkGetMacro(LowerThreshold, double)
+  vtkGetMacro(UpperThreshold, double)
+
+protected:
+  vtkImageThresholdSurface();
+  ~vtkImageThresholdSurface() VTK_OVERRIDE;
+
+  int FillInputPortInformation(int port, vtkInformation* info) VTK_OVERRIDE;
+  int RequestData(vtkInformation* request, vtkInformationVector** inputVector,
+                  vtkInformationVector* outputVector) VTK_OVERRIDE;
+
+  double LowerThreshold;
+  double UpperThreshold;
+
+private:
+  vtkImageThresholdSurface(const vtkImageThresholdSurface&)
+    VTK_DELETE_FUNCTION;
+  void operator=(const vtkImageThresholdSurface&) VTK_DELETE_FUNCTION;
+};
+
+#endif
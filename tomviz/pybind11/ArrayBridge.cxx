@@ -0,0 +1,146 @@
+/******************************************************************************
+
+  This source file is part of the tomviz project.
+
+  Copyright Kitware, Inc.
+
+  This source code is released under the New BSD License, (the "License").
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+******************************************************************************/
+#include "ArrayBridge.h"
+
+#include "Utilities.h"
+
+#include <vtkCallbackCommand.h>
+#include <vtkDataArray.h>
+#include <vtkImageData.h>
+#include <vtkNew.h>
+#include <vtkPointData.h>
+#include <vtkSmartPointer.h>
+
+#include <mutex>
+#include <vector>
+
+namespace py = pybind11;
+
+namespace {
+
+// The arrays released by scalars deleted on threads without the GIL, waiting
+// for a thread holding it to drop them.
+std::mutex releasedMutex;
+std::vector<PyObject*> released;
+bool drainScheduled = false;
+
+// Called with the GIL held.
+int drainReleased(void* = nullptr)
+{
+  std::vector<PyObject*> arrays;
+  {
+    std::lock_guard<std::mutex> lock(releasedMutex);
+    arrays.swap(released);
+    drainScheduled = false;
+  }
+  for (auto array : arrays) {
+    Py_DECREF(array);
+  }
+  return 0;
+}
+
+void releaseArray(vtkObject*, unsigned long, void* clientData, void*)
+{
+  // The scalars may be deleted on any thread, or after the interpreter is
+  // gone along with the array.
+  if (!Py_IsInitialized()) {
+    return;
+  }
+  auto array = static_cast<PyObject*>(clientData);
+  if (PyGILState_Check()) {
+    Py_DECREF(array);
+    return;
+  }
+
+  // Waiting for the GIL would block this thread, often the UI one, for as
+  // long as an operator runs. Queue the array instead, the interpreter drops
+  // it between two instructions, or the next array conversion does.
+  std::lock_guard<std::mutex> lock(releasedMutex);
+  released.push_back(array);
+  if (!drainScheduled) {
+    // Fails when the interpreter's queue is full, the next release retries.
+    drainScheduled = Py_AddPendingCall(drainReleased, nullptr) == 0;
+  }
+}
+} // namespace
+
+py::object getArray(vtkImageData* image)
+{
+  drainReleased();
+  auto scalars = image->GetPointData()->GetScalars();
+  if (scalars == nullptr) {
+    return py::none();
+  }
+  auto dtype = tomviz::numpyType(scalars->GetDataType());
+  if (dtype.isEmpty() || !scalars->HasStandardMemoryLayout()) {
+    throw py::type_error("The scalars can't be viewed as a numpy array.");
+  }
+
+  int dims[3];
+  image->GetDimensions(dims);
+  py::ssize_t components = scalars->GetNumberOfComponents();
+  py::ssize_t itemSize = scalars->GetDataTypeSize();
+  py::ssize_t stride = components * itemSize;
+  std::vector<py::ssize_t> shape = { dims[0], dims[1], dims[2] };
+  std::vector<py::ssize_t> strides = { stride, stride * dims[0],
+                                       stride * dims[0] * dims[1] };
+  if (components > 1) {
+    shape.push_back(components);
+    strides.push_back(itemSize);
+  }
+
+  // The view holds a reference to the scalars until it is released.
+  scalars->Register(nullptr);
+  py::capsule base(scalars, [](void* array) {
+    static_cast<vtkDataArray*>(array)->UnRegister(nullptr);
+  });
+  return py::array(py::dtype(dtype.toStdString()), shape, strides,
+                   scalars->GetVoidPointer(0), base);
+}
+
+void setArray(vtkImageData* image, py::array array, const std::string& name)
+{
+  drainReleased();
+  auto dtype = py::cast<std::string>(array.dtype().attr("name"));
+  int type = tomviz::vtkType(QString::fromStdString(dtype));
+  if (type < 0 || !py::cast<bool>(array.dtype().attr("isnative"))) {
+    throw py::type_error("Unsupported array type: " + dtype);
+  }
+  if (array.ndim() < 1 || array.ndim() > 2 ||
+      !(array.flags() & py::array::c_style)) {
+    throw py::value_error("The array must be contiguous and one or two "
+                          "dimensional.");
+  }
+  vtkIdType tuples = array.shape(0);
+  int components = array.ndim() == 2 ? array.shape(1) : 1;
+  if (tuples != image->GetNumberOfPoints()) {
+    throw py::value_error("The size of the array doesn't match the image.");
+  }
+
+  vtkSmartPointer<vtkDataArray> scalars;
+  scalars.TakeReference(vtkDataArray::CreateDataArray(type));
+  scalars->SetName(name.c_str());
+  scalars->SetNumberOfComponents(components);
+  scalars->SetVoidArray(array.mutable_data(), tuples * components, 1);
+
+  // Keep the array alive as long as the scalars use its memory.
+  vtkNew<vtkCallbackCommand> release;
+  release->SetClientData(array.release().ptr());
+  release->SetCallback(releaseArray);
+  scalars->AddObserver(vtkCommand::DeleteEvent, release.Get());
+
+  image->GetPointData()->SetScalars(scalars);
+}
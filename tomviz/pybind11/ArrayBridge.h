@@ -0,0 +1,38 @@
+/******************************************************************************
+
+  This source file is part of the tomviz project.
+
+  Copyright Kitware, Inc.
+
+  This source code is released under the New BSD License, (the "License").
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+******************************************************************************/
+#ifndef tomvizArrayBridge_h
+#define tomvizArrayBridge_h
+
+#include <pybind11/numpy.h>
+
+#include <string>
+
+class vtkImageData;
+
+/// A writable numpy view of the scalars of the image, indexed x, y, z, with
+/// the components last if there are more than one. The view references the
+/// scalars, so it stays valid if they are replaced. None if there are no
+/// scalars.
+pybind11::object getArray(vtkImageData* image);
+
+/// Set a contiguous numpy array, with x varying fastest, as the scalars of the
+/// image. It is either one dimensional or has the components as its second
+/// dimension. The scalars use the memory of the array rather than a copy of
+/// it, the array is released when the scalars are deleted.
+void setArray(vtkImageData* image, pybind11::array array,
+              const std::string& name);
+
+#endif
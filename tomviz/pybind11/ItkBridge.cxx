@@ -0,0 +1,102 @@
+/******************************************************************************
+
+  This source file is part of the tomviz project.
+
+  Copyright Kitware, Inc.
+
+  This source code is released under the New BSD License, (the "License").
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+******************************************************************************/
+#include "ItkBridge.h"
+
+#include <itkCommand.h>
+#include <itkProcessObject.h>
+
+#include <cstdint>
+
+namespace py = pybind11;
+
+namespace {
+
+class ProgressCommand : public itk::Command
+{
+public:
+  typedef ProgressCommand Self;
+  typedef itk::SmartPointer<Self> Pointer;
+  itkNewMacro(Self);
+
+  void setCallback(py::function callback) { m_callback = callback; }
+
+  void Execute(itk::Object* caller, const itk::EventObject& event) override
+  {
+    Execute(const_cast<const itk::Object*>(caller), event);
+  }
+
+  void Execute(const itk::Object*, const itk::EventObject&) override
+  {
+    py::gil_scoped_acquire gil;
+    try {
+      m_callback();
+    } catch (py::error_already_set& e) {
+      // There is no Python frame to raise into, report it the way an
+      // itk.PyCommand would.
+      e.restore();
+      PyErr_Print();
+    }
+  }
+
+protected:
+  ProgressCommand() = default;
+
+  ~ProgressCommand() override
+  {
+    // The filter, and this along with it, may be deleted from C++ after the
+    // interpreter is gone.
+    if (Py_IsInitialized()) {
+      py::gil_scoped_acquire gil;
+      m_callback.release().dec_ref();
+    } else {
+      m_callback.release();
+    }
+  }
+
+private:
+  py::function m_callback;
+};
+
+itk::ProcessObject* processObject(py::object filter)
+{
+  // The SWIG pointer is to the wrapped filter class. ITK's classes only use
+  // single inheritance, so it is also a pointer to its LightObject base.
+  auto address = py::int_(filter.attr("this")).cast<std::uintptr_t>();
+  auto object = reinterpret_cast<itk::LightObject*>(address);
+  auto process = dynamic_cast<itk::ProcessObject*>(object);
+  if (process == nullptr) {
+    throw py::type_error("Expected an ITK filter.");
+  }
+  return process;
+}
+} // namespace
+
+void observeItkProgress(py::object filter, py::function callback)
+{
+  auto command = ProgressCommand::New();
+  command->setCallback(callback);
+  processObject(filter)->AddObserver(itk::ProgressEvent(), command);
+}
+
+void updateItkFilter(py::object filter)
+{
+  auto process = processObject(filter);
+  // Keep the filter alive should the Python wrapping be released by another
+  // thread while this one runs without the GIL.
+  itk::ProcessObject::Pointer guard = process;
+  py::gil_scoped_release release;
+  guard->Update();
+}
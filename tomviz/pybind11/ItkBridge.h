@@ -0,0 +1,32 @@
+/******************************************************************************
+
+  This source file is part of the tomviz project.
+
+  Copyright Kitware, Inc.
+
+  This source code is released under the New BSD License, (the "License").
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+******************************************************************************/
+#ifndef tomvizItkBridge_h
+#define tomvizItkBridge_h
+
+#include <pybind11/pybind11.h>
+
+/// Call the callback on the progress events of an ITK filter, given as its
+/// Python wrapping. Unlike an itk.PyCommand the callback takes the GIL itself,
+/// so it may be called while the filter is updated by updateItkFilter().
+void observeItkProgress(pybind11::object filter, pybind11::function callback);
+
+/// Update an ITK filter, given as its Python wrapping, with the GIL released
+/// so that other Python threads run while ITK does the work. Its progress
+/// must only be observed through observeItkProgress(). ITK exceptions are
+/// raised as RuntimeError, as the ITK wrapping does.
+void updateItkFilter(pybind11::object filter);
+
+#endif
@@ -0,0 +1,127 @@
+/******************************************************************************
+
+  This source file is part of the tomviz project.
+
+  Copyright Kitware, Inc.
+
+  This source code is released under the New BSD License, (the "License").
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+******************************************************************************/
+#include "ReconstructionBridge.h"
+
+#include "TomographyReconstruction.h"
+
+#include <vtkImageData.h>
+#include <vtkPointData.h>
+
+#include <functional>
+#include <mutex>
+#include <string>
+
+namespace py = pybind11;
+
+using tomviz::TomographyReconstruction::IterationCallback;
+using tomviz::TomographyReconstruction::SirtMethod;
+
+namespace {
+
+using Angles = py::array_t<double, py::array::c_style | py::array::forcecast>;
+using Reconstruct =
+  std::function<bool(const double* tiltAngles, float* recon,
+                     const IterationCallback& callback)>;
+
+py::object reconstruct(vtkImageData* tiltSeries, Angles tiltAngles,
+                       py::object callback, const Reconstruct& run)
+{
+  if (tiltSeries->GetPointData()->GetScalars() == nullptr) {
+    throw py::value_error("The tilt series has no scalars.");
+  }
+  int dims[3];
+  tiltSeries->GetDimensions(dims);
+  if (tiltAngles.ndim() != 1 || tiltAngles.shape(0) < dims[2]) {
+    throw py::value_error("There must be a tilt angle for each tilt.");
+  }
+
+  py::array_t<float, py::array::f_style> recon(
+    { static_cast<py::ssize_t>(dims[0]), static_cast<py::ssize_t>(dims[1]),
+      static_cast<py::ssize_t>(dims[1]) });
+
+  // Only the first error is kept, the other threads are canceled by it.
+  std::mutex errorMutex;
+  std::string error;
+  IterationCallback iterationDone;
+  if (!callback.is_none()) {
+    iterationDone = [&]() {
+      py::gil_scoped_acquire gil;
+      try {
+        return static_cast<bool>(py::bool_(callback()));
+      } catch (py::error_already_set& e) {
+        std::lock_guard<std::mutex> lock(errorMutex);
+        if (error.empty()) {
+          error = e.what();
+        }
+        return false;
+      }
+    };
+  }
+
+  bool completed = false;
+  {
+    py::gil_scoped_release release;
+    completed = run(tiltAngles.data(), recon.mutable_data(), iterationDone);
+  }
+  if (!error.empty()) {
+    throw std::runtime_error(error);
+  }
+  if (!completed) {
+    return py::none();
+  }
+  return std::move(recon);
+}
+} // namespace
+
+py::object reconstructArt(vtkImageData* tiltSeries, py::array_t<double> angles,
+                          int iterations, py::object callback)
+{
+  return reconstruct(
+    tiltSeries, Angles::ensure(angles), callback,
+    [&](const double* tiltAngles, float* recon, const IterationCallback& cb) {
+      return tomviz::TomographyReconstruction::art3(tiltSeries, tiltAngles,
+                                                    recon, iterations, cb);
+    });
+}
+
+py::object reconstructSirt(vtkImageData* tiltSeries, py::array_t<double> angles,
+                           int iterations, double stepSize, int method,
+                           py::object callback)
+{
+  if (method < static_cast<int>(SirtMethod::Landweber) ||
+      method > static_cast<int>(SirtMethod::ComponentAveraging)) {
+    throw py::value_error("Invalid update method.");
+  }
+  return reconstruct(
+    tiltSeries, Angles::ensure(angles), callback,
+    [&](const double* tiltAngles, float* recon, const IterationCallback& cb) {
+      return tomviz::TomographyReconstruction::sirt3(
+        tiltSeries, tiltAngles, recon, iterations, stepSize,
+        static_cast<SirtMethod>(method), cb);
+    });
+}
+
+py::object reconstructTvMinimization(vtkImageData* tiltSeries,
+                                     py::array_t<double> angles,
+                                     int iterations, py::object callback)
+{
+  return reconstruct(
+    tiltSeries, Angles::ensure(angles), callback,
+    [&](const double* tiltAngles, float* recon, const IterationCallback& cb) {
+      return tomviz::TomographyReconstruction::tvMinimization3(
+        tiltSeries, tiltAngles, recon, iterations, cb);
+    });
+}
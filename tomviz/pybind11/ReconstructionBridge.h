@@ -0,0 +1,44 @@
+/******************************************************************************
+
+  This source file is part of the tomviz project.
+
+  Copyright Kitware, Inc.
+
+  This source code is released under the New BSD License, (the "License").
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+******************************************************************************/
+#ifndef tomvizReconstructionBridge_h
+#define tomvizReconstructionBridge_h
+
+#include <pybind11/numpy.h>
+
+class vtkImageData;
+
+/// The iterative reconstructions of TomographyReconstruction, run with the GIL
+/// released. The callback, if not None, is called with no arguments each time
+/// a slice has been through an iteration, possibly from several threads, and
+/// cancels the reconstruction if it returns False. An exception raised by it
+/// also cancels the reconstruction and is raised as RuntimeError. They return
+/// the [x, y, y] float32 reconstruction in Fortran order, or None if canceled.
+pybind11::object reconstructArt(vtkImageData* tiltSeries,
+                                pybind11::array_t<double> tiltAngles,
+                                int iterations, pybind11::object callback);
+
+/// The method is the index of the TomographyReconstruction::SirtMethod.
+pybind11::object reconstructSirt(vtkImageData* tiltSeries,
+                                 pybind11::array_t<double> tiltAngles,
+                                 int iterations, double stepSize, int method,
+                                 pybind11::object callback);
+
+pybind11::object reconstructTvMinimization(vtkImageData* tiltSeries,
+                                           pybind11::array_t<double> tiltAngles,
+                                           int iterations,
+                                           pybind11::object callback);
+
+#endif
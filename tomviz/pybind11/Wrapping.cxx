@@ -16,8 +16,13 @@
 
 #include <pybind11/pybind11.h>
 
+#include "ArrayBridge.h"
+#ifdef TOMVIZ_ITK
+#include "ItkBridge.h"
+#endif
 #include "OperatorPythonWrapper.h"
 #include "PybindVTKTypeCaster.h"
+#include "ReconstructionBridge.h"
 
 #include "vtkImageData.h"
 
@@ -42,5 +47,29 @@ PYBIND11_PLUGIN(_wrapping)
     .def_property("progress_data", &OperatorPythonWrapper::progressData,
                   &OperatorPythonWrapper::setProgressData);
 
+  m.def("get_array", &getArray, "Writable view of the scalars of an image.");
+  m.def("set_array", &setArray,
+        "Set an array as the scalars of an image without copying it.");
+
+  m.def("reconstruct_art", &reconstructArt,
+        "Reconstruct a tilt series using ART.", py::arg("tilt_series"),
+        py::arg("tilt_angles"), py::arg("iterations"),
+        py::arg("callback") = py::none());
+  m.def("reconstruct_sirt", &reconstructSirt,
+        "Reconstruct a tilt series using SIRT.", py::arg("tilt_series"),
+        py::arg("tilt_angles"), py::arg("iterations"), py::arg("step_size"),
+        py::arg("method"), py::arg("callback") = py::none());
+  m.def("reconstruct_tv_minimization", &reconstructTvMinimization,
+        "Reconstruct a tilt series using TV minimization.",
+        py::arg("tilt_series"), py::arg("tilt_angles"), py::arg("iterations"),
+        py::arg("callback") = py::none());
+
+#ifdef TOMVIZ_ITK
+  m.def("observe_itk_progress", &observeItkProgress,
+        "Call a function on the progress events of an ITK filter.");
+  m.def("update_itk_filter", &updateItkFilter,
+        "Update an ITK filter with the GIL released.");
+#endif
+
   return m.ptr();
 }
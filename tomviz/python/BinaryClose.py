@@ -70,7 +70,7 @@ class BinaryClose(tomviz.operators.CancelableOperator):
                                              STEP_PCT[2], STEP_PCT[3])
 
             try:
-                erode_filter.Update()
+                itkutils.update_filter(erode_filter)
             except RuntimeError:
                 return
 
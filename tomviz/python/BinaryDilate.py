@@ -60,7 +60,7 @@ class BinaryDilate(tomviz.operators.CancelableOperator):
                                              STEP_PCT[1], STEP_PCT[2])
 
             try:
-                dilate_filter.Update()
+                itkutils.update_filter(dilate_filter)
             except RuntimeError:
                 return
 
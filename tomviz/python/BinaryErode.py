@@ -60,7 +60,7 @@ class BinaryErode(tomviz.operators.CancelableOperator):
                                              STEP_PCT[1], STEP_PCT[2])
 
             try:
-                erode_filter.Update()
+                itkutils.update_filter(erode_filter)
             except RuntimeError:
                 return
 
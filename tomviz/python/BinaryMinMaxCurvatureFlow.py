@@ -49,7 +49,7 @@ class BinaryMinMaxCurvatureFlow(tomviz.operators.CancelableOperator):
                                              STEP_PCT[1], STEP_PCT[2])
 
             try:
-                caster.Update()
+                itkutils.update_filter(caster)
             except RuntimeError:
                 return
 
@@ -65,7 +65,7 @@ class BinaryMinMaxCurvatureFlow(tomviz.operators.CancelableOperator):
                                              STEP_PCT[2], STEP_PCT[3])
 
             try:
-                smoothing_filter.Update()
+                itkutils.update_filter(smoothing_filter)
             except RuntimeError:
                 return
 
@@ -81,7 +81,7 @@ class BinaryMinMaxCurvatureFlow(tomviz.operators.CancelableOperator):
                                              STEP_PCT[3], STEP_PCT[4])
 
             try:
-                caster.Update()
+                itkutils.update_filter(caster)
             except RuntimeError:
                 return
 
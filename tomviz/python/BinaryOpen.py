@@ -70,7 +70,7 @@ class BinaryOpen(tomviz.operators.CancelableOperator):
                                              STEP_PCT[2], STEP_PCT[3])
 
             try:
-                dilate_filter.Update()
+                itkutils.update_filter(dilate_filter)
             except RuntimeError:
                 return
 
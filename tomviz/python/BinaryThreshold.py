@@ -61,7 +61,7 @@ class BinaryThreshold(tomviz.operators.CancelableOperator):
                                              STEP_PCT[2], STEP_PCT[3])
 
             try:
-                threshold_filter.Update()
+                itkutils.update_filter(threshold_filter)
             except RuntimeError:
                 return returnValue
 
@@ -40,7 +40,7 @@ class DefaultITKTransform(tomviz.operators.CancelableOperator):
             itkutils.observe_filter_progress(self, filter, 30, 70)
 
             try:
-                filter.Update()
+                itkutils.update_filter(filter)
             except RuntimeError: # Exception thrown when ITK filter is aborted
                 return
 
@@ -1,3 +1,7 @@
+# The 2D filter only blurs within each tilt image.
+PER_SLICE = True
+
+
 def transform_scalars(dataset, sigma=2.0):
     """Apply a Gaussian filter to tilt images."""
     """Gaussian Filter blurs the image and reduces the noise and details."""
@@ -58,7 +58,7 @@ class OtsuMultipleThreshold(tomviz.operators.CancelableOperator):
                                              STEP_PCT[1], STEP_PCT[2])
 
             try:
-                otsu_filter.Update()
+                itkutils.update_filter(otsu_filter)
             except RuntimeError:
                 return
 
@@ -83,7 +83,7 @@ class OtsuMultipleThreshold(tomviz.operators.CancelableOperator):
                                                  STEP_PCT[2], STEP_PCT[3])
 
                 try:
-                    caster.Update()
+                    itkutils.update_filter(caster)
                 except RuntimeError:
                     return
 
@@ -50,7 +50,7 @@ class PeronaMalikAnisotropicDiffusion(tomviz.operators.CancelableOperator):
                                              STEP_PCT[1], STEP_PCT[2])
 
             try:
-                diffusion_filter.Update()
+                itkutils.update_filter(diffusion_filter)
             except RuntimeError:
                 return
 
@@ -1,3 +1,7 @@
+# Bad pixels are found and replaced within each tilt image.
+PER_SLICE = True
+
+
 def transform_scalars(dataset, threshold=None):
     """Remove bad pixels in tilt series."""
 
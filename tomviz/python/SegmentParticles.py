@@ -16,7 +16,7 @@ def median_filter(operator, step_pct, input_image):
     itkutils.observe_filter_progress(operator, median_filter,
                                      progress, progress + next(step_pct))
     try:
-        median_filter.Update()
+        itkutils.update_filter(median_filter)
     except RuntimeError:
         return
 
@@ -38,7 +38,7 @@ def opening_by_reconstruction(operator, step_pct, input_image,
                                      progress, progress + next(step_pct))
 
     try:
-        opening.Update()
+        itkutils.update_filter(opening)
     except RuntimeError:
         return
 
@@ -60,7 +60,7 @@ def threshold(operator, step_pct, input_image):
                                      progress, progress + next(step_pct))
 
     try:
-        otsu_filter.Update()
+        itkutils.update_filter(otsu_filter)
     except RuntimeError:
         return
 
@@ -82,7 +82,7 @@ def threshold(operator, step_pct, input_image):
                                          progress, progress + next(step_pct))
 
         try:
-            caster.Update()
+            itkutils.update_filter(caster)
         except RuntimeError:
             return
 
@@ -105,7 +105,7 @@ def morphological_closing(operator, step_pct, input_image, structuring_element):
                                      progress, progress + next(step_pct))
 
     try:
-        closer.Update()
+        itkutils.update_filter(closer)
     except RuntimeError:
         return
 
@@ -125,7 +125,7 @@ def morphological_opening(operator, step_pct, input_image, structuring_element):
                                      progress, progress + next(step_pct))
 
     try:
-        opener.Update()
+        itkutils.update_filter(opener)
     except RuntimeError:
         return
 
@@ -144,7 +144,7 @@ def fill_holes(operator, step_pct, input_image):
                                      progress, progress + next(step_pct))
 
     try:
-        fill_hole.Update()
+        itkutils.update_filter(fill_hole)
     except RuntimeError:
         return
 
@@ -17,7 +17,7 @@ def median_filter(operator, step_pct, input_image):
     itkutils.observe_filter_progress(operator, median_filter,
                                      progress, progress + next(step_pct))
     try:
-        median_filter.Update()
+        itkutils.update_filter(median_filter)
     except RuntimeError:
         return
 
@@ -40,7 +40,7 @@ def unsharp_mask(operator, step_pct, input_image):
     itkutils.observe_filter_progress(operator, enhancer,
                                      progress, progress + next(step_pct))
     try:
-        enhancer.Update()
+        itkutils.update_filter(enhancer)
     except RuntimeError:
         return
 
@@ -62,7 +62,7 @@ def get_distance(operator, step_pct, input_image):
     itkutils.observe_filter_progress(operator, distance_mapper,
                                      progress, progress + next(step_pct))
     try:
-        distance_mapper.Update()
+        itkutils.update_filter(distance_mapper)
     except RuntimeError:
         return
 
@@ -81,7 +81,7 @@ def invert(operator, step_pct, input_image):
     itkutils.observe_filter_progress(operator, inverter,
                                      progress, progress + next(step_pct))
     try:
-        inverter.Update()
+        itkutils.update_filter(inverter)
     except RuntimeError:
         return
 
@@ -103,7 +103,7 @@ def threshold(operator, step_pct, input_image):
                                      progress, progress + next(step_pct))
 
     try:
-        otsu_filter.Update()
+        itkutils.update_filter(otsu_filter)
     except RuntimeError:
         return
 
@@ -126,7 +126,7 @@ def threshold(operator, step_pct, input_image):
                                          progress, progress + next(step_pct))
 
         try:
-            caster.Update()
+            itkutils.update_filter(caster)
         except RuntimeError:
             return
 
@@ -159,7 +159,7 @@ def watershed(operator, step_pct, input_image, level):
     itkutils.observe_filter_progress(operator, watershed_filter,
                                      progress, progress + next(step_pct))
     try:
-        watershed_filter.Update()
+        itkutils.update_filter(watershed_filter)
     except RuntimeError:
         return
 
@@ -202,7 +202,7 @@ def morphological_closing(operator, step_pct, input_image, structuring_element):
                                      progress, progress + next(step_pct))
 
     try:
-        closer.Update()
+        itkutils.update_filter(closer)
     except RuntimeError:
         return
 
@@ -237,7 +237,7 @@ def encapsulate(operator, step_pct, input_image, mask, structuring_element):
                                      progress, nextprogress)
 
     try:
-        or_filter.Update()
+        itkutils.update_filter(or_filter)
     except RuntimeError:
         return
 
@@ -259,7 +259,7 @@ def opening_by_reconstruction(operator, step_pct, input_image,
                                      progress, progress + next(step_pct))
 
     try:
-        opening.Update()
+        itkutils.update_filter(opening)
     except RuntimeError:
         return
 
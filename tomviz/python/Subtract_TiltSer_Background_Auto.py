@@ -1,3 +1,7 @@
+# The background level is estimated separately for each tilt image.
+PER_SLICE = True
+
+
 def transform_scalars(dataset):
     """
     For each tilt image, the method calculates its histogram
@@ -47,7 +47,7 @@ class UnsharpMask(tomviz.operators.CancelableOperator):
                                              next(step_pct))
 
             try:
-                unsharp_mask.Update()
+                itkutils.update_filter(unsharp_mask)
             except RuntimeError:
                 return
 
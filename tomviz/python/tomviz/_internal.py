@@ -78,6 +78,13 @@ def is_cancelable(transform_module):
                                           tomviz.operators.CancelableOperator)
 
 
+def is_per_slice(transform_module):
+    # Operators transforming each slice independently of the others declare it
+    # with a module level PER_SLICE = True, so appended slices can be run
+    # through them on their own.
+    return bool(getattr(transform_module, 'PER_SLICE', False))
+
+
 def find_transform_scalars(transform_module, op=None):
 
     transform_function = find_transform_scalars_function(transform_module)
@@ -103,6 +110,12 @@ def find_transform_scalars(transform_module, op=None):
     return transform_function
 
 
+def python_path():
+    # The pipeline workers run in their own interpreter, they are given the
+    # module search path of the application's one.
+    return os.pathsep.join(sys.path)
+
+
 def _load_module(operator_dir, python_file):
     module_name, _ = os.path.splitext(python_file)
     fp, pathname, description = imp.find_module(module_name, [operator_dir])
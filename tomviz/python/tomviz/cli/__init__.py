@@ -70,9 +70,10 @@ def main(data_file_path, state_file_path, output_file_path, progress_method,
         # absolute path.
         data_file_path = os.path.abspath(
             os.path.join(os.path.dirname(state_file_path), data_file_path))
-        if not data_file_path.lower().endswith('.emd'):
+        if not data_file_path.lower().endswith(('.emd', '.json')):
             raise Exception(
-                'Unsupported data source format, only EMD is supported.')
+                'Unsupported data source format, only EMD and raw with a '
+                'JSON header are supported.')
         if not os.path.exists(data_file_path):
             raise Exception('Data source path does not exist: %s'
                             % data_file_path)
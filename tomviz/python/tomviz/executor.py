@@ -9,6 +9,7 @@ import socket
 import abc
 import stat
 import json
+import time
 import six
 
 
@@ -186,7 +187,7 @@ class JsonProgress(ProgressBase):
         m = {
             'type': 'progress.message',
             'operator': self._operator_index,
-            'messages': msg
+            'value': msg
         }
         self.write(m)
 
@@ -359,6 +360,79 @@ def _write_emd(path, data, dims):
             d[:] = value
 
 
+def _read_raw(path):
+    # The header describes a C ordered raw file, in the same directory, that is
+    # mapped rather than read. The mapping is copy on write so operators can
+    # modify the data in place without touching the file.
+    with open(path, 'r') as f:
+        header = json.load(f)
+
+    data_path = os.path.join(os.path.dirname(path), header['file'])
+    data = numpy.memmap(data_path, dtype=numpy.dtype(header['dtype']),
+                        mode='c', shape=tuple(header['shape']))
+
+    return (data, header['spacing'])
+
+
+def _write_raw(path, data, spacing):
+    data_file = '%s.raw' % os.path.splitext(os.path.basename(path))[0]
+    data_path = os.path.join(os.path.dirname(path), data_file)
+    out = numpy.memmap(data_path, dtype=data.dtype, mode='w+',
+                       shape=data.shape)
+    out[...] = data
+    out.flush()
+    del out
+
+    # Write the header last, so it is only there once the data is complete.
+    header = {
+        'file': data_file,
+        'dtype': data.dtype.name,
+        'shape': list(data.shape),
+        'spacing': list(spacing)
+    }
+    with open(path, 'w') as f:
+        json.dump(header, f)
+
+
+def _is_raw(path):
+    return path.lower().endswith('.json')
+
+
+def _dims_to_spacing(dims):
+    # The first dimension is the slowest varying axis, z.
+    return [float(value[1] - value[0]) for (_, value, _, _) in reversed(dims)]
+
+
+def _spacing_to_dims(spacing):
+    dims = []
+    for (dataset_name, name, step) in zip(DIMS, ['x', 'y', 'z'],
+                                          reversed(spacing)):
+        dims.append((dataset_name, [0.0, step], name, '[n_m]'))
+
+    return dims
+
+
+def _read_data(path):
+    start = time.time()
+    if _is_raw(path):
+        data, spacing = _read_raw(path)
+        dims = _spacing_to_dims(spacing)
+    else:
+        data, dims = _read_emd(path)
+    logger.info('Read data in %.3f s.' % (time.time() - start))
+
+    return (data, dims)
+
+
+def _write_data(path, data, dims):
+    start = time.time()
+    if _is_raw(path):
+        _write_raw(path, data, _dims_to_spacing(dims))
+    else:
+        _write_emd(path, data, dims)
+    logger.info('Wrote data in %.3f s.' % (time.time() - start))
+
+
 def _execute_transform(operator_label, transform, arguments, input, progress):
     # Monkey patch tomviz.utils to make get_scalars a no-op and allow use to
     # retrieve the transformed data from set_scalars. I know this is a little
@@ -429,7 +503,7 @@ def _load_transform_functions(operators):
 
 def execute(operators, start_at, data_file_path, output_file_path,
             progress_method, progress_path):
-    data, dims = _read_emd(data_file_path)
+    data, dims = _read_data(data_file_path)
 
     operators = operators[start_at:]
     transforms = _load_transform_functions(operators)
@@ -448,7 +522,7 @@ def execute(operators, start_at, data_file_path, output_file_path,
         if output_file_path is None:
             output_file_path = '%s_transformed.emd' % \
                 os.path.splitext(os.path.basename(data_file_path))[0]
-        _write_emd(output_file_path, data, dims)
+        _write_data(output_file_path, data, dims)
         logger.info('Write complete.')
         progress.finished()
 
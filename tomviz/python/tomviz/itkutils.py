@@ -16,6 +16,7 @@
 #
 ###############################################################################
 from tomviz import py2to3
+from tomviz._internal import in_application
 
 # Dictionary going from VTK array type to ITK type
 _vtk_to_itk_types = None
@@ -418,7 +419,34 @@ def observe_filter_progress(transform, filter, start_pct, end_pct):
         if transform.canceled:
             filter.AbortGenerateDataOn()
 
+    bridge = _itk_bridge()
+    if bridge is not None:
+        bridge.observe_itk_progress(filter, progress_func)
+        return
+
     import itk
     progress_observer = itk.PyCommand.New()
     progress_observer.SetCommandCallable(progress_func)
     filter.AddObserver(itk.ProgressEvent(), progress_observer)
+
+
+def update_filter(filter):
+    """Update an ITK filter. Within the application the GIL is released while
+    ITK runs, so that operators of other pipelines make progress meanwhile.
+    The progress of the filter, and of any filter upstream of it, must only be
+    observed through observe_filter_progress."""
+    bridge = _itk_bridge()
+    if bridge is not None:
+        bridge.update_itk_filter(filter)
+    else:
+        filter.Update()
+
+
+def _itk_bridge():
+    """The tomviz wrapping if it was built to update ITK filters."""
+    if in_application():
+        from tomviz import _wrapping
+        if hasattr(_wrapping, 'update_itk_filter'):
+            return _wrapping
+
+    return None
@@ -22,6 +22,7 @@ from tomviz._internal import in_application
 if in_application():
     import vtk.numpy_interface.dataset_adapter as dsa
     import vtk.util.numpy_support as np_s
+    from tomviz import _wrapping
 
 
 def get_scalars(dataobject):
@@ -43,32 +44,39 @@ def is_numpy_vtk_type(newscalars):
         return True
 
 
-def set_scalars(dataobject, newscalars):
-    do = dsa.WrapDataObject(dataobject)
-    oldscalars = do.PointData.GetScalars()
-    if oldscalars is None:
-        name = "scalars"
-    else:
-        name = oldscalars.GetName()
-        del oldscalars
+def _vtk_compatible(array):
+    # Returns the array, or a copy of it, with a type that can be used as VTK
+    # scalars.
+    if array.dtype == np.bool_:
+        # Same layout, no need to copy
+        return array.view(np.uint8)
+    if not is_numpy_vtk_type(array):
+        return array.astype(np.float32)
+    if not array.dtype.isnative or not array.flags.writeable:
+        return array.astype(array.dtype.newbyteorder('='))
+    return array
 
-    if not is_numpy_vtk_type(newscalars):
-        newscalars = newscalars.astype(np.float32)
 
-    do.PointData.append(newscalars, name)
-    do.PointData.SetActiveScalars(name)
+def _scalars_name(dataobject, default):
+    scalars = dataobject.GetPointData().GetScalars()
+    if scalars is None or not scalars.GetName():
+        return default
+    return scalars.GetName()
+
+
+def set_scalars(dataobject, newscalars):
+    name = _scalars_name(dataobject, "scalars")
+    newscalars = _vtk_compatible(np.ascontiguousarray(newscalars))
+    _wrapping.set_array(dataobject, newscalars, name)
 
 
 def get_array(dataobject, order='F'):
-    scalars_array = get_scalars(dataobject)
-    if order == 'F':
-        scalars_array3d = np.reshape(scalars_array,
-                                     (dataobject.GetDimensions()),
-                                     order=order)
-    else:
-        scalars_array3d = np.reshape(scalars_array,
-                                     (dataobject.GetDimensions()[::-1]),
-                                     order=order)
+    # A writable view of the scalars, no copy is made.
+    scalars_array3d = _wrapping.get_array(dataobject)
+    if order != 'F' and scalars_array3d is not None:
+        # Reverse the spatial axes, the components stay last.
+        axes = [2, 1, 0] + list(range(3, scalars_array3d.ndim))
+        scalars_array3d = scalars_array3d.transpose(axes)
     return scalars_array3d
 
 
@@ -98,8 +106,7 @@ def set_array(dataobject, newarray, minextent=None, isFortran=True):
         arr = tmp.reshape(-1, order='F')
         print('...done.')
 
-    if not is_numpy_vtk_type(arr):
-        arr = arr.astype(np.float32)
+    arr = _vtk_compatible(arr)
 
     if minextent is None:
         minextent = dataobject.GetExtent()[::2]
@@ -112,17 +119,10 @@ def set_array(dataobject, newarray, minextent=None, isFortran=True):
             [x + y - 1 for (x, y) in zip(minextent, vtkshape)]
         dataobject.SetExtent(extent)
 
-    # Now replace the scalars array with the new array.
-    vtkarray = np_s.numpy_to_vtk(arr)
-    vtkarray.Association = dsa.ArrayAssociation.POINT
-    do = dsa.WrapDataObject(dataobject)
-    oldscalars = do.PointData.GetScalars()
-    arrayname = "Scalars"
-    if oldscalars is not None:
-        arrayname = oldscalars.GetName()
-    del oldscalars
-    do.PointData.append(arr, arrayname)
-    do.PointData.SetActiveScalars(arrayname)
+    # Now replace the scalars array with the new array, VTK takes over its
+    # memory.
+    arrayname = _scalars_name(dataobject, "Scalars")
+    _wrapping.set_array(dataobject, arr, arrayname)
 
 
 def get_tilt_angles(dataobject):
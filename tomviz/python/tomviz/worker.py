@@ -0,0 +1,83 @@
+###############################################################################
+#
+#  This source file is part of the tomviz project.
+#
+#  Copyright Kitware, Inc.
+#
+#  This source code is released under the New BSD License, (the "License").
+#
+#  Unless required by applicable law or agreed to in writing, software
+#  distributed under the License is distributed on an "AS IS" BASIS,
+#  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+#  See the License for the specific language governing permissions and
+#  limitations under the License.
+#
+###############################################################################
+"""
+A persistent pipeline worker, started by the application for its process pool
+execution mode. Jobs are read from stdin, one JSON object per line:
+
+    {
+        "operators": [...],     # serialized operators of the pipeline
+        "start": 0,             # index of the first operator to run
+        "input": "...",         # EMD file or JSON header of raw data
+        "output": "...",        # where to write the transformed data
+        "progress": "socket",   # progress method, see executor.execute
+        "progressPath": "..."
+    }
+
+A JSON object is written back on stdout once a job is done, either
+{"status": "ok"} or {"status": "error", "error": "..."}. The worker exits when
+stdin is closed.
+"""
+import importlib
+import json
+import sys
+import traceback
+
+# Imported once up front, so the operators of every job find them loaded.
+PRELOAD_MODULES = ['tomviz.executor', 'numpy', 'scipy', 'scipy.ndimage',
+                   'itk']
+
+
+def _preload():
+    for name in PRELOAD_MODULES:
+        try:
+            importlib.import_module(name)
+        except ImportError:
+            pass
+
+
+def _run(job):
+    from tomviz import executor
+
+    executor.execute(job['operators'], job.get('start', 0), job['input'],
+                     job['output'], job.get('progress', 'tqdm'),
+                     job.get('progressPath'))
+
+
+def main():
+    # Anything the operators print goes to stderr, stdout only carries the
+    # replies.
+    replies = sys.stdout
+    sys.stdout = sys.stderr
+
+    _preload()
+
+    for line in iter(sys.stdin.readline, ''):
+        line = line.strip()
+        if not line:
+            continue
+
+        try:
+            _run(json.loads(line))
+            reply = {'status': 'ok'}
+        except Exception:
+            reply = {'status': 'error', 'error': traceback.format_exc()}
+
+        replies.write('%s\n' % json.dumps(reply))
+        replies.flush()
+
+
+if __name__ == '__main__':
+    main()